@@ -16,6 +16,7 @@
 #include "unit.h"
 #include "map.h"
 #include "faction_type.h"
+#include "config.h"
 #include "leak_dumper.h"
 
 using namespace
@@ -434,6 +435,13 @@ namespace
 			aiRules.push_back(new AiRuleExpand(this));
 			aiRules.push_back(new AiRuleRepair(this));
 			aiRules.push_back(new AiRuleRepair(this));
+
+			staggerRules =
+				Config::getInstance().getBool("AiStaggerRules", "true");
+			maxRulesPerUpdate =
+				Config::getInstance().getInt("AiMaxRulesPerUpdate", "0");
+			deferredRules.assign(aiRules.size(), false);
+			dueRules.reserve(aiRules.size());
 		}
 
 		Ai::~Ai() {
@@ -473,6 +481,20 @@ namespace
 			return &random;
 		}
 
+		bool
+			Ai::isRuleDue(unsigned int ruleIdx) const {
+			int
+				intervalFrames =
+				AiRuleSchedule::getIntervalFrames(aiRules[ruleIdx]->
+					getTestInterval(), GameConstants::updateFps);
+			int
+				phase =
+				AiRuleSchedule::getPhase(ruleIdx, aiInterface->getFactionIndex(),
+					intervalFrames, staggerRules);
+			return AiRuleSchedule::isDue(aiInterface->getTimer(), phase,
+				intervalFrames);
+		}
+
 		void
 			Ai::update() {
 
@@ -563,8 +585,26 @@ namespace
 					voteResult);
 			}
 
-			//process ai rules
+			//process ai rules, the ones deferred last frame go first
+			dueRules.clear();
 			for (unsigned int ruleIdx = 0; ruleIdx < aiRules.size(); ++ruleIdx) {
+				if (deferredRules[ruleIdx] == true) {
+					dueRules.push_back(ruleIdx);
+				}
+			}
+			for (unsigned int ruleIdx = 0; ruleIdx < aiRules.size(); ++ruleIdx) {
+				if (deferredRules[ruleIdx] == false && isRuleDue(ruleIdx) == true) {
+					dueRules.push_back(ruleIdx);
+				}
+			}
+
+			AiRuleTrace *
+				ruleTrace = aiInterface->getRuleTrace();
+			int64
+				ruleStartMicros = 0;
+			for (unsigned int dueIdx = 0; dueIdx < dueRules.size(); ++dueIdx) {
+				unsigned int
+					ruleIdx = dueRules[dueIdx];
 				AiRule *
 					rule = aiRules[ruleIdx];
 				if (rule == NULL) {
@@ -579,11 +619,15 @@ namespace
 						"In [%s::%s Line: %d] took msecs: %lld [ruleIdx = %d]\n",
 						__FILE__, __FUNCTION__, __LINE__,
 						chrono.getMillis(), ruleIdx);
-				// Determines wether to process AI rules. Whether a particular rule is processed, is weighted by getTestInterval().
+				// Rules past the per update limit wait for the next update. The
+				// limit counts rules, not time, so the AI makes the same choices
+				// however fast the machine is. At least one rule runs each update
+				// so none starve.
 				// Values returned by getTestInterval() are defined in ai_rule.h.
-				if ((aiInterface->getTimer() %
-					(rule->getTestInterval() * GameConstants::updateFps /
-						1000)) == 0) {
+				deferredRules[ruleIdx] =
+					(maxRulesPerUpdate > 0 &&
+						dueIdx >= (unsigned int) maxRulesPerUpdate);
+				if (deferredRules[ruleIdx] == false) {
 
 					if (SystemFlags::
 						getSystemSettingType(SystemFlags::debugPerformance).enabled
@@ -595,20 +639,35 @@ namespace
 
 					//printf("Testing AI Faction # %d RULE Name[%s]\n",aiInterface->getFactionIndex(),rule->getName().c_str());
 
+					if (ruleTrace->isEnabled() == true) {
+						ruleTrace->beginRule(aiInterface->getTimer(),
+							aiInterface->getFactionIndex(), ruleIdx,
+							rule->getName());
+						ruleStartMicros = AiRuleTrace::getCurrentMicros();
+					}
+					int64
+						testMicros = 0;
+
 					// Test to see if AI can execute rule e.g. is there a worker available to for harvesting wood?
-					if (rule->test()) {
+					bool
+						ruleTestPassed = rule->test();
+					if (ruleTrace->isEnabled() == true) {
+						testMicros = AiRuleTrace::getCurrentMicros() - ruleStartMicros;
+						if (ruleTestPassed == false) {
+							ruleTrace->endRule(false, testMicros, 0);
+						}
+					}
+					if (ruleTestPassed) {
 						if (outputAIBehaviourToConsole())
 							printf
 							("\n\nYYYYY Executing AI Faction # %d RULE Name[%s]\n\n",
 								aiInterface->getFactionIndex(),
 								rule->getName().c_str());
 
-						aiInterface->printLog(3,
-							intToStr(1000 *
-								aiInterface->getTimer() /
-								GameConstants::updateFps) +
-							": Executing rule: " +
-							rule->getName() + '\n');
+						aiInterface->printLogf(3, "%d: Executing rule: %s\n",
+							1000 * aiInterface->getTimer() /
+							GameConstants::updateFps,
+							rule->getName().c_str());
 
 						if (SystemFlags::
 							getSystemSettingType(SystemFlags::debugPerformance).
@@ -620,7 +679,14 @@ namespace
 								ruleIdx,
 								rule->getName().c_str());
 						// Execute the rule.
+						if (ruleTrace->isEnabled() == true) {
+							ruleStartMicros = AiRuleTrace::getCurrentMicros();
+						}
 						rule->execute();
+						if (ruleTrace->isEnabled() == true) {
+							ruleTrace->endRule(true, testMicros,
+								AiRuleTrace::getCurrentMicros() - ruleStartMicros);
+						}
 
 						if (SystemFlags::
 							getSystemSettingType(SystemFlags::debugPerformance).
@@ -713,12 +779,9 @@ namespace
 					r = aiInterface->getResource(rt);
 
 				if (rt->getClass() != rcStatic && rt->getClass() != rcConsumable) {
-					char
-						szBuf[8096] = "";
-					snprintf(szBuf, 8096,
+					aiInterface->printLogf(3,
 						"Examining resource [%s] amount [%d] (previous amount [%d]",
 						rt->getName().c_str(), r->getAmount(), amount);
-					aiInterface->printLog(3, szBuf);
 				}
 
 				if (rt->getClass() != rcStatic && rt->getClass() != rcConsumable
@@ -756,17 +819,13 @@ namespace
 				}
 			}
 
-			char
-				szBuf[8096] = "";
-			snprintf(szBuf, 8096,
+			aiInterface->printLogf(3,
 				"Unit [%d - %s] looking for resources (not static or consumable)",
 				unit->getId(), unit->getType()->getName(false).c_str());
-			aiInterface->printLog(3, szBuf);
-			snprintf(szBuf, 8096, "[resource type count %d] Needed resource [%s].",
+			aiInterface->printLogf(3, "[resource type count %d] Needed resource [%s].",
 				tt->getResourceTypeCount(),
 				(neededResource !=
 					NULL ? neededResource->getName().c_str() : "<none>"));
-			aiInterface->printLog(3, szBuf);
 
 			return neededResource;
 		}
@@ -783,21 +842,15 @@ namespace
 			UnitClass
 				ucWorkerType = ucWorker;
 			if (getCountOfClass(ucWarrior, &ucWorkerType) > minWarriors) {
-				char
-					szBuf[8096] = "";
-				snprintf(szBuf, 8096,
+				aiInterface->printLogf(4,
 					"Base is stable [minWarriors = %d found = %d]",
 					minWarriors, ucWorkerType);
-				aiInterface->printLog(4, szBuf);
 
 				return true;
 			} else {
-				char
-					szBuf[8096] = "";
-				snprintf(szBuf, 8096,
+				aiInterface->printLogf(4,
 					"Base is NOT stable [minWarriors = %d found = %d]",
 					minWarriors, ucWorkerType);
-				aiInterface->printLog(4, szBuf);
 
 				return false;
 			}
@@ -968,16 +1021,43 @@ namespace
 			Ai::findPosForBuilding(const UnitType * building,
 				const Vec2i & searchPos, Vec2i & outPos) {
 
-			for (int currRadius = 0; currRadius < maxBuildRadius; ++currRadius) {
-				for (int i = searchPos.x - currRadius; i < searchPos.x + currRadius;
-					++i) {
-					for (int j = searchPos.y - currRadius;
-						j < searchPos.y + currRadius; ++j) {
-						outPos = Vec2i(i, j);
-						if (aiInterface->
+			int
+				footprintSize = building->getAiBuildSize() + minBuildSpacing * 2;
+			if (maxBuildRadius <= 1) {
+				return false;
+			}
+
+			// free cells are looked up once per window instead of once per
+			// candidate, the window grows as the search radius does
+			int
+				tableRadius = 0;
+
+			// the cells of radius currRadius not already tested at a smaller
+			// radius, visited in the order of the full square scan
+			for (int currRadius = 1; currRadius < maxBuildRadius; ++currRadius) {
+				if (currRadius > tableRadius) {
+					tableRadius = min(max(tableRadius * 2, 8), maxBuildRadius - 1);
+					int
+						tableSize = tableRadius * 2 - 1 + footprintSize;
+					buildCellsTable.build(aiInterface->getMap(),
+						searchPos - Vec2i(tableRadius + minBuildSpacing),
+						tableSize, tableSize, fLand);
+				}
+
+				int
+					minPos = -currRadius;
+				int
+					maxPos = currRadius - 1;
+				for (int i = minPos; i <= maxPos; ++i) {
+					bool
+						fullColumn = (i == minPos || i == maxPos);
+					int
+						step = (fullColumn == true ? 1 : maxPos - minPos);
+					for (int j = minPos; j <= maxPos; j += step) {
+						outPos = Vec2i(searchPos.x + i, searchPos.y + j);
+						if (buildCellsTable.
 							isFreeCells(outPos - Vec2i(minBuildSpacing),
-								building->getAiBuildSize() +
-								minBuildSpacing * 2, fLand)) {
+								footprintSize)) {
 							int
 								aiBuildSizeDiff =
 								building->getAiBuildSize() - building->getSize();
@@ -1003,7 +1083,9 @@ namespace
 		void
 			Ai::addTask(const Task * task) {
 			tasks.push_back(task);
-			aiInterface->printLog(2, "Task added: " + task->toString());
+			if (aiInterface->isLogLevelEnabled(2) == true) {
+				aiInterface->printLog(2, "Task added: " + task->toString());
+			}
 		}
 
 		void
@@ -1012,7 +1094,9 @@ namespace
 			tasks.clear();
 
 			tasks.push_back(task);
-			aiInterface->printLog(2, "Priority Task added: " + task->toString());
+			if (aiInterface->isLogLevelEnabled(2) == true) {
+				aiInterface->printLog(2, "Priority Task added: " + task->toString());
+			}
 		}
 
 		bool
@@ -1031,7 +1115,9 @@ namespace
 
 		void
 			Ai::removeTask(const Task * task) {
-			aiInterface->printLog(2, "Task removed: " + task->toString());
+			if (aiInterface->isLogLevelEnabled(2) == true) {
+				aiInterface->printLog(2, "Task removed: " + task->toString());
+			}
 			tasks.remove(task);
 			delete
 				task;
@@ -1188,10 +1274,8 @@ namespace
 							__FUNCTION__, __LINE__);
 
 					aiInterface->giveCommand(unit, ccAttack, pos);
-					aiInterface->printLog(2,
-						"Scout patrol sent to: " +
-						intToStr(pos.x) + "," +
-						intToStr(pos.y) + "\n");
+					aiInterface->printLogf(2,
+						"Scout patrol sent to: %d,%d\n", pos.x, pos.y);
 				}
 			}
 		}
@@ -1388,9 +1472,8 @@ namespace
 					minWarriors += minMinWarriorsExpandCpuNormal;
 				}
 			}
-			aiInterface->printLog(2,
-				"Massive attack to pos: " + intToStr(pos.x) +
-				", " + intToStr(pos.y) + "\n");
+			aiInterface->printLogf(2,
+				"Massive attack to pos: %d, %d\n", pos.x, pos.y);
 		}
 
 		void
@@ -19,6 +19,7 @@
 #   include "commander.h"
 #   include "command.h"
 #   include "randomgen.h"
+#   include "ai_rule_schedule.h"
 #   include "leak_dumper.h"
 
 using
@@ -280,6 +281,23 @@ namespace
 				factionSwitchTeamRequestCount;
 			int
 				minWarriors;
+			FreeCellsTable
+				buildCellsTable;
+
+			// rule scheduling: rules with the same test interval are spread
+			// over different frames, and rules past the per update limit
+			// are deferred to the next frame
+			bool
+				staggerRules;
+			int
+				maxRulesPerUpdate;
+			std::vector < bool >
+				deferredRules;
+			std::vector < unsigned int >
+				dueRules;
+
+			bool
+				isRuleDue(unsigned int ruleIdx) const;
 
 			bool
 				getAdjacentUnits(std::map < float, std::map < int,
@@ -306,6 +324,8 @@ namespace
 				startLoc = -1;
 				randomMinWarriorsReached = false;
 				minWarriors = 0;
+				staggerRules = true;
+				maxRulesPerUpdate = 0;
 			}
 			~
 				Ai();
@@ -22,6 +22,7 @@
 
 #include "ai_interface.h"
 
+#include <cstdarg>
 #include "ai.h"
 #include "command_type.h"
 #include "faction.h"
@@ -92,9 +93,7 @@ namespace
 		void
 			AiInterfaceThread::signal(int frameIndex) {
 			if (frameIndex >= 0) {
-				static string
-					mutexOwnerId =
-					string(__FILE__) + string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				MutexSafeWrapper
 					safeMutex(triggerIdMutex, mutexOwnerId);
 				this->frameIndex.first = frameIndex;
@@ -108,9 +107,7 @@ namespace
 		void
 			AiInterfaceThread::setTaskCompleted(int frameIndex) {
 			if (frameIndex >= 0) {
-				static string
-					mutexOwnerId =
-					string(__FILE__) + string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				MutexSafeWrapper
 					safeMutex(triggerIdMutex, mutexOwnerId);
 				if (this->frameIndex.first == frameIndex) {
@@ -138,8 +135,7 @@ namespace
 			if (getRunningStatus() == false) {
 				return true;
 			}
-			static string
-				mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper
 				safeMutex(triggerIdMutex, mutexOwnerId);
 			//bool result = (event != NULL ? event->eventCompleted : true);
@@ -158,7 +154,7 @@ namespace
 			if (this->aiIntf != NULL) {
 				MutexSafeWrapper
 					safeMutex(this->aiIntf->getMutex(),
-						string(__FILE__) + "_" + intToStr(__LINE__));
+						CODE_AT_LINE);
 				this->aiIntf = NULL;
 			}
 
@@ -213,9 +209,7 @@ namespace
 						break;
 					}
 
-					static string
-						mutexOwnerId =
-						string(__FILE__) + string("_") + intToStr(__LINE__);
+					static const char *mutexOwnerId = CODE_AT_LINE;
 					MutexSafeWrapper
 						safeMutex(triggerIdMutex, mutexOwnerId);
 					bool
@@ -231,7 +225,7 @@ namespace
 
 						MutexSafeWrapper
 							safeMutex(this->aiIntf->getMutex(),
-								string(__FILE__) + "_" + intToStr(__LINE__));
+								CODE_AT_LINE);
 
 						this->aiIntf->update();
 
@@ -294,6 +288,7 @@ namespace
 			this->aiMutex = new Mutex(CODE_AT_LINE);
 			this->workerThread = NULL;
 			this->world = game.getWorld();
+			this->threatMap = game.getAiThreatMap();
 			this->commander = game.getCommander();
 			this->console = game.getConsole();
 			this->gameSettings = game.getGameSettings();
@@ -309,20 +304,19 @@ namespace
 			logLevel = Config::getInstance().getInt("AiLog");
 			redir = Config::getInstance().getBool("AiRedir");
 
-			aiLogFile = getLogFilename();
+			string
+				logPath = "";
 			if (getGameReadWritePath(GameConstants::path_logs_CacheLookupKey) !=
 				"") {
-				aiLogFile =
-					getGameReadWritePath(GameConstants::path_logs_CacheLookupKey) +
-					aiLogFile;
+				logPath =
+					getGameReadWritePath(GameConstants::path_logs_CacheLookupKey);
 			} else {
-				string
-					userData = Config::getInstance().getString("UserData_Root", "");
-				if (userData != "") {
-					endPathWithSlash(userData);
+				logPath = Config::getInstance().getString("UserData_Root", "");
+				if (logPath != "") {
+					endPathWithSlash(logPath);
 				}
-				aiLogFile = userData + aiLogFile;
 			}
+			aiLogFile = logPath + getLogFilename();
 
 			//clear log file
 			if (logLevel > 0) {
@@ -344,6 +338,9 @@ namespace
 					this->world->getFaction(this->factionIndex)->getType()->
 					getName().c_str(), this->factionIndex);
 			}
+			if (Config::getInstance().getBool("AiRuleTrace", "false") == true) {
+				ruleTrace.open(logPath + getRuleTraceFilename());
+			}
 
 
 			if (Config::getInstance().getBool("EnableAIWorkerThreads", "true") ==
@@ -356,10 +353,7 @@ namespace
 					}
 					workerThread = NULL;
 				}
-				static string
-					mutexOwnerId =
-					string(extractFileFromDirectoryPath(__FILE__).c_str()) +
-					string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				this->workerThread = new AiInterfaceThread(this);
 				this->workerThread->setUniqueID(mutexOwnerId);
 				this->workerThread->start();
@@ -386,6 +380,7 @@ namespace
 			fp = NULL;;
 			aiMutex = NULL;
 			workerThread = NULL;
+			threatMap = NULL;
 		}
 
 		AiInterface::~AiInterface() {
@@ -408,6 +403,15 @@ namespace
 				workerThread = NULL;
 			}
 
+			if (frameTimes.getCount() > 0) {
+				printLogf(1, "Frame times: %s", frameTimes.getReport("AI updates").c_str());
+				if (SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).
+					enabled)
+					SystemFlags::OutputDebug(SystemFlags::debugPerformance,
+						"AI faction %d frame times: %s\n", this->factionIndex,
+						frameTimes.getReport("AI updates").c_str());
+			}
+
 			if (fp) {
 				fclose(fp);
 				fp = NULL;
@@ -440,7 +444,10 @@ namespace
 		void
 			AiInterface::update() {
 			timer++;
+			int64
+				updateStartMicros = AiRuleTrace::getCurrentMicros();
 			ai.update();
+			frameTimes.add(AiRuleTrace::getCurrentMicros() - updateStartMicros);
 		}
 
 		// ==================== misc ====================
@@ -457,7 +464,7 @@ namespace
 					logString = "(" + intToStr(factionIndex) + ") " + s;
 
 				MutexSafeWrapper
-					safeMutex(aiMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+					safeMutex(aiMutex, CODE_AT_LINE);
 				//print log to file
 				if (fp != NULL) {
 					fprintf(fp, "%s\n", logString.c_str());
@@ -470,6 +477,30 @@ namespace
 			}
 		}
 
+		void
+			AiInterface::printLogf(int logLevel, const char *fmt, ...) {
+			if (isLogLevelEnabled(logLevel) == false) {
+				return;
+			}
+
+			va_list
+				argList;
+			va_start(argList, fmt);
+			char
+				szBuf[8096] = "";
+			vsnprintf(szBuf, 8096, fmt, argList);
+			va_end(argList);
+
+			printLog(logLevel, szBuf);
+		}
+
+		void
+			AiInterface::traceCommand(const CommandType * commandType,
+				const Vec2i & pos, const Unit * targetUnit) {
+			ruleTrace.setTarget((commandType != NULL ? commandType->getName() : ""),
+				pos, (targetUnit != NULL ? targetUnit->getId() : -1));
+		}
+
 		// ==================== interaction ====================
 
 		Faction *
@@ -509,6 +540,9 @@ namespace
 			assert(this->gameSettings != NULL);
 
 			std::pair < CommandResult, string > result(crFailUndefined, "");
+			if (ruleTrace.isEnabled() == true && getMyUnit(unitIndex) != NULL) {
+				traceCommand(getMyUnit(unitIndex)->getType()->getFirstCtOfClass(commandClass), pos, NULL);
+			}
 			if (executeCommandOverNetwork() == true) {
 				const Unit *
 					unit = getMyUnit(unitIndex);
@@ -552,6 +586,9 @@ namespace
 			assert(this->gameSettings != NULL);
 
 			std::pair < CommandResult, string > result(crFailUndefined, "");
+			if (ruleTrace.isEnabled() == true) {
+				traceCommand(commandType, pos, NULL);
+			}
 			if (unit == NULL) {
 				printf("In [%s::%s Line: %d] Can not find AI unit in AI factionIndex = %d. Game out of sync.\n",
 					__FILE__, __FUNCTION__, __LINE__, factionIndex);
@@ -644,6 +681,9 @@ namespace
 			assert(this->gameSettings != NULL);
 
 			std::pair < CommandResult, string > result(crFailUndefined, "");
+			if (ruleTrace.isEnabled() == true) {
+				traceCommand(commandType, pos, NULL);
+			}
 			const Unit *
 				unit = getMyUnit(unitIndex);
 			if (unit == NULL) {
@@ -731,6 +771,9 @@ namespace
 			assert(this->gameSettings != NULL);
 
 			std::pair < CommandResult, string > result(crFailUndefined, "");
+			if (ruleTrace.isEnabled() == true) {
+				traceCommand(commandType, pos, NULL);
+			}
 			const Unit *
 				unit = getMyUnit(unitIndex);
 			if (unit == NULL) {
@@ -817,6 +860,9 @@ namespace
 			assert(this->commander != NULL);
 
 			std::pair < CommandResult, string > result(crFailUndefined, "");
+			if (ruleTrace.isEnabled() == true) {
+				traceCommand(commandType, (u != NULL ? u->getPos() : Vec2i(0)), u);
+			}
 
 			if (commandType == NULL)
 				return result;
@@ -1183,31 +1229,47 @@ namespace
 				} else {
 					const Map *
 						map = world->getMap();
-					for (int i = 0; i < map->getW(); ++i) {
-						for (int j = 0; j < map->getH(); ++j) {
-							Vec2i
-								resPos = Vec2i(i, j);
-							Vec2i
-								surfPos = Map::toSurfCoords(resPos);
-							SurfaceCell *
-								sc = map->getSurfaceCell(surfPos);
-
-							//if explored cell
-							if (sc != NULL && sc->isExplored(teamIndex)) {
-								Resource *
-									r = sc->getResource();
-
-								//if resource cell
-								if (r != NULL) {
-									if (r->getType() == rt) {
-										float
-											tmpDist = pos.dist(resPos);
-										if (tmpDist < nearestDist) {
-											anyResource = true;
-											nearestDist = tmpDist;
-											resultPos = resPos;
-										}
-									}
+					vector < Vec2i > surfacePosList;
+					map->getResourceIndex()->findResources(rt, Vec2i(0, 0),
+						Vec2i(map->getSurfaceW() - 1, map->getSurfaceH() - 1),
+						surfacePosList);
+					for (unsigned int idx = 0; idx < surfacePosList.size(); ++idx) {
+						SurfaceCell *
+							sc = map->getSurfaceCell(surfacePosList[idx]);
+
+						//if explored cell
+						if (sc == NULL ||
+							map->isSurfaceExplored(surfacePosList[idx],
+								teamIndex) == false) {
+							continue;
+						}
+						Resource *
+							r = sc->getResource();
+
+						//if resource cell
+						if (r == NULL || r->getType() != rt) {
+							continue;
+						}
+						Vec2i
+							cellPos = Map::toUnitCoords(surfacePosList[idx]);
+						for (int i = 0; i < Map::cellScale; ++i) {
+							for (int j = 0; j < Map::cellScale; ++j) {
+								Vec2i
+									resPos = cellPos + Vec2i(i, j);
+								if (map->isInside(resPos) == false) {
+									continue;
+								}
+								float
+									tmpDist = pos.dist(resPos);
+								// ties keep the cell the old whole map scan
+								// (x outer, y inner) would have found first
+								if (tmpDist < nearestDist ||
+									(tmpDist == nearestDist && resultPos.x >= 0 &&
+									(resPos.x < resultPos.x ||
+									(resPos.x == resultPos.x && resPos.y < resultPos.y)))) {
+									anyResource = true;
+									nearestDist = tmpDist;
+									resultPos = resPos;
 								}
 							}
 						}
@@ -1269,13 +1331,19 @@ namespace
 			const int
 				WARNING_ENEMY_COUNT = 6;
 
+			// nothing visible near home, skip scanning every unit in the world
+			if (getVisibleEnemyCount(getHomeLocation(), radius) == 0) {
+				return NULL;
+			}
+
 			for (int i = 0; i < world->getFactionCount(); ++i) {
 				for (int j = 0; j < world->getFaction(i)->getUnitCount(); ++j) {
 					Unit *
 						unit = world->getFaction(i)->getUnit(j);
-					SurfaceCell *
-						sc =
-						map->getSurfaceCell(Map::toSurfCoords(unit->getPos()));
+					bool
+						unitCellVisible =
+						map->isSurfaceVisible(Map::toSurfCoords(unit->getPos()),
+							teamIndex);
 					bool
 						cannotSeeUnit = (unit->getType()->hasCellMap() == true &&
 							unit->getType()->getAllowEmptyCellMap() ==
@@ -1283,14 +1351,13 @@ namespace
 							&& unit->getType()->hasEmptyCellMap() ==
 							true);
 
-					if (sc->isVisible(teamIndex) && cannotSeeUnit == false &&
+					if (unitCellVisible && cannotSeeUnit == false &&
 						isAlly(unit) == false && unit->isAlive() == true) {
 						pos = unit->getPos();
 						field = unit->getCurrField();
 						if (pos.dist(getHomeLocation()) < radius) {
-							printLog(2,
-								"Being attacked at pos " + intToStr(pos.x) +
-								"," + intToStr(pos.y) + "\n");
+							printLogf(2,
+								"Being attacked at pos %d,%d\n", pos.x, pos.y);
 
 							// Now check if there are more than x enemies in sight and if
 							// so make note of the position
@@ -1318,7 +1385,7 @@ namespace
 												toSurfCoords(checkPos));
 										if (scAI != NULL && cAI != NULL
 											&& cAI->getUnit(field) != NULL
-											&& sc->isVisible(teamIndex)) {
+											&& unitCellVisible) {
 											const Unit *
 												checkUnit = cAI->getUnit(field);
 											if (foundEnemyList.
@@ -1361,6 +1428,12 @@ namespace
 			return NULL;
 		}
 
+		int
+			AiInterface::getVisibleEnemyCount(const Vec2i & pos, int radius) {
+			return threatMap->getVisibleEnemyCount(world,
+				world->getFaction(factionIndex)->getTeam(), pos, radius);
+		}
+
 		Map *
 			AiInterface::getMap() {
 			Map *
@@ -29,11 +29,16 @@
 #   include "conversion.h"
 #   include "ai.h"
 #   include "game_settings.h"
+#   include "ai_threat_map.h"
+#   include "ai_rule_trace.h"
+#   include "time_histogram.h"
 #   include <map>
 #   include "leak_dumper.h"
 
 using
 Shared::Util::intToStr;
+using
+Shared::Util::TimeHistogram;
 
 namespace
 	Glest {
@@ -129,6 +134,10 @@ namespace
 				aiLogFile;
 			FILE *
 				fp;
+			AiRuleTrace
+				ruleTrace;
+			TimeHistogram
+				frameTimes;
 
 			std::map < const ResourceType *, int >
 				cacheUnitHarvestResourceLookup;
@@ -138,6 +147,8 @@ namespace
 
 			AiInterfaceThread *
 				workerThread;
+			AiThreatMap *
+				threatMap;
 			std::vector <
 				Vec2i >
 				enemyWarningPositionList;
@@ -203,6 +214,20 @@ namespace
 			//misc
 			void
 				printLog(int logLevel, const string & s);
+			// formats only when the log level is enabled
+			void
+				printLogf(int logLevel, const char *fmt, ...);
+			const TimeHistogram &
+				getFrameTimes() const {
+				return frameTimes;
+			}
+			AiRuleTrace *
+				getRuleTrace() {
+				return &ruleTrace;
+			}
+			void
+				traceCommand(const CommandType * commandType, const Vec2i & pos,
+					const Unit * targetUnit);
 
 			//interact
 			std::pair < CommandResult, string > giveCommand(int unitIndex,
@@ -291,6 +316,8 @@ namespace
 				isFreeCells(const Vec2i & pos, int size, Field field);
 			const Unit *
 				getFirstOnSightEnemyUnit(Vec2i & pos, Field & field, int radius);
+			int
+				getVisibleEnemyCount(const Vec2i & pos, int radius);
 			Map *
 				getMap();
 			World *
@@ -314,6 +341,12 @@ namespace
 					intToStr(factionIndex) +
 					".log";
 			}
+			string getRuleTraceFilename()const {
+				return
+					"ai" +
+					intToStr(factionIndex) +
+					"_rules.csv";
+			}
 			bool
 				executeCommandOverNetwork();
 
@@ -742,13 +742,10 @@ namespace
 						this->getName().c_str());
 
 				if (aiInterface->isLogLevelEnabled(4) == true) {
-					char
-						szBuf[8096] = "";
-					snprintf(szBuf, 8096,
+					aiInterface->printLogf(4,
 						"CONSUMABLE [%s][%d] Testing AI RULE Name[%s]",
 						rt->getName().c_str(), r->getBalance(),
 						this->getName().c_str());
-					aiInterface->printLog(4, szBuf);
 				}
 
 				bool
@@ -804,13 +801,10 @@ namespace
 						rt->getName().c_str(), r->getAmount(),
 						targetStaticResourceCount, this->getName().c_str());
 				if (aiInterface->isLogLevelEnabled(4) == true) {
-					char
-						szBuf[8096] = "";
-					snprintf(szBuf, 8096,
+					aiInterface->printLogf(4,
 						"STATIC resource check [%s][%d] [min %d] Testing AI RULE Name[%s]",
 						rt->getName().c_str(), r->getAmount(),
 						targetStaticResourceCount, this->getName().c_str());
-					aiInterface->printLog(4, szBuf);
 				}
 
 				if (rt->getClass() == rcStatic
@@ -884,13 +878,10 @@ namespace
 						NULL ? produceTask->getUnitType()->getName(false).
 						c_str() : "null"));
 				if (aiInterface->isLogLevelEnabled(4) == true) {
-					char
-						szBuf[8096] = "";
-					snprintf(szBuf, 8096, "AiRuleProduce producing [%s]",
+					aiInterface->printLogf(4, "AiRuleProduce producing [%s]",
 						(produceTask->getUnitType() !=
 							NULL ? produceTask->getUnitType()->getName(false).
 							c_str() : "null"));
-					aiInterface->printLog(4, szBuf);
 				}
 
 				//generic produce task, produce random unit that has the skill or produces the resource
@@ -976,14 +967,11 @@ namespace
 			}
 
 			if (aiInterface != NULL && aiInterface->isLogLevelEnabled(4) == true) {
-				char
-					szBuf[8096] = "";
-				snprintf(szBuf, 8096,
+				aiInterface->printLogf(4,
 					"canUnitTypeOfferResourceType for unit type [%s] for resource type [%s] returned: %d",
 					(ut != NULL ? ut->getName(false).c_str() : "n/a"),
 					(rt != NULL ? rt->getName(false).c_str() : "n/a"),
 					unitTypeOffersResourceType);
-				aiInterface->printLog(4, szBuf);
 			}
 
 			return unitTypeOffersResourceType;
@@ -1023,13 +1011,10 @@ namespace
 			}
 
 			if (aiInterface->isLogLevelEnabled(4) == true) {
-				char
-					szBuf[8096] = "";
-				snprintf(szBuf, 8096,
+				aiInterface->printLogf(4,
 					"setAIProduceTaskForResourceType for resource type [%s] returned: %d",
 					pt->getResourceType()->getName(false).c_str(),
 					taskAdded);
-				aiInterface->printLog(4, szBuf);
 			}
 
 			return taskAdded;
@@ -1050,13 +1035,10 @@ namespace
 				AiInterface *
 					aiInterface = ai->getAiInterface();
 				if (aiInterface->isLogLevelEnabled(4) == true) {
-					char
-						szBuf[8096] = "";
-					snprintf(szBuf, 8096,
+					aiInterface->printLogf(4,
 						"addUnitTypeToCandidates for unit type [%s] unitCanGiveBackResource = %d",
 						producedUnit->getName(false).c_str(),
 						unitCanGiveBackResource);
-					aiInterface->printLog(4, szBuf);
 				}
 
 			}
@@ -1073,12 +1055,9 @@ namespace
 				aiInterface = ai->getAiInterface();
 			if (pt->getResourceType() != NULL) {
 				if (aiInterface->isLogLevelEnabled(4) == true) {
-					char
-						szBuf[8096] = "";
-					snprintf(szBuf, 8096,
+					aiInterface->printLogf(4,
 						"****START: produceGeneric for resource type [%s]",
 						pt->getResourceType()->getName(false).c_str());
-					aiInterface->printLog(4, szBuf);
 				}
 
 				if (setAIProduceTaskForResourceType(pt, aiInterface) == true) {
@@ -1253,38 +1232,30 @@ namespace
 						}
 
 						if (aiInterface->isLogLevelEnabled(4) == true) {
-							char
-								szBuf[8096] = "";
-							snprintf(szBuf, 8096,
+							aiInterface->printLogf(4,
 								"In produceGeneric for unit type [%s] givesBack: %d count of unit type: %d",
 								ut->getName(false).c_str(), givesBack,
 								ai->getCountOfType(ut));
-							aiInterface->printLog(4, szBuf);
 						}
 
 					}
 
 					if (aiInterface->isLogLevelEnabled(4) == true) {
-						char
-							szBuf[8096] = "";
-						snprintf(szBuf, 8096,
+						aiInterface->printLogf(4,
 							"haveEnoughProducers [%d] haveNonProducers [%d]",
 							haveEnoughProducers, haveNonProducers);
-						aiInterface->printLog(4, szBuf);
 
 						for (unsigned int i = 0; i < ableUnits.size(); ++i) {
 							const UnitType *
 								ut = ableUnits[i];
-							snprintf(szBuf, 8096, "i: %u unit type [%s]", i,
+							aiInterface->printLogf(4, "i: %u unit type [%s]", i,
 								ut->getName(false).c_str());
-							aiInterface->printLog(4, szBuf);
 						}
 						for (unsigned int i = 0; i < newAbleUnits.size(); ++i) {
 							const UnitType *
 								ut = newAbleUnits[i];
-							snprintf(szBuf, 8096, "i: %u new unit type [%s]", i,
+							aiInterface->printLogf(4, "i: %u new unit type [%s]", i,
 								ut->getName(false).c_str());
-							aiInterface->printLog(4, szBuf);
 						}
 					}
 
@@ -1298,14 +1269,11 @@ namespace
 					if (ai->getCountOfType(ableUnits[i]) == 0) {
 						if (ai->getRandom()->randRange(0, 1) == 0) {
 							if (aiInterface->isLogLevelEnabled(4) == true) {
-								char
-									szBuf[8096] = "";
-								snprintf(szBuf, 8096,
+								aiInterface->printLogf(4,
 									"In produceGeneric priority adding produce task: %d of "
 									MG_SIZE_T_SPECIFIER " for unit type [%s]",
 									i, ableUnits.size(),
 									ableUnits[i]->getName(false).c_str());
-								aiInterface->printLog(4, szBuf);
 							}
 
 							ai->addTask(new ProduceTask(ableUnits[i]));
@@ -1319,27 +1287,21 @@ namespace
 					randomUnitTypeIndex =
 					ai->getRandom()->randRange(0, (int) ableUnits.size() - 1);
 				if (aiInterface->isLogLevelEnabled(4) == true) {
-					char
-						szBuf[8096] = "";
-					snprintf(szBuf, 8096,
+					aiInterface->printLogf(4,
 						"In produceGeneric randomUnitTypeIndex = %d of "
 						MG_SIZE_T_SPECIFIER " equals unit type [%s]",
 						randomUnitTypeIndex, ableUnits.size() - 1,
 						ableUnits[randomUnitTypeIndex]->getName(false).
 						c_str());
-					aiInterface->printLog(4, szBuf);
 				}
 
 				const UnitType *
 					ut = ableUnits[randomUnitTypeIndex];
 
 				if (aiInterface->isLogLevelEnabled(4) == true) {
-					char
-						szBuf[8096] = "";
-					snprintf(szBuf, 8096,
+					aiInterface->printLogf(4,
 						"== END In produceGeneric normal adding produce task for unit type [%s]",
 						ut->getName(false).c_str());
-					aiInterface->printLog(4, szBuf);
 				}
 
 				ai->addTask(new ProduceTask(ut));
@@ -1549,14 +1511,11 @@ namespace
 					aiInterface->reqsOk(pt->getUnitType()),
 					this->getName().c_str());
 			if (aiInterface->isLogLevelEnabled(4) == true) {
-				char
-					szBuf[8096] = "";
-				snprintf(szBuf, 8096,
+				aiInterface->printLogf(4,
 					"== START produceSpecific aiInterface->reqsOk(pt->getUnitType()) = [%s][%d] Testing AI RULE Name[%s]",
 					pt->getUnitType()->getName().c_str(),
 					aiInterface->reqsOk(pt->getUnitType()),
 					this->getName().c_str());
-				aiInterface->printLog(4, szBuf);
 			}
 
 			//if unit meets requirements
@@ -1631,24 +1590,18 @@ namespace
 							ctypeForCostCheck),
 						this->getName().c_str());
 				if (aiInterface->isLogLevelEnabled(4) == true) {
-					char
-						szBuf[8096] = "";
-					snprintf(szBuf, 8096,
+					aiInterface->printLogf(4,
 						"produceSpecific aiInterface->checkCosts(pt->getUnitType()) = [%d] Testing AI RULE Name[%s]",
 						aiInterface->checkCosts(pt->getUnitType(),
 							ctypeForCostCheck),
 						this->getName().c_str());
-					aiInterface->printLog(4, szBuf);
 				}
 
 				//if unit doesnt meet resources retry
 				if (aiInterface->
 					checkCosts(pt->getUnitType(), ctypeForCostCheck) == false) {
 					if (aiInterface->isLogLevelEnabled(4) == true) {
-						char
-							szBuf[8096] = "";
-						snprintf(szBuf, 8096, "Check costs FAILED.");
-						aiInterface->printLog(4, szBuf);
+						aiInterface->printLogf(4, "Check costs FAILED.");
 					}
 
 					ai->retryTask(pt);
@@ -1715,12 +1668,9 @@ namespace
 						("produceSpecific producers.empty() = [%d] Testing AI RULE Name[%s]\n",
 							producers.empty(), this->getName().c_str());
 					if (aiInterface->isLogLevelEnabled(4) == true) {
-						char
-							szBuf[8096] = "";
-						snprintf(szBuf, 8096,
+						aiInterface->printLogf(4,
 							"produceSpecific producers.empty() = [%d] Testing AI RULE Name[%s]",
 							producers.empty(), this->getName().c_str());
-						aiInterface->printLog(4, szBuf);
 					}
 
 					// Narrow down producers list to those who are not busy if possible
@@ -2031,9 +1981,7 @@ namespace
 												getName().c_str());
 										if (aiInterface->isLogLevelEnabled(4) ==
 											true) {
-											char
-												szBuf[8096] = "";
-											snprintf(szBuf, 8096,
+											aiInterface->printLogf(4,
 												"zeta #1 produceSpecific giveCommand to unit [%s] commandType [%s]",
 												aiInterface->
 												getMyUnit(bestIndex)->
@@ -2043,7 +1991,6 @@ namespace
 												getCommandType
 												(commandIndex)->getName().
 												c_str());
-											aiInterface->printLog(4, szBuf);
 										}
 
 										aiInterface->giveCommand(bestIndex,
@@ -2103,9 +2050,7 @@ namespace
 												NULL ? defCt->getName().
 												c_str() : "n/a"));
 									if (aiInterface->isLogLevelEnabled(4) == true) {
-										char
-											szBuf[8096] = "";
-										snprintf(szBuf, 8096,
+										aiInterface->printLogf(4,
 											"zeta #2 produceSpecific giveCommand to unit [%s] commandType [%s]",
 											aiInterface->
 											getMyUnit(bestIndex)->
@@ -2113,7 +2058,6 @@ namespace
 											(defCt !=
 												NULL ? defCt->getName().
 												c_str() : "n/a"));
-										aiInterface->printLog(4, szBuf);
 									}
 									if (defCt != NULL)
 										aiInterface->giveCommand(bestIndex, defCt);
@@ -2172,9 +2116,7 @@ namespace
 												NULL ? defCt->getName().
 												c_str() : "n/a"));
 									if (aiInterface->isLogLevelEnabled(4) == true) {
-										char
-											szBuf[8096] = "";
-										snprintf(szBuf, 8096,
+										aiInterface->printLogf(4,
 											"zeta #3 produceSpecific giveCommand to unit [%s] commandType [%s]",
 											aiInterface->
 											getMyUnit(bestIndex)->
@@ -2182,7 +2124,6 @@ namespace
 											(defCt !=
 												NULL ? defCt->getName().
 												c_str() : "n/a"));
-										aiInterface->printLog(4, szBuf);
 									}
 									if (defCt != NULL)
 										aiInterface->giveCommand(bestIndex, defCt);
@@ -2233,16 +2174,13 @@ namespace
 										(defCt !=
 											NULL ? defCt->getName().c_str() : "n/a"));
 								if (aiInterface->isLogLevelEnabled(4) == true) {
-									char
-										szBuf[8096] = "";
-									snprintf(szBuf, 8096,
+									aiInterface->printLogf(4,
 										"zeta #4 produceSpecific giveCommand to unit [%s] commandType [%s]",
 										aiInterface->getMyUnit(bestIndex)->
 										getType()->getName().c_str(),
 										(defCt !=
 											NULL ? defCt->getName().
 											c_str() : "n/a"));
-									aiInterface->printLog(4, szBuf);
 								}
 								if (defCt != NULL)
 									aiInterface->giveCommand(bestIndex, defCt);
@@ -2301,16 +2239,13 @@ namespace
 								getName().c_str(),
 								(defCt != NULL ? defCt->getName().c_str() : "n/a"));
 						if (aiInterface->isLogLevelEnabled(4) == true) {
-							char
-								szBuf[8096] = "";
-							snprintf(szBuf, 8096,
+							aiInterface->printLogf(4,
 								"produceSpecific giveCommand to unit [%s] commandType [%s]",
 								aiInterface->getMyUnit(producerIndex)->
 								getType()->getName().c_str(),
 								(defCt !=
 									NULL ? defCt->getName().
 									c_str() : "(null)"));
-							aiInterface->printLog(4, szBuf);
 						}
 						if (defCt != NULL)
 							aiInterface->giveCommand(producerIndex, defCt);
@@ -2373,14 +2308,11 @@ namespace
 				aiInterface = ai->getAiInterface();
 
 			if (aiInterface->isLogLevelEnabled(4) == true) {
-				char
-					szBuf[8096] = "";
-				snprintf(szBuf, 8096,
+				aiInterface->printLogf(4,
 					"== START: buildGeneric for resource type [%s]",
 					(bt->getResourceType() !=
 						NULL ? bt->getResourceType()->getName().
 						c_str() : "null"));
-				aiInterface->printLog(4, szBuf);
 			}
 
 			typedef
@@ -2410,16 +2342,13 @@ namespace
 							//if(ai->getRandom()->randRange(0, 1)==0) {
 
 							if (aiInterface->isLogLevelEnabled(4) == true) {
-								char
-									szBuf[8096] = "";
-								snprintf(szBuf, 8096,
+								aiInterface->printLogf(4,
 									"In buildGeneric for resource type [%s] aibcResourceProducerUnits = "
 									MG_SIZE_T_SPECIFIER
 									" priorityUnit.first: [%s]\n",
 									bt->getResourceType()->getName().
 									c_str(), unitList.size(),
 									priorityUnit.first->getName().c_str());
-								aiInterface->printLog(4, szBuf);
 							}
 
 							ai->addTask(new BuildTask(priorityUnit.first));
@@ -2449,16 +2378,13 @@ namespace
 							//if(ai->getRandom()->randRange(0, 1)==0) {
 
 							if (aiInterface->isLogLevelEnabled(4) == true) {
-								char
-									szBuf[8096] = "";
-								snprintf(szBuf, 8096,
+								aiInterface->printLogf(4,
 									"In buildGeneric for resource type [%s] aibcBuildingUnits = "
 									MG_SIZE_T_SPECIFIER
 									" priorityUnit.first: [%s]\n",
 									bt->getResourceType()->getName().
 									c_str(), unitList.size(),
 									priorityUnit.first->getName().c_str());
-								aiInterface->printLog(4, szBuf);
 							}
 
 							ai->addTask(new BuildTask(priorityUnit.first));
@@ -2513,12 +2439,9 @@ namespace
 
 			if (aiInterface->isLogLevelEnabled(4) == true) {
 				for (int i = 0; i < (int) buildings.size(); ++i) {
-					char
-						szBuf[8096] = "";
-					snprintf(szBuf, 8096,
+					aiInterface->printLogf(4,
 						"In buildGeneric i = %d unit type: [%s]\n", i,
 						buildings[i]->getName().c_str());
-					aiInterface->printLog(4, szBuf);
 				}
 			}
 
@@ -2533,12 +2456,9 @@ namespace
 			AiInterface *
 				aiInterface = ai->getAiInterface();
 			if (aiInterface->isLogLevelEnabled(4) == true) {
-				char
-					szBuf[8096] = "";
-				snprintf(szBuf, 8096,
+				aiInterface->printLogf(4,
 					"==> START buildBestBuilding buildings.size = "
 					MG_SIZE_T_SPECIFIER "\n", buildings.size());
-				aiInterface->printLog(4, szBuf);
 			}
 
 			if (!buildings.empty()) {
@@ -2560,12 +2480,9 @@ namespace
 								&& isDefensive(building)) {
 
 								if (aiInterface->isLogLevelEnabled(4) == true) {
-									char
-										szBuf[8096] = "";
-									snprintf(szBuf, 8096,
+									aiInterface->printLogf(4,
 										"In buildBestBuilding defensive building unit type: [%s] i = %d j = %d\n",
 										building->getName().c_str(), i, j);
-									aiInterface->printLog(4, szBuf);
 								}
 
 								ai->addTask(new BuildTask(building));
@@ -2582,12 +2499,9 @@ namespace
 								&& isWarriorProducer(building)) {
 
 								if (aiInterface->isLogLevelEnabled(4) == true) {
-									char
-										szBuf[8096] = "";
-									snprintf(szBuf, 8096,
+									aiInterface->printLogf(4,
 										"In buildBestBuilding warriorproducer building unit type: [%s] i = %d j = %u\n",
 										building->getName().c_str(), i, j);
-									aiInterface->printLog(4, szBuf);
 								}
 
 								ai->addTask(new BuildTask(building));
@@ -2604,12 +2518,9 @@ namespace
 								&& isResourceProducer(building)) {
 
 								if (aiInterface->isLogLevelEnabled(4) == true) {
-									char
-										szBuf[8096] = "";
-									snprintf(szBuf, 8096,
+									aiInterface->printLogf(4,
 										"In buildBestBuilding resourceproducer building unit type: [%s] i = %d j = %u\n",
 										building->getName().c_str(), i, j);
-									aiInterface->printLog(4, szBuf);
 								}
 
 								ai->addTask(new BuildTask(building));
@@ -2626,12 +2537,9 @@ namespace
 						if (ai->getCountOfType(building) <= i) {
 
 							if (aiInterface->isLogLevelEnabled(4) == true) {
-								char
-									szBuf[8096] = "";
-								snprintf(szBuf, 8096,
+								aiInterface->printLogf(4,
 									"In buildBestBuilding ANY building unit type: [%s] i = %d j = %u\n",
 									building->getName().c_str(), i, j);
-								aiInterface->printLog(4, szBuf);
 							}
 
 							ai->addTask(new BuildTask(building));
@@ -2642,12 +2550,9 @@ namespace
 			}
 
 			if (aiInterface->isLogLevelEnabled(4) == true) {
-				char
-					szBuf[8096] = "";
-				snprintf(szBuf, 8096,
+				aiInterface->printLogf(4,
 					"==> END buildBestBuilding buildings.size = "
 					MG_SIZE_T_SPECIFIER "\n", buildings.size());
-				aiInterface->printLog(4, szBuf);
 			}
 		}
 
@@ -2657,9 +2562,7 @@ namespace
 				aiInterface = ai->getAiInterface();
 
 			if (aiInterface->isLogLevelEnabled(4) == true) {
-				char
-					szBuf[8096] = "";
-				snprintf(szBuf, 8096,
+				aiInterface->printLogf(4,
 					"== START: buildSpecific for resource type [%s] bt->getUnitType() [%s]",
 					(bt->getResourceType() !=
 						NULL ? bt->getResourceType()->getName().
@@ -2667,7 +2570,6 @@ namespace
 						(bt->getUnitType() !=
 							NULL ? bt->getUnitType()->getName(false).
 							c_str() : "null"));
-				aiInterface->printLog(4, szBuf);
 			}
 
 			//if reqs ok
@@ -2676,14 +2578,11 @@ namespace
 				//retry if not enough resources
 				if (aiInterface->checkCosts(bt->getUnitType(), NULL) == false) {
 					if (aiInterface->isLogLevelEnabled(4) == true) {
-						char
-							szBuf[8096] = "";
-						snprintf(szBuf, 8096,
+						aiInterface->printLogf(4,
 							"In buildSpecific for resource type [%s] checkcosts == false RETRYING",
 							(bt->getResourceType() !=
 								NULL ? bt->getResourceType()->getName().
 								c_str() : "null"));
-						aiInterface->printLog(4, szBuf);
 					}
 
 					ai->retryTask(bt);
@@ -2881,14 +2780,11 @@ namespace
 				}
 			} else {
 				if (aiInterface->isLogLevelEnabled(4) == true) {
-					char
-						szBuf[8096] = "";
-					snprintf(szBuf, 8096,
+					aiInterface->printLogf(4,
 						"In buildSpecific for resource type [%s] reqsok == false",
 						(bt->getResourceType() !=
 							NULL ? bt->getResourceType()->getName().
 							c_str() : "null"));
-					aiInterface->printLog(4, szBuf);
 				}
 
 			}
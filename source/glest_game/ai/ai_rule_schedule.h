@@ -0,0 +1,66 @@
+//
+//      ai_rule_schedule.h:
+//
+//      This file is part of ZetaGlest <https://github.com/ZetaGlest>
+//
+//      Copyright (C) 2018  The ZetaGlest team
+//
+//      ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+//      This program is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program.  If not, see <https://www.gnu.org/licenses/>
+
+#ifndef _GLEST_GAME_AIRULESCHEDULE_H_
+#   define _GLEST_GAME_AIRULESCHEDULE_H_
+
+#   include "leak_dumper.h"
+
+namespace Glest {
+	namespace Game {
+
+		// =====================================================
+		//      class AiRuleSchedule
+		//
+		///     When an AI rule is tested. Without an offset every
+		///     rule with the same test interval, in every AI faction,
+		///     is tested on the same frame. The offset only depends
+		///     on the rule and faction index so the schedule is the
+		///     same on every run
+		// =====================================================
+
+		class AiRuleSchedule {
+		public:
+			static int getIntervalFrames(int intervalMillis, int updateFps) {
+				return intervalMillis * updateFps / 1000;
+			}
+
+			static int getPhase(int ruleIndex, int factionIndex, int intervalFrames,
+				bool stagger) {
+				if (stagger == false || intervalFrames <= 1) {
+					return 0;
+				}
+				return (ruleIndex * 7 + factionIndex * 3) % intervalFrames;
+			}
+
+			static bool isDue(int timer, int phase, int intervalFrames) {
+				if (intervalFrames <= 1) {
+					return true;
+				}
+				return ((timer + phase) % intervalFrames) == 0;
+			}
+		};
+
+	}
+}//end namespace
+
+#endif
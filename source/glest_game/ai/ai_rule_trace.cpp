@@ -0,0 +1,239 @@
+//
+//      ai_rule_trace.cpp:
+//
+//      This file is part of ZetaGlest <https://github.com/ZetaGlest>
+//
+//      Copyright (C) 2018  The ZetaGlest team
+//
+//      ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+//      This program is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program.  If not, see <https://www.gnu.org/licenses/>
+
+#include "ai_rule_trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <set>
+#include "platform_util.h"
+#include "util.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Util;
+using namespace Shared::Platform;
+
+namespace Glest {
+	namespace Game {
+
+		// =====================================================
+		//      class AiRuleTraceEvent
+		// =====================================================
+
+		AiRuleTraceEvent::AiRuleTraceEvent() {
+			frame = 0;
+			factionIndex = 0;
+			ruleIndex = 0;
+			executed = false;
+			testMicros = 0;
+			executeMicros = 0;
+			targetUnitId = -1;
+		}
+
+		// =====================================================
+		//      class AiRuleTrace
+		// =====================================================
+
+		const char *AiRuleTrace::fileHeader =
+			"frame,faction,rule,name,executed,test_us,execute_us,command,target_x,target_y,target_unit";
+
+		// names are written as single csv fields
+		static string getTraceField(const string &value) {
+			if (value.empty() == true) {
+				return "-";
+			}
+			string result = value;
+			std::replace(result.begin(), result.end(), ',', ' ');
+			std::replace(result.begin(), result.end(), '\n', ' ');
+			return result;
+		}
+
+		AiRuleTrace::AiRuleTrace() {
+			fp = NULL;
+		}
+
+		AiRuleTrace::~AiRuleTrace() {
+			close();
+		}
+
+		void AiRuleTrace::open(const string &path) {
+			close();
+#ifdef WIN32
+			fp = _wfopen(utf8_decode(path).c_str(), L"wt");
+#else
+			fp = fopen(path.c_str(), "wt");
+#endif
+			if (fp == NULL) {
+				throw megaglest_runtime_error("Can't open file: [" + path + "]");
+			}
+			fprintf(fp, "%s\n", fileHeader);
+		}
+
+		void AiRuleTrace::close() {
+			if (fp != NULL) {
+				fclose(fp);
+				fp = NULL;
+			}
+		}
+
+		void AiRuleTrace::beginRule(int frame, int factionIndex, int ruleIndex, const string &ruleName) {
+			current = AiRuleTraceEvent();
+			current.frame = frame;
+			current.factionIndex = factionIndex;
+			current.ruleIndex = ruleIndex;
+			current.ruleName = ruleName;
+		}
+
+		void AiRuleTrace::setTarget(const string &command, const Vec2i &pos, int unitId) {
+			current.command = command;
+			current.targetPos = pos;
+			current.targetUnitId = unitId;
+		}
+
+		void AiRuleTrace::endRule(bool executed, int64 testMicros, int64 executeMicros) {
+			if (fp == NULL) {
+				return;
+			}
+			fprintf(fp, "%d,%d,%d,%s,%d,%lld,%lld,%s,%d,%d,%d\n",
+				current.frame, current.factionIndex, current.ruleIndex,
+				getTraceField(current.ruleName).c_str(), executed,
+				(long long int) testMicros, (long long int) executeMicros,
+				getTraceField(current.command).c_str(),
+				current.targetPos.x, current.targetPos.y, current.targetUnitId);
+		}
+
+		int64 AiRuleTrace::getCurrentMicros() {
+			return std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		void AiRuleTrace::load(const string &path, std::vector<AiRuleTraceEvent> &events) {
+#ifdef WIN32
+			FILE *f = _wfopen(utf8_decode(path).c_str(), L"rt");
+#else
+			FILE *f = fopen(path.c_str(), "rt");
+#endif
+			if (f == NULL) {
+				throw megaglest_runtime_error("Error opening AI rule trace file: [" + path + "]");
+			}
+
+			char line[1024] = "";
+			if (fgets(line, sizeof(line), f) == NULL ||
+				string(line).find(fileHeader) != 0) {
+				fclose(f);
+				throw megaglest_runtime_error("Not an AI rule trace file: [" + path + "]");
+			}
+			while (fgets(line, sizeof(line), f) != NULL) {
+				AiRuleTraceEvent event;
+				char ruleName[256] = "";
+				char command[256] = "";
+				int executed = 0;
+				long long int testMicros = 0;
+				long long int executeMicros = 0;
+				if (sscanf(line, "%d,%d,%d,%255[^,],%d,%lld,%lld,%255[^,],%d,%d,%d",
+					&event.frame, &event.factionIndex, &event.ruleIndex, ruleName,
+					&executed, &testMicros, &executeMicros, command,
+					&event.targetPos.x, &event.targetPos.y, &event.targetUnitId) != 11) {
+					continue;
+				}
+				event.ruleName = ruleName;
+				event.executed = (executed != 0);
+				event.testMicros = testMicros;
+				event.executeMicros = executeMicros;
+				event.command = (string(command) != "-" ? command : "");
+				events.push_back(event);
+			}
+			fclose(f);
+		}
+
+		class AiRuleTraceTotals {
+		public:
+			AiRuleTraceTotals() {
+				tests = 0;
+				executions = 0;
+				testMicros = 0;
+				executeMicros = 0;
+				maxMicros = 0;
+			}
+
+			string name;
+			int tests;
+			int executions;
+			int64 testMicros;
+			int64 executeMicros;
+			int64 maxMicros;
+		};
+
+		static bool compareAiRuleTraceTotals(const AiRuleTraceTotals &a, const AiRuleTraceTotals &b) {
+			return a.testMicros + a.executeMicros > b.testMicros + b.executeMicros;
+		}
+
+		string AiRuleTrace::getSummary(const std::vector<AiRuleTraceEvent> &events) {
+			std::map<string, AiRuleTraceTotals> ruleTotals;
+			std::set<std::pair<int, int> > factionFrames;
+			int64 totalMicros = 0;
+			for (unsigned int i = 0; i < events.size(); ++i) {
+				const AiRuleTraceEvent &event = events[i];
+				AiRuleTraceTotals &totals = ruleTotals[event.ruleName];
+				totals.name = event.ruleName;
+				totals.tests++;
+				totals.testMicros += event.testMicros;
+				if (event.executed == true) {
+					totals.executions++;
+					totals.executeMicros += event.executeMicros;
+				}
+				totals.maxMicros = std::max(totals.maxMicros, event.testMicros + event.executeMicros);
+				totalMicros += event.testMicros + event.executeMicros;
+				factionFrames.insert(std::make_pair(event.factionIndex, event.frame));
+			}
+
+			std::vector<AiRuleTraceTotals> sortedTotals;
+			for (std::map<string, AiRuleTraceTotals>::const_iterator iterMap = ruleTotals.begin();
+				iterMap != ruleTotals.end(); ++iterMap) {
+				sortedTotals.push_back(iterMap->second);
+			}
+			std::sort(sortedTotals.begin(), sortedTotals.end(), compareAiRuleTraceTotals);
+
+			char szBuf[8096] = "";
+			snprintf(szBuf, 8096, "%d rule events over %d AI updates, %.2f ms total, %.3f ms per AI update\n",
+				(int) events.size(), (int) factionFrames.size(), totalMicros / 1000.0,
+				(factionFrames.empty() == false ? totalMicros / 1000.0 / factionFrames.size() : 0.0));
+			string result = szBuf;
+			snprintf(szBuf, 8096, "%-32s %8s %8s %12s %12s %10s %7s\n",
+				"rule", "tests", "execs", "test ms", "execute ms", "max ms", "share");
+			result += szBuf;
+			for (unsigned int i = 0; i < sortedTotals.size(); ++i) {
+				const AiRuleTraceTotals &totals = sortedTotals[i];
+				int64 ruleMicros = totals.testMicros + totals.executeMicros;
+				snprintf(szBuf, 8096, "%-32s %8d %8d %12.2f %12.2f %10.2f %6.1f%%\n",
+					totals.name.c_str(), totals.tests, totals.executions,
+					totals.testMicros / 1000.0, totals.executeMicros / 1000.0,
+					totals.maxMicros / 1000.0,
+					(totalMicros > 0 ? ruleMicros * 100.0 / totalMicros : 0.0));
+				result += szBuf;
+			}
+			return result;
+		}
+
+	}
+}//end namespace
@@ -0,0 +1,101 @@
+//
+//      ai_rule_trace.h:
+//
+//      This file is part of ZetaGlest <https://github.com/ZetaGlest>
+//
+//      Copyright (C) 2018  The ZetaGlest team
+//
+//      ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+//      This program is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program.  If not, see <https://www.gnu.org/licenses/>
+
+#ifndef _GLEST_GAME_AIRULETRACE_H_
+#   define _GLEST_GAME_AIRULETRACE_H_
+
+#   include <cstdio>
+#   include <string>
+#   include <vector>
+#   include "vec.h"
+#   include "data_types.h"
+#   include "leak_dumper.h"
+
+using std::string;
+using Shared::Graphics::Vec2i;
+using Shared::Platform::int64;
+
+namespace Glest {
+	namespace Game {
+
+		// =====================================================
+		//      class AiRuleTraceEvent
+		//
+		///     One tested AI rule: how long the test and the
+		///     execution took and the last command it gave
+		// =====================================================
+
+		class AiRuleTraceEvent {
+		public:
+			AiRuleTraceEvent();
+
+			int frame;
+			int factionIndex;
+			int ruleIndex;
+			string ruleName;
+			bool executed;
+			int64 testMicros;
+			int64 executeMicros;
+			string command;
+			Vec2i targetPos;
+			int targetUnitId;
+		};
+
+		// =====================================================
+		//      class AiRuleTrace
+		//
+		///     Comma separated stream of AI rule events for one
+		///     faction, written only when AiRuleTrace is enabled
+		// =====================================================
+
+		class AiRuleTrace {
+		private:
+			static const char *fileHeader;
+
+			FILE *fp;
+			AiRuleTraceEvent current;
+
+		public:
+			AiRuleTrace();
+			~AiRuleTrace();
+
+			void open(const string &path);
+			void close();
+			inline bool isEnabled() const {
+				return fp != NULL;
+			}
+
+			void beginRule(int frame, int factionIndex, int ruleIndex, const string &ruleName);
+			void setTarget(const string &command, const Vec2i &pos, int unitId);
+			void endRule(bool executed, int64 testMicros, int64 executeMicros);
+
+			static int64 getCurrentMicros();
+
+			static void load(const string &path, std::vector<AiRuleTraceEvent> &events);
+			// per rule totals over all given traces, most expensive rule first
+			static string getSummary(const std::vector<AiRuleTraceEvent> &events);
+		};
+
+	}
+}//end namespace
+
+#endif
@@ -0,0 +1,165 @@
+//
+//      ai_threat_map.cpp:
+//
+//      This file is part of ZetaGlest <https://github.com/ZetaGlest>
+//
+//      Copyright (C) 2018  The ZetaGlest team
+//
+//      ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+//      This program is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program.  If not, see <https://www.gnu.org/licenses/>
+
+#include "ai_threat_map.h"
+
+#include <algorithm>
+#include "world.h"
+#include "map.h"
+#include "faction.h"
+#include "unit.h"
+#include "unit_type.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Util;
+
+namespace Glest {
+	namespace Game {
+
+		// =====================================================
+		//      class AiThreatMap
+		// =====================================================
+
+		AiThreatMap::AiThreatMap() {
+			mutex = new Mutex(CODE_AT_LINE);
+			frameCount = -1;
+			w = 0;
+			h = 0;
+			mapW = 0;
+			mapH = 0;
+		}
+
+		AiThreatMap::~AiThreatMap() {
+			delete mutex;
+			mutex = NULL;
+		}
+
+		bool AiThreatMap::isHiddenUnit(const Unit *unit) {
+			return (unit->getType()->hasCellMap() == true &&
+				unit->getType()->getAllowEmptyCellMap() == true &&
+				unit->getType()->hasEmptyCellMap() == true);
+		}
+
+		void AiThreatMap::rebuild(const World *world) {
+			const Map *map = world->getMap();
+			mapW = map->getW();
+			mapH = map->getH();
+			w = (mapW + cellSize - 1) / cellSize;
+			h = (mapH + cellSize - 1) / cellSize;
+
+			for (int teamIndex = 0; teamIndex < GameConstants::maxPlayers; ++teamIndex) {
+				TeamGrid &grid = teams[teamIndex];
+				grid.used = false;
+				grid.visibleEnemyCount.assign(w * h, 0);
+			}
+			for (int i = 0; i < world->getFactionCount(); ++i) {
+				int teamIndex = world->getFaction(i)->getTeam();
+				if (teamIndex >= 0 && teamIndex < GameConstants::maxPlayers) {
+					teams[teamIndex].used = true;
+				}
+			}
+
+			// one pass over all units for every team instead of one pass per
+			// AI and query
+			for (int i = 0; i < world->getFactionCount(); ++i) {
+				const Faction *faction = world->getFaction(i);
+				int unitTeam = faction->getTeam();
+				for (int j = 0; j < faction->getUnitCount(); ++j) {
+					Unit *unit = faction->getUnit(j);
+					if (unit->isAlive() == false) {
+						continue;
+					}
+
+					Vec2i unitPos = unit->getPos();
+					if (map->isInside(unitPos) == false) {
+						continue;
+					}
+					int cellIndex = (unitPos.y / cellSize) * w + (unitPos.x / cellSize);
+					bool hidden = isHiddenUnit(unit);
+					int visibleTeams = map->getSurfaceVisibleTeams(Map::toSurfCoords(unitPos));
+
+					for (int teamIndex = 0; teamIndex < GameConstants::maxPlayers; ++teamIndex) {
+						TeamGrid &grid = teams[teamIndex];
+						if (grid.used == false) {
+							continue;
+						}
+						if (teamIndex != unitTeam &&
+							unitTeam != GameConstants::maxPlayers - 1 + fpt_Observer &&
+							hidden == false && (visibleTeams & (1 << teamIndex)) != 0) {
+							grid.visibleEnemyCount[cellIndex]++;
+						}
+					}
+				}
+			}
+		}
+
+		void AiThreatMap::ensureUpdated(const World *world) {
+			if (frameCount != world->getFrameCount()) {
+				rebuild(world);
+				frameCount = world->getFrameCount();
+			}
+		}
+
+		bool AiThreatMap::getGridRect(const Vec2i &pos, int radius, int &x0, int &y0, int &x1, int &y1) const {
+			if (w <= 0 || h <= 0 || radius < 0) {
+				return false;
+			}
+			radius = std::min(radius, std::max(mapW, mapH));
+
+			x0 = std::max(pos.x - radius, 0) / cellSize;
+			y0 = std::max(pos.y - radius, 0) / cellSize;
+			x1 = std::min(pos.x + radius, mapW - 1) / cellSize;
+			y1 = std::min(pos.y + radius, mapH - 1) / cellSize;
+			return (x0 <= x1 && y0 <= y1);
+		}
+
+		int AiThreatMap::sumCells(const std::vector<int> &cells, const Vec2i &pos, int radius) const {
+			int x0 = 0;
+			int y0 = 0;
+			int x1 = 0;
+			int y1 = 0;
+			if (getGridRect(pos, radius, x0, y0, x1, y1) == false) {
+				return 0;
+			}
+
+			int sum = 0;
+			for (int y = y0; y <= y1; ++y) {
+				for (int x = x0; x <= x1; ++x) {
+					sum += cells[y * w + x];
+				}
+			}
+			return sum;
+		}
+
+		// counts cover every threat map cell touching the square of the given
+		// radius around pos, so they are an upper bound for the exact area
+		int AiThreatMap::getVisibleEnemyCount(const World *world, int teamIndex, const Vec2i &pos, int radius) {
+			if (teamIndex < 0 || teamIndex >= GameConstants::maxPlayers) {
+				return 0;
+			}
+			MutexSafeWrapper safeMutex(mutex, CODE_AT_LINE);
+			ensureUpdated(world);
+			return sumCells(teams[teamIndex].visibleEnemyCount, pos, radius);
+		}
+
+	}
+}//end namespace
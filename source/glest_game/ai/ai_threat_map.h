@@ -0,0 +1,89 @@
+//
+//      ai_threat_map.h:
+//
+//      This file is part of ZetaGlest <https://github.com/ZetaGlest>
+//
+//      Copyright (C) 2018  The ZetaGlest team
+//
+//      ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+//      This program is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program.  If not, see <https://www.gnu.org/licenses/>
+
+#ifndef _GLEST_GAME_AITHREATMAP_H_
+#   define _GLEST_GAME_AITHREATMAP_H_
+
+#   include <vector>
+#   include "vec.h"
+#   include "thread.h"
+#   include "game_constants.h"
+#   include "leak_dumper.h"
+
+using Shared::Graphics::Vec2i;
+using Shared::Platform::Mutex;
+
+namespace Glest {
+	namespace Game {
+
+		class World;
+		class Unit;
+
+		// =====================================================
+		//      class AiThreatMap
+		//
+		///     Coarse per team grid of visible enemies, shared by all
+		///     AIs and rebuilt at most once per world frame
+		// =====================================================
+
+		class AiThreatMap {
+		public:
+			// map cells per side of a threat map cell
+			static const int cellSize = 8;
+
+		private:
+			class TeamGrid {
+			public:
+				TeamGrid() {
+					used = false;
+				}
+
+				bool used;
+				std::vector<int> visibleEnemyCount;
+			};
+
+			Mutex *mutex;
+			int frameCount;
+			int w;
+			int h;
+			int mapW;
+			int mapH;
+			TeamGrid teams[GameConstants::maxPlayers];
+
+			void rebuild(const World *world);
+			void ensureUpdated(const World *world);
+			bool getGridRect(const Vec2i &pos, int radius, int &x0, int &y0, int &x1, int &y1) const;
+			int sumCells(const std::vector<int> &cells, const Vec2i &pos, int radius) const;
+
+			static bool isHiddenUnit(const Unit *unit);
+
+		public:
+			AiThreatMap();
+			~AiThreatMap();
+
+			int getVisibleEnemyCount(const World *world, int teamIndex, const Vec2i &pos, int radius);
+		};
+
+	}
+}//end namespace
+
+#endif
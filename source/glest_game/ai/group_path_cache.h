@@ -0,0 +1,125 @@
+//
+//      group_path_cache.h:
+//
+//      This file is part of ZetaGlest <https://github.com/ZetaGlest>
+//
+//      Copyright (C) 2018  The ZetaGlest team
+//
+//      ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+//      This program is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program.  If not, see <https://www.gnu.org/licenses/>
+
+#ifndef _GLEST_GAME_GROUPPATHCACHE_H_
+#   define _GLEST_GAME_GROUPPATHCACHE_H_
+
+#   include <cstdlib>
+#   include <algorithm>
+#   include <deque>
+#   include <map>
+#   include <vector>
+#   include "vec.h"
+#   include "leak_dumper.h"
+
+using Shared::Graphics::Vec2i;
+
+namespace Glest {
+	namespace Game {
+
+		// =====================================================
+		//      class GroupPath
+		//
+		///     The full path found for one unit of a command group,
+		///     the other units of the group walk it at their own
+		///     offset instead of searching for a path themselves
+		// =====================================================
+
+		class GroupPath {
+		public:
+			Vec2i targetPos;
+			std::vector<Vec2i> cells;
+
+			// index of the cell a unit at pos joins the path at: the closest
+			// cell no more than joinDistance cells away, the later one on a
+			// tie so units that reached the path keep moving forward. -1 if
+			// no cell is close enough
+			int findJoinIndex(const Vec2i &pos, int joinDistance) const {
+				int joinIndex = -1;
+				for (int i = 0; i < (int) cells.size(); ++i) {
+					Vec2i diff = cells[i] - pos;
+					int distance = std::max(abs(diff.x), abs(diff.y));
+					if (distance <= joinDistance) {
+						joinIndex = i;
+						joinDistance = distance;
+					}
+				}
+				return joinIndex;
+			}
+		};
+
+		// =====================================================
+		//      class GroupPathCache
+		//
+		///     Group paths of one faction keyed by command group id.
+		///     Command group ids are counted per network peer, so they
+		///     say nothing about age and the oldest path is tracked by
+		///     insertion order instead. Paths are part of the synched
+		///     state, so the order is saved with them
+		// =====================================================
+
+		class GroupPathCache {
+		private:
+			std::map<int, GroupPath> paths;
+			std::deque<int> order;
+
+		public:
+			// the path for groupId, a new empty one if there is none yet.
+			// When that pushes the cache past maxPaths, the path stored
+			// first is dropped
+			GroupPath &add(int groupId, int maxPaths) {
+				std::map<int, GroupPath>::iterator iterFind = paths.find(groupId);
+				if (iterFind != paths.end()) {
+					return iterFind->second;
+				}
+
+				order.push_back(groupId);
+				while ((int) order.size() > maxPaths && order.size() > 1) {
+					paths.erase(order.front());
+					order.pop_front();
+				}
+				return paths[groupId];
+			}
+
+			const GroupPath *find(int groupId) const {
+				std::map<int, GroupPath>::const_iterator iterFind = paths.find(groupId);
+				return (iterFind != paths.end() ? &iterFind->second : NULL);
+			}
+
+			void clear() {
+				paths.clear();
+				order.clear();
+			}
+
+			inline int size() const {
+				return (int) order.size();
+			}
+			// group id of the index-th path in insertion order
+			inline int getGroupId(int index) const {
+				return order[index];
+			}
+		};
+
+	}
+}//end namespace
+
+#endif
@@ -58,6 +58,10 @@ namespace
 			PathFinder::pathFindExtendRefreshNodeCountMin = 40;
 		const int
 			PathFinder::pathFindExtendRefreshNodeCountMax = 40;
+		const int
+			PathFinder::maxGroupPaths = 32;
+		const int
+			PathFinder::groupPathJoinDistance = 3;
 
 		PathFinder::PathFinder() {
 			minorDebugPathfinder = false;
@@ -111,9 +115,7 @@ namespace
 			PathFinder::clearCaches() {
 			for (int factionIndex = 0; factionIndex < GameConstants::maxPlayers;
 				++factionIndex) {
-				static string
-					mutexOwnerId =
-					string(__FILE__) + string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				FactionState & faction = factions.getFactionState(factionIndex);
 				MutexSafeWrapper
 					safeMutex(faction.getMutexPreCache(), mutexOwnerId);
@@ -128,9 +130,7 @@ namespace
 			if (unit != NULL && factions.size() > unit->getFactionIndex()) {
 				int
 					factionIndex = unit->getFactionIndex();
-				static string
-					mutexOwnerId =
-					string(__FILE__) + string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				FactionState & faction = factions.getFactionState(factionIndex);
 				MutexSafeWrapper
 					safeMutex(faction.getMutexPreCache(), mutexOwnerId);
@@ -145,9 +145,7 @@ namespace
 			if (unit != NULL && factions.size() > unit->getFactionIndex()) {
 				int
 					factionIndex = unit->getFactionIndex();
-				static string
-					mutexOwnerId =
-					string(__FILE__) + string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				FactionState & faction = factions.getFactionState(factionIndex);
 				MutexSafeWrapper
 					safeMutex(faction.getMutexPreCache(), mutexOwnerId);
@@ -174,9 +172,7 @@ namespace
 				int
 					factionIndex = unit->getFactionIndex();
 				FactionState & faction = factions.getFactionState(factionIndex);
-				static string
-					mutexOwnerId =
-					string(__FILE__) + string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				MutexSafeWrapper
 					safeMutexPrecache(faction.getMutexPreCache(), mutexOwnerId);
 
@@ -985,6 +981,12 @@ namespace
 					}
 				}
 
+				// units of a command group follow the path found for the group
+				if (frameIndex < 0 && inBailout == false &&
+					followGroupPath(unit, targetPos, faction) == true) {
+					return tsMoving;
+				}
+
 				const Vec2i
 					unitPos = unit->getPos();
 				const Vec2i
@@ -1408,6 +1410,10 @@ namespace
 						}
 					}
 
+					if (frameIndex < 0 && inBailout == false) {
+						addGroupPath(unit, targetPos, faction, firstNode);
+					}
+
 					if (SystemFlags::
 						getSystemSettingType(SystemFlags::debugPerformance).
 						enabled == true && chrono.getMillis() > 4)
@@ -1755,6 +1761,102 @@ namespace
 		//      return unitImmediatelyBlocked;
 		//}
 
+		int
+			PathFinder::getCommandGroupId(const Unit * unit) {
+			const Command *
+				command = unit->getCurrCommand();
+			if (command == NULL) {
+				return -1;
+			}
+			return command->getUnitCommandGroupId();
+		}
+
+		void
+			PathFinder::addGroupPath(const Unit * unit, const Vec2i & targetPos,
+				FactionState & faction, const Node * firstNode) {
+			int
+				groupId = getCommandGroupId(unit);
+			if (groupId <= 0) {
+				return;
+			}
+
+			GroupPath & groupPath = faction.groupPaths.add(groupId, maxGroupPaths);
+			groupPath.targetPos = targetPos;
+			groupPath.cells.clear();
+			for (const Node * node = firstNode; node != NULL; node = node->next) {
+				groupPath.cells.push_back(node->pos);
+			}
+		}
+
+		bool
+			PathFinder::followGroupPath(Unit * unit, const Vec2i & targetPos,
+				FactionState & faction) {
+			int
+				groupId = getCommandGroupId(unit);
+			if (groupId <= 0) {
+				return false;
+			}
+			const GroupPath *
+				groupPath = faction.groupPaths.find(groupId);
+			if (groupPath == NULL || groupPath->targetPos != targetPos) {
+				return false;
+			}
+			const std::vector < Vec2i > &cells = groupPath->cells;
+
+			const Vec2i
+				unitPos = unit->getPos();
+			int
+				joinIndex = groupPath->findJoinIndex(unitPos, groupPathJoinDistance);
+			if (joinIndex < 0) {
+				return false;
+			}
+
+			// keep the unit's place in the formation and walk the group path
+			// beside the others, a blocked cell ends the shared part and the
+			// unit searches its own path from there
+			const Vec2i
+				offset = unitPos - cells[joinIndex];
+			std::vector < Vec2i > steps;
+			Vec2i
+				lastPos = unitPos;
+			for (int i = joinIndex + 1; i < (int) cells.size() &&
+				(int) steps.size() < unit->getPathFindRefreshCellCount(); ++i) {
+				Vec2i
+					nodePos = cells[i] + offset;
+				if (map->isInside(nodePos) == false ||
+					map->isInsideSurface(map->toSurfCoords(nodePos)) == false ||
+					canUnitMoveSoon(unit, lastPos, nodePos) == false) {
+					break;
+				}
+				steps.push_back(nodePos);
+				lastPos = nodePos;
+			}
+			if (steps.empty() == true) {
+				return false;
+			}
+
+			UnitPathInterface *
+				path = unit->getPath();
+			path->clear();
+			for (unsigned int i = 0; i < steps.size(); ++i) {
+				path->add(steps[i]);
+			}
+			unit->setUsePathfinderExtendedMaxNodes(false);
+
+			if (SystemFlags::getSystemSettingType(SystemFlags::debugWorldSynch).
+				enabled == true) {
+				char
+					szBuf[8096] = "";
+				snprintf(szBuf, 8096,
+					"following group %d path from index %d offset [%s] steps %d",
+					groupId, joinIndex, offset.getString().c_str(),
+					(int) steps.size());
+				unit->logSynchData(extractFileFromDirectoryPath(__FILE__).
+					c_str(), __LINE__, szBuf);
+			}
+			return true;
+		}
+
 		void
 			PathFinder::saveGame(XmlNode * rootNode) {
 			std::map < string, string > mapTagReplacements;
@@ -1809,6 +1911,31 @@ namespace
 				factionsNode->addAttribute("useMaxNodeCount",
 					intToStr(factionState.useMaxNodeCount),
 					mapTagReplacements);
+
+				// in insertion order, which decides the next path to drop
+				for (int groupIndex = 0; groupIndex < factionState.groupPaths.size();
+					++groupIndex) {
+					int
+						groupId = factionState.groupPaths.getGroupId(groupIndex);
+					const GroupPath *
+						groupPath = factionState.groupPaths.find(groupId);
+					XmlNode *
+						groupPathNode = factionsNode->addChild("groupPath");
+					groupPathNode->addAttribute("groupId",
+						intToStr(groupId),
+						mapTagReplacements);
+					groupPathNode->addAttribute("targetPos",
+						groupPath->targetPos.getString(),
+						mapTagReplacements);
+					string
+						cells = "";
+					for (unsigned int j = 0; j < groupPath->cells.size(); ++j) {
+						const Vec2i & cell = groupPath->cells[j];
+						cells += (j > 0 ? "," : "") + intToStr(cell.x) + "," +
+							intToStr(cell.y);
+					}
+					groupPathNode->addAttribute("cells", cells, mapTagReplacements);
+				}
 			}
 		}
 
@@ -1868,6 +1995,28 @@ namespace
 					getAttribute("random")->
 					getIntValue());
 				factionState.useMaxNodeCount = PathFinder::pathFindNodesMax;
+
+				factionState.groupPaths.clear();
+				vector < XmlNode * >groupPathNodeList =
+					factionsNode->getChildList("groupPath");
+				for (unsigned int j = 0; j < (unsigned int) groupPathNodeList.size();
+					++j) {
+					XmlNode *
+						groupPathNode = groupPathNodeList[j];
+					GroupPath & groupPath =
+						factionState.groupPaths.add(groupPathNode->
+							getAttribute("groupId")->getIntValue(), maxGroupPaths);
+					groupPath.targetPos =
+						Vec2i::strToVec2(groupPathNode->getAttribute("targetPos")->
+							getValue());
+					vector < string > cellTokens;
+					Tokenize(groupPathNode->getAttribute("cells")->getValue(),
+						cellTokens, ",");
+					for (unsigned int k = 0; k + 1 < cellTokens.size(); k += 2) {
+						groupPath.cells.push_back(Vec2i(strToInt(cellTokens[k]),
+							strToInt(cellTokens[k + 1])));
+					}
+				}
 			}
 		}
 
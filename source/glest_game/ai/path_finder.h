@@ -24,6 +24,7 @@
 #   include "skill_type.h"
 #   include "map.h"
 #   include "unit.h"
+#   include "group_path_cache.h"
 //#include "randomc.h"
 #   include "leak_dumper.h"
 
@@ -185,6 +186,9 @@ namespace
 					std::vector <
 					Vec2i > >
 					precachedPath;
+
+				GroupPathCache
+					groupPaths;
 			};
 
 			class
@@ -245,6 +249,10 @@ namespace
 				pathFindExtendRefreshNodeCountMin;
 			static const int
 				pathFindExtendRefreshNodeCountMax;
+			static const int
+				maxGroupPaths;
+			static const int
+				groupPathJoinDistance;
 
 		private:
 
@@ -326,6 +334,15 @@ namespace
 			Vec2i
 				computeNearestFreePos(const Unit * unit, const Vec2i & targetPos);
 
+			static int
+				getCommandGroupId(const Unit * unit);
+			void
+				addGroupPath(const Unit * unit, const Vec2i & targetPos,
+					FactionState & faction, const Node * firstNode);
+			bool
+				followGroupPath(Unit * unit, const Vec2i & targetPos,
+					FactionState & faction);
+
 			inline static float
 				heuristic(const Vec2i & pos, const Vec2i & finalPos) {
 				return pos.dist(finalPos);
@@ -407,8 +424,8 @@ namespace
 						sucNode->prev = node;
 						sucNode->next = NULL;
 						sucNode->exploredCell =
-							map->getSurfaceCell(Map::toSurfCoords(sucPos))->
-							isExplored(unit->getTeam());
+							map->isSurfaceExplored(Map::toSurfCoords(sucPos),
+								unit->getTeam());
 						if (faction.openNodesList.find(sucNode->heuristic) ==
 							faction.openNodesList.end()) {
 							faction.openNodesList[sucNode->heuristic].clear();
@@ -0,0 +1,234 @@
+//
+//      harvest_benchmark.cpp:
+//
+//      This file is part of ZetaGlest <https://github.com/ZetaGlest>
+//
+//      Copyright (C) 2018  The ZetaGlest team
+//
+//      ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+//      This program is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program.  If not, see <https://www.gnu.org/licenses/>
+
+#include "harvest_benchmark.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <set>
+#include "replay_benchmark.h"
+#include "map.h"
+#include "tileset.h"
+#include "tech_tree.h"
+#include "faction_type.h"
+#include "unit_type.h"
+#include "command_type.h"
+#include "unit_updater.h"
+#include "config.h"
+#include "map_preview.h"
+#include "checksum.h"
+#include "randomgen.h"
+#include "platform_util.h"
+#include "util.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Util;
+using namespace Shared::Map;
+using namespace Shared::PlatformCommon;
+
+namespace Glest {
+	namespace Game {
+
+		// =====================================================
+		//      class HarvestBenchmark
+		// =====================================================
+
+		// how far from a resource cell the workers are placed
+		static const int workerSpread = 12;
+
+		static const HarvestCommandType *findHarvestCommand(const TechTree *techTree) {
+			for (int i = 0; i < techTree->getTypeCount(); ++i) {
+				const FactionType *factionType = techTree->getType(i);
+				for (int j = 0; j < factionType->getUnitTypeCount(); ++j) {
+					const UnitType *unitType = factionType->getUnitType(j);
+					for (int k = 0; k < unitType->getCommandTypeCount(); ++k) {
+						const CommandType *ct = unitType->getCommandType(k);
+						if (ct->getClass() == ccHarvest) {
+							return static_cast<const HarvestCommandType *>(ct);
+						}
+					}
+				}
+			}
+			return NULL;
+		}
+
+		int HarvestBenchmark::run(const string &tilesetName, const string &techName,
+			int rounds, int workerCount) {
+			Config &config = Config::getInstance();
+			rounds = max(rounds, 1);
+			workerCount = max(workerCount, 1);
+
+			vector<string> techPaths = config.getPathListForType(ptTechs);
+			if (TechTree::exists(techName, techPaths) == false) {
+				printf("\nTechtree [%s] not found\n\n", techName.c_str());
+				return 1;
+			}
+
+			std::map<string, vector<pair<string, string> > > loadedFileList;
+			Checksum checksum;
+			Tileset tileset;
+			TechTree techTree(techPaths);
+			try {
+				tileset.loadTileset(config.getPathListForType(ptTilesets), tilesetName,
+					&checksum, loadedFileList);
+				std::set<string> factions;
+				techTree.loadTech(techName, factions, &checksum, loadedFileList, true);
+			} catch (const megaglest_runtime_error &ex) {
+				printf("%s\n", ex.what());
+				return 1;
+			}
+
+			const HarvestCommandType *hct = findHarvestCommand(&techTree);
+			if (hct == NULL) {
+				printf("\nTechtree [%s] has no harvest command\n\n", techName.c_str());
+				return 1;
+			}
+			const int maxRadius = UnitUpdater::getMaxResSearchRadius() - 1;
+
+			vector<string> maps = MapPreview::findAllValidMaps(
+				config.getPathListForType(ptMaps), "", false, true);
+			std::sort(maps.begin(), maps.end());
+
+			printf("Resource search of %d workers on %d maps, %d rounds\n\n",
+				workerCount, (int) maps.size(), rounds);
+			printf("%-32s %9s %10s %10s %8s %s\n", "map", "found", "scan [ms]",
+				"index [ms]", "speedup", "cells");
+
+			int mismatches = 0;
+			int64 totalScanMicros = 0;
+			int64 totalIndexMicros = 0;
+			for (unsigned int index = 0; index < maps.size(); ++index) {
+				string mapPath = Config::getMapPath(maps[index], "", false);
+				if (mapPath == "") {
+					continue;
+				}
+
+				Map map;
+				try {
+					map.load(mapPath, &techTree, &tileset);
+					map.init(&tileset);
+				} catch (const megaglest_runtime_error &ex) {
+					printf("%-32s %s\n", maps[index].c_str(), ex.what());
+					continue;
+				}
+
+				vector<Vec2i> resourceCells;
+				for (int j = 0; j < map.getSurfaceH(); ++j) {
+					for (int i = 0; i < map.getSurfaceW(); ++i) {
+						const Resource *r = map.getSurfaceCell(i, j)->getResource();
+						if (r != NULL && hct->canHarvest(r->getType())) {
+							resourceCells.push_back(Map::toUnitCoords(Vec2i(i, j)));
+						}
+					}
+				}
+				if (resourceCells.empty() == true) {
+					printf("%-32s no resources\n", maps[index].c_str());
+					continue;
+				}
+
+				// the same workers on every run of the benchmark
+				RandomGen random;
+				random.init(index + 1);
+				vector<Vec2i> workers;
+				for (int i = 0; i < workerCount; ++i) {
+					Vec2i pos = resourceCells[random.randRange(0, (int) resourceCells.size() - 1)];
+					pos.x = clamp(pos.x + random.randRange(-workerSpread, workerSpread), 0, map.getW() - 1);
+					pos.y = clamp(pos.y + random.randRange(-workerSpread, workerSpread), 0, map.getH() - 1);
+					workers.push_back(pos);
+				}
+
+				int found = 0;
+				bool identical = true;
+				for (int i = 0; i < workerCount; ++i) {
+					Vec2i scanPos(-1, -1);
+					Vec2i indexPos(-1, -1);
+					bool scanFound = scanForHarvestCell(&map, workers[i], maxRadius, hct, scanPos);
+					bool indexFound = map.findHarvestCell(workers[i], maxRadius, hct, NULL, indexPos);
+					if (scanFound != indexFound || scanPos != indexPos) {
+						identical = false;
+					}
+					if (scanFound == true) {
+						found++;
+					}
+				}
+
+				int64 startMicros = ReplayBenchmark::getCurrentMicros();
+				for (int round = 0; round < rounds; ++round) {
+					for (int i = 0; i < workerCount; ++i) {
+						Vec2i scanPos;
+						scanForHarvestCell(&map, workers[i], maxRadius, hct, scanPos);
+					}
+				}
+				int64 scanMicros = ReplayBenchmark::getCurrentMicros() - startMicros;
+
+				startMicros = ReplayBenchmark::getCurrentMicros();
+				for (int round = 0; round < rounds; ++round) {
+					for (int i = 0; i < workerCount; ++i) {
+						Vec2i indexPos;
+						map.findHarvestCell(workers[i], maxRadius, hct, NULL, indexPos);
+					}
+				}
+				int64 indexMicros = ReplayBenchmark::getCurrentMicros() - startMicros;
+
+				if (identical == false) {
+					mismatches++;
+				}
+				totalScanMicros += scanMicros;
+				totalIndexMicros += indexMicros;
+
+				string foundText = intToStr(found) + "/" + intToStr(workerCount);
+				printf("%-32s %9s %10.2f %10.2f %7.2fx %s\n", maps[index].c_str(), foundText.c_str(),
+					scanMicros / 1000.0, indexMicros / 1000.0,
+					(indexMicros > 0 ? (double) scanMicros / indexMicros : 0.0),
+					(identical == true ? "identical" : "DIFFER"));
+			}
+
+			printf("\n%-32s %9s %10.2f %10.2f %7.2fx\n", "total", "",
+				totalScanMicros / 1000.0, totalIndexMicros / 1000.0,
+				(totalIndexMicros > 0 ? (double) totalScanMicros / totalIndexMicros : 0.0));
+			if (mismatches > 0) {
+				printf("\n%d maps picked different cells with the resource index!\n", mismatches);
+				return 1;
+			}
+			return 0;
+		}
+
+		bool HarvestBenchmark::scanForHarvestCell(const Map *map, const Vec2i &pos,
+			int maxRadius, const HarvestCommandType *hct, Vec2i &resultPos) {
+			for (int radius = 0; radius <= maxRadius; radius++) {
+				for (int i = pos.x - radius; i <= pos.x + radius; ++i) {
+					for (int j = pos.y - radius; j <= pos.y + radius; ++j) {
+						if (map->isInside(i, j)) {
+							Resource *r = map->getSurfaceCell(Map::toSurfCoords(Vec2i(i, j)))->getResource();
+							if (r != NULL && hct->canHarvest(r->getType())) {
+								resultPos = Vec2i(i, j);
+								return true;
+							}
+						}
+					}
+				}
+			}
+			return false;
+		}
+
+	}
+}//end namespace
@@ -0,0 +1,64 @@
+//
+//      harvest_benchmark.h:
+//
+//      This file is part of ZetaGlest <https://github.com/ZetaGlest>
+//
+//      Copyright (C) 2018  The ZetaGlest team
+//
+//      ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+//      This program is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program.  If not, see <https://www.gnu.org/licenses/>
+
+#ifndef _GLEST_GAME_HARVESTBENCHMARK_H_
+#   define _GLEST_GAME_HARVESTBENCHMARK_H_
+
+#   include <string>
+#   include "vec.h"
+#   include "leak_dumper.h"
+
+using std::string;
+using Shared::Graphics::Vec2i;
+
+namespace Glest {
+	namespace Game {
+
+		class Map;
+		class HarvestCommandType;
+
+		// =====================================================
+		//      class HarvestBenchmark
+		//
+		///     Loads every map with the given tileset and techtree,
+		///     places workers around the map resources and times
+		///     their resource searches with the old ring scan and
+		///     with the map resource index, checking that both
+		///     pick the same cells
+		// =====================================================
+
+		class HarvestBenchmark {
+		public:
+			// returns the process exit code
+			static int run(const string &tilesetName, const string &techName,
+				int rounds, int workerCount);
+
+			// the search UnitUpdater did before the resource index: the
+			// cells of every ring around pos, first match wins
+			static bool scanForHarvestCell(const Map *map, const Vec2i &pos,
+				int maxRadius, const HarvestCommandType *hct, Vec2i &resultPos);
+		};
+
+	}
+}//end namespace
+
+#endif
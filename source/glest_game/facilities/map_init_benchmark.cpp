@@ -0,0 +1,178 @@
+//
+//      map_init_benchmark.cpp:
+//
+//      This file is part of ZetaGlest <https://github.com/ZetaGlest>
+//
+//      Copyright (C) 2018  The ZetaGlest team
+//
+//      ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+//      This program is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program.  If not, see <https://www.gnu.org/licenses/>
+
+#include "map_init_benchmark.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <set>
+#include "replay_benchmark.h"
+#include "map.h"
+#include "tileset.h"
+#include "tech_tree.h"
+#include "config.h"
+#include "map_preview.h"
+#include "simple_threads.h"
+#include "checksum.h"
+#include "platform_util.h"
+#include "util.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Util;
+using namespace Shared::Map;
+using namespace Shared::PlatformCommon;
+
+namespace Glest {
+	namespace Game {
+
+		// =====================================================
+		//      class MapInitBenchmark
+		// =====================================================
+
+		int MapInitBenchmark::run(const string &tilesetName, const string &techName,
+			int runs, int workerCount) {
+			Config &config = Config::getInstance();
+			runs = max(runs, 1);
+
+			vector<string> techPaths = config.getPathListForType(ptTechs);
+			if (TechTree::exists(techName, techPaths) == false) {
+				printf("\nTechtree [%s] not found\n\n", techName.c_str());
+				return 1;
+			}
+
+			std::map<string, vector<pair<string, string> > > loadedFileList;
+			Checksum checksum;
+			Tileset tileset;
+			TechTree techTree(techPaths);
+			try {
+				tileset.loadTileset(config.getPathListForType(ptTilesets), tilesetName,
+					&checksum, loadedFileList);
+				std::set<string> factions;
+				techTree.loadTech(techName, factions, &checksum, loadedFileList, true);
+			} catch (const megaglest_runtime_error &ex) {
+				printf("%s\n", ex.what());
+				return 1;
+			}
+
+			vector<string> maps = MapPreview::findAllValidMaps(
+				config.getPathListForType(ptMaps), "", false, true);
+			std::sort(maps.begin(), maps.end());
+
+			int threads = ParallelRowsThread::getWorkerCount(INT_MAX, 1, workerCount);
+			printf("Map init of %d maps, best of %d runs, 1 and up to %d threads\n\n",
+				(int) maps.size(), runs, threads);
+			printf("%-32s %9s %10s %10s %8s %s\n", "map", "size", "1 [ms]",
+				"n [ms]", "speedup", "terrain");
+
+			int mismatches = 0;
+			int64 totalSingleMicros = 0;
+			int64 totalParallelMicros = 0;
+			for (unsigned int index = 0; index < maps.size(); ++index) {
+				string mapPath = Config::getMapPath(maps[index], "", false);
+				if (mapPath == "") {
+					continue;
+				}
+
+				int64 bestMicros[2] = { 0, 0 };
+				uint32 terrainCRC[2] = { 0, 0 };
+				int surfaceW = 0;
+				int surfaceH = 0;
+				try {
+					for (int run = 0; run < runs; ++run) {
+						for (int pass = 0; pass < 2; ++pass) {
+							config.setInt("MapInitWorkerThreads", (pass == 0 ? 1 : threads), true);
+
+							Map map;
+							map.load(mapPath, &techTree, &tileset);
+							int64 startMicros = ReplayBenchmark::getCurrentMicros();
+							map.init(&tileset);
+							int64 micros = ReplayBenchmark::getCurrentMicros() - startMicros;
+
+							if (run == 0 || micros < bestMicros[pass]) {
+								bestMicros[pass] = micros;
+							}
+							terrainCRC[pass] = getTerrainCRC(&map);
+							surfaceW = map.getSurfaceW();
+							surfaceH = map.getSurfaceH();
+						}
+					}
+				} catch (const megaglest_runtime_error &ex) {
+					printf("%-32s %s\n", maps[index].c_str(), ex.what());
+					continue;
+				}
+
+				bool identical = (terrainCRC[0] == terrainCRC[1]);
+				if (identical == false) {
+					mismatches++;
+				}
+				totalSingleMicros += bestMicros[0];
+				totalParallelMicros += bestMicros[1];
+
+				string size = intToStr(surfaceW) + "x" + intToStr(surfaceH);
+				printf("%-32s %9s %10.2f %10.2f %7.2fx %s\n", maps[index].c_str(), size.c_str(),
+					bestMicros[0] / 1000.0, bestMicros[1] / 1000.0,
+					(bestMicros[1] > 0 ? (double) bestMicros[0] / bestMicros[1] : 0.0),
+					(identical == true ? "identical" : "DIFFERS"));
+			}
+			config.setInt("MapInitWorkerThreads", workerCount, true);
+
+			printf("\n%-32s %9s %10.2f %10.2f %7.2fx\n", "total", "",
+				totalSingleMicros / 1000.0, totalParallelMicros / 1000.0,
+				(totalParallelMicros > 0 ? (double) totalSingleMicros / totalParallelMicros : 0.0));
+			if (mismatches > 0) {
+				printf("\n%d maps got a different terrain on worker threads!\n", mismatches);
+				return 1;
+			}
+			return 0;
+		}
+
+		uint32 MapInitBenchmark::getTerrainCRC(const Map *map) {
+			Checksum crc;
+			float maxMapHeight = map->getMaxMapHeight();
+			crc.addBytes(&maxMapHeight, sizeof(maxMapHeight));
+			for (int j = 0; j < map->getSurfaceH(); ++j) {
+				for (int i = 0; i < map->getSurfaceW(); ++i) {
+					const SurfaceCell *sc = map->getSurfaceCell(i, j);
+					crc.addBytes(&sc->getVertex(), sizeof(Vec3f));
+					crc.addBytes(&sc->getNormal(), sizeof(Vec3f));
+					crc.addBytes(&sc->getColor(), sizeof(Vec3f));
+					crc.addInt(sc->getSurfaceType());
+					crc.addInt(sc->getNearSubmerged());
+					if (sc->getObject() != NULL) {
+						Vec3f pos = sc->getObject()->getPos();
+						crc.addBytes(&pos, sizeof(Vec3f));
+						crc.addInt(sc->getObject()->getType() != NULL);
+					}
+				}
+			}
+			for (int j = 0; j < map->getH(); ++j) {
+				for (int i = 0; i < map->getW(); ++i) {
+					float height = map->getCell(i, j)->getHeight();
+					crc.addBytes(&height, sizeof(height));
+				}
+			}
+			return crc.getSum();
+		}
+
+	}
+}//end namespace
@@ -0,0 +1,60 @@
+//
+//      map_init_benchmark.h:
+//
+//      This file is part of ZetaGlest <https://github.com/ZetaGlest>
+//
+//      Copyright (C) 2018  The ZetaGlest team
+//
+//      ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+//      This program is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program.  If not, see <https://www.gnu.org/licenses/>
+
+#ifndef _GLEST_GAME_MAPINITBENCHMARK_H_
+#   define _GLEST_GAME_MAPINITBENCHMARK_H_
+
+#   include <string>
+#   include "data_types.h"
+#   include "leak_dumper.h"
+
+using std::string;
+using Shared::Platform::uint32;
+
+namespace Glest {
+	namespace Game {
+
+		class Map;
+
+		// =====================================================
+		//      class MapInitBenchmark
+		//
+		///     Loads every map with the given tileset and techtree,
+		///     times the terrain preprocessing of Map::init on one
+		///     thread and on worker threads, and checks that both
+		///     give the same terrain
+		// =====================================================
+
+		class MapInitBenchmark {
+		public:
+			// returns the process exit code, workerCount 0 uses
+			// one thread per cpu
+			static int run(const string &tilesetName, const string &techName,
+				int runs, int workerCount);
+
+			static uint32 getTerrainCRC(const Map *map);
+		};
+
+	}
+}//end namespace
+
+#endif
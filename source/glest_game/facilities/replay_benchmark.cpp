@@ -0,0 +1,168 @@
+//
+//      replay_benchmark.cpp:
+//
+//      This file is part of ZetaGlest <https://github.com/ZetaGlest>
+//
+//      Copyright (C) 2018  The ZetaGlest team
+//
+//      ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+//      This program is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program.  If not, see <https://www.gnu.org/licenses/>
+
+#include "replay_benchmark.h"
+
+#include <chrono>
+#include "game.h"
+#include "world.h"
+#include "faction.h"
+#include "checksum.h"
+#include "platform_util.h"
+#include "util.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Util;
+using namespace Shared::Platform;
+
+namespace Glest {
+	namespace Game {
+
+		// =====================================================
+		//      class ReplayBenchmark
+		// =====================================================
+
+		string ReplayBenchmark::replayFile = "";
+		string ReplayBenchmark::reportFile = "";
+		int ReplayBenchmark::maxFrames = 0;
+		const int ReplayBenchmark::framesPerUpdate = 100;
+
+		ReplayBenchmark & ReplayBenchmark::getInstance() {
+			static ReplayBenchmark replayBenchmark;
+			return replayBenchmark;
+		}
+
+		ReplayBenchmark::ReplayBenchmark() {
+			fp = NULL;
+			startMicros = 0;
+			lastFrameMicros = 0;
+			startFrame = -1;
+			frames = 0;
+			unitUpdates = 0;
+		}
+
+		ReplayBenchmark::~ReplayBenchmark() {
+			if (fp != NULL) {
+				fclose(fp);
+				fp = NULL;
+			}
+		}
+
+		void ReplayBenchmark::setup(const string &replayFile, int maxFrames, const string &reportFile) {
+			ReplayBenchmark::replayFile = replayFile;
+			ReplayBenchmark::maxFrames = maxFrames;
+			ReplayBenchmark::reportFile = (reportFile != "" ? reportFile : replayFile + ".benchmark.csv");
+		}
+
+		int64 ReplayBenchmark::getCurrentMicros() {
+			return std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		unsigned int ReplayBenchmark::getWorldCRC(World *world) {
+			Checksum crc;
+			crc.addInt(world->getFrameCount());
+			for (int i = 0; i < world->getFactionCount(); ++i) {
+				crc.addUInt(world->getFaction(i)->getCRC().getSum());
+			}
+			return crc.getSum();
+		}
+
+		void ReplayBenchmark::addPerformanceCount(const string &key, int64 value) {
+			frameCounts[key] += value;
+		}
+
+		void ReplayBenchmark::open(Game *game) {
+#ifdef WIN32
+			fp = _wfopen(utf8_decode(reportFile).c_str(), L"wt");
+#else
+			fp = fopen(reportFile.c_str(), "wt");
+#endif
+			if (fp == NULL) {
+				throw megaglest_runtime_error("Can't open file: [" + reportFile + "]");
+			}
+			// one row per frame and measurement, all times in microseconds
+			// so phases shorter than a millisecond still add up
+			fprintf(fp, "frame,bucket,value\n");
+
+			startFrame = game->getWorld()->getFrameCount() - 1;
+			startMicros = getCurrentMicros();
+			lastFrameMicros = startMicros;
+			printf("Benchmarking replay [%s] from frame %d, writing [%s]\n",
+				replayFile.c_str(), startFrame, reportFile.c_str());
+		}
+
+		bool ReplayBenchmark::frameDone(Game *game, int replayLastFrame) {
+			if (fp == NULL) {
+				open(game);
+			}
+
+			World *world = game->getWorld();
+			int64 nowMicros = getCurrentMicros();
+			int unitCount = 0;
+			for (int i = 0; i < world->getFactionCount(); ++i) {
+				unitCount += world->getFaction(i)->getUnitCount();
+			}
+
+			int frame = world->getFrameCount();
+			fprintf(fp, "%d,FrameMicros,%lld\n", frame, (long long int) (nowMicros - lastFrameMicros));
+			fprintf(fp, "%d,Units,%d\n", frame, unitCount);
+			for (std::map<string, int64>::iterator iterMap = frameCounts.begin();
+				iterMap != frameCounts.end(); ++iterMap) {
+				if (iterMap->second != 0) {
+					fprintf(fp, "%d,%s,%lld\n", frame, iterMap->first.c_str(), (long long int) iterMap->second);
+					totalCounts[iterMap->first] += iterMap->second;
+					iterMap->second = 0;
+				}
+			}
+			lastFrameMicros = nowMicros;
+			frames++;
+			unitUpdates += unitCount;
+
+			int lastFrame = (maxFrames > 0 ? startFrame + maxFrames : replayLastFrame);
+			if (frame < lastFrame) {
+				return false;
+			}
+			finish(game);
+			return true;
+		}
+
+		void ReplayBenchmark::finish(Game *game) {
+			fclose(fp);
+			fp = NULL;
+
+			World *world = game->getWorld();
+			double seconds = (getCurrentMicros() - startMicros) / 1000000.0;
+			printf("Replay benchmark finished at frame %d\n", world->getFrameCount());
+			printf("  frames simulated: %d in %.3f seconds, %.1f frames per second\n",
+				frames, seconds, (seconds > 0 ? frames / seconds : 0.0));
+			printf("  unit updates: %lld, %.0f units per second\n",
+				(long long int) unitUpdates, (seconds > 0 ? unitUpdates / seconds : 0.0));
+			for (std::map<string, int64>::const_iterator iterMap = totalCounts.begin();
+				iterMap != totalCounts.end(); ++iterMap) {
+				printf("  %s: %.3f ms\n", iterMap->first.c_str(), iterMap->second / 1000.0);
+			}
+			printf("  world CRC: %u\n", getWorldCRC(world));
+		}
+
+	}
+}//end namespace
@@ -0,0 +1,97 @@
+//
+//      replay_benchmark.h:
+//
+//      This file is part of ZetaGlest <https://github.com/ZetaGlest>
+//
+//      Copyright (C) 2018  The ZetaGlest team
+//
+//      ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+//      This program is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program.  If not, see <https://www.gnu.org/licenses/>
+
+#ifndef _GLEST_GAME_REPLAYBENCHMARK_H_
+#   define _GLEST_GAME_REPLAYBENCHMARK_H_
+
+#   include <cstdio>
+#   include <map>
+#   include <string>
+#   include "data_types.h"
+#   include "leak_dumper.h"
+
+using std::string;
+using Shared::Platform::int64;
+
+namespace Glest {
+	namespace Game {
+
+		class Game;
+		class World;
+
+		// =====================================================
+		//      class ReplayBenchmark
+		//
+		///     Runs a recorded replay headless and as fast as the
+		///     simulation allows, writes the per frame timings to a
+		///     csv file and prints a summary with the final world
+		///     CRC when done
+		// =====================================================
+
+		class ReplayBenchmark {
+		private:
+			static string replayFile;
+			static string reportFile;
+			static int maxFrames;
+
+			FILE *fp;
+			int64 startMicros;
+			int64 lastFrameMicros;
+			int startFrame;
+			int frames;
+			int64 unitUpdates;
+			std::map<string, int64> frameCounts;
+			std::map<string, int64> totalCounts;
+
+			void open(Game *game);
+			void finish(Game *game);
+
+		public:
+			// world frames stepped per game update while benchmarking
+			static const int framesPerUpdate;
+
+			static ReplayBenchmark & getInstance();
+			ReplayBenchmark();
+			~ReplayBenchmark();
+
+			static void setup(const string &replayFile, int maxFrames, const string &reportFile);
+			static bool isEnabled() {
+				return replayFile != "";
+			}
+			static string getReplayFile() {
+				return replayFile;
+			}
+
+			static int64 getCurrentMicros();
+			static unsigned int getWorldCRC(World *world);
+
+			// value in microseconds
+			void addPerformanceCount(const string &key, int64 value);
+			// call after each world frame, returns true once the last
+			// frame to benchmark was simulated
+			bool frameDone(Game *game, int replayLastFrame);
+		};
+
+	}
+}//end namespace
+
+#endif
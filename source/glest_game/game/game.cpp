@@ -35,6 +35,7 @@
 #include "network_manager.h"
 #include "checksum.h"
 #include "auto_test.h"
+#include "replay_benchmark.h"
 #include "menu_state_keysetup.h"
 #include "video_player.h"
 #include "compression_utils.h"
@@ -266,6 +267,7 @@ namespace Glest {
 			visibleHUD = Config::getInstance().getBool("VisibleHud", "true");
 			timeDisplay = Config::getInstance().getBool("TimeDisplay", "true");
 			withRainEffect = Config::getInstance().getBool("RainEffect", "true");
+			renderSnapshots.init(Config::getInstance().getBool("UnitInterpolation", "true"));
 			//MIN_RENDER_FPS_ALLOWED = Config::getInstance().getInt("MIN_RENDER_FPS_ALLOWED",intToStr(MIN_RENDER_FPS_ALLOWED).c_str());
 
 			mouseX = 0;
@@ -2697,7 +2699,7 @@ namespace Glest {
 					if (clientInterface != NULL) {
 						uint64
 							lastNetworkFrameFromServer =
-							clientInterface->getCachedLastPendingFrameCount();
+							clientInterface->getCachedLastServerFrameCount();
 
 						/////////////////////////////////
 						// TTTT new attempt to make things smoother:
@@ -2827,7 +2829,7 @@ namespace Glest {
 				}
 
 				addPerformanceCount("CalculateNetworkUpdateLoops",
-					chronoGamePerformanceCounts.getMillis());
+					chronoGamePerformanceCounts.getMicros());
 
 				if (SystemFlags::
 					getSystemSettingType(SystemFlags::debugPerformance).enabled
@@ -2870,7 +2872,7 @@ namespace Glest {
 				ReplaceDisconnectedNetworkPlayersWithAI(isNetworkGame, role);
 
 				addPerformanceCount("ReplaceDisconnectedNetworkPlayersWithAI",
-					chronoGamePerformanceCounts.getMillis());
+					chronoGamePerformanceCounts.getMicros());
 
 				setupPopupMenus(true);
 
@@ -2897,6 +2899,7 @@ namespace Glest {
 					//update
 					Chrono chronoReplay;
 					int64 lastReplaySecond = -1;
+					bool replayBenchmarkDone = false;
 					int replayCommandsPlayed = 0;
 					int replayTotal = commander.getReplayCommandListForFrameCount();
 					if (replayTotal > 0) {
@@ -2927,9 +2930,15 @@ namespace Glest {
 								processNetworkSynchChecksIfRequired();
 
 								addPerformanceCount("CalculateNetworkCRCSynchChecks",
-									chronoGamePerformanceCounts.getMillis
+									chronoGamePerformanceCounts.getMicros
 									());
 
+								GameNetworkInterface *aiNetworkInterface =
+									NetworkManager::getInstance().getGameNetworkInterface();
+								int firstAiCommand =
+									(aiNetworkInterface != NULL ?
+										aiNetworkInterface->getRequestedCommandCount() : -1);
+
 								const bool
 									newThreadManager =
 									Config::getInstance().getBool("EnableNewThreadManager",
@@ -3020,9 +3029,13 @@ namespace Glest {
 									}
 
 									addPerformanceCount("ProcessAIWorkerThreads",
-										chronoGamePerformanceCounts.getMillis
+										chronoGamePerformanceCounts.getMicros
 										());
 								}
+								if (aiNetworkInterface != NULL) {
+									aiNetworkInterface->orderRequestedCommandsByFaction(
+										firstAiCommand, &world);
+								}
 
 								if (showPerfStats) {
 									sprintf(perfBuf,
@@ -3035,7 +3048,8 @@ namespace Glest {
 
 							} else {
 								// Simply show a progress message while replaying commands
-								if (lastReplaySecond < chronoReplay.getSeconds()) {
+								if (lastReplaySecond < chronoReplay.getSeconds() &&
+									this->masterserverMode == false) {
 									lastReplaySecond = chronoReplay.getSeconds();
 									Renderer & renderer = Renderer::getInstance();
 									renderer.clearBuffers();
@@ -3110,7 +3124,14 @@ namespace Glest {
 								world.update();
 
 							addPerformanceCount("ProcessWorldUpdate",
-								chronoGamePerformanceCounts.getMillis());
+								chronoGamePerformanceCounts.getMicros());
+
+							if (ReplayBenchmark::isEnabled() == true &&
+								ReplayBenchmark::getInstance().frameDone(this,
+									lastworldFrameCountForReplay) == true) {
+								replayBenchmarkDone = true;
+								break;
+							}
 
 							if (SystemFlags::getSystemSettingType
 							(SystemFlags::debugPerformance).enabled
@@ -3175,7 +3196,7 @@ namespace Glest {
 							}
 
 							addPerformanceCount("ProcessNetworkUpdate",
-								chronoGamePerformanceCounts.getMillis());
+								chronoGamePerformanceCounts.getMicros());
 
 							if (showPerfStats) {
 								sprintf(perfBuf,
@@ -3205,7 +3226,7 @@ namespace Glest {
 							gui.update();
 
 							addPerformanceCount("ProcessGUIUpdate",
-								chronoGamePerformanceCounts.getMillis());
+								chronoGamePerformanceCounts.getMicros());
 
 							if (SystemFlags::getSystemSettingType
 							(SystemFlags::debugPerformance).enabled
@@ -3263,7 +3284,7 @@ namespace Glest {
 							renderer.updateParticleManager(rsGame, avgRenderFps);
 
 							addPerformanceCount("ProcessParticleManager",
-								chronoGamePerformanceCounts.getMillis());
+								chronoGamePerformanceCounts.getMicros());
 
 							if (SystemFlags::getSystemSettingType
 							(SystemFlags::debugPerformance).enabled
@@ -3289,7 +3310,17 @@ namespace Glest {
 
 							//good_fpu_control_registers(NULL,extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 						}
-					} while (commander.hasReplayCommandListForFrame() == true);
+					} while (commander.hasReplayCommandListForFrame() == true &&
+						replayBenchmarkDone == false);
+
+					if (replayBenchmarkDone == true) {
+						program->exit();
+						return;
+					}
+
+					if (this->masterserverMode == false) {
+						renderSnapshots.publish(&world);
+					}
 				}
 				//else if(role == nrClient) {
 				else {
@@ -3375,7 +3406,7 @@ namespace Glest {
 				}
 
 				addPerformanceCount("ProcessMiscNetwork",
-					chronoGamePerformanceCounts.getMillis());
+					chronoGamePerformanceCounts.getMicros());
 
 				// START - Handle joining in progress games
 				if (role == nrServer) {
@@ -3969,6 +4000,9 @@ namespace Glest {
 
 		void Game::addPerformanceCount(string key, int64 value) {
 			gamePerformanceCounts[key] = value + gamePerformanceCounts[key] / 2;
+			if (ReplayBenchmark::isEnabled() == true) {
+				ReplayBenchmark::getInstance().addPerformanceCount(key, value);
+			}
 		}
 
 		string Game::getGamePerformanceCounts(bool displayWarnings) const {
@@ -3992,14 +4026,17 @@ namespace Glest {
 			for (std::map < string, int64 >::const_iterator iterMap =
 				gamePerformanceCounts.begin();
 				iterMap != gamePerformanceCounts.end(); ++iterMap) {
+				// counts are kept in microseconds, shown in milliseconds
+				int64
+					avgMillis = iterMap->second / 1000;
 				if (iterMap->first == ProgramState::MAIN_PROGRAM_RENDER_KEY) {
-					if (iterMap->second < WARNING_RENDER_MILLIS) {
+					if (avgMillis < WARNING_RENDER_MILLIS) {
 						continue;
 					}
 					//else {
 					//      printf("iterMap->second: " MG_I64_SPECIFIER " WARNING_RENDER_MILLIS = %d\n",iterMap->second,WARNING_RENDER_MILLIS);
 					//}
-				} else if (iterMap->second < WARNING_MILLIS) {
+				} else if (avgMillis < WARNING_MILLIS) {
 					continue;
 				}
 
@@ -4008,7 +4045,7 @@ namespace Glest {
 				}
 				string
 					perfStat =
-					iterMap->first + " = avg millis: " + intToStr(iterMap->second);
+					iterMap->first + " = avg millis: " + intToStr(avgMillis);
 
 				if (displayWarnings == true && WARN_TO_CONSOLE == true) {
 					if (displayWarningHeader == true) {
@@ -4392,8 +4429,10 @@ namespace Glest {
 							isClientConnected(faction->getStartLocationIndex()) ==
 							false) {
 
+							// clients that detect a desync drop out of the game, so
+							// keep the server's side of the trace for comparison
 							if (faction->getPersonalityType() != fpt_Observer) {
-								DumpCRCWorldLogIfRequired("_faction_" + intToStr(i));
+								DumpCRCWorldLogIfRequired("_faction_" + intToStr(i), true);
 							}
 
 							faction->setFactionDisconnectHandled(true);
@@ -4589,6 +4628,8 @@ namespace Glest {
 				getSystemSettingType(SystemFlags::debugPerformance).enabled)
 				chrono.start();
 
+			// the whole frame is drawn from the same two world snapshots
+			renderSnapshots.beginRender();
 			render3d();
 
 			if (SystemFlags::
@@ -4605,6 +4646,7 @@ namespace Glest {
 				chrono.start();
 
 			render2d();
+			renderSnapshots.endRender();
 
 			if (SystemFlags::
 				getSystemSettingType(SystemFlags::debugPerformance).enabled
@@ -6750,10 +6792,17 @@ namespace Glest {
 			NetworkManager & networkManager = NetworkManager::getInstance();
 			NetworkRole role = networkManager.getNetworkRole();
 			string suffix = "_client";
+			bool synchMismatchDetected = false;
 			if (role == nrServer) {
 				suffix = "_server";
+			} else if (role == nrClient) {
+				ClientInterface *clientInterface =
+					dynamic_cast <
+					ClientInterface *>(networkManager.getClientInterface());
+				synchMismatchDetected = (clientInterface != NULL &&
+					clientInterface->getSynchMismatchDetected() == true);
 			}
-			this->DumpCRCWorldLogIfRequired(suffix);
+			this->DumpCRCWorldLogIfRequired(suffix, synchMismatchDetected);
 
 			if (SystemFlags::
 				getSystemSettingType(SystemFlags::debugSystem).enabled == true) {
@@ -6790,7 +6839,7 @@ namespace Glest {
 			return endStats;
 		}
 
-		void Game::DumpCRCWorldLogIfRequired(string fileSuffix) {
+		void Game::DumpCRCWorldLogIfRequired(string fileSuffix, bool saveSynchTrace) {
 			bool isNetworkGame = this->gameSettings.isNetworkGame();
 			if (isNetworkGame == true) {
 				if (SystemFlags::VERBOSE_MODE_ENABLED)
@@ -6798,6 +6847,37 @@ namespace Glest {
 					("Check save world CRC to log. isNetworkGame = %d fileSuffix = %s\n",
 						isNetworkGame, fileSuffix.c_str());
 
+				if (saveSynchTrace == true &&
+					world.getSynchTrace()->isEnabled() == true) {
+					string
+						synchTraceFile =
+						Config::getInstance().getString("DebugSynchTraceFile",
+							"synchTrace.bin");
+					synchTraceFile += fileSuffix;
+
+					if (getGameReadWritePath
+					(GameConstants::path_logs_CacheLookupKey) != "") {
+						synchTraceFile =
+							getGameReadWritePath(GameConstants::path_logs_CacheLookupKey) +
+							synchTraceFile;
+					} else {
+						string
+							userData =
+							Config::getInstance().getString("UserData_Root", "");
+						if (userData != "") {
+							endPathWithSlash(userData);
+						}
+						synchTraceFile = userData + synchTraceFile;
+					}
+
+					printf("Save synch trace to %s\n", synchTraceFile.c_str());
+					try {
+						world.getSynchTrace()->save(synchTraceFile);
+					} catch (const megaglest_runtime_error & ex) {
+						printf("%s\n", ex.what());
+					}
+				}
+
 				GameSettings *settings = world.getGameSettingsPtr();
 				if (settings != NULL &&
 					(isFlagType1BitEnabled(ft1_network_synch_checks_verbose) ==
@@ -7267,6 +7347,7 @@ namespace Glest {
 				chrono.start();
 
 			//objects
+			renderer.resetRenderQueueMicros();
 			renderer.renderObjects(avgRenderFps);
 			if (SystemFlags::
 				getSystemSettingType(SystemFlags::debugPerformance).enabled
@@ -7314,6 +7395,10 @@ namespace Glest {
 
 			//air units
 			renderer.renderUnits(true, avgRenderFps);
+			if (renderInGamePerformance == true) {
+				addPerformanceCount("RenderModelQueue", renderer.getRenderQueueMicros());
+				addPerformanceCount("RenderModelDraw", renderer.getRenderQueueDrawMicros());
+			}
 			if (SystemFlags::
 				getSystemSettingType(SystemFlags::debugPerformance).enabled
 				&& chrono.getMillis() > 0)
@@ -7461,6 +7546,9 @@ namespace Glest {
 					"Log buffer count: " +
 					intToStr(SystemFlags::getLogEntryBufferCount()) + "\n";
 			}
+#ifdef MUTEX_PROFILING
+			str += "Worst mutex lock sites:\n" + MutexLockSite::getReport(5);
+#endif
 
 			str +=
 				"UnitRangeCellsLookupItemCache: " +
@@ -8429,6 +8517,9 @@ namespace Glest {
 		}
 
 		int Game::getUpdateLoops() {
+			if (ReplayBenchmark::isEnabled() == true) {
+				return ReplayBenchmark::framesPerUpdate;
+			}
 			if (commander.hasReplayCommandListForFrame() == true) {
 				return 1;
 			}
@@ -37,6 +37,8 @@
 #   include "game_camera.h"
 #   include "world.h"
 #   include "ai_interface.h"
+#   include "ai_threat_map.h"
+#   include "render_snapshot.h"
 #   include "program.h"
 #   include "chat_manager.h"
 #   include "script_manager.h"
@@ -95,7 +97,9 @@ namespace Glest {
 		private:
 			//main data
 			World world;
+			AiThreatMap aiThreatMap;
 			AiInterfaces aiInterfaces;
+			RenderSnapshots renderSnapshots;
 			Gui gui;
 			GameCamera gameCamera;
 			Commander commander;
@@ -328,6 +332,12 @@ namespace Glest {
 			const World *getWorld() const {
 				return &world;
 			}
+			AiThreatMap *getAiThreatMap() {
+				return &aiThreatMap;
+			}
+			const RenderSnapshots *getRenderSnapshots() const {
+				return &renderSnapshots;
+			}
 
 			Program *getProgram() {
 				return program;
@@ -466,7 +476,10 @@ namespace Glest {
 
 			bool showTranslatedTechTree()const;
 
-			void DumpCRCWorldLogIfRequired(string fileSuffix = "");
+			// the synch trace is only written when saveSynchTrace is set,
+			// which is when a peer lost synch
+			void DumpCRCWorldLogIfRequired(string fileSuffix = "",
+				bool saveSynchTrace = false);
 
 			bool getDisableSpeedChange()const {
 				return disableSpeedChange;
@@ -476,6 +489,7 @@ namespace Glest {
 			}
 
 			string getGamePerformanceCounts(bool displayWarnings) const;
+			// value in microseconds
 			virtual void addPerformanceCount(string key, int64 value);
 			bool getRenderInGamePerformance()const {
 				return renderInGamePerformance;
@@ -99,6 +99,8 @@ namespace Glest {
 		const int OBJECT_SELECT_OFFSET = 100000000;
 
 		bool VisibleQuadContainerCache::enableFrustumCalcs = true;
+		const float VisibleQuadContainerCache::frustumTileMargin = 4.0f;
+		const float VisibleQuadContainerCache::frustumTileHeightAllowance = 12.0f;
 
 		// ==================== constructor and destructor ====================
 
@@ -136,6 +138,9 @@ namespace Glest {
 			mapSurfaceData.clear();
 			visibleFrameUnitList.clear();
 			visibleFrameUnitListCameraKey = "";
+			renderQueueMicros = 0;
+			renderQueueDrawMicros = 0;
+			sortRenderQueue = true;
 
 			quadCache = VisibleQuadContainerCache();
 			quadCache.clearFrustumData();
@@ -169,6 +174,7 @@ namespace Glest {
 
 			Renderer::perspFarPlane = config.getFloat("PerspectiveFarPlane", floatToStr(Renderer::perspFarPlane).c_str());
 			this->no2DMouseRendering = config.getBool("No2DMouseRendering", "false");
+			this->sortRenderQueue = config.getBool("SortRenderQueue", "true");
 			this->maxConsoleLines = config.getInt("ConsoleMaxLines");
 
 			if (SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] Renderer::perspFarPlane [%f] this->no2DMouseRendering [%d] this->maxConsoleLines [%d]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, Renderer::perspFarPlane, this->no2DMouseRendering, this->maxConsoleLines);
@@ -197,7 +203,7 @@ namespace Glest {
 			}
 
 			if (GlobalStaticFlags::getIsNonGraphicalModeEnabled() == false) {
-				static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				saveScreenShotThread = new SimpleTaskThread(this, 0, 25);
 				saveScreenShotThread->setUniqueID(mutexOwnerId);
 				saveScreenShotThread->start();
@@ -226,7 +232,7 @@ namespace Glest {
 				if (getSaveScreenQueueSize() > 0) {
 					if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line %d] FORCING MEMORY CLEANUP and NOT SAVING screenshots, saveScreenQueue.size() = %d\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, saveScreenQueue.size());
 
-					static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+					static const char *mutexOwnerId = CODE_AT_LINE;
 					MutexSafeWrapper safeMutex(saveScreenShotThreadAccessor, mutexOwnerId);
 					for (std::list<std::pair<string, Pixmap2D *> >::iterator iter = saveScreenQueue.begin();
 						iter != saveScreenQueue.end(); ++iter) {
@@ -297,7 +303,7 @@ namespace Glest {
 			// This code reads pixmaps from a queue and saves them to disk
 			Pixmap2D *savePixMapBuffer = NULL;
 			string path = "";
-			static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(saveScreenShotThreadAccessor, mutexOwnerId);
 			if (saveScreenQueue.empty() == false) {
 				if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line %d] saveScreenQueue.size() = %d\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, saveScreenQueue.size());
@@ -1001,12 +1007,12 @@ namespace Glest {
 						++visibleUnitIndex) {
 						Unit *unit = qCache.visibleQuadUnitList[visibleUnitIndex];
 
-						if (world->toRenderUnit(unit) &&
-							unit->getCurrMidHeightVector().dist(gameCamera->getPos()) < maxLightDist &&
+						if (isUnitRenderedInMap(unit) &&
+							getUnitRenderMidHeightVector(unit).dist(gameCamera->getPos()) < maxLightDist &&
 							unit->getType()->getLight() && unit->isOperative()) {
 							//printf("$$$ Show light for faction: %s # %d / %d for Unit [%d - %s]\n",world->getFaction(i)->getType()->getName().c_str(),lightCount,maxLights,unit->getId(),unit->getFullName().c_str());
 
-							Vec4f pos = Vec4f(unit->getCurrMidHeightVector());
+							Vec4f pos = Vec4f(getUnitRenderMidHeightVector(unit));
 							pos.y += 4.f;
 
 							GLenum lightEnum = GL_LIGHT0 + lightCount;
@@ -1389,12 +1395,115 @@ namespace Glest {
 			return true;
 		}
 
+		// Classifies an axis aligned box against the frustum using the same
+		// corner test as CubeInFrustum, so any cube contained in a box that is
+		// outside (or inside) gets the same answer from CubeInFrustum
+		int Renderer::BoxInFrustumState(vector<vector<float> > &frustum, const Vec3f &boxMin, const Vec3f &boxMax) {
+			bool allInside = true;
+			for (unsigned int p = 0; p < frustum.size(); p++) {
+				const vector<float> &plane = frustum[p];
+				int cornersInside = 0;
+				for (int corner = 0; corner < 8; ++corner) {
+					float x = ((corner & 1) ? boxMax.x : boxMin.x);
+					float y = ((corner & 2) ? boxMax.y : boxMin.y);
+					float z = ((corner & 4) ? boxMax.z : boxMin.z);
+					if (plane[0] * x + plane[1] * y + plane[2] * z + plane[3] > 0) {
+						cornersInside++;
+					}
+				}
+				if (cornersInside == 0) {
+					return VisibleQuadContainerCache::ftsOutside;
+				}
+				if (cornersInside != 8) {
+					allInside = false;
+				}
+			}
+			return (allInside == true ? VisibleQuadContainerCache::ftsInside : VisibleQuadContainerCache::ftsIntersect);
+		}
+
+		void Renderer::updateFrustumTileState(VisibleQuadContainerCache &quadCacheItem, const Map *map) {
+			const int tileSize = VisibleQuadContainerCache::frustumTileSize;
+			const int tileW = (map->getW() + tileSize - 1) / tileSize;
+			const int tileH = (map->getH() + tileSize - 1) / tileSize;
+
+			// terrain height range per tile only depends on the map
+			if (quadCacheItem.frustumTileW != tileW || quadCacheItem.frustumTileH != tileH ||
+				(int) quadCacheItem.frustumTileMinHeight.size() != tileW * tileH) {
+				quadCacheItem.frustumTileW = tileW;
+				quadCacheItem.frustumTileH = tileH;
+				quadCacheItem.frustumTileMinHeight.assign(tileW * tileH, 0.f);
+				quadCacheItem.frustumTileMaxHeight.assign(tileW * tileH, 0.f);
+				quadCacheItem.frustumTileState.assign(tileW * tileH, VisibleQuadContainerCache::ftsIntersect);
+
+				for (int ty = 0; ty < tileH; ++ty) {
+					for (int tx = 0; tx < tileW; ++tx) {
+						int sx0 = max(0, (tx * tileSize) / Map::cellScale - 1);
+						int sy0 = max(0, (ty * tileSize) / Map::cellScale - 1);
+						int sx1 = min(map->getSurfaceW() - 1, ((tx + 1) * tileSize) / Map::cellScale + 1);
+						int sy1 = min(map->getSurfaceH() - 1, ((ty + 1) * tileSize) / Map::cellScale + 1);
+
+						float minHeight = map->getSurfaceCell(sx0, sy0)->getVertex().y;
+						float maxHeight = minHeight;
+						for (int sy = sy0; sy <= sy1; ++sy) {
+							for (int sx = sx0; sx <= sx1; ++sx) {
+								float height = map->getSurfaceCell(sx, sy)->getVertex().y;
+								minHeight = min(minHeight, height);
+								maxHeight = max(maxHeight, height);
+							}
+						}
+						quadCacheItem.frustumTileMinHeight[ty * tileW + tx] = minHeight;
+						quadCacheItem.frustumTileMaxHeight[ty * tileW + tx] = maxHeight;
+					}
+				}
+			}
+
+			const float margin = VisibleQuadContainerCache::frustumTileMargin;
+			for (int ty = 0; ty < tileH; ++ty) {
+				for (int tx = 0; tx < tileW; ++tx) {
+					int index = ty * tileW + tx;
+					Vec3f boxMin(tx * tileSize - margin,
+						quadCacheItem.frustumTileMinHeight[index] - margin,
+						ty * tileSize - margin);
+					Vec3f boxMax((tx + 1) * tileSize + margin,
+						quadCacheItem.frustumTileMaxHeight[index] + VisibleQuadContainerCache::frustumTileHeightAllowance + margin,
+						(ty + 1) * tileSize + margin);
+					quadCacheItem.frustumTileState[index] = BoxInFrustumState(quadCacheItem.frustumData, boxMin, boxMax);
+				}
+			}
+			quadCacheItem.frustumTileStateValid = true;
+		}
+
+		bool Renderer::CubeInFrustumTiles(VisibleQuadContainerCache &quadCacheItem, float x, float y, float z, float size) {
+			if (quadCacheItem.frustumTileStateValid == true &&
+				size <= VisibleQuadContainerCache::frustumTileMargin && x >= 0 && z >= 0) {
+				const int tileSize = VisibleQuadContainerCache::frustumTileSize;
+				int tx = (int) x / tileSize;
+				int ty = (int) z / tileSize;
+				if (tx < quadCacheItem.frustumTileW && ty < quadCacheItem.frustumTileH) {
+					int index = ty * quadCacheItem.frustumTileW + tx;
+					if (y >= quadCacheItem.frustumTileMinHeight[index] &&
+						y <= quadCacheItem.frustumTileMaxHeight[index] + VisibleQuadContainerCache::frustumTileHeightAllowance) {
+						int state = quadCacheItem.frustumTileState[index];
+						if (state == VisibleQuadContainerCache::ftsOutside) {
+							return false;
+						} else if (state == VisibleQuadContainerCache::ftsInside) {
+							return true;
+						}
+					}
+				}
+			}
+			return CubeInFrustum(quadCacheItem.frustumData, x, y, z, size);
+		}
+
 		void Renderer::computeVisibleQuad() {
 			visibleQuad = this->gameCamera->computeVisibleQuad();
 
 			bool frustumChanged = false;
 			if (VisibleQuadContainerCache::enableFrustumCalcs == true) {
 				frustumChanged = ExtractFrustum(quadCache);
+				if (frustumChanged == true) {
+					quadCache.frustumTileStateValid = false;
+				}
 			}
 
 			if (frustumChanged && SystemFlags::VERBOSE_MODE_ENABLED) {
@@ -4766,15 +4875,48 @@ namespace Glest {
 
 			VisibleQuadContainerCache &qCache = getQuadCache();
 
+			Chrono chronoRenderQueue;
+			bool measureRenderQueue = (game != NULL && game->getRenderInGamePerformance() == true);
+			if (measureRenderQueue == true) {
+				chronoRenderQueue.start();
+			}
+
 			//	for(int visibleIndex = 0;
 			//			visibleIndex < qCache.visibleObjectList.size(); ++visibleIndex) {
-			// render from last to first object so animated objects which are on bottom of screen are
-			// rendered first which looks better for limited number of animated tileset objects
+			// pick animated objects from last to first so animated objects which are on bottom of screen
+			// get the budget first which looks better for limited number of animated tileset objects
+			objectRenderQueue.clear();
 			for (int visibleIndex = (int) qCache.visibleObjectList.size() - 1;
 				visibleIndex >= 0; --visibleIndex) {
 				Object *o = qCache.visibleObjectList[visibleIndex];
 
-				Model *objModel = o->getModelPtr();
+				ModelRenderQueueItem item;
+				item.object = o;
+				item.model = o->getModelPtr();
+				if (tilesetObjectsToAnimate == -1) {
+					item.animProgress = o->getAnimProgress();
+				} else if (tilesetObjectsToAnimate > 0 && o->isAnimated()) {
+					tilesetObjectsToAnimate--;
+					item.animProgress = o->getAnimProgress();
+				} else {
+					item.animProgress = 0;
+				}
+				objectRenderQueue.push_back(item);
+			}
+			if (sortRenderQueue == true) {
+				std::sort(objectRenderQueue.begin(), objectRenderQueue.end());
+			}
+
+			if (measureRenderQueue == true) {
+				renderQueueMicros += chronoRenderQueue.getMicros();
+				chronoRenderQueue.start();
+			}
+
+			for (int queueIndex = 0; queueIndex < (int) objectRenderQueue.size(); ++queueIndex) {
+				const ModelRenderQueueItem &item = objectRenderQueue[queueIndex];
+				Object *o = item.object;
+
+				Model *objModel = item.model;
 				//objModel->updateInterpolationData(o->getAnimProgress(), true);
 				const Vec3f v = o->getConstPos();
 
@@ -4818,21 +4960,11 @@ namespace Glest {
 				//			setupLightingForRotatedModel();
 				//		}
 
-				//objModel->updateInterpolationData(0.f, true);
-				//if(this->gameCamera->getPos().dist(o->getPos()) <= SKIP_INTERPOLATION_DISTANCE) {
-
+				// objects sharing a model and progress are adjacent in the queue,
+				// Model::updateInterpolationData and InterpolationData::update skip
+				// the vertex interpolation when t and cycle did not change
+				objModel->updateInterpolationData(item.animProgress, true);
 
-				if (tilesetObjectsToAnimate == -1) {
-					objModel->updateInterpolationData(o->getAnimProgress(), true);
-				} else if (tilesetObjectsToAnimate > 0 && o->isAnimated()) {
-					tilesetObjectsToAnimate--;
-					objModel->updateInterpolationData(o->getAnimProgress(), true);
-				} else {
-					objModel->updateInterpolationData(0, true);
-				}
-
-				//		objModel->updateInterpolationData(o->getAnimProgress(), true);
-						//}
 				modelRenderer->render(objModel);
 
 				triangleCount += objModel->getTriangleCount();
@@ -4846,6 +4978,10 @@ namespace Glest {
 				glPopAttrib();
 			}
 
+			if (measureRenderQueue == true) {
+				renderQueueDrawMicros += chronoRenderQueue.getMicros();
+			}
+
 			//restore
 			static_cast<ModelRendererGl*>(modelRenderer)->setDuplicateTexCoords(true);
 
@@ -4925,7 +5061,7 @@ namespace Glest {
 					}
 
 					if (cellExplored == false) {
-						cellExplored = (tc0->isExplored(thisTeamIndex) || tc1->isExplored(thisTeamIndex));
+						cellExplored = (map->isSurfaceExplored(Vec2i(i, j), thisTeamIndex) || map->isSurfaceExplored(Vec2i(i, j + 1), thisTeamIndex));
 					}
 
 					if (cellExplored == true && tc0->getNearSubmerged()) {
@@ -5018,7 +5154,7 @@ namespace Glest {
 				for (int visibleUnitIndex = 0;
 					visibleUnitIndex < (int) qCache.visibleQuadUnitList.size(); ++visibleUnitIndex) {
 					Unit *unit = qCache.visibleQuadUnitList[visibleUnitIndex];
-					Vec3f currVec = unit->getCurrVectorFlat();
+					Vec3f currVec = getUnitRenderVectorFlat(unit);
 					Vec4f color = unit->getFaction()->getTexture()->getPixmapConst()->getPixel4f(0, 0);
 					glColor4f(color.x, color.y, color.z, color.w * 0.7f);
 					renderSelectionCircle(currVec, unit->getType()->getSize(), 0.8f, 0.05f);
@@ -5067,7 +5203,7 @@ namespace Glest {
 
 						glColor4f(color.x, color.y, color.z, color.w);
 
-						Vec3f currVec = unit->getCurrVectorFlat();
+						Vec3f currVec = getUnitRenderVectorFlat(unit);
 						renderSelectionCircle(currVec, unit->getType()->getSize(), radius, thickness);
 					}
 				}
@@ -5092,7 +5228,7 @@ namespace Glest {
 					visibleUnitIndex < (int) qCache.visibleQuadUnitList.size(); ++visibleUnitIndex) {
 					Unit *unit = qCache.visibleQuadUnitList[visibleUnitIndex];
 					if (unit->isAlive()) {
-						Vec3f currVec = unit->getCurrVectorFlat();
+						Vec3f currVec = getUnitRenderVectorFlat(unit);
 						renderTeamColorEffect(currVec, visibleUnitIndex, unit->getType()->getSize(),
 							unit->getFaction()->getTexture()->getPixmapConst()->getPixel4f(0, 0), texture);
 					}
@@ -5153,6 +5289,30 @@ namespace Glest {
 			glPopMatrix();
 		}
 
+		UnitRenderState Renderer::getUnitRenderState(const Unit *unit) const {
+			UnitRenderState state;
+			if (game == NULL || game->getRenderSnapshots()->getUnitState(unit->getId(), state) == false) {
+				state.capture((game != NULL ? game->getWorld() : NULL), unit);
+			}
+			return state;
+		}
+
+		bool Renderer::isUnitRenderedInMap(const Unit *unit) const {
+			bool renderInMap = false;
+			if (game == NULL || game->getRenderSnapshots()->getUnitRenderInMap(unit->getId(), renderInMap) == false) {
+				renderInMap = (game != NULL && game->getWorld()->toRenderUnit(unit) == true);
+			}
+			return renderInMap;
+		}
+
+		Vec3f Renderer::getUnitRenderVectorFlat(const Unit *unit) const {
+			return getUnitRenderState(unit).vectorFlat;
+		}
+
+		Vec3f Renderer::getUnitRenderMidHeightVector(const Unit *unit) const {
+			return getUnitRenderVectorFlat(unit) + Vec3f(0.f, unit->getType()->getHeight() / 2.f, 0.f);
+		}
+
 		void Renderer::renderUnits(bool airUnits, const int renderFps) {
 			if (GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
 				return;
@@ -5175,7 +5335,13 @@ namespace Glest {
 
 			VisibleQuadContainerCache &qCache = getQuadCache();
 			if (qCache.visibleQuadUnitList.empty() == false) {
-				bool modelRenderStarted = false;
+				Chrono chronoRenderQueue;
+				bool measureRenderQueue = (game != NULL && game->getRenderInGamePerformance() == true);
+				if (measureRenderQueue == true) {
+					chronoRenderQueue.start();
+				}
+
+				unitRenderQueue.clear();
 				for (int visibleUnitIndex = 0;
 					visibleUnitIndex < (int) qCache.visibleQuadUnitList.size(); ++visibleUnitIndex) {
 					Unit *unit = qCache.visibleQuadUnitList[visibleUnitIndex];
@@ -5183,7 +5349,31 @@ namespace Glest {
 					if ((airUnits == false && unit->getType()->getField() == fAir) || (airUnits == true && unit->getType()->getField() != fAir)) {
 						continue;
 					}
-					meshCallback.setTeamTexture(unit->getFaction()->getTexture());
+
+					ModelRenderQueueItem item;
+					item.unit = unit;
+					item.unitState = getUnitRenderState(unit);
+					item.model = unit->getCurrentModelPtr();
+					item.teamTexture = unit->getFaction()->getTexture();
+					item.animProgress = item.unitState.animProgress;
+					item.animate = (unit->isAlive() && !unit->isAnimProgressBound());
+					unitRenderQueue.push_back(item);
+				}
+				if (sortRenderQueue == true) {
+					std::sort(unitRenderQueue.begin(), unitRenderQueue.end());
+				}
+
+				if (measureRenderQueue == true) {
+					renderQueueMicros += chronoRenderQueue.getMicros();
+					chronoRenderQueue.start();
+				}
+
+				bool modelRenderStarted = false;
+				for (int queueIndex = 0; queueIndex < (int) unitRenderQueue.size(); ++queueIndex) {
+					const ModelRenderQueueItem &item = unitRenderQueue[queueIndex];
+					Unit *unit = item.unit;
+
+					meshCallback.setTeamTexture(item.teamTexture);
 
 					if (modelRenderStarted == false) {
 						modelRenderStarted = true;
@@ -5203,6 +5393,9 @@ namespace Glest {
 							}
 						}
 						glActiveTexture(baseTexUnit);
+						glEnable(GL_COLOR_MATERIAL);
+						// we cut off a tiny bit here to avoid problems with fully transparent texture parts cutting units in background rendered later.
+						glAlphaFunc(GL_GREATER, 0.02f);
 
 						modelRenderer->begin(true, true, true, false, &meshCallback);
 					}
@@ -5211,39 +5404,36 @@ namespace Glest {
 					glPushMatrix();
 
 					//translate
-					Vec3f currVec = unit->getCurrVectorFlat();
+					Vec3f currVec = item.unitState.vectorFlat;
 					glTranslatef(currVec.x, currVec.y, currVec.z);
 
 					//rotate
-					float zrot = unit->getRotationZ();
-					float xrot = unit->getRotationX();
+					float zrot = item.unitState.rotationZ;
+					float xrot = item.unitState.rotationX;
 					if (zrot != .0f) {
 						glRotatef(zrot, 0.f, 0.f, 1.f);
 					}
 					if (xrot != .0f) {
 						glRotatef(xrot, 1.f, 0.f, 0.f);
 					}
-					glRotatef(unit->getRotation(), 0.f, 1.f, 0.f);
+					glRotatef(item.unitState.rotation, 0.f, 1.f, 0.f);
 
 					//dead alpha
 					const SkillType *st = unit->getCurrSkill();
 					float alpha = 1.0f;
 					if (st->getClass() == scDie) {
 						if (static_cast<const DieSkillType*>(st)->getFade())
-							alpha = 1.0f - unit->getAnimProgressAsFloat();
+							alpha = 1.0f - item.animProgress;
 						else
-							alpha = 1.0f - 0.625f * unit->getAnimProgressAsFloat();
+							alpha = 1.0f - 0.625f * item.animProgress;
 					}
-					glEnable(GL_COLOR_MATERIAL);
-					// we cut off a tiny bit here to avoid problems with fully transparent texture parts cutting units in background rendered later.
-					glAlphaFunc(GL_GREATER, 0.02f);
 
 					//render
-					Model *model = unit->getCurrentModelPtr();
+					Model *model = item.model;
 					//printf("Rendering model [%d - %s]\n[%s]\nCamera [%s]\nDistance: %f\n",unit->getId(),unit->getType()->getName().c_str(),unit->getCurrVector().getString().c_str(),this->gameCamera->getPos().getString().c_str(),this->gameCamera->getPos().dist(unit->getCurrVector()));
 
 					//if(this->gameCamera->getPos().dist(unit->getCurrVector()) <= SKIP_INTERPOLATION_DISTANCE) {
-					model->updateInterpolationData(unit->getAnimProgressAsFloat(), unit->isAlive() && !unit->isAnimProgressBound());
+					model->updateInterpolationData(item.animProgress, item.animate);
 					//}
 
 					modelRenderer->render(model, 0, alpha);
@@ -5253,6 +5443,12 @@ namespace Glest {
 					glPopMatrix();
 					unit->setVisible(true);
 
+					// particles drawn later in the frame follow the model
+					Vec3f particleOffset = currVec - unit->getCurrVectorFlat();
+					if (particleOffset != Vec3f(0.f) || item.unitState.rotation != unit->getRotation()) {
+						unit->placeParticleSystems(particleOffset, item.unitState.rotation);
+					}
+
 					if (showDebugUI == true &&
 						(showDebugUILevel & debugui_unit_titles) == debugui_unit_titles) {
 
@@ -5266,6 +5462,10 @@ namespace Glest {
 					modelRenderer->end();
 					glPopAttrib();
 				}
+
+				if (measureRenderQueue == true) {
+					renderQueueDrawMicros += chronoRenderQueue.getMicros();
+				}
 			}
 
 			//restore
@@ -5383,7 +5583,7 @@ namespace Glest {
 									initialized = true;
 								}
 
-								Vec3f currVec = unit->getCurrVectorFlat();
+								Vec3f currVec = getUnitRenderVectorFlat(unit);
 								currVec = Vec3f(currVec.x, currVec.y + 0.3f, currVec.z);
 								if (mType->getField() == fAir && unit->getType()->getField() == fLand) {
 									currVec = Vec3f(currVec.x, currVec.y + game->getWorld()->getTileset()->getAirHeight(), currVec.z);
@@ -5437,7 +5637,7 @@ namespace Glest {
 				const Unit *unit = selection->getUnit(i);
 				if (unit != NULL) {
 					//translate
-					Vec3f currVec = unit->getCurrVectorFlat();
+					Vec3f currVec = getUnitRenderVectorFlat(unit);
 					currVec.y += 0.3f;
 
 					//selection circle
@@ -5514,7 +5714,7 @@ namespace Glest {
 								int findUnitId = effect.currentAttackBoostUnits[i];
 								Unit *affectedUnit = game->getWorld()->findUnitById(findUnitId);
 								if (affectedUnit != NULL) {
-									Vec3f currVecBoost = affectedUnit->getCurrVectorFlat();
+									Vec3f currVecBoost = getUnitRenderVectorFlat(affectedUnit);
 									currVecBoost.y += 0.3f;
 
 									renderSelectionCircle(currVecBoost, affectedUnit->getType()->getSize(), 1.f);
@@ -5529,7 +5729,7 @@ namespace Glest {
 						map->clampPos(pos);
 
 						Vec3f arrowTarget = Vec3f(pos.x, map->getCell(pos)->getHeight(), pos.y);
-						renderArrow(unit->getCurrVectorFlat(), arrowTarget, Vec4f(0.f, 0.f, 1.f, 0.8f), 0.3f);
+						renderArrow(getUnitRenderVectorFlat(unit), arrowTarget, Vec4f(0.f, 0.f, 1.f, 0.8f), 0.3f);
 					}
 				}
 			}
@@ -5569,7 +5769,7 @@ namespace Glest {
 							Vec3f arrowTarget;
 							Command *c = unit->getCurrCommand();
 							if (c->getUnit() != NULL) {
-								arrowTarget = c->getUnit()->getCurrVectorFlat();
+								arrowTarget = getUnitRenderVectorFlat(c->getUnit());
 							} else {
 								Vec2i pos = c->getPos();
 								map->clampPos(pos);
@@ -5577,7 +5777,7 @@ namespace Glest {
 								arrowTarget = Vec3f(pos.x, map->getCell(pos)->getHeight(), pos.y);
 							}
 
-							renderArrow(unit->getCurrVectorFlat(), arrowTarget, arrowColor, 0.3f);
+							renderArrow(getUnitRenderVectorFlat(unit), arrowTarget, arrowColor, 0.3f);
 						}
 					}
 				}
@@ -5595,7 +5795,7 @@ namespace Glest {
 						glColor4f(1.f, 0.f, 0.f, highlight);
 					}
 
-					Vec3f v = unit->getCurrVectorFlat();
+					Vec3f v = getUnitRenderVectorFlat(unit);
 					v.y += 0.3f;
 					renderSelectionCircle(v, unit->getType()->getSize(), 0.5f + 0.4f*highlight);
 				}
@@ -5703,7 +5903,7 @@ namespace Glest {
 							}
 						}
 
-						Vec3f currVec = unit->getCurrVectorFlat();
+						Vec3f currVec = getUnitRenderVectorFlat(unit);
 						if (healthbarheight == -100.0f) {
 							currVec.y += unit->getType()->getHeight();
 						} else {
@@ -5789,7 +5989,7 @@ namespace Glest {
 					Vec2i intPos = Vec2i(static_cast<int>(ws->getPos().x), static_cast<int>(ws->getPos().y));
 					const Vec2i &mapPos = Map::toSurfCoords(intPos);
 
-					bool visible = map->getSurfaceCell(mapPos)->isVisible(world->getThisTeamIndex());
+					bool visible = map->isSurfaceVisible(mapPos, world->getThisTeamIndex());
 					if (visible == false && world->showWorldForPlayer(world->getThisFactionIndex()) == true) {
 						visible = true;
 					}
@@ -6949,7 +7149,7 @@ namespace Glest {
 					visibleUnitIndex < (int) qCache.visibleQuadUnitList.size(); ++visibleUnitIndex) {
 					Unit *unit = qCache.visibleQuadUnitList[visibleUnitIndex];
 					if (unit != NULL && unit->isAlive()) {
-						Vec3f unitPos = unit->getCurrMidHeightVector();
+						Vec3f unitPos = getUnitRenderMidHeightVector(unit);
 						bool insideQuad = CubeInFrustum(quadSelectionCacheItem.frustumData,
 							unitPos.x, unitPos.y, unitPos.z, unit->getType()->getRenderSize());
 						if (insideQuad == true) {
@@ -7506,10 +7706,21 @@ namespace Glest {
 			Texture2D::Filter textureFilter = strToTextureFilter(config.getString("Filter"));
 			int maxAnisotropy = config.getInt("FilterMaxAnisotropy");
 
+			// Released model textures are kept resident up to this budget so
+			// loading the model again can reuse them
+			std::size_t unusedTextureCacheBytes = (std::size_t)max(0, config.getInt("TextureCacheMemoryMB", "64")) * 1024 * 1024;
+			bool textureShareDuplicates = config.getBool("TextureShareDuplicates", "true");
+
+			// Strings laid out per font (bidi conversion, line splitting and
+			// widths) so console, lobby lists and titles are not redone each frame
+			TextLayoutCache::setMaxEntries(config.getInt("TextLayoutCacheEntries", "2048"));
+
 			if (GlobalStaticFlags::getIsNonGraphicalModeEnabled() == false) {
 				for (int i = 0; i < rsCount; ++i) {
 					textureManager[i]->setFilter(textureFilter);
 					textureManager[i]->setMaxAnisotropy(maxAnisotropy);
+					textureManager[i]->setMaxUnusedTextureBytes(unusedTextureCacheBytes);
+					textureManager[i]->setShareDuplicateContent(textureShareDuplicates);
 				}
 			}
 		}
@@ -7567,7 +7778,7 @@ namespace Glest {
 			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
 			// Signal the threads queue to add a screenshot save request
-			MutexSafeWrapper safeMutex(saveScreenShotThreadAccessor, string(extractFileFromDirectoryPath(__FILE__).c_str()) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutex(saveScreenShotThreadAccessor, CODE_AT_LINE);
 			saveScreenQueue.push_back(make_pair(path, pixmapScreenShot));
 			safeMutex.ReleaseLock();
 
@@ -7575,7 +7786,7 @@ namespace Glest {
 		}
 
 		unsigned int Renderer::getSaveScreenQueueSize() {
-			MutexSafeWrapper safeMutex(saveScreenShotThreadAccessor, string(extractFileFromDirectoryPath(__FILE__).c_str()) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutex(saveScreenShotThreadAccessor, CODE_AT_LINE);
 			int queueSize = (int) saveScreenQueue.size();
 			safeMutex.ReleaseLock();
 
@@ -7708,18 +7919,19 @@ namespace Glest {
 						glPushMatrix();
 
 						//translate
-						Vec3f currVec = unit->getCurrVectorFlat();
+						UnitRenderState unitState = getUnitRenderState(unit);
+						Vec3f currVec = unitState.vectorFlat;
 						glTranslatef(currVec.x, currVec.y, currVec.z);
 
 						//rotate
-						glRotatef(unit->getRotation(), 0.f, 1.f, 0.f);
+						glRotatef(unitState.rotation, 0.f, 1.f, 0.f);
 
 						//render
 						Model *model = unit->getCurrentModelPtr();
 						//if(this->gameCamera->getPos().dist(unit->getCurrVector()) <= SKIP_INTERPOLATION_DISTANCE) {
 
 							// ***MV don't think this is needed below 2013/01/11
-						model->updateInterpolationVertices(unit->getAnimProgressAsFloat(), unit->isAlive() && !unit->isAnimProgressBound());
+						model->updateInterpolationVertices(unitState.animProgress, unit->isAlive() && !unit->isAnimProgressBound());
 
 						//}
 
@@ -8844,7 +9056,7 @@ namespace Glest {
 								renderText3D(unit->getCurrentUnitTitle(), font, color, std::fabs(screenPos.x) + 5, std::fabs(screenPos.y) + 5, false);
 								//unitRenderedList[unit->getId()] = true;
 							} else {
-								string str = unit->getFullName(unit->showTranslatedTechTree()) + " - " + intToStr(unit->getId()) + " [" + unit->getPosNotThreadSafe().getString() + "]";
+								string str = unit->getFullName(unit->showTranslatedTechTree()) + " - " + intToStr(unit->getId()) + " [" + getUnitRenderState(unit).cellPos.getString() + "]";
 								Vec3f screenPos = unit->getScreenPos();
 								renderText3D(str, font, color, std::fabs(screenPos.x) + 5, std::fabs(screenPos.y) + 5, false);
 							}
@@ -8897,7 +9109,7 @@ namespace Glest {
 
 							//unitRenderedList[unit->getId()] = true;
 						} else {
-							string str = unit->getFullName(unit->showTranslatedTechTree()) + " - " + intToStr(unit->getId()) + " [" + unit->getPosNotThreadSafe().getString() + "]";
+							string str = unit->getFullName(unit->showTranslatedTechTree()) + " - " + intToStr(unit->getId()) + " [" + getUnitRenderState(unit).cellPos.getString() + "]";
 							Vec3f screenPos = unit->getScreenPos();
 							renderText(str, font, color, std::fabs(screenPos.x) + 5, std::fabs(screenPos.y) + 5, false);
 						}
@@ -8980,6 +9192,11 @@ namespace Glest {
 					worldToScreenPosCache.clear();
 					//}
 
+					if (VisibleQuadContainerCache::enableFrustumCalcs == true &&
+						quadCache.frustumTileStateValid == false) {
+						updateFrustumTileState(quadCache, world->getMap());
+					}
+
 					// Unit calculations
 					for (int i = 0; i < world->getFactionCount(); ++i) {
 						const Faction *faction = world->getFaction(i);
@@ -8987,10 +9204,14 @@ namespace Glest {
 							Unit *unit = faction->getUnit(j);
 
 							bool unitCheckedForRender = false;
+							bool renderInMap = isUnitRenderedInMap(unit);
 							if (VisibleQuadContainerCache::enableFrustumCalcs == true) {
 								//bool insideQuad 	= PointInFrustum(quadCache.frustumData, unit->getCurrVector().x, unit->getCurrVector().y, unit->getCurrVector().z );
-								bool insideQuad = CubeInFrustum(quadCache.frustumData, unit->getCurrMidHeightVector().x, unit->getCurrMidHeightVector().y, unit->getCurrMidHeightVector().z, unit->getType()->getRenderSize());
-								bool renderInMap = world->toRenderUnit(unit);
+								bool insideQuad = false;
+								if (renderInMap == true) {
+									const Vec3f unitMidHeightVector = unit->getCurrMidHeightVector();
+									insideQuad = CubeInFrustumTiles(quadCache, unitMidHeightVector.x, unitMidHeightVector.y, unitMidHeightVector.z, unit->getType()->getRenderSize());
+								}
 								if (insideQuad == false || renderInMap == false) {
 									unit->setVisible(false);
 									if (renderInMap == true) {
@@ -9003,7 +9224,6 @@ namespace Glest {
 							}
 							if (unitCheckedForRender == false) {
 								bool insideQuad = visibleQuad.isInside(unit->getPos());
-								bool renderInMap = world->toRenderUnit(unit);
 								if (insideQuad == true && renderInMap == true) {
 									quadCache.visibleQuadUnitList.push_back(unit);
 								} else {
@@ -9030,7 +9250,7 @@ namespace Glest {
 								if (VisibleQuadContainerCache::enableFrustumCalcs == true) {
 									Vec3f pos3f = Vec3f(pos.x, map->getCell(pos)->getHeight(), pos.y);
 									//bool insideQuad 	= PointInFrustum(quadCache.frustumData, unit->getCurrVector().x, unit->getCurrVector().y, unit->getCurrVector().z );
-									bool insideQuad = CubeInFrustum(quadCache.frustumData, pos3f.x, pos3f.y, pos3f.z, pendingUnit.buildUnit->getRenderSize());
+									bool insideQuad = CubeInFrustumTiles(quadCache, pos3f.x, pos3f.y, pos3f.z, pendingUnit.buildUnit->getRenderSize());
 									bool renderInMap = world->toRenderUnit(pendingUnit);
 									if (insideQuad == false || renderInMap == false) {
 										if (renderInMap == true) {
@@ -9089,7 +9309,8 @@ namespace Glest {
 								if (VisibleQuadContainerCache::enableFrustumCalcs == true) {
 									if (o != NULL) {
 										//bool insideQuad 	= PointInFrustum(quadCache.frustumData, o->getPos().x, o->getPos().y, o->getPos().z );
-										bool insideQuad = CubeInFrustum(quadCache.frustumData, o->getPos().x, o->getPos().y, o->getPos().z, 1);
+										const Vec3f &objectPos = o->getPos();
+										bool insideQuad = CubeInFrustumTiles(quadCache, objectPos.x, objectPos.y, objectPos.z, 1);
 										if (insideQuad == false) {
 											o->setVisible(false);
 											continue;
@@ -9099,7 +9320,7 @@ namespace Glest {
 
 								bool cellExplored = world->showWorldForPlayer(world->getThisFactionIndex());
 								if (cellExplored == false) {
-									cellExplored = sc->isExplored(world->getThisTeamIndex());
+									cellExplored = map->isSurfaceExplored(mapPos, world->getThisTeamIndex());
 								}
 
 								bool isExplored = (cellExplored == true && o != NULL);
@@ -39,6 +39,7 @@
 #include "base_renderer.h"
 #include "simple_threads.h"
 #include "video_player.h"
+#include "render_snapshot.h"
 
 #ifdef DEBUG_RENDERING_ENABLED
 #	define IF_DEBUG_EDITION(x) x
@@ -72,6 +73,7 @@ namespace Glest {
 		class ConsoleLineInfo;
 		class SurfaceCell;
 		class Program;
+		class Map;
 
 		// ===========================================================
 		// 	class Renderer
@@ -95,6 +97,12 @@ namespace Glest {
 				proj = obj.proj;
 				modl = obj.modl;
 				frustumDataCache = obj.frustumDataCache;
+				frustumTileState = obj.frustumTileState;
+				frustumTileMinHeight = obj.frustumTileMinHeight;
+				frustumTileMaxHeight = obj.frustumTileMaxHeight;
+				frustumTileW = obj.frustumTileW;
+				frustumTileH = obj.frustumTileH;
+				frustumTileStateValid = obj.frustumTileStateValid;
 			}
 
 		public:
@@ -139,6 +147,15 @@ namespace Glest {
 				proj = vector<float>(16, 0);
 				modl = vector<float>(16, 0);
 				frustumDataCache.clear();
+				clearFrustumTileData();
+			}
+			inline void clearFrustumTileData() {
+				frustumTileState.clear();
+				frustumTileMinHeight.clear();
+				frustumTileMaxHeight.clear();
+				frustumTileW = 0;
+				frustumTileH = 0;
+				frustumTileStateValid = false;
 			}
 			int cacheFrame;
 			Quad2i lastVisibleQuad;
@@ -155,6 +172,56 @@ namespace Glest {
 			vector<float> modl;
 			map<pair<vector<float>, vector<float> >, vector<vector<float> > > frustumDataCache;
 
+			// Coarse map tiles classified against the frustum so most units and
+			// objects are culled with a lookup instead of a cube test
+			enum FrustumTileState {
+				ftsOutside,
+				ftsIntersect,
+				ftsInside
+			};
+			static const int frustumTileSize = 8;
+			static const float frustumTileMargin;
+			static const float frustumTileHeightAllowance;
+
+			std::vector<int8> frustumTileState;
+			std::vector<float> frustumTileMinHeight;
+			std::vector<float> frustumTileMaxHeight;
+			int frustumTileW;
+			int frustumTileH;
+			bool frustumTileStateValid;
+
+		};
+
+		// Units and objects collected for one render pass and sorted so that
+		// consecutive draws share model, texture and interpolation state
+		class ModelRenderQueueItem {
+		public:
+			inline ModelRenderQueueItem() {
+				unit = NULL;
+				object = NULL;
+				model = NULL;
+				teamTexture = NULL;
+				animProgress = 0.f;
+				animate = true;
+			}
+
+			Unit *unit;
+			Object *object;
+			Model *model;
+			const Texture *teamTexture;
+			float animProgress;
+			bool animate;
+			UnitRenderState unitState;
+
+			inline bool operator<(const ModelRenderQueueItem &item) const {
+				if (model != item.model) {
+					return model < item.model;
+				}
+				if (teamTexture != item.teamTexture) {
+					return teamTexture < item.teamTexture;
+				}
+				return animProgress < item.animProgress;
+			}
 		};
 
 		class VisibleQuadContainerVBOCache {
@@ -299,6 +366,11 @@ namespace Glest {
 			bool allowRenderUnitTitles;
 			//std::vector<std::pair<Unit *,Vec3f> > renderUnitTitleList;
 			std::vector<Unit *> visibleFrameUnitList;
+			std::vector<ModelRenderQueueItem> unitRenderQueue;
+			std::vector<ModelRenderQueueItem> objectRenderQueue;
+			int64 renderQueueMicros;
+			int64 renderQueueDrawMicros;
+			bool sortRenderQueue;
 			string visibleFrameUnitListCameraKey;
 
 			bool no2DMouseRendering;
@@ -419,6 +491,9 @@ namespace Glest {
 			//bool PointInFrustum(vector<vector<float> > &frustum, float x, float y, float z );
 			//bool SphereInFrustum(vector<vector<float> > &frustum,  float x, float y, float z, float radius);
 			bool CubeInFrustum(vector<vector<float> > &frustum, float x, float y, float z, float size);
+			int BoxInFrustumState(vector<vector<float> > &frustum, const Vec3f &boxMin, const Vec3f &boxMax);
+			void updateFrustumTileState(VisibleQuadContainerCache &quadCacheItem, const Map *map);
+			bool CubeInFrustumTiles(VisibleQuadContainerCache &quadCacheItem, float x, float y, float z, float size);
 
 		private:
 			Renderer();
@@ -554,6 +629,16 @@ namespace Glest {
 			void renderObjects(const int renderFps);
 
 			void renderWater();
+			// the unit as published by the last world updates, or as it
+			// is now when it was created after the last snapshot
+			UnitRenderState getUnitRenderState(const Unit *unit) const;
+			// whether the last snapshot shows the unit, so the visible
+			// unit lists match what getUnitRenderState draws
+			bool isUnitRenderedInMap(const Unit *unit) const;
+			// where the unit is drawn this frame, for everything drawn
+			// around it
+			Vec3f getUnitRenderVectorFlat(const Unit *unit) const;
+			Vec3f getUnitRenderMidHeightVector(const Unit *unit) const;
 			void renderUnits(bool airUnits, const int renderFps);
 			void renderUnitsToBuild(const int renderFps);
 
@@ -648,6 +733,21 @@ namespace Glest {
 				return lastRenderFps;
 			}
 
+			// time spent building and sorting the unit/object render queues
+			// and issuing their draws (CPU side) since the last reset, only
+			// measured when the performance overlay is on. SortRenderQueue=false
+			// draws in visibility order to compare against
+			inline int64 getRenderQueueMicros() const {
+				return renderQueueMicros;
+			}
+			inline int64 getRenderQueueDrawMicros() const {
+				return renderQueueDrawMicros;
+			}
+			inline void resetRenderQueueMicros() {
+				renderQueueMicros = 0;
+				renderQueueDrawMicros = 0;
+			}
+
 			VisibleQuadContainerCache & getQuadCache(bool updateOnDirtyFrame = true, bool forceNew = false);
 			std::pair<bool, Vec3f> posInCellQuadCache(Vec2i pos);
 			//Vec3f getMarkedCellScreenPosQuadCache(Vec2i pos);
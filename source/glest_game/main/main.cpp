@@ -57,6 +57,10 @@
 #include <locale.h>
 #include "string_utils.h"
 #include "auto_test.h"
+#include "replay_benchmark.h"
+#include "map_init_benchmark.h"
+#include "harvest_benchmark.h"
+#include "ai_rule_trace.h"
 #include "lua_script.h"
 #include "interpolation.h"
 #include "common_scoped_ptr.h"
@@ -5306,6 +5310,217 @@ namespace
 			return return_value;
 		}
 
+		string
+			getSynchTraceValueText(const SynchTraceRecord & record) {
+			switch (record.tag) {
+				case sttPos:
+				case sttLastPos:
+				case sttTargetPos:
+				case sttMeetingPos:
+					return Vec2i(record.value >> 16,
+						(int16) (record.value & 0xFFFF)).getString();
+				default:
+					return intToStr(record.value);
+			}
+		}
+
+		int
+			handleDiffSynchTracesCommand(int argc, char **argv) {
+			int
+				foundParamIndIndex = -1;
+			hasCommandArgument(argc, argv,
+				string(GAME_ARGS[GAME_ARG_DIFF_SYNCH_TRACES]) + string("="),
+				&foundParamIndIndex);
+			if (foundParamIndIndex < 0) {
+				hasCommandArgument(argc, argv,
+					string(GAME_ARGS[GAME_ARG_DIFF_SYNCH_TRACES]),
+					&foundParamIndIndex);
+			}
+			string
+				paramValue = argv[foundParamIndIndex];
+			vector < string > paramPartTokens;
+			Tokenize(paramValue, paramPartTokens, "=");
+			vector < string > fileTokens;
+			if (paramPartTokens.size() >= 2) {
+				Tokenize(paramPartTokens[1], fileTokens, ",");
+			}
+			if (fileTokens.size() != 2) {
+				printf
+				("\nInvalid synch trace files specified on commandline [%s]\n\n",
+					argv[foundParamIndIndex]);
+				return 1;
+			}
+
+			vector < SynchTraceRecord > firstRecords;
+			vector < SynchTraceRecord > secondRecords;
+			try {
+				SynchTrace::load(fileTokens[0], firstRecords);
+				SynchTrace::load(fileTokens[1], secondRecords);
+			} catch (const megaglest_runtime_error & ex) {
+				printf("%s\n", ex.what());
+				return 1;
+			}
+
+			printf("[%s] has %d records, [%s] has %d records\n",
+				fileTokens[0].c_str(), (int) firstRecords.size(),
+				fileTokens[1].c_str(), (int) secondRecords.size());
+
+			SynchTraceDivergence divergence;
+			if (SynchTrace::findFirstDivergence(firstRecords, secondRecords,
+				divergence) == false) {
+				printf("No divergence found in the frames both traces cover.\n");
+				return 0;
+			}
+
+			const SynchTraceRecord & record =
+				(divergence.firstMissing == false ? divergence.first : divergence.second);
+			printf("First divergence at frame %d unit %d field %s\n",
+				record.frame, record.id,
+				World::getSynchTraceTagName(record.tag).c_str());
+			if (divergence.firstMissing == false) {
+				printf("  [%s]: unit %d %s = %s\n", fileTokens[0].c_str(),
+					divergence.first.id,
+					World::getSynchTraceTagName(divergence.first.tag).c_str(),
+					getSynchTraceValueText(divergence.first).c_str());
+			} else {
+				printf("  [%s]: no record\n", fileTokens[0].c_str());
+			}
+			if (divergence.secondMissing == false) {
+				printf("  [%s]: unit %d %s = %s\n", fileTokens[1].c_str(),
+					divergence.second.id,
+					World::getSynchTraceTagName(divergence.second.tag).c_str(),
+					getSynchTraceValueText(divergence.second).c_str());
+			} else {
+				printf("  [%s]: no record\n", fileTokens[1].c_str());
+			}
+			return 2;
+		}
+
+		int
+			handleBenchmarkMapInitCommand(int argc, char **argv) {
+			int
+				foundParamIndIndex = -1;
+			hasCommandArgument(argc, argv,
+				string(GAME_ARGS[GAME_ARG_BENCHMARK_MAP_INIT]) + string("="),
+				&foundParamIndIndex);
+			if (foundParamIndIndex < 0) {
+				hasCommandArgument(argc, argv,
+					string(GAME_ARGS[GAME_ARG_BENCHMARK_MAP_INIT]),
+					&foundParamIndIndex);
+			}
+			string
+				paramValue = argv[foundParamIndIndex];
+			vector < string > paramPartTokens;
+			Tokenize(paramValue, paramPartTokens, "=");
+			vector < string > paramTokens;
+			if (paramPartTokens.size() >= 2) {
+				Tokenize(paramPartTokens[1], paramTokens, ",");
+			}
+			if (paramTokens.size() < 2 || paramTokens[0].length() == 0
+				|| paramTokens[1].length() == 0) {
+				printf
+				("\nInvalid tileset and techtree specified on commandline [%s]\n\n",
+					argv[foundParamIndIndex]);
+				return 1;
+			}
+
+			int
+				runs = 3;
+			if (paramTokens.size() >= 3 && paramTokens[2].length() > 0) {
+				runs = strToInt(paramTokens[2]);
+			}
+			int
+				workerCount = 0;
+			if (paramTokens.size() >= 4 && paramTokens[3].length() > 0) {
+				workerCount = strToInt(paramTokens[3]);
+			}
+			return MapInitBenchmark::run(paramTokens[0], paramTokens[1], runs,
+				workerCount);
+		}
+
+		int
+			handleBenchmarkHarvestCommand(int argc, char **argv) {
+			int
+				foundParamIndIndex = -1;
+			hasCommandArgument(argc, argv,
+				string(GAME_ARGS[GAME_ARG_BENCHMARK_HARVEST]) + string("="),
+				&foundParamIndIndex);
+			if (foundParamIndIndex < 0) {
+				hasCommandArgument(argc, argv,
+					string(GAME_ARGS[GAME_ARG_BENCHMARK_HARVEST]),
+					&foundParamIndIndex);
+			}
+			string
+				paramValue = argv[foundParamIndIndex];
+			vector < string > paramPartTokens;
+			Tokenize(paramValue, paramPartTokens, "=");
+			vector < string > paramTokens;
+			if (paramPartTokens.size() >= 2) {
+				Tokenize(paramPartTokens[1], paramTokens, ",");
+			}
+			if (paramTokens.size() < 2 || paramTokens[0].length() == 0
+				|| paramTokens[1].length() == 0) {
+				printf
+				("\nInvalid tileset and techtree specified on commandline [%s]\n\n",
+					argv[foundParamIndIndex]);
+				return 1;
+			}
+
+			int
+				rounds = 100;
+			if (paramTokens.size() >= 3 && paramTokens[2].length() > 0) {
+				rounds = strToInt(paramTokens[2]);
+			}
+			int
+				workerCount = 400;
+			if (paramTokens.size() >= 4 && paramTokens[3].length() > 0) {
+				workerCount = strToInt(paramTokens[3]);
+			}
+			return HarvestBenchmark::run(paramTokens[0], paramTokens[1], rounds,
+				workerCount);
+		}
+
+		int
+			handleAiRuleSummaryCommand(int argc, char **argv) {
+			int
+				foundParamIndIndex = -1;
+			hasCommandArgument(argc, argv,
+				string(GAME_ARGS[GAME_ARG_AI_RULE_SUMMARY]) + string("="),
+				&foundParamIndIndex);
+			if (foundParamIndIndex < 0) {
+				hasCommandArgument(argc, argv,
+					string(GAME_ARGS[GAME_ARG_AI_RULE_SUMMARY]),
+					&foundParamIndIndex);
+			}
+			string
+				paramValue = argv[foundParamIndIndex];
+			vector < string > paramPartTokens;
+			Tokenize(paramValue, paramPartTokens, "=");
+			vector < string > fileTokens;
+			if (paramPartTokens.size() >= 2) {
+				Tokenize(paramPartTokens[1], fileTokens, ",");
+			}
+			if (fileTokens.empty() == true) {
+				printf
+				("\nInvalid AI rule trace files specified on commandline [%s]\n\n",
+					argv[foundParamIndIndex]);
+				return 1;
+			}
+
+			vector < AiRuleTraceEvent > events;
+			try {
+				for (unsigned int i = 0; i < fileTokens.size(); ++i) {
+					AiRuleTrace::load(fileTokens[i], events);
+				}
+			} catch (const megaglest_runtime_error & ex) {
+				printf("%s\n", ex.what());
+				return 1;
+			}
+
+			printf("%s", AiRuleTrace::getSummary(events).c_str());
+			return 0;
+		}
+
 		int
 			handleListDataCommand(int argc, char **argv) {
 			int
@@ -5814,6 +6029,62 @@ namespace
 				}
 			}
 
+			if (hasCommandArgument
+			(argc, argv,
+				string(GAME_ARGS[GAME_ARG_SIMULATE_REPLAY])) == true) {
+				GlobalStaticFlags::setIsNonGraphicalModeEnabled(true);
+
+				int
+					foundParamIndIndex = -1;
+				hasCommandArgument(argc, argv,
+					string(GAME_ARGS[GAME_ARG_SIMULATE_REPLAY]) +
+					string("="), &foundParamIndIndex);
+				if (foundParamIndIndex < 0) {
+					hasCommandArgument(argc, argv,
+						string(GAME_ARGS[GAME_ARG_SIMULATE_REPLAY]),
+						&foundParamIndIndex);
+				}
+				string
+					paramValue = argv[foundParamIndIndex];
+				vector < string > paramPartTokens;
+				Tokenize(paramValue, paramPartTokens, "=");
+				vector < string > paramReplayTokens;
+				if (paramPartTokens.size() >= 2) {
+					Tokenize(paramPartTokens[1], paramReplayTokens, ",");
+				}
+				if (paramReplayTokens.empty() == true ||
+					paramReplayTokens[0].length() == 0) {
+					printf
+					("\nInvalid saved game specified on commandline [%s]\n\n",
+						argv[foundParamIndIndex]);
+					return 1;
+				}
+
+				// the replay is found next to the saved game it belongs to
+				string
+					replayFile = paramReplayTokens[0];
+				if (EndsWith(replayFile, ".replay") == true) {
+					replayFile = replayFile.substr(0, replayFile.length() - 7);
+				}
+				if (fileExists(replayFile + ".replay") == false) {
+					printf("\nReplay file not found [%s]\n\n",
+						(replayFile + ".replay").c_str());
+					return 1;
+				}
+				int
+					maxFrames = 0;
+				if (paramReplayTokens.size() >= 2
+					&& paramReplayTokens[1].length() > 0) {
+					maxFrames = strToInt(paramReplayTokens[1]);
+				}
+				string
+					reportFile = "";
+				if (paramReplayTokens.size() >= 3) {
+					reportFile = paramReplayTokens[2];
+				}
+				ReplayBenchmark::setup(replayFile, maxFrames, reportFile);
+			}
+
 			if (hasCommandArgument(argc, argv, GAME_ARGS[GAME_ARG_SERVER_TITLE]) ==
 				true) {
 				int
@@ -5883,6 +6154,10 @@ namespace
 				true
 				|| hasCommandArgument(argc, argv,
 					GAME_ARGS[GAME_ARG_VALIDATE_TILESET]) == true
+				|| hasCommandArgument(argc, argv,
+					GAME_ARGS[GAME_ARG_BENCHMARK_MAP_INIT]) == true
+				|| hasCommandArgument(argc, argv,
+					GAME_ARGS[GAME_ARG_BENCHMARK_HARVEST]) == true
 				|| hasCommandArgument(argc, argv,
 					GAME_ARGS[GAME_ARG_TRANSLATE_TECHTREES]) ==
 				true
@@ -6055,6 +6330,10 @@ namespace
 				true
 				|| hasCommandArgument(argc, argv,
 					GAME_ARGS[GAME_ARG_VALIDATE_TILESET]) == true
+				|| hasCommandArgument(argc, argv,
+					GAME_ARGS[GAME_ARG_BENCHMARK_MAP_INIT]) == true
+				|| hasCommandArgument(argc, argv,
+					GAME_ARGS[GAME_ARG_BENCHMARK_HARVEST]) == true
 				|| hasCommandArgument(argc, argv,
 					GAME_ARGS[GAME_ARG_TRANSLATE_TECHTREES]) ==
 				true
@@ -6155,6 +6434,12 @@ namespace
 				&& hasCommandArgument(argc, argv,
 					GAME_ARGS[GAME_ARG_VALIDATE_TILESET]) ==
 				false
+				&& hasCommandArgument(argc, argv,
+					GAME_ARGS[GAME_ARG_BENCHMARK_MAP_INIT]) ==
+				false
+				&& hasCommandArgument(argc, argv,
+					GAME_ARGS[GAME_ARG_BENCHMARK_HARVEST]) ==
+				false
 				&& hasCommandArgument(argc, argv,
 					GAME_ARGS[GAME_ARG_TRANSLATE_TECHTREES]) ==
 				false
@@ -6499,7 +6784,8 @@ namespace
 					|| hasCommandArgument(argc, argv,
 						string(GAME_ARGS
 							[GAME_ARG_MASTERSERVER_MODE])) ==
-					true) {
+					true
+					|| ReplayBenchmark::isEnabled() == true) {
 					config.setString("FactorySound", "None", true);
 					if (hasCommandArgument
 					(argc, argv,
@@ -7164,6 +7450,16 @@ namespace
 					return handleCreateDataArchivesCommand(argc, argv);
 				}
 
+				if (hasCommandArgument
+				(argc, argv, GAME_ARGS[GAME_ARG_DIFF_SYNCH_TRACES]) == true) {
+					return handleDiffSynchTracesCommand(argc, argv);
+				}
+
+				if (hasCommandArgument
+				(argc, argv, GAME_ARGS[GAME_ARG_AI_RULE_SUMMARY]) == true) {
+					return handleAiRuleSummaryCommand(argc, argv);
+				}
+
 				if (hasCommandArgument(argc, argv, GAME_ARGS[GAME_ARG_SHOW_MAP_CRC])
 					== true
 					|| hasCommandArgument(argc, argv,
@@ -7269,6 +7565,12 @@ namespace
 				} else if (hasCommandArgument(argc, argv, string(GAME_ARGS[GAME_ARG_MASTERSERVER_MODE])) == true) {
 					program->initServer(mainWindow, false, true, true);
 					gameInitialized = true;
+				} else if (ReplayBenchmark::isEnabled() == true) {
+					// the saved game only finds its replay commands when this is set
+					config.setBool("SaveCommandsForReplay", true, true);
+					program->initSavedGame(mainWindow, true,
+						ReplayBenchmark::getReplayFile());
+					gameInitialized = true;
 				} else if (hasCommandArgument(argc, argv, string(GAME_ARGS[GAME_ARG_AUTOSTART_LASTGAME])) == true) {
 					program->initServer(mainWindow, true, false);
 					gameInitialized = true;
@@ -7749,6 +8051,28 @@ namespace
 					return 0;
 				}
 
+				if (hasCommandArgument
+				(argc, argv, GAME_ARGS[GAME_ARG_BENCHMARK_MAP_INIT]) == true) {
+					int
+						result = handleBenchmarkMapInitCommand(argc, argv);
+
+					delete
+						mainWindow;
+					mainWindow = NULL;
+					return result;
+				}
+
+				if (hasCommandArgument
+				(argc, argv, GAME_ARGS[GAME_ARG_BENCHMARK_HARVEST]) == true) {
+					int
+						result = handleBenchmarkHarvestCommand(argc, argv);
+
+					delete
+						mainWindow;
+					mainWindow = NULL;
+					return result;
+				}
+
 				gameInitialized = true;
 
 				SystemFlags::OutputDebug(SystemFlags::debugSystem,
@@ -7777,11 +8101,7 @@ namespace
 						__FILE__, __FUNCTION__, __LINE__, startCRCPrecacheThread);
 				if (startCRCPrecacheThread == true
 					&& GlobalStaticFlags::getIsNonGraphicalModeEnabled() == false) {
-					static
-						string
-						mutexOwnerId =
-						string(extractFileFromDirectoryPath(__FILE__).c_str()) +
-						string("_") + intToStr(__LINE__);
+					static const char *mutexOwnerId = CODE_AT_LINE;
 					vector < string > techDataPaths =
 						config.getPathListForType(ptTechs);
 
@@ -640,7 +640,7 @@ namespace Glest {
 			programState->addPerformanceCount(ProgramState::
 				MAIN_PROGRAM_RENDER_KEY,
 				chronoPerformanceCounts.
-				getMillis());
+				getMicros());
 
 			if (showPerfStats) {
 				sprintf(perfBuf,
@@ -676,7 +676,7 @@ namespace Glest {
 			}
 
 			programState->addPerformanceCount("programState->updateCamera()",
-				chronoPerformanceCounts.getMillis
+				chronoPerformanceCounts.getMicros
 				());
 
 			if (showPerfStats) {
@@ -799,7 +799,7 @@ namespace Glest {
 
 					programState->addPerformanceCount
 					("SoundRenderer::getInstance().update()",
-						chronoPerformanceCounts.getMillis());
+						chronoPerformanceCounts.getMicros());
 
 					if (showPerfStats) {
 						sprintf(perfBuf,
@@ -817,7 +817,7 @@ namespace Glest {
 
 					programState->addPerformanceCount
 					("NetworkManager::getInstance().update()",
-						chronoPerformanceCounts.getMillis());
+						chronoPerformanceCounts.getMicros());
 #ifdef DEBUG
 					if (SystemFlags::getSystemSettingType
 					(SystemFlags::debugPerformance).enabled
@@ -886,7 +886,7 @@ namespace Glest {
 				}
 
 				programState->addPerformanceCount("programState->tick()",
-					chronoPerformanceCounts.getMillis
+					chronoPerformanceCounts.getMicros
 					());
 
 				if (showPerfStats) {
@@ -1399,11 +1399,7 @@ namespace Glest {
 					if (BaseThread::shutdownAndWait(soundThreadManager) == true) {
 						delete soundThreadManager;
 					}
-					static
-						string
-						mutexOwnerId =
-						string(extractFileFromDirectoryPath(__FILE__).c_str()) +
-						string("_") + intToStr(__LINE__);
+					static const char *mutexOwnerId = CODE_AT_LINE;
 					soundThreadManager =
 						new SimpleTaskThread(&SoundRenderer::getInstance(), 0,
 							SOUND_THREAD_UPDATE_MILLISECONDS);
@@ -1513,11 +1509,7 @@ namespace Glest {
 			Program::startSoundSystem() {
 			stopSoundSystem();
 			if (SoundRenderer::getInstance().runningThreaded() == true) {
-				static
-					string
-					mutexOwnerId =
-					string(extractFileFromDirectoryPath(__FILE__).c_str()) +
-					string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				soundThreadManager =
 					new SimpleTaskThread(&SoundRenderer::getInstance(), 0,
 						SOUND_THREAD_UPDATE_MILLISECONDS);
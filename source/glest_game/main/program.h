@@ -223,6 +223,7 @@ namespace Glest {
 			virtual void
 				reloadUI() {
 			};
+			// value in microseconds
 			virtual void
 				addPerformanceCount(string key, int64 value) {
 			};
@@ -40,6 +40,7 @@
 #include "cache_manager.h"
 #include "string_utils.h"
 #include "map_preview.h"
+#include "map_info_index.h"
 #include <iterator>
 #include "compression_utils.h"
 
@@ -792,14 +793,13 @@ namespace Glest {
 					fileArchiveExtractCommandParameters,
 					fileArchiveExtractCommandSuccessResult,
 					tempFilePath);
+				if (config.getBool("EnableContentDeltaSync", "false") == true) {
+					ftpClientThread->setContentSyncPort(portNumber + ContentSyncServerThread::ftpPortOffset);
+				}
 				ftpClientThread->start();
 			}
 			// Start http meta data thread
-			static
-				string
-				mutexOwnerId =
-				string(extractFileFromDirectoryPath(__FILE__).c_str()) +
-				string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			modHttpServerThread = new SimpleTaskThread(this, 0, 200);
 			modHttpServerThread->setUniqueID(mutexOwnerId);
 			modHttpServerThread->start();
@@ -1272,9 +1272,7 @@ namespace Glest {
 			if (SystemFlags::VERBOSE_MODE_ENABLED)
 				printf("In [%s::%s Line %d]\n", __FILE__, __FUNCTION__, __LINE__);
 
-			static
-				string
-				mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper
 				safeMutexThreadOwner(callingThread->getMutexThreadOwnerValid(),
 					mutexOwnerId);
@@ -1442,7 +1440,7 @@ namespace Glest {
 
 			MutexSafeWrapper
 				safeMutex(callingThread->getMutexThreadObjectAccessor(),
-					string(__FILE__) + "_" + intToStr(__LINE__));
+					CODE_AT_LINE);
 			tilesetListRemote.clear();
 			Tokenize(tilesetsMetaData, tilesetListRemote, "\n");
 			safeMutex.ReleaseLock(true);
@@ -1705,8 +1703,7 @@ namespace Glest {
 											NULL ?
 											modHttpServerThread->getMutexThreadObjectAccessor
 											() : NULL),
-											string(__FILE__) + "_" +
-											intToStr(__LINE__));
+											CODE_AT_LINE);
 									string mapURL = mapCacheList[mapName].url;
 									safeMutexThread.ReleaseLock();
 
@@ -1717,8 +1714,7 @@ namespace Glest {
 											NULL ?
 											ftpClientThread->getProgressMutex
 											() : NULL),
-											string(__FILE__) + "_" +
-											intToStr(__LINE__));
+											CODE_AT_LINE);
 									fileFTPProgressList[getMissingMapFromFTPServer] =
 										pair < int,
 										string >(0, "");
@@ -1731,8 +1727,7 @@ namespace Glest {
 											NULL ?
 											ftpClientThread->getProgressMutex
 											() : NULL),
-											string(__FILE__) + "_" +
-											intToStr(__LINE__));
+											CODE_AT_LINE);
 									fileFTPProgressList[getMissingMapFromFTPServer] =
 										pair < int,
 										string >(0, "");
@@ -1780,8 +1775,7 @@ namespace Glest {
 											NULL ?
 											modHttpServerThread->getMutexThreadObjectAccessor
 											() : NULL),
-											string(__FILE__) + "_" +
-											intToStr(__LINE__));
+											CODE_AT_LINE);
 									string tilesetURL = tilesetCacheList[tilesetName].url;
 									safeMutexThread.ReleaseLock();
 
@@ -1793,8 +1787,7 @@ namespace Glest {
 											NULL ?
 											ftpClientThread->getProgressMutex
 											() : NULL),
-											string(__FILE__) + "_" +
-											intToStr(__LINE__));
+											CODE_AT_LINE);
 									fileFTPProgressList[getMissingTilesetFromFTPServer] =
 										pair < int,
 										string >(0, "");
@@ -1807,8 +1800,7 @@ namespace Glest {
 											NULL ?
 											ftpClientThread->getProgressMutex
 											() : NULL),
-											string(__FILE__) + "_" +
-											intToStr(__LINE__));
+											CODE_AT_LINE);
 									fileFTPProgressList[getMissingTilesetFromFTPServer] =
 										pair < int,
 										string >(0, "");
@@ -1856,8 +1848,7 @@ namespace Glest {
 											NULL ?
 											modHttpServerThread->getMutexThreadObjectAccessor
 											() : NULL),
-											string(__FILE__) + "_" +
-											intToStr(__LINE__));
+											CODE_AT_LINE);
 									string techURL = techCacheList[techName].url;
 									safeMutexThread.ReleaseLock();
 
@@ -1869,8 +1860,7 @@ namespace Glest {
 											NULL ?
 											ftpClientThread->getProgressMutex
 											() : NULL),
-											string(__FILE__) + "_" +
-											intToStr(__LINE__));
+											CODE_AT_LINE);
 									fileFTPProgressList[getMissingTechtreeFromFTPServer] =
 										pair < int,
 										string >(0, "");
@@ -1883,8 +1873,7 @@ namespace Glest {
 											NULL ?
 											ftpClientThread->getProgressMutex
 											() : NULL),
-											string(__FILE__) + "_" +
-											intToStr(__LINE__));
+											CODE_AT_LINE);
 									fileFTPProgressList[getMissingTechtreeFromFTPServer] =
 										pair < int,
 										string >(0, "");
@@ -2036,6 +2025,9 @@ namespace Glest {
 						fileArchiveExtractCommandParameters,
 						fileArchiveExtractCommandSuccessResult,
 						tempFilePath);
+					if (config.getBool("EnableContentDeltaSync", "false") == true) {
+						ftpClientThread->setContentSyncPort(portNumber + ContentSyncServerThread::ftpPortOffset);
+					}
 					ftpClientThread->start();
 
 					Lang & lang = Lang::getInstance();
@@ -3397,12 +3389,10 @@ namespace Glest {
 
 				if (gameSettings->getMap() != "") {
 					if (lastCheckedCRCMapName != gameSettings->getMap()) {
-						Checksum checksum;
 						string
 							file = Config::getMapPath(gameSettings->getMap(), "", false);
 						//console.addLine("Checking map CRC [" + file + "]");
-						checksum.addFile(file);
-						lastCheckedCRCMapValue = checksum.getSum();
+						lastCheckedCRCMapValue = MapInfoIndex::getCRC(file);
 						lastCheckedCRCMapName = gameSettings->getMap();
 					}
 					gameSettings->setMapCRC(lastCheckedCRCMapValue);
@@ -3853,8 +3843,7 @@ namespace Glest {
 					safeMutexFTPProgress((ftpClientThread !=
 						NULL ? ftpClientThread->getProgressMutex() :
 						NULL),
-						string(__FILE__) + "_" +
-						intToStr(__LINE__));
+						CODE_AT_LINE);
 
 				// !!! START TEMP MV
 				//renderer.renderButton(&buttonCancelDownloads);
@@ -3971,7 +3960,7 @@ namespace Glest {
 				newLabelConnectionInfo = lang.getString("MGGameStatus2");
 			}
 			// Test progress bar
-			//MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+			//MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),CODE_AT_LINE);
 			//fileFTPProgressList["test"] = pair<int,string>(difftime(time(NULL),lastNetworkSendPing) * 20,"test file 123");
 			//safeMutexFTPProgress.ReleaseLock();
 			//
@@ -4187,8 +4176,7 @@ namespace Glest {
 									NULL ?
 									ftpClientThread->getProgressMutex() :
 									NULL),
-									string(__FILE__) + "_" +
-									intToStr(__LINE__));
+									CODE_AT_LINE);
 							if (fileFTPProgressList.empty() == true) {
 								Lang & lang = Lang::getInstance();
 								const
@@ -4270,8 +4258,7 @@ namespace Glest {
 								NULL ?
 								ftpClientThread->getProgressMutex() :
 								NULL,
-								string(__FILE__) + "_" +
-								intToStr(__LINE__));
+								CODE_AT_LINE);
 
 						uint32 tilesetCRC = lastCheckedCRCTilesetValue;
 						if (lastCheckedCRCTilesetName !=
@@ -5338,8 +5325,7 @@ namespace Glest {
 								NULL ?
 								ftpClientThread->getProgressMutex() :
 								NULL),
-								string(__FILE__) + "_" +
-								intToStr(__LINE__));
+								CODE_AT_LINE);
 						if (readyToJoinInProgressGame == false) {
 							if (getInProgressSavedGameFromFTPServer == "") {
 
@@ -6226,7 +6212,7 @@ namespace Glest {
 									(__FILE__).c_str(), __FUNCTION__,
 									__LINE__);
 							if (mapPreview.getMapFileLoaded() != file) {
-								mapPreview.loadFromFile(file.c_str());
+								mapPreview.loadPreviewFromFile(file);
 								cleanupMapPreviewTexture();
 							}
 						}
@@ -6434,8 +6420,7 @@ namespace Glest {
 						safeMutexFTPProgress((ftpClientThread !=
 							NULL ? ftpClientThread->getProgressMutex()
 							: NULL),
-							string(__FILE__) + "_" +
-							intToStr(__LINE__));
+							CODE_AT_LINE);
 					pair < int,
 						string >
 						lastProgress;
@@ -6565,8 +6550,7 @@ namespace Glest {
 					safeMutexFTPProgress((ftpClientThread !=
 						NULL ? ftpClientThread->getProgressMutex() :
 						NULL),
-						string(__FILE__) + "_" +
-						intToStr(__LINE__));
+						CODE_AT_LINE);
 				fileFTPProgressList.erase(itemName);
 				safeMutexFTPProgress.ReleaseLock();
 
@@ -6692,8 +6676,7 @@ namespace Glest {
 					safeMutexFTPProgress((ftpClientThread !=
 						NULL ? ftpClientThread->getProgressMutex() :
 						NULL),
-						string(__FILE__) + "_" +
-						intToStr(__LINE__));
+						CODE_AT_LINE);
 				fileFTPProgressList.erase(itemName);
 				safeMutexFTPProgress.ReleaseLock(true);
 
@@ -6844,8 +6827,7 @@ namespace Glest {
 					safeMutexFTPProgress((ftpClientThread !=
 						NULL ? ftpClientThread->getProgressMutex() :
 						NULL),
-						string(__FILE__) + "_" +
-						intToStr(__LINE__));
+						CODE_AT_LINE);
 				fileFTPProgressList.erase(itemName);
 				safeMutexFTPProgress.ReleaseLock(true);
 
@@ -6999,8 +6981,7 @@ namespace Glest {
 					safeMutexFTPProgress((ftpClientThread !=
 						NULL ? ftpClientThread->getProgressMutex() :
 						NULL),
-						string(__FILE__) + "_" +
-						intToStr(__LINE__));
+						CODE_AT_LINE);
 				//fileFTPProgressList.erase(itemName);
 				std::map < string, pair < int,
 					string > >::iterator
@@ -7264,8 +7245,7 @@ namespace Glest {
 									NULL ?
 									modHttpServerThread->getMutexThreadObjectAccessor
 									() : NULL),
-									string(__FILE__) + "_" +
-									intToStr(__LINE__));
+									CODE_AT_LINE);
 							if (tilesetCacheList.find(getMissingTilesetFromFTPServer) ==
 								tilesetCacheList.end()) {
 								ftpMessageBox.init(lang.getString("Yes"),
@@ -7381,8 +7361,7 @@ namespace Glest {
 									NULL ?
 									modHttpServerThread->getMutexThreadObjectAccessor
 									() : NULL),
-									string(__FILE__) + "_" +
-									intToStr(__LINE__));
+									CODE_AT_LINE);
 							if (techCacheList.find(getMissingTechtreeFromFTPServer) ==
 								techCacheList.end()) {
 								ftpMessageBox.init(lang.getString("Yes"),
@@ -7525,8 +7504,7 @@ namespace Glest {
 									NULL ?
 									modHttpServerThread->getMutexThreadObjectAccessor
 									() : NULL),
-									string(__FILE__) + "_" +
-									intToStr(__LINE__));
+									CODE_AT_LINE);
 							if (mapCacheList.find(getMissingMapFromFTPServer) ==
 								mapCacheList.end()) {
 								ftpMessageBox.init(lang.getString("Yes"),
@@ -982,17 +982,13 @@ namespace Glest {
 
 				GraphicComponent::applyAllCustomProperties(containerName);
 
-				static string mutexOwnerId =
-					string(extractFileFromDirectoryPath(__FILE__).c_str()) +
-					string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				publishToMasterserverThread =
 					new SimpleTaskThread(this, 0, 300, false,
 					(void *) tnt_MASTERSERVER);
 				publishToMasterserverThread->setUniqueID(mutexOwnerId);
 
-				static string mutexOwnerId2 =
-					string(extractFileFromDirectoryPath(__FILE__).c_str()) +
-					string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId2 = CODE_AT_LINE;
 				publishToClientsThread =
 					new SimpleTaskThread(this, 0, 200, false, (void *) tnt_CLIENTS,
 						false);
@@ -1609,13 +1605,13 @@ namespace Glest {
 								NULL ?
 								publishToMasterserverThread->getMutexThreadObjectAccessor
 								() : NULL),
-								string(__FILE__) + "_" + intToStr(__LINE__));
+								CODE_AT_LINE);
 						MutexSafeWrapper
 							safeMutexCLI((publishToClientsThread !=
 								NULL ?
 								publishToClientsThread->getMutexThreadObjectAccessor
 								() : NULL),
-								string(__FILE__) + "_" + intToStr(__LINE__));
+								CODE_AT_LINE);
 						needToBroadcastServerSettings = false;
 						needToRepublishToMasterserver = false;
 						lastNetworkPing = time(NULL);
@@ -1660,13 +1656,13 @@ namespace Glest {
 								NULL ?
 								publishToMasterserverThread->getMutexThreadObjectAccessor
 								() : NULL),
-								string(__FILE__) + "_" + intToStr(__LINE__));
+								CODE_AT_LINE);
 						MutexSafeWrapper
 							safeMutexCLI((publishToClientsThread !=
 								NULL ?
 								publishToClientsThread->getMutexThreadObjectAccessor
 								() : NULL),
-								string(__FILE__) + "_" + intToStr(__LINE__));
+								CODE_AT_LINE);
 
 						loadMapInfo(Config::getMapPath(getCurrentMapFile(), "", false),
 							&mapInfo, true);
@@ -1690,13 +1686,13 @@ namespace Glest {
 								NULL ?
 								publishToMasterserverThread->getMutexThreadObjectAccessor
 								() : NULL),
-								string(__FILE__) + "_" + intToStr(__LINE__));
+								CODE_AT_LINE);
 						MutexSafeWrapper
 							safeMutexCLI((publishToClientsThread !=
 								NULL ?
 								publishToClientsThread->getMutexThreadObjectAccessor
 								() : NULL),
-								string(__FILE__) + "_" + intToStr(__LINE__));
+								CODE_AT_LINE);
 
 						cleanupMapPreviewTexture();
 						if (checkBoxPublishServer.getValue() == true) {
@@ -1714,13 +1710,13 @@ namespace Glest {
 								NULL ?
 								publishToMasterserverThread->getMutexThreadObjectAccessor
 								() : NULL),
-								string(__FILE__) + "_" + intToStr(__LINE__));
+								CODE_AT_LINE);
 						MutexSafeWrapper
 							safeMutexCLI((publishToClientsThread !=
 								NULL ?
 								publishToClientsThread->getMutexThreadObjectAccessor
 								() : NULL),
-								string(__FILE__) + "_" + intToStr(__LINE__));
+								CODE_AT_LINE);
 
 						if (checkBoxPublishServer.getValue() == true) {
 							needToRepublishToMasterserver = true;
@@ -1742,13 +1738,13 @@ namespace Glest {
 								NULL ?
 								publishToMasterserverThread->getMutexThreadObjectAccessor
 								() : NULL),
-								string(__FILE__) + "_" + intToStr(__LINE__));
+								CODE_AT_LINE);
 						MutexSafeWrapper
 							safeMutexCLI((publishToClientsThread !=
 								NULL ?
 								publishToClientsThread->getMutexThreadObjectAccessor
 								() : NULL),
-								string(__FILE__) + "_" + intToStr(__LINE__));
+								CODE_AT_LINE);
 
 						if (checkBoxPublishServer.getValue() == true) {
 							needToRepublishToMasterserver = true;
@@ -1770,13 +1766,13 @@ namespace Glest {
 								NULL ?
 								publishToMasterserverThread->getMutexThreadObjectAccessor
 								() : NULL),
-								string(__FILE__) + "_" + intToStr(__LINE__));
+								CODE_AT_LINE);
 						MutexSafeWrapper
 							safeMutexCLI((publishToClientsThread !=
 								NULL ?
 								publishToClientsThread->getMutexThreadObjectAccessor
 								() : NULL),
-								string(__FILE__) + "_" + intToStr(__LINE__));
+								CODE_AT_LINE);
 
 
 						if (checkBoxPublishServer.getValue() == true) {
@@ -1794,13 +1790,13 @@ namespace Glest {
 								NULL ?
 								publishToMasterserverThread->getMutexThreadObjectAccessor
 								() : NULL),
-								string(__FILE__) + "_" + intToStr(__LINE__));
+								CODE_AT_LINE);
 						MutexSafeWrapper
 							safeMutexCLI((publishToClientsThread !=
 								NULL ?
 								publishToClientsThread->getMutexThreadObjectAccessor
 								() : NULL),
-								string(__FILE__) + "_" + intToStr(__LINE__));
+								CODE_AT_LINE);
 
 
 						if (checkBoxPublishServer.getValue() == true) {
@@ -1817,13 +1813,13 @@ namespace Glest {
 								NULL ?
 								publishToMasterserverThread->getMutexThreadObjectAccessor
 								() : NULL),
-								string(__FILE__) + "_" + intToStr(__LINE__));
+								CODE_AT_LINE);
 						MutexSafeWrapper
 							safeMutexCLI((publishToClientsThread !=
 								NULL ?
 								publishToClientsThread->getMutexThreadObjectAccessor
 								() : NULL),
-								string(__FILE__) + "_" + intToStr(__LINE__));
+								CODE_AT_LINE);
 
 						if (checkBoxPublishServer.getValue() == true) {
 							needToRepublishToMasterserver = true;
@@ -1840,13 +1836,13 @@ namespace Glest {
 								NULL ?
 								publishToMasterserverThread->getMutexThreadObjectAccessor
 								() : NULL),
-								string(__FILE__) + "_" + intToStr(__LINE__));
+								CODE_AT_LINE);
 						MutexSafeWrapper
 							safeMutexCLI((publishToClientsThread !=
 								NULL ?
 								publishToClientsThread->getMutexThreadObjectAccessor
 								() : NULL),
-								string(__FILE__) + "_" + intToStr(__LINE__));
+								CODE_AT_LINE);
 
 						if (checkBoxPublishServer.getValue() == true) {
 							needToRepublishToMasterserver = true;
@@ -1864,13 +1860,13 @@ namespace Glest {
 								NULL ?
 								publishToMasterserverThread->getMutexThreadObjectAccessor
 								() : NULL),
-								string(__FILE__) + "_" + intToStr(__LINE__));
+								CODE_AT_LINE);
 						MutexSafeWrapper
 							safeMutexCLI((publishToClientsThread !=
 								NULL ?
 								publishToClientsThread->getMutexThreadObjectAccessor
 								() : NULL),
-								string(__FILE__) + "_" + intToStr(__LINE__));
+								CODE_AT_LINE);
 
 						if (checkBoxPublishServer.getValue() == true) {
 							needToRepublishToMasterserver = true;
@@ -1888,13 +1884,13 @@ namespace Glest {
 								NULL ?
 								publishToMasterserverThread->getMutexThreadObjectAccessor
 								() : NULL),
-								string(__FILE__) + "_" + intToStr(__LINE__));
+								CODE_AT_LINE);
 						MutexSafeWrapper
 							safeMutexCLI((publishToClientsThread !=
 								NULL ?
 								publishToClientsThread->getMutexThreadObjectAccessor
 								() : NULL),
-								string(__FILE__) + "_" + intToStr(__LINE__));
+								CODE_AT_LINE);
 
 						if (checkBoxPublishServer.getValue() == true) {
 							needToRepublishToMasterserver = true;
@@ -1912,13 +1908,13 @@ namespace Glest {
 									NULL ?
 									publishToMasterserverThread->getMutexThreadObjectAccessor
 									() : NULL),
-									string(__FILE__) + "_" + intToStr(__LINE__));
+									CODE_AT_LINE);
 							MutexSafeWrapper
 								safeMutexCLI((publishToClientsThread !=
 									NULL ?
 									publishToClientsThread->getMutexThreadObjectAccessor
 									() : NULL),
-									string(__FILE__) + "_" + intToStr(__LINE__));
+									CODE_AT_LINE);
 
 							if (checkBoxPublishServer.getValue() == true) {
 								needToRepublishToMasterserver = true;
@@ -1935,13 +1931,13 @@ namespace Glest {
 									NULL ?
 									publishToMasterserverThread->getMutexThreadObjectAccessor
 									() : NULL),
-									string(__FILE__) + "_" + intToStr(__LINE__));
+									CODE_AT_LINE);
 							MutexSafeWrapper
 								safeMutexCLI((publishToClientsThread !=
 									NULL ?
 									publishToClientsThread->getMutexThreadObjectAccessor
 									() : NULL),
-									string(__FILE__) + "_" + intToStr(__LINE__));
+									CODE_AT_LINE);
 
 							switchToNextMapGroup(listBoxMapFilter.getSelectedItemIndex() -
 								oldListBoxMapfilterIndex);
@@ -1978,13 +1974,13 @@ namespace Glest {
 										NULL ?
 										publishToMasterserverThread->getMutexThreadObjectAccessor
 										() : NULL),
-										string(__FILE__) + "_" + intToStr(__LINE__));
+										CODE_AT_LINE);
 								MutexSafeWrapper
 									safeMutexCLI((publishToClientsThread !=
 										NULL ?
 										publishToClientsThread->getMutexThreadObjectAccessor
 										() : NULL),
-										string(__FILE__) + "_" + intToStr(__LINE__));
+										CODE_AT_LINE);
 
 								if (checkBoxPublishServer.getValue() == true) {
 									needToRepublishToMasterserver = true;
@@ -2001,13 +1997,13 @@ namespace Glest {
 										NULL ?
 										publishToMasterserverThread->getMutexThreadObjectAccessor
 										() : NULL),
-										string(__FILE__) + "_" + intToStr(__LINE__));
+										CODE_AT_LINE);
 								MutexSafeWrapper
 									safeMutexCLI((publishToClientsThread !=
 										NULL ?
 										publishToClientsThread->getMutexThreadObjectAccessor
 										() : NULL),
-										string(__FILE__) + "_" + intToStr(__LINE__));
+										CODE_AT_LINE);
 
 								needToRepublishToMasterserver = true;
 								soundRenderer.playFx(coreData.getClickSoundC());
@@ -2027,13 +2023,13 @@ namespace Glest {
 										NULL ?
 										publishToMasterserverThread->getMutexThreadObjectAccessor
 										() : NULL),
-										string(__FILE__) + "_" + intToStr(__LINE__));
+										CODE_AT_LINE);
 								MutexSafeWrapper
 									safeMutexCLI((publishToClientsThread !=
 										NULL ?
 										publishToClientsThread->getMutexThreadObjectAccessor
 										() : NULL),
-										string(__FILE__) + "_" + intToStr(__LINE__));
+										CODE_AT_LINE);
 
 								if (checkBoxPublishServer.getValue() == true) {
 									needToRepublishToMasterserver = true;
@@ -2054,13 +2050,13 @@ namespace Glest {
 											NULL ?
 											publishToMasterserverThread->getMutexThreadObjectAccessor
 											() : NULL),
-											string(__FILE__) + "_" + intToStr(__LINE__));
+											CODE_AT_LINE);
 									MutexSafeWrapper
 										safeMutexCLI((publishToClientsThread !=
 											NULL ?
 											publishToClientsThread->getMutexThreadObjectAccessor
 											() : NULL),
-											string(__FILE__) + "_" + intToStr(__LINE__));
+											CODE_AT_LINE);
 
 									// set multiplier
 									if (listBoxRMultiplier[i].mouseClick(x, y)) {
@@ -2414,13 +2410,13 @@ namespace Glest {
 					NULL ?
 					publishToMasterserverThread->getMutexThreadObjectAccessor
 					() : NULL),
-					string(__FILE__) + "_" + intToStr(__LINE__));
+					CODE_AT_LINE);
 			MutexSafeWrapper
 				safeMutexCLI((publishToClientsThread !=
 					NULL ?
 					publishToClientsThread->getMutexThreadObjectAccessor()
 					: NULL),
-					string(__FILE__) + "_" + intToStr(__LINE__));
+					CODE_AT_LINE);
 
 			if (checkBoxPublishServer.getValue() == true) {
 				needToRepublishToMasterserver = true;
@@ -2494,13 +2490,13 @@ namespace Glest {
 					NULL ?
 					publishToMasterserverThread->getMutexThreadObjectAccessor
 					() : NULL),
-					string(__FILE__) + "_" + intToStr(__LINE__));
+					CODE_AT_LINE);
 			MutexSafeWrapper
 				safeMutexCLI((publishToClientsThread !=
 					NULL ?
 					publishToClientsThread->getMutexThreadObjectAccessor()
 					: NULL),
-					string(__FILE__) + "_" + intToStr(__LINE__));
+					CODE_AT_LINE);
 
 			if (saveGame == true) {
 				saveGameSettingsToFile(SAVED_GAME_FILENAME);
@@ -3576,7 +3572,7 @@ namespace Glest {
 					NULL ?
 					publishToMasterserverThread->getMutexThreadObjectAccessor
 					() : NULL),
-					string(__FILE__) + "_" + intToStr(__LINE__));
+					CODE_AT_LINE);
 
 			publishToServerInfo.clear();
 
@@ -3743,8 +3739,7 @@ namespace Glest {
 
 				MutexSafeWrapper
 					safeMutexThreadOwner(callingThread->getMutexThreadOwnerValid(),
-						string(__FILE__) + "_" +
-						intToStr(__LINE__));
+						CODE_AT_LINE);
 				if (callingThread->getQuitStatus() == true
 					|| safeMutexThreadOwner.isValidMutex() == false) {
 					return;
@@ -3754,7 +3749,7 @@ namespace Glest {
 
 				MutexSafeWrapper
 					safeMutex(callingThread->getMutexThreadObjectAccessor(),
-						string(__FILE__) + "_" + intToStr(__LINE__));
+						CODE_AT_LINE);
 				bool republish = (needToRepublishToMasterserver == true
 					&& publishToServerInfo.empty() == false);
 				needToRepublishToMasterserver = false;
@@ -3820,8 +3815,7 @@ namespace Glest {
 
 					MutexSafeWrapper
 						safeMutexThreadOwner2(callingThread->getMutexThreadOwnerValid(),
-							string(__FILE__) + "_" +
-							intToStr(__LINE__));
+							CODE_AT_LINE);
 					if (callingThread->getQuitStatus() == true
 						|| safeMutexThreadOwner2.isValidMutex() == false) {
 						return;
@@ -3920,8 +3914,7 @@ namespace Glest {
 
 				MutexSafeWrapper
 					safeMutexThreadOwner(callingThread->getMutexThreadOwnerValid(),
-						string(__FILE__) + "_" +
-						intToStr(__LINE__));
+						CODE_AT_LINE);
 				if (callingThread->getQuitStatus() == true
 					|| safeMutexThreadOwner.isValidMutex() == false) {
 					return;
@@ -3931,7 +3924,7 @@ namespace Glest {
 
 				MutexSafeWrapper
 					safeMutex(callingThread->getMutexThreadObjectAccessor(),
-						string(__FILE__) + "_" + intToStr(__LINE__));
+						CODE_AT_LINE);
 				bool broadCastSettings = needToBroadcastServerSettings;
 
 				//printf("simpleTask broadCastSettings = %d\n",broadCastSettings);
@@ -3971,8 +3964,7 @@ namespace Glest {
 				if (broadCastSettings == true) {
 					MutexSafeWrapper
 						safeMutexThreadOwner2(callingThread->getMutexThreadOwnerValid(),
-							string(__FILE__) + "_" +
-							intToStr(__LINE__));
+							CODE_AT_LINE);
 					if (callingThread->getQuitStatus() == true
 						|| safeMutexThreadOwner2.isValidMutex() == false) {
 						return;
@@ -4033,8 +4025,7 @@ namespace Glest {
 				if (needPing == true) {
 					MutexSafeWrapper
 						safeMutexThreadOwner2(callingThread->getMutexThreadOwnerValid(),
-							string(__FILE__) + "_" +
-							intToStr(__LINE__));
+							CODE_AT_LINE);
 					if (callingThread->getQuitStatus() == true
 						|| safeMutexThreadOwner2.isValidMutex() == false) {
 						return;
@@ -5332,7 +5323,7 @@ namespace Glest {
 								(__FILE__).c_str(), __FUNCTION__,
 								__LINE__);
 
-						mapPreview.loadFromFile(file.c_str());
+						mapPreview.loadPreviewFromFile(file);
 
 						//printf("Loading map preview MAP\n");
 						cleanupMapPreviewTexture();
@@ -5394,13 +5385,13 @@ namespace Glest {
 							NULL ?
 							publishToMasterserverThread->getMutexThreadObjectAccessor
 							() : NULL),
-							string(__FILE__) + "_" + intToStr(__LINE__));
+							CODE_AT_LINE);
 					MutexSafeWrapper
 						safeMutexCLI((publishToClientsThread !=
 							NULL ?
 							publishToClientsThread->getMutexThreadObjectAccessor
 							() : NULL),
-							string(__FILE__) + "_" + intToStr(__LINE__));
+							CODE_AT_LINE);
 
 					if (hasNetworkGameSettings() == true) {
 						needToSetChangedGameSettings = true;
@@ -5428,13 +5419,13 @@ namespace Glest {
 							NULL ?
 							publishToMasterserverThread->getMutexThreadObjectAccessor
 							() : NULL),
-							string(__FILE__) + "_" + intToStr(__LINE__));
+							CODE_AT_LINE);
 					MutexSafeWrapper
 						safeMutexCLI((publishToClientsThread !=
 							NULL ?
 							publishToClientsThread->getMutexThreadObjectAccessor
 							() : NULL),
-							string(__FILE__) + "_" + intToStr(__LINE__));
+							CODE_AT_LINE);
 
 					if (hasNetworkGameSettings() == true) {
 						needToSetChangedGameSettings = true;
@@ -5510,13 +5501,13 @@ namespace Glest {
 							NULL ?
 							publishToMasterserverThread->getMutexThreadObjectAccessor
 							() : NULL),
-							string(__FILE__) + "_" + intToStr(__LINE__));
+							CODE_AT_LINE);
 					MutexSafeWrapper
 						safeMutexCLI((publishToClientsThread !=
 							NULL ?
 							publishToClientsThread->getMutexThreadObjectAccessor
 							() : NULL),
-							string(__FILE__) + "_" + intToStr(__LINE__));
+							CODE_AT_LINE);
 
 					if (hasNetworkGameSettings() == true) {
 						needToSetChangedGameSettings = true;
@@ -5964,13 +5955,13 @@ namespace Glest {
 							NULL ?
 							publishToMasterserverThread->getMutexThreadObjectAccessor
 							() : NULL),
-							string(__FILE__) + "_" + intToStr(__LINE__));
+							CODE_AT_LINE);
 					MutexSafeWrapper
 						safeMutexCLI((publishToClientsThread !=
 							NULL ?
 							publishToClientsThread->getMutexThreadObjectAccessor
 							() : NULL),
-							string(__FILE__) + "_" + intToStr(__LINE__));
+							CODE_AT_LINE);
 
 					if (checkBoxPublishServer.getValue() == true) {
 						needToRepublishToMasterserver = true;
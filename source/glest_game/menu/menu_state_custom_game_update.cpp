@@ -50,13 +50,13 @@ namespace Glest {
 					NULL ?
 					publishToMasterserverThread->getMutexThreadObjectAccessor
 					() : NULL),
-					string(__FILE__) + "_" + intToStr(__LINE__));
+					CODE_AT_LINE);
 			MutexSafeWrapper
 				safeMutexCLI((publishToClientsThread !=
 					NULL ?
 					publishToClientsThread->getMutexThreadObjectAccessor()
 					: NULL),
-					string(__FILE__) + "_" + intToStr(__LINE__));
+					CODE_AT_LINE);
 
 			try {
 				if (serverInitError == true) {
@@ -660,7 +660,7 @@ namespace Glest {
 									NULL ?
 									publishToMasterserverThread->getMutexThreadObjectAccessor
 									() : NULL),
-									string(__FILE__) + "_" + intToStr(__LINE__));
+									CODE_AT_LINE);
 
 							ServerInterface *serverInterface =
 								NetworkManager::getInstance().getServerInterface();
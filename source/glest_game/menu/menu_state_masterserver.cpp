@@ -326,9 +326,7 @@ namespace Glest {
 
 			needUpdateFromServer = true;
 
-			static string mutexOwnerId =
-				string(extractFileFromDirectoryPath(__FILE__).c_str()) +
-				string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			updateFromMasterserverThread = new SimpleTaskThread(this, 0, 100);
 			updateFromMasterserverThread->setUniqueID(mutexOwnerId);
 			updateFromMasterserverThread->start();
@@ -362,9 +360,7 @@ namespace Glest {
 			}
 
 			MutexSafeWrapper safeMutexIRCPtr(mutexIRCClient,
-				string(extractFileFromDirectoryPath
-				(__FILE__).c_str()) + "_" +
-				intToStr(__LINE__));
+				CODE_AT_LINE);
 
 			if (SystemFlags::VERBOSE_MODE_ENABLED)
 				printf("#1 IRCCLient Cache check\n");
@@ -396,9 +392,7 @@ namespace Glest {
 				if (SystemFlags::VERBOSE_MODE_ENABLED)
 					printf("#2 IRCCLient Cache check\n");
 
-				static string mutexOwnerId =
-					string(extractFileFromDirectoryPath(__FILE__).c_str()) +
-					string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				ircThread = new IRCThread(ircArgs, this);
 				ircClient = ircThread;
 				ircClient->setUniqueID(mutexOwnerId);
@@ -507,9 +501,7 @@ namespace Glest {
 			const char **params,
 			unsigned int count) {
 			MutexSafeWrapper safeMutexIRCPtr(mutexIRCClient,
-				string(extractFileFromDirectoryPath
-				(__FILE__).c_str()) + "_" +
-				intToStr(__LINE__));
+				CODE_AT_LINE);
 			if (ircClient != NULL) {
 				if (evt == IRC_evt_exitThread) {
 					ircClient->leaveChannel();
@@ -545,8 +537,7 @@ namespace Glest {
 				safeMutex((updateFromMasterserverThread !=
 					NULL ? updateFromMasterserverThread->
 					getMutexThreadObjectAccessor() : NULL),
-					string(extractFileFromDirectoryPath(__FILE__).c_str()) +
-					"_" + intToStr(__LINE__));
+					CODE_AT_LINE);
 			needUpdateFromServer = false;
 			safeMutex.ReleaseLock();
 
@@ -619,9 +610,7 @@ namespace Glest {
 			clearUserButtons();
 
 			MutexSafeWrapper safeMutexIRCPtr(mutexIRCClient,
-				string(extractFileFromDirectoryPath
-				(__FILE__).c_str()) + "_" +
-				intToStr(__LINE__));
+				CODE_AT_LINE);
 			if (ircClient != NULL) {
 				if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).
 					enabled)
@@ -745,8 +734,7 @@ namespace Glest {
 					safeMutex((updateFromMasterserverThread !=
 						NULL ? updateFromMasterserverThread->
 						getMutexThreadObjectAccessor() : NULL),
-						string(extractFileFromDirectoryPath(__FILE__).
-							c_str()) + "_" + intToStr(__LINE__));
+						CODE_AT_LINE);
 				soundRenderer.playFx(coreData.getClickSoundB());
 				needUpdateFromServer = true;
 
@@ -817,8 +805,7 @@ namespace Glest {
 					safeMutex((updateFromMasterserverThread !=
 						NULL ? updateFromMasterserverThread->
 						getMutexThreadObjectAccessor() : NULL),
-						string(extractFileFromDirectoryPath(__FILE__).
-							c_str()) + "_" + intToStr(__LINE__));
+						CODE_AT_LINE);
 				soundRenderer.playFx(coreData.getClickSoundB());
 				needUpdateFromServer = false;
 				safeMutex.ReleaseLock();
@@ -859,8 +846,7 @@ namespace Glest {
 					safeMutex((updateFromMasterserverThread !=
 						NULL ? updateFromMasterserverThread->
 						getMutexThreadObjectAccessor() : NULL),
-						string(extractFileFromDirectoryPath(__FILE__).
-							c_str()) + "_" + intToStr(__LINE__));
+						CODE_AT_LINE);
 				soundRenderer.playFx(coreData.getClickSoundA());
 				autoRefreshTime = 10 * listBoxAutoRefresh.getSelectedItemIndex();
 			} else {
@@ -868,8 +854,7 @@ namespace Glest {
 					safeMutex((updateFromMasterserverThread !=
 						NULL ? updateFromMasterserverThread->
 						getMutexThreadObjectAccessor() : NULL),
-						string(extractFileFromDirectoryPath(__FILE__).
-							c_str()) + "_" + intToStr(__LINE__));
+						CODE_AT_LINE);
 				bool clicked = false;
 				if (serverScrollBar.getElementCount() != 0) {
 					for (int i = serverScrollBar.getVisibleStart();
@@ -961,8 +946,7 @@ namespace Glest {
 				safeMutex((updateFromMasterserverThread !=
 					NULL ? updateFromMasterserverThread->
 					getMutexThreadObjectAccessor() : NULL),
-					string(extractFileFromDirectoryPath(__FILE__).c_str()) +
-					"_" + intToStr(__LINE__));
+					CODE_AT_LINE);
 
 			if (mainMessageBox.getEnabled()) {
 				mainMessageBox.mouseMove(x, y);
@@ -1003,8 +987,7 @@ namespace Glest {
 				safeMutex((updateFromMasterserverThread !=
 					NULL ? updateFromMasterserverThread->
 					getMutexThreadObjectAccessor() : NULL),
-					string(extractFileFromDirectoryPath(__FILE__).c_str()) +
-					"_" + intToStr(__LINE__));
+					CODE_AT_LINE);
 			if (mainMessageBox.getEnabled()) {
 				renderer.renderMessageBox(&mainMessageBox);
 			} else {
@@ -1036,9 +1019,7 @@ namespace Glest {
 
 				Lang & lang = Lang::getInstance();
 				MutexSafeWrapper safeMutexIRCPtr(mutexIRCClient,
-					string(extractFileFromDirectoryPath
-					(__FILE__).c_str()) + "_" +
-					intToStr(__LINE__));
+					CODE_AT_LINE);
 				if (ircClient != NULL && ircClient->isConnected() == true
 					&& ircClient->getHasJoinedChannel() == true) {
 					const Vec4f titleLabelColor = GREEN;
@@ -1108,8 +1089,7 @@ namespace Glest {
 				safeMutex((updateFromMasterserverThread !=
 					NULL ? updateFromMasterserverThread->
 					getMutexThreadObjectAccessor() : NULL),
-					string(extractFileFromDirectoryPath(__FILE__).c_str()) +
-					"_" + intToStr(__LINE__));
+					CODE_AT_LINE);
 			if (autoRefreshTime != 0
 				&& difftime(time(NULL), lastRefreshTimer) >= autoRefreshTime) {
 				needUpdateFromServer = true;
@@ -1142,9 +1122,7 @@ namespace Glest {
 			consoleIRC.update();
 
 			MutexSafeWrapper safeMutexIRCPtr(mutexIRCClient,
-				string(extractFileFromDirectoryPath
-				(__FILE__).c_str()) + "_" +
-				intToStr(__LINE__));
+				CODE_AT_LINE);
 			if (ircClient != NULL) {
 				nickList = ircClient->getNickList();
 
@@ -1246,9 +1224,7 @@ namespace Glest {
 			}
 			MutexSafeWrapper safeMutex(callingThread->
 				getMutexThreadObjectAccessor(),
-				string(extractFileFromDirectoryPath
-				(__FILE__).c_str()) + "_" +
-				intToStr(__LINE__));
+				CODE_AT_LINE);
 			bool needUpdate = needUpdateFromServer;
 
 			if (needUpdate == true) {
@@ -1661,10 +1637,7 @@ namespace Glest {
 				if (chatManager.getEditEnabled() == true) {
 					//printf("keyDown key [%d] chatManager.getText() [%s]\n",key,chatManager.getText().c_str());
 					MutexSafeWrapper safeMutexIRCPtr(mutexIRCClient,
-						string
-						(extractFileFromDirectoryPath
-						(__FILE__).c_str()) + "_" +
-						intToStr(__LINE__));
+						CODE_AT_LINE);
 					//if (key == vkReturn && ircClient != NULL) {
 					if (isKeyPressed(SDLK_RETURN, key, false) == true
 						&& ircClient != NULL) {
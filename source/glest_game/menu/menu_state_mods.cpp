@@ -329,9 +329,7 @@ namespace Glest {
 			if (SystemFlags::VERBOSE_MODE_ENABLED)
 				printf("In [%s::%s Line %d]\n", __FILE__, __FUNCTION__, __LINE__);
 			// Start http meta data thread
-			static string mutexOwnerId =
-				string(extractFileFromDirectoryPath(__FILE__).c_str()) +
-				string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			modHttpServerThread = new SimpleTaskThread(this, 0, 200);
 			modHttpServerThread->setUniqueID(mutexOwnerId);
 			modHttpServerThread->start();
@@ -512,8 +510,7 @@ namespace Glest {
 			if (SystemFlags::VERBOSE_MODE_ENABLED)
 				printf("In [%s::%s Line %d]\n", __FILE__, __FUNCTION__, __LINE__);
 
-			static string mutexOwnerId =
-				string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutexThreadOwner(callingThread->
 				getMutexThreadOwnerValid(),
 				mutexOwnerId);
@@ -1654,8 +1651,7 @@ namespace Glest {
 									string mapURL = mapCacheList[mapName].url;
 									if (ftpClientThread != NULL)
 										ftpClientThread->addMapToRequests(mapName, mapURL);
-									static string mutexOwnerId =
-										string(__FILE__) + string("_") + intToStr(__LINE__);
+									static const char *mutexOwnerId = CODE_AT_LINE;
 									MutexSafeWrapper
 										safeMutexFTPProgress((ftpClientThread !=
 											NULL ? ftpClientThread->
@@ -1707,8 +1703,7 @@ namespace Glest {
 										}
 									}
 								}
-								static string mutexOwnerId =
-									string(__FILE__) + string("_") + intToStr(__LINE__);
+								static const char *mutexOwnerId = CODE_AT_LINE;
 								MutexSafeWrapper
 									safeMutexFTPProgress((ftpClientThread !=
 										NULL ? ftpClientThread->
@@ -1743,8 +1738,7 @@ namespace Glest {
 									ftpClientThread->addTilesetToRequests(tilesetName,
 										tilesetURL);
 
-								static string mutexOwnerId =
-									string(__FILE__) + string("_") + intToStr(__LINE__);
+								static const char *mutexOwnerId = CODE_AT_LINE;
 								MutexSafeWrapper
 									safeMutexFTPProgress((ftpClientThread !=
 										NULL ? ftpClientThread->
@@ -1795,8 +1789,7 @@ namespace Glest {
 									}
 								}
 
-								static string mutexOwnerId =
-									string(__FILE__) + string("_") + intToStr(__LINE__);
+								static const char *mutexOwnerId = CODE_AT_LINE;
 								MutexSafeWrapper
 									safeMutexFTPProgress((ftpClientThread !=
 										NULL ? ftpClientThread->
@@ -1831,8 +1824,7 @@ namespace Glest {
 								if (ftpClientThread != NULL)
 									ftpClientThread->addTechtreeToRequests(techName, techURL);
 
-								static string mutexOwnerId =
-									string(__FILE__) + string("_") + intToStr(__LINE__);
+								static const char *mutexOwnerId = CODE_AT_LINE;
 								MutexSafeWrapper
 									safeMutexFTPProgress((ftpClientThread !=
 										NULL ? ftpClientThread->
@@ -1884,8 +1876,7 @@ namespace Glest {
 									}
 								}
 
-								static string mutexOwnerId =
-									string(__FILE__) + string("_") + intToStr(__LINE__);
+								static const char *mutexOwnerId = CODE_AT_LINE;
 								MutexSafeWrapper
 									safeMutexFTPProgress((ftpClientThread !=
 										NULL ? ftpClientThread->
@@ -1920,8 +1911,7 @@ namespace Glest {
 									ftpClientThread->addScenarioToRequests(scenarioName,
 										scenarioURL);
 
-								static string mutexOwnerId =
-									string(__FILE__) + string("_") + intToStr(__LINE__);
+								static const char *mutexOwnerId = CODE_AT_LINE;
 								MutexSafeWrapper
 									safeMutexFTPProgress((ftpClientThread !=
 										NULL ? ftpClientThread->
@@ -2049,8 +2039,7 @@ namespace Glest {
 						if (ftpClientThread != NULL)
 							ftpClientThread->addTechtreeToRequests(techName, techURL);
 
-						static string mutexOwnerId =
-							string(__FILE__) + string("_") + intToStr(__LINE__);
+						static const char *mutexOwnerId = CODE_AT_LINE;
 						MutexSafeWrapper
 							safeMutexFTPProgress((ftpClientThread !=
 								NULL ? ftpClientThread->
@@ -2167,8 +2156,7 @@ namespace Glest {
 						if (ftpClientThread != NULL)
 							ftpClientThread->addTilesetToRequests(tilesetName, tilesetURL);
 
-						static string mutexOwnerId =
-							string(__FILE__) + string("_") + intToStr(__LINE__);
+						static const char *mutexOwnerId = CODE_AT_LINE;
 						MutexSafeWrapper
 							safeMutexFTPProgress((ftpClientThread !=
 								NULL ? ftpClientThread->
@@ -2259,8 +2247,7 @@ namespace Glest {
 						if (ftpClientThread != NULL)
 							ftpClientThread->addMapToRequests(mapName, mapURL);
 
-						static string mutexOwnerId =
-							string(__FILE__) + string("_") + intToStr(__LINE__);
+						static const char *mutexOwnerId = CODE_AT_LINE;
 						MutexSafeWrapper
 							safeMutexFTPProgress((ftpClientThread !=
 								NULL ? ftpClientThread->
@@ -2378,8 +2365,7 @@ namespace Glest {
 							ftpClientThread->addScenarioToRequests(scenarioName,
 								scenarioURL);
 
-						static string mutexOwnerId =
-							string(__FILE__) + string("_") + intToStr(__LINE__);
+						static const char *mutexOwnerId = CODE_AT_LINE;
 						MutexSafeWrapper
 							safeMutexFTPProgress((ftpClientThread !=
 								NULL ? ftpClientThread->
@@ -2614,7 +2600,7 @@ namespace Glest {
 						extractFileFromDirectoryPath(__FILE__).
 						c_str(), __FUNCTION__, __LINE__);
 
-				mapPreview.loadFromFile(mapPath.c_str());
+				mapPreview.loadPreviewFromFile(mapPath);
 
 				//printf("Loading map preview MAP\n");
 				cleanupMapPreviewTexture();
@@ -2649,8 +2635,7 @@ namespace Glest {
 					if (ftpClientThread != NULL)
 						ftpClientThread->addFileToRequests(tempImage, modInfo->imageUrl);
 
-					static string mutexOwnerId =
-						string(__FILE__) + string("_") + intToStr(__LINE__);
+					static const char *mutexOwnerId = CODE_AT_LINE;
 					MutexSafeWrapper
 						safeMutexFTPProgress((ftpClientThread !=
 							NULL ? ftpClientThread->
@@ -2662,8 +2647,7 @@ namespace Glest {
 					safeMutexFTPProgress.ReleaseLock();
 
 				} else {
-					static string mutexOwnerId =
-						string(__FILE__) + string("_") + intToStr(__LINE__);
+					static const char *mutexOwnerId = CODE_AT_LINE;
 					MutexSafeWrapper
 						safeMutexFTPProgress((ftpClientThread !=
 							NULL ? ftpClientThread->
@@ -3062,8 +3046,7 @@ namespace Glest {
 				}
 				renderer.renderScrollBar(&keyScenarioScrollBar);
 
-				static string mutexOwnerId =
-					string(__FILE__) + string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				MutexSafeWrapper
 					safeMutexFTPProgress((ftpClientThread !=
 						NULL ? ftpClientThread->
@@ -3319,8 +3302,7 @@ namespace Glest {
 					}
 					//if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Got FTP Callback for [%s] current file [%s] fileProgress = %d [now = %f, total = %f]\n",itemName.c_str(),stats->currentFilename.c_str(), fileProgress,stats->download_now,stats->download_total);
 
-					static string mutexOwnerId =
-						string(__FILE__) + string("_") + intToStr(__LINE__);
+					static const char *mutexOwnerId = CODE_AT_LINE;
 					MutexSafeWrapper
 						safeMutexFTPProgress((ftpClientThread !=
 							NULL ? ftpClientThread->
@@ -3356,8 +3338,7 @@ namespace Glest {
 					printf("Got FTP Callback for [%s] result = %d [%s]\n",
 						itemName.c_str(), result.first, result.second.c_str());
 
-				static string mutexOwnerId =
-					string(__FILE__) + string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				MutexSafeWrapper
 					safeMutexFTPProgress((ftpClientThread !=
 						NULL ? ftpClientThread->
@@ -3380,8 +3361,7 @@ namespace Glest {
 					printf("Got FTP Callback for [%s] result = %d [%s]\n",
 						itemName.c_str(), result.first, result.second.c_str());
 
-				static string mutexOwnerId =
-					string(__FILE__) + string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				MutexSafeWrapper
 					safeMutexFTPProgress((ftpClientThread !=
 						NULL ? ftpClientThread->
@@ -3417,8 +3397,7 @@ namespace Glest {
 					printf("Got FTP Callback for [%s] result = %d [%s]\n",
 						itemName.c_str(), result.first, result.second.c_str());
 
-				static string mutexOwnerId =
-					string(__FILE__) + string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				MutexSafeWrapper
 					safeMutexFTPProgress((ftpClientThread !=
 						NULL ? ftpClientThread->
@@ -3457,8 +3436,7 @@ namespace Glest {
 					printf("Got FTP Callback for [%s] result = %d [%s]\n",
 						itemName.c_str(), result.first, result.second.c_str());
 
-				static string mutexOwnerId =
-					string(__FILE__) + string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				MutexSafeWrapper
 					safeMutexFTPProgress((ftpClientThread !=
 						NULL ? ftpClientThread->
@@ -3522,8 +3500,7 @@ namespace Glest {
 					printf("Got FTP Callback for [%s] result = %d [%s]\n",
 						itemName.c_str(), result.first, result.second.c_str());
 
-				static string mutexOwnerId =
-					string(__FILE__) + string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				MutexSafeWrapper
 					safeMutexFTPProgress((ftpClientThread !=
 						NULL ? ftpClientThread->
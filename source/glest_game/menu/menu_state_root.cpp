@@ -316,8 +316,7 @@ namespace Glest {
 								ftpClientThread->addTempFileToRequests(ftpFileName,
 									ftpFileURL);
 
-							static string mutexOwnerId =
-								string(__FILE__) + string("_") + intToStr(__LINE__);
+							static const char *mutexOwnerId = CODE_AT_LINE;
 							MutexSafeWrapper
 								safeMutexFTPProgress((ftpClientThread !=
 									NULL ? ftpClientThread->
@@ -489,8 +488,7 @@ namespace Glest {
 					}
 					//if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Got FTP Callback for [%s] current file [%s] fileProgress = %d [now = %f, total = %f]\n",itemName.c_str(),stats->currentFilename.c_str(), fileProgress,stats->download_now,stats->download_total);
 
-					static string mutexOwnerId =
-						string(__FILE__) + string("_") + intToStr(__LINE__);
+					static const char *mutexOwnerId = CODE_AT_LINE;
 					MutexSafeWrapper
 						safeMutexFTPProgress((ftpClientThread !=
 							NULL ? ftpClientThread->
@@ -538,8 +536,7 @@ namespace Glest {
 					printf("Got FTP Callback for [%s] result = %d [%s]\n",
 						itemName.c_str(), result.first, result.second.c_str());
 
-				static string mutexOwnerId =
-					string(__FILE__) + string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				MutexSafeWrapper
 					safeMutexFTPProgress((ftpClientThread !=
 						NULL ? ftpClientThread->
@@ -767,9 +764,7 @@ namespace Glest {
 				string updateCheckURL =
 					Config::getInstance().getString("UpdateCheckURL", "");
 				if (updateCheckURL != "") {
-					static string mutexOwnerId =
-						string(extractFileFromDirectoryPath(__FILE__).c_str()) +
-						string("_") + intToStr(__LINE__);
+					static const char *mutexOwnerId = CODE_AT_LINE;
 					updatesHttpServerThread = new SimpleTaskThread(this, 1, 200);
 					updatesHttpServerThread->setUniqueID(mutexOwnerId);
 					updatesHttpServerThread->start();
@@ -784,8 +779,7 @@ namespace Glest {
 			if (SystemFlags::VERBOSE_MODE_ENABLED)
 				printf("In [%s::%s Line %d]\n", __FILE__, __FUNCTION__, __LINE__);
 
-			static string mutexOwnerId =
-				string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutexThreadOwner(callingThread->
 				getMutexThreadOwnerValid(),
 				mutexOwnerId);
@@ -21,6 +21,7 @@
 //	along with this program.  If not, see <https://www.gnu.org/licenses/>
 
 #include "client_interface.h"
+#include "command_delay.h"
 
 #include "logger.h"
 #include "window.h"
@@ -54,6 +55,8 @@ namespace Glest {
 		const int ClientInterface::messageWaitTimeout = 10000;	//10 seconds
 		const int ClientInterface::waitSleepTime = 10;
 		const int ClientInterface::maxNetworkCommandListSendTimeWait = 5;
+		const int ClientInterface::messagePollMicroseconds = 5000;
+		const int ClientInterface::commandWaitMillis = 5;
 
 		// =====================================================
 		//	class ClientInterfaceThread
@@ -125,12 +128,13 @@ namespace Glest {
 
 						// START: Test simulating lag for the client
 						int simulateLag = Config::getInstance().getInt("SimulateClientLag", "0");
-						if (simulateLag > 0) {
+						int simulateLagJitter = Config::getInstance().getInt("SimulateClientLagJitter", "0");
+						if (simulateLag > 0 || simulateLagJitter > 0) {
 							if (clientSimulationLagStartTime == 0) {
 								clientSimulationLagStartTime = time(NULL);
 							}
 							if (difftime((long int) time(NULL), clientSimulationLagStartTime) <= Config::getInstance().getInt("SimulateClientLagDurationSeconds", "0")) {
-								sleep(simulateLag);
+								sleep(simulateLag + (simulateLagJitter > 0 ? rand() % (simulateLagJitter + 1) : 0));
 							}
 						}
 						// END: Test simulating lag for the client
@@ -197,6 +201,7 @@ namespace Glest {
 			networkCommandListThread = NULL;
 			cachedPendingCommandsIndex = 0;
 			cachedLastPendingFrameCount = 0;
+			cachedLastCommandDelay = 0;
 			timeClientWaitedForLastMessage = 0;
 
 			flagAccessor = new Mutex(CODE_AT_LINE);
@@ -210,6 +215,7 @@ namespace Glest {
 			this->joinGameInProgressLaunch = false;
 			this->readyForInGameJoin = false;
 			this->resumeInGameJoin = false;
+			this->synchMismatchDetected = false;
 
 			quitThreadAccessor = new Mutex(CODE_AT_LINE);
 			setQuitThread(false);
@@ -298,6 +304,11 @@ namespace Glest {
 			shutdownNetworkCommandListThread(safeMutex);
 			//printf("A === Client destructor\n");
 
+			if (frameWaitTimes.getCount() > 0) {
+				if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "Client waits for command lists: %s\n", frameWaitTimes.getReport("frames").c_str());
+				if (SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled) SystemFlags::OutputDebug(SystemFlags::debugPerformance, "Client waits for command lists: %s\n", frameWaitTimes.getReport("frames").c_str());
+			}
+
 			if (SystemFlags::VERBOSE_MODE_ENABLED) printf("%s Line: %d\n", __FUNCTION__, __LINE__);
 
 			if (clientSocket != NULL &&
@@ -391,6 +402,16 @@ namespace Glest {
 			return resumeInGameJoin;
 		}
 
+		bool ClientInterface::getSynchMismatchDetected() {
+			MutexSafeWrapper safeMutex(flagAccessor, CODE_AT_LINE);
+			return synchMismatchDetected;
+		}
+
+		void ClientInterface::setSynchMismatchDetected() {
+			MutexSafeWrapper safeMutex(flagAccessor, CODE_AT_LINE);
+			synchMismatchDetected = true;
+		}
+
 		void ClientInterface::connect(const Ip &ip, int port) {
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s] START\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__);
 
@@ -1098,15 +1119,13 @@ namespace Glest {
 					chronoPerf.start();
 				}
 
-				int waitMicroseconds = (checkFrame == NULL ? 10 : 0);
-
 				bool done = false;
 				while (done == false && getQuitThread() == false) {
 					//printf("BEFORE Client get networkMessageType\n");
 
 
 					//wait for the next message
-					NetworkMessageType networkMessageType = waitForMessage(waitMicroseconds);
+					NetworkMessageType networkMessageType = waitForMessage(messagePollMicroseconds);
 
 					//printf("AFTER Client got networkMessageType = %d\n",networkMessageType);
 
@@ -1138,6 +1157,7 @@ namespace Glest {
 
 							MutexSafeWrapper safeMutex(networkCommandListThreadAccessor, CODE_AT_LINE);
 							cachedLastPendingFrameCount = networkMessageCommandList.getFrameCount();
+							cachedLastCommandDelay = networkMessageCommandList.getCommandDelay();
 							//printf("cachedLastPendingFrameCount = %lld\n",(long long int)cachedLastPendingFrameCount);
 
 							//check that we are in the right frame
@@ -1147,6 +1167,7 @@ namespace Glest {
 										" got a Network synchronization error, frame counts do not match, server frameCount = " +
 										intToStr(networkMessageCommandList.getFrameCount()) + ", local frameCount = " +
 										intToStr(*checkFrame);
+									setSynchMismatchDetected();
 									sendTextMessage(sErr, -1, true, "");
 									DisplayErrorMessage(sErr);
 									sleep(1);
@@ -1163,6 +1184,7 @@ namespace Glest {
 											" got a Network CRC error, CRC's do not match, server CRC = " +
 											uIntToStr(networkMessageCommandList.getNetworkPlayerFactionCRC(index)) + ", local CRC = " +
 											uIntToStr(getNetworkPlayerFactionCRC(index));
+										setSynchMismatchDetected();
 										sendTextMessage(sErr, -1, true, "");
 										DisplayErrorMessage(sErr);
 										sleep(1);
@@ -1191,9 +1213,11 @@ namespace Glest {
 									for (int index = 0; index < GameConstants::maxPlayers; ++index) {
 										cachedPendingCommandCRCs[networkMessageCommandList.getFrameCount()].push_back(networkMessageCommandList.getNetworkPlayerFactionCRC(index));
 									}
+									cachedPendingCommandDelays[networkMessageCommandList.getFrameCount()] = networkMessageCommandList.getCommandDelay();
 								}
 							}
 							safeMutex.ReleaseLock();
+							networkCommandListReceived.signal();
 
 							done = true;
 						}
@@ -1207,6 +1231,9 @@ namespace Glest {
 							if (receiveMessage(&networkMessagePing)) {
 								if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s Line: %d]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__);
 								this->setLastPingInfo(networkMessagePing);
+								if (networkMessagePing.getPingFrequency() == NetworkMessagePing::echoRequest) {
+									sendMessage(&networkMessagePing);
+								}
 							}
 						}
 						break;
@@ -1384,9 +1411,9 @@ namespace Glest {
 			//printf("#3 ClientInterface::updateFrame\n");
 		}
 
-		uint64 ClientInterface::getCachedLastPendingFrameCount() {
+		uint64 ClientInterface::getCachedLastServerFrameCount() {
 			MutexSafeWrapper safeMutex(networkCommandListThreadAccessor, CODE_AT_LINE);
-			uint64 result = cachedLastPendingFrameCount;
+			uint64 result = cachedLastPendingFrameCount - cachedLastCommandDelay;
 			return result;
 		}
 
@@ -1412,6 +1439,10 @@ namespace Glest {
 				MutexSafeWrapper safeMutex(NULL, CODE_AT_LINE);
 
 				for (; getQuit() == false && getQuitThread() == false;) {
+					// drop wakeups for lists stored before the check below, so
+					// the wait only returns early for a list stored after it
+					while (networkCommandListReceived.tryDecrement() == true) {
+					}
 
 					if (safeMutex.isValidMutex() == false) {
 						safeMutex.setMutex(networkCommandListThreadAccessor, CODE_AT_LINE);
@@ -1432,18 +1463,23 @@ namespace Glest {
 							}
 							cachedPendingCommands[frameCount].clear();
 
-							if (frameCount >= 0) {
+							// the server sent the checksums of the keyframe it made the list on
+							int commandDelay = cachedPendingCommandDelays[frameCount];
+							std::map<int, vector<uint32> >::const_iterator iterKeyframeCRCs = keyframeCRCs.find(frameCount - commandDelay);
+							if (frameCount >= 0 && (commandDelay == 0 || iterKeyframeCRCs != keyframeCRCs.end())) {
 								for (int index = 0; index < GameConstants::maxPlayers; ++index) {
-									//printf("X**X Frame: %d faction: %d local CRC: %u Remote CRC: %u\n",frameCount,index,getNetworkPlayerFactionCRC(index),cachedPendingCommandCRCs[frameCount][index]);
+									uint32 localCRC = (commandDelay == 0 ? getNetworkPlayerFactionCRC(index) : iterKeyframeCRCs->second[index]);
+									//printf("X**X Frame: %d faction: %d local CRC: %u Remote CRC: %u\n",frameCount,index,localCRC,cachedPendingCommandCRCs[frameCount][index]);
 
-									if (cachedPendingCommandCRCs[frameCount][index] != getNetworkPlayerFactionCRC(index)) {
+									if (cachedPendingCommandCRCs[frameCount][index] != localCRC) {
 
-										printf("X**X Frame: %d faction: %d local CRC: %u Remote CRC: %u\n", frameCount, index, getNetworkPlayerFactionCRC(index), cachedPendingCommandCRCs[frameCount][index]);
+										printf("X**X Frame: %d faction: %d local CRC: %u Remote CRC: %u\n", frameCount, index, localCRC, cachedPendingCommandCRCs[frameCount][index]);
 
 										string sErr = "Player: " + getHumanPlayerName() +
 											" got a Network CRC error, CRC's do not match, server CRC = " +
 											uIntToStr(cachedPendingCommandCRCs[frameCount][index]) + ", local CRC = " +
-											uIntToStr(getNetworkPlayerFactionCRC(index));
+											uIntToStr(localCRC);
+										setSynchMismatchDetected();
 										sendTextMessage(sErr, -1, true, "");
 										DisplayErrorMessage(sErr);
 										sleep(1);
@@ -1454,10 +1490,14 @@ namespace Glest {
 								}
 							}
 							cachedPendingCommandCRCs.erase(frameCount);
+							cachedPendingCommandDelays.erase(frameCount);
 						}
 						if (waitForData == true) {
 							timeClientWaitedForLastMessage = chrono.getMillis();
+							frameWaitTimes.add(chrono.getMicros());
 							chrono.stop();
+						} else {
+							frameWaitTimes.add(0);
 						}
 						safeMutex.ReleaseLock(true);
 
@@ -1473,11 +1513,10 @@ namespace Glest {
 						if (copyCachedLastPendingFrameCount > frameCountAsUInt64) {
 							break;
 						}
+						waitForData = true;
 
-						if (waitForData == false) {
-							waitForData = true;
-							sleep(0);
-						}
+						// sleep until the network thread stores a command list
+						networkCommandListReceived.waitTillSignalled(commandWaitMillis);
 
 						waitCount++;
 						//printf("Client waiting for packet for frame: %d, currentCachedPendingCommandsIndex = %d, cachedPendingCommandsIndex = %lld\n",frameCount,currentCachedPendingCommandsIndex,(long long int)cachedPendingCommandsIndex);
@@ -1498,7 +1537,7 @@ namespace Glest {
 
 			if (getQuit() == false && getQuitThread() == false) {
 				if (networkCommandListThread == NULL) {
-					static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+					static const char *mutexOwnerId = CODE_AT_LINE;
 					networkCommandListThread = new ClientInterfaceThread(this);
 					networkCommandListThread->setUniqueID(mutexOwnerId);
 					networkCommandListThread->start();
@@ -1506,6 +1545,15 @@ namespace Glest {
 					sleep(0);
 				}
 
+				// keep own checksums as long as a command list may refer back to them
+				vector<uint32> &crcs = keyframeCRCs[frameCount];
+				crcs.clear();
+				for (int index = 0; index < GameConstants::maxPlayers; ++index) {
+					crcs.push_back(getNetworkPlayerFactionCRC(index));
+				}
+				int oldestKeyframe = frameCount - (CommandDelayController::maxDelayPeriods + 1) * gameSettings.getNetworkFramePeriod();
+				keyframeCRCs.erase(keyframeCRCs.begin(), keyframeCRCs.lower_bound(oldestKeyframe));
+
 				getNetworkCommand(frameCount, cachedPendingCommandsIndex);
 			}
 		}
@@ -1954,14 +2002,20 @@ namespace Glest {
 
 			Chrono chrono;
 			chrono.start();
+			int64 lastConnectionCheck = 0;
 
 			NetworkMessageType msg = nmtInvalid;
 			while (msg == nmtInvalid &&
 				getQuitThread() == false) {
 
+				// blocks in select until data arrives or the wait is over
 				msg = getNextMessageType(waitMicroseconds);
 				if (msg == nmtInvalid) {
-					if (getSocket() == NULL || (chrono.getMillis() % 250 == 0 && isConnected() == false)) {
+					bool checkConnection = (chrono.getMillis() - lastConnectionCheck >= 250);
+					if (checkConnection == true) {
+						lastConnectionCheck = chrono.getMillis();
+					}
+					if (getSocket() == NULL || (checkConnection == true && isConnected() == false)) {
 						if (getQuit() == false) {
 							Lang &lang = Lang::getInstance();
 							DisplayErrorMessage(lang.getString("ServerDisconnected"));
@@ -1994,11 +2048,9 @@ namespace Glest {
 						close();
 						return msg;
 					}
-					// Sleep every x milli-seconds we wait to let other threads work
-					else if (chrono.getMillis() % 2 == 0) {
+					// without a wait slice the socket was only polled
+					else if (waitMicroseconds <= 0) {
 						sleep(1);
-					} else {
-						sleep(0);
 					}
 				}
 
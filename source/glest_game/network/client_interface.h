@@ -31,10 +31,13 @@
 #include <vector>
 #include "network_interface.h"
 #include "socket.h"
+#include "time_histogram.h"
 #include "leak_dumper.h"
 
 using Shared::Platform::Ip;
 using Shared::Platform::ClientSocket;
+using Shared::Platform::Semaphore;
+using Shared::Util::TimeHistogram;
 using std::vector;
 
 namespace Glest {
@@ -71,6 +74,10 @@ namespace Glest {
 			static const int messageWaitTimeout;
 			static const int waitSleepTime;
 			static const int maxNetworkCommandListSendTimeWait;
+			// longest single block on the socket or on the command list
+			// before quit and timeouts are checked again
+			static const int messagePollMicroseconds;
+			static const int commandWaitMillis;
 
 		private:
 			ClientSocket * clientSocket;
@@ -101,17 +108,28 @@ namespace Glest {
 			ClientInterfaceThread *networkCommandListThread;
 
 			Mutex *networkCommandListThreadAccessor;
+			// signalled when a command list has been received
+			Semaphore networkCommandListReceived;
 			std::map<int, Commands> cachedPendingCommands;	//commands ready to be given
 			std::map<int, vector<uint32> > cachedPendingCommandCRCs;	//commands ready to be given
+			std::map<int, int> cachedPendingCommandDelays;
 			uint64 cachedPendingCommandsIndex;
 			uint64 cachedLastPendingFrameCount;
+			int cachedLastCommandDelay;
+			// own checksums by keyframe, for command lists the server
+			// scheduled ahead of the frame it made them on
+			std::map<int, vector<uint32> > keyframeCRCs;
 			int64 timeClientWaitedForLastMessage;
+			// how long each frame waited for its command list
+			TimeHistogram frameWaitTimes;
 
 			Mutex *flagAccessor;
 			bool joinGameInProgress;
 			bool joinGameInProgressLaunch;
 			bool readyForInGameJoin;
 			bool resumeInGameJoin;
+			// set when the server's frame count or checksums differed from ours
+			bool synchMismatchDetected;
 
 			Mutex *quitThreadAccessor;
 			bool quitThread;
@@ -120,6 +138,7 @@ namespace Glest {
 			void setQuitThread(bool value);
 			bool getQuit();
 			void setQuit(bool value);
+			void setSynchMismatchDetected();
 
 		public:
 			ClientInterface();
@@ -139,7 +158,10 @@ namespace Glest {
 			bool getResumeInGameJoin();
 			void sendResumeGameMessage();
 
-			uint64 getCachedLastPendingFrameCount();
+			bool getSynchMismatchDetected();
+
+			// frame the server was on when it sent the newest command list
+			uint64 getCachedLastServerFrameCount();
 			int64 getTimeClientWaitedForLastMessage();
 
 			//message processing
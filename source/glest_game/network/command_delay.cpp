@@ -0,0 +1,78 @@
+//
+//	command_delay.cpp:
+//
+//	This file is part of ZetaGlest <https://github.com/ZetaGlest>
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+//	This program is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.  If not, see <https://www.gnu.org/licenses/>
+
+#include "command_delay.h"
+
+#include <algorithm>
+#include "game_constants.h"
+#include "leak_dumper.h"
+
+namespace Glest {
+	namespace Game {
+
+		// =====================================================
+		//	class CommandDelayController
+		// =====================================================
+
+		const double CommandDelayController::stallProbability = 0.01;
+
+		CommandDelayController::CommandDelayController() {
+			init(false, GameConstants::networkFramePeriod);
+		}
+
+		void CommandDelayController::init(bool enabled, int framePeriod) {
+			this->enabled = enabled;
+			this->framePeriod = std::max(1, framePeriod);
+			delayFrames = 0;
+			shrinkKeyframes = 0;
+		}
+
+		int CommandDelayController::getNeededDelayFrames(int64 latencyMicros) const {
+			int64 periodMicros = (int64) framePeriod * 1000000 / GameConstants::updateFps;
+			int64 periods = (latencyMicros + periodMicros - 1) / periodMicros;
+			periods = std::max<int64>(0, std::min<int64>(periods, maxDelayPeriods));
+			return (int) periods * framePeriod;
+		}
+
+		int CommandDelayController::update(int64 latencyMicros) {
+			if (enabled == false) {
+				return delayFrames;
+			}
+			int neededFrames = getNeededDelayFrames(latencyMicros);
+			if (neededFrames > delayFrames) {
+				delayFrames += framePeriod;
+				shrinkKeyframes = 0;
+			} else if (neededFrames < delayFrames) {
+				// one quiet moment is no reason to stall on the next spike
+				shrinkKeyframes++;
+				if (shrinkKeyframes >= keyframesBeforeShrinking) {
+					delayFrames -= framePeriod;
+					shrinkKeyframes = 0;
+				}
+			} else {
+				shrinkKeyframes = 0;
+			}
+			return delayFrames;
+		}
+
+	}
+}//end namespace
@@ -0,0 +1,80 @@
+//
+//	command_delay.h:
+//
+//	This file is part of ZetaGlest <https://github.com/ZetaGlest>
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+//	This program is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.  If not, see <https://www.gnu.org/licenses/>
+
+#ifndef _GLEST_GAME_COMMANDDELAY_H_
+#define _GLEST_GAME_COMMANDDELAY_H_
+
+#include "data_types.h"
+#include "leak_dumper.h"
+
+using Shared::Platform::int64;
+
+namespace Glest {
+	namespace Game {
+
+		// =====================================================
+		//	class CommandDelayController
+		//
+		///	Picks how many frames ahead the server schedules the
+		///	command lists it broadcasts, so clients have them
+		///	before they reach the frame instead of stalling on
+		///	every latency spike
+		// =====================================================
+
+		class CommandDelayController {
+		public:
+			// longest delay, in network frame periods
+			static const int maxDelayPeriods = 8;
+			// chance of a command list arriving late the delay is picked for
+			static const double stallProbability;
+			// keyframes the latency has to stay low before the delay shrinks
+			static const int keyframesBeforeShrinking = 20;
+
+		private:
+			bool enabled;
+			int framePeriod;
+			int delayFrames;
+			int shrinkKeyframes;
+
+		public:
+			CommandDelayController();
+
+			void init(bool enabled, int framePeriod);
+
+			bool isEnabled() const {
+				return enabled;
+			}
+			int getDelayFrames() const {
+				return delayFrames;
+			}
+			// delay covering the given one way latency at normal game speed
+			int getNeededDelayFrames(int64 latencyMicros) const;
+			// called on every keyframe with the one way latency the slowest
+			// client stays under; grows the delay by at most one period at
+			// a time, so command lists keep covering every keyframe
+			int update(int64 latencyMicros);
+		};
+
+	}
+}//end namespace
+
+#endif
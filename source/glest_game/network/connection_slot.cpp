@@ -105,6 +105,11 @@ namespace Glest {
 						break;
 					}
 				}
+				safeMutex.ReleaseLock();
+
+				if (slotInterface != NULL) {
+					slotInterface->slotTaskCompleted(slotIndex);
+				}
 			}
 		}
 
@@ -121,6 +126,11 @@ namespace Glest {
 					slotEvent.eventCompleted = true;
 				}
 			}
+			safeMutex.ReleaseLock();
+
+			if (slotInterface != NULL) {
+				slotInterface->slotTaskCompleted(slotIndex);
+			}
 		}
 
 		void ConnectionSlotThread::purgeCompletedEvents() {
@@ -363,11 +373,12 @@ namespace Glest {
 		ConnectionSlot::ConnectionSlot(ServerInterface* serverInterface, int playerIndex) {
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s] Line: %d\n", __FILE__, __FUNCTION__, __LINE__);
 
-			this->mutexSocket = new Mutex(CODE_AT_LINE);
+			this->mutexSocket = new Mutex(CODE_AT_LINE_X(mutexSocket));
 			this->socket = NULL;
-			this->mutexCloseConnection = new Mutex(CODE_AT_LINE);
-			this->mutexPendingNetworkCommandList = new Mutex(CODE_AT_LINE);
-			this->socketSynchAccessor = new Mutex(CODE_AT_LINE);
+			this->mutexCloseConnection = new Mutex(CODE_AT_LINE_X(mutexCloseConnection));
+			this->mutexPendingNetworkCommandList = new Mutex(CODE_AT_LINE_X(mutexPendingNetworkCommandList));
+			this->socketSynchAccessor = new Mutex(CODE_AT_LINE_X(socketSynchAccessor));
+			this->mutexRoundTripTimes = new Mutex(CODE_AT_LINE_X(mutexRoundTripTimes));
 			this->connectedRemoteIPAddress = 0;
 			this->sessionKey = 0;
 			this->serverInterface = serverInterface;
@@ -406,7 +417,7 @@ namespace Glest {
 
 			this->setSocket(NULL);
 			this->slotThreadWorker = NULL;
-			static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			this->slotThreadWorker = new ConnectionSlotThread(this->serverInterface, playerIndex);
 			this->slotThreadWorker->setUniqueID(mutexOwnerId);
 			this->slotThreadWorker->start();
@@ -460,6 +471,9 @@ namespace Glest {
 			delete mutexPendingNetworkCommandList;
 			mutexPendingNetworkCommandList = NULL;
 
+			delete mutexRoundTripTimes;
+			mutexRoundTripTimes = NULL;
+
 			delete mutexCloseConnection;
 			mutexCloseConnection = NULL;
 
@@ -477,6 +491,19 @@ namespace Glest {
 			autoPauseGameCountForLag++;
 		}
 
+		void ConnectionSlot::addRoundTripTime(int64 micros) {
+			MutexSafeWrapper safeMutex(mutexRoundTripTimes, CODE_AT_LINE);
+			roundTripTimes.addSample(micros);
+		}
+
+		int64 ConnectionSlot::getRoundTripTimeQuantile(double exceedProbability) {
+			MutexSafeWrapper safeMutex(mutexRoundTripTimes, CODE_AT_LINE);
+			if (roundTripTimes.getSampleCount() == 0) {
+				return -1;
+			}
+			return roundTripTimes.getQuantileMicros(exceedProbability);
+		}
+
 		bool ConnectionSlot::getGameStarted() {
 			bool result = false;
 			if (this->slotThreadWorker != NULL) {
@@ -683,6 +710,9 @@ namespace Glest {
 									if (receiveMessage(&networkMessagePing)) {
 										if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s Line: %d]\n", __FILE__, __FUNCTION__, __LINE__);
 										lastPingInfo = networkMessagePing;
+										if (networkMessagePing.getPingFrequency() == NetworkMessagePing::echoRequest) {
+											addRoundTripTime(LatencyEstimator::getCurrentMicros() - networkMessagePing.getPingTime());
+										}
 									} else {
 										if (SystemFlags::getSystemSettingType(SystemFlags::debugError).enabled) SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d]\nInvalid message type before intro handshake [%d]\nDisconnecting socket for slot: %d [%s].\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, networkMessageType, this->playerIndex, this->getIpAddress().c_str());
 										this->serverInterface->notifyBadClientConnectAttempt(this->getIpAddress());
@@ -24,6 +24,7 @@
 #include "socket.h"
 #include "network_interface.h"
 #include "base_thread.h"
+#include "latency_estimator.h"
 #include <time.h>
 #include <vector>
 
@@ -32,6 +33,7 @@
 using Shared::Platform::ServerSocket;
 using Shared::Platform::Socket;
 using std::vector;
+using Shared::Util::LatencyEstimator;
 
 namespace Glest {
 	namespace Game {
@@ -82,6 +84,8 @@ namespace Glest {
 			virtual Mutex *getSlotMutex(int index) = 0;
 
 			virtual void slotUpdateTask(ConnectionSlotEvent *event) = 0;
+			// called from the slot thread when an event has been processed
+			virtual void slotTaskCompleted(int index) = 0;
 			virtual ~ConnectionSlotCallbackInterface() {
 			}
 		};
@@ -181,6 +185,9 @@ namespace Glest {
 
 			int autoPauseGameCountForLag;
 
+			Mutex *mutexRoundTripTimes;
+			LatencyEstimator roundTripTimes;
+
 		public:
 			ConnectionSlot(ServerInterface* serverInterface, int playerIndex);
 			~ConnectionSlot();
@@ -188,6 +195,11 @@ namespace Glest {
 			int getAutoPauseGameCountForLag();
 			void incrementAutoPauseGameCountForLag();
 
+			void addRoundTripTime(int64 micros);
+			// round trip time only exceeded with the given probability,
+			// -1 before any echoed ping came back
+			int64 getRoundTripTimeQuantile(double exceedProbability);
+
 			bool getGameStarted();
 			void setGameStarted(bool value);
 
@@ -20,6 +20,8 @@
 #include <fstream>
 #include "util.h"
 #include "network_protocol.h"
+#include "world.h"
+#include <algorithm>
 #include "leak_dumper.h"
 
 using namespace Shared::Platform;
@@ -80,33 +82,33 @@ namespace Glest {
 		}
 
 		uint32 NetworkInterface::getNetworkPlayerFactionCRC(int index) {
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(networkPlayerFactionCRCMutex, mutexOwnerId);
 
 			return networkPlayerFactionCRC[index];
 		}
 		void NetworkInterface::setNetworkPlayerFactionCRC(int index, uint32 crc) {
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(networkPlayerFactionCRCMutex, mutexOwnerId);
 
 			networkPlayerFactionCRC[index] = crc;
 		}
 
 		void NetworkInterface::addChatInfo(const ChatMsgInfo &msg) {
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(networkAccessMutex, mutexOwnerId);
 
 			chatTextList.push_back(msg);
 		}
 
 		void NetworkInterface::addMarkedCell(const MarkedCell &msg) {
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(networkAccessMutex, mutexOwnerId);
 
 			markedCellList.push_back(msg);
 		}
 		void NetworkInterface::addUnMarkedCell(const UnMarkedCell &msg) {
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(networkAccessMutex, mutexOwnerId);
 
 			unmarkedCellList.push_back(msg);
@@ -118,14 +120,14 @@ namespace Glest {
 			networkMessage->send(socket);
 		}
 
-		NetworkMessageType NetworkInterface::getNextMessageType(int waitMilliseconds) {
+		NetworkMessageType NetworkInterface::getNextMessageType(int waitMicroseconds) {
 			Socket* socket = getSocket(false);
 			int8 messageType = nmtInvalid;
 
 			/*
 				if(socket != NULL &&
-					((waitMilliseconds <= 0 && socket->hasDataToRead() == true) ||
-					 (waitMilliseconds > 0 && socket->hasDataToReadWithWait(waitMilliseconds) == true))) {
+					((waitMicroseconds <= 0 && socket->hasDataToRead() == true) ||
+					 (waitMicroseconds > 0 && socket->hasDataToReadWithWait(waitMicroseconds) == true))) {
 					//peek message type
 					int dataSize = socket->getDataToRead();
 					if(dataSize >= (int)sizeof(messageType)) {
@@ -166,8 +168,8 @@ namespace Glest {
 
 
 			if (socket != NULL &&
-				((waitMilliseconds <= 0 && socket->hasDataToRead() == true) ||
-				(waitMilliseconds > 0 && socket->hasDataToReadWithWait(waitMilliseconds) == true))) {
+				((waitMicroseconds <= 0 && socket->hasDataToRead() == true) ||
+				(waitMicroseconds > 0 && socket->hasDataToReadWithWait(waitMicroseconds) == true))) {
 				//peek message type
 				int dataSize = socket->getDataToRead();
 				if (dataSize >= (int)sizeof(messageType)) {
@@ -224,27 +226,27 @@ namespace Glest {
 		}
 
 		void NetworkInterface::setLastPingInfo(const NetworkMessagePing &ping) {
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(networkAccessMutex, mutexOwnerId);
 
 			this->lastPingInfo = ping;
 		}
 
 		void NetworkInterface::setLastPingInfoToNow() {
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(networkAccessMutex, mutexOwnerId);
 
 			this->lastPingInfo.setPingReceivedLocalTime(time(NULL));
 		}
 
 		NetworkMessagePing NetworkInterface::getLastPingInfo() {
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(networkAccessMutex, mutexOwnerId);
 
 			return lastPingInfo;
 		}
 		double NetworkInterface::getLastPingLag() {
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(networkAccessMutex, mutexOwnerId);
 
 			return difftime((long int) time(NULL), lastPingInfo.getPingReceivedLocalTime());
@@ -269,7 +271,7 @@ namespace Glest {
 		std::vector<ChatMsgInfo> NetworkInterface::getChatTextList(bool clearList) {
 			std::vector<ChatMsgInfo> result;
 
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(networkAccessMutex, mutexOwnerId);
 
 			if (chatTextList.empty() == false) {
@@ -283,7 +285,7 @@ namespace Glest {
 		}
 
 		void NetworkInterface::clearChatInfo() {
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(networkAccessMutex, mutexOwnerId);
 
 			if (chatTextList.empty() == false) {
@@ -295,7 +297,7 @@ namespace Glest {
 		std::vector<MarkedCell> NetworkInterface::getMarkedCellList(bool clearList) {
 			std::vector<MarkedCell> result;
 
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(networkAccessMutex, mutexOwnerId);
 
 			if (markedCellList.empty() == false) {
@@ -309,7 +311,7 @@ namespace Glest {
 		}
 
 		void NetworkInterface::clearMarkedCellList() {
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(networkAccessMutex, mutexOwnerId);
 
 			if (markedCellList.empty() == false) {
@@ -321,7 +323,7 @@ namespace Glest {
 		std::vector<UnMarkedCell> NetworkInterface::getUnMarkedCellList(bool clearList) {
 			std::vector<UnMarkedCell> result;
 
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(networkAccessMutex, mutexOwnerId);
 
 			if (unmarkedCellList.empty() == false) {
@@ -335,7 +337,7 @@ namespace Glest {
 		}
 
 		void NetworkInterface::clearUnMarkedCellList() {
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(networkAccessMutex, mutexOwnerId);
 
 			if (unmarkedCellList.empty() == false) {
@@ -347,7 +349,7 @@ namespace Glest {
 		std::vector<MarkedCell> NetworkInterface::getHighlightedCellList(bool clearList) {
 			std::vector<MarkedCell> result;
 
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(networkAccessMutex, mutexOwnerId);
 
 			if (highlightedCellList.empty() == false) {
@@ -361,7 +363,7 @@ namespace Glest {
 		}
 
 		void NetworkInterface::clearHighlightedCellList() {
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(networkAccessMutex, mutexOwnerId);
 
 			if (highlightedCellList.empty() == false) {
@@ -371,7 +373,7 @@ namespace Glest {
 		}
 
 		void NetworkInterface::setHighlightedCell(const MarkedCell &msg) {
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(networkAccessMutex, mutexOwnerId);
 
 			for (int idx = 0; idx < (int) highlightedCellList.size(); idx++) {
@@ -406,14 +408,65 @@ namespace Glest {
 			Mutex *mutex = getServerSynchAccessor();
 
 			if (insertAtStart == false) {
-				MutexSafeWrapper safeMutex(mutex, string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex(mutex, CODE_AT_LINE);
 				requestedCommands.push_back(*networkCommand);
 			} else {
-				MutexSafeWrapper safeMutex(mutex, string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex(mutex, CODE_AT_LINE);
 				requestedCommands.insert(requestedCommands.begin(), *networkCommand);
 			}
 		}
 
+		int GameNetworkInterface::getRequestedCommandCount() {
+			Mutex *mutex = getServerSynchAccessor();
+			MutexSafeWrapper safeMutex(mutex, CODE_AT_LINE);
+			return (int) requestedCommands.size();
+		}
+
+		static int getRequestingFactionIndex(const NetworkCommand &networkCommand, const World *world) {
+			switch (networkCommand.getNetworkCommandType()) {
+				case nctSwitchTeam:
+				case nctSwitchTeamVote:
+					// these carry the faction index in place of a unit id
+					return networkCommand.getUnitId();
+				case nctGiveCommand:
+				case nctCancelCommand:
+				case nctSetMeetingPoint:
+				{
+					const Unit *unit = world->findUnitById(networkCommand.getUnitId());
+					if (unit != NULL) {
+						return unit->getFaction()->getIndex();
+					}
+				}
+				break;
+				default:
+					break;
+			}
+			return -1;
+		}
+
+		void GameNetworkInterface::orderRequestedCommandsByFaction(int firstCommand, const World *world) {
+			Mutex *mutex = getServerSynchAccessor();
+			MutexSafeWrapper safeMutex(mutex, CODE_AT_LINE);
+			if (firstCommand < 0 || firstCommand + 1 >= (int) requestedCommands.size()) {
+				return;
+			}
+
+			// stable, each faction's commands keep the order its AI gave them in
+			std::vector<std::pair<int, int> > commandOrder;
+			commandOrder.reserve(requestedCommands.size() - firstCommand);
+			for (int i = firstCommand; i < (int) requestedCommands.size(); ++i) {
+				commandOrder.push_back(std::make_pair(getRequestingFactionIndex(requestedCommands[i], world), i));
+			}
+			std::sort(commandOrder.begin(), commandOrder.end());
+
+			Commands orderedCommands;
+			orderedCommands.reserve(commandOrder.size());
+			for (unsigned int i = 0; i < commandOrder.size(); ++i) {
+				orderedCommands.push_back(requestedCommands[commandOrder[i].second]);
+			}
+			std::copy(orderedCommands.begin(), orderedCommands.end(), requestedCommands.begin() + firstCommand);
+		}
+
 		// =====================================================
 		//	class FileTransferSocketThread
 		// =====================================================
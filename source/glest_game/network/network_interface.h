@@ -37,6 +37,8 @@ using namespace Shared::Platform;
 namespace Glest {
 	namespace Game {
 
+		class World;
+
 		// =====================================================
 		//	class NetworkInterface
 		// =====================================================
@@ -276,7 +278,7 @@ namespace Glest {
 			}
 
 			virtual void sendMessage(NetworkMessage* networkMessage);
-			NetworkMessageType getNextMessageType(int waitMilliseconds = 0);
+			NetworkMessageType getNextMessageType(int waitMicroseconds = 0);
 			bool receiveMessage(NetworkMessage* networkMessage);
 			bool receiveMessage(NetworkMessage* networkMessage, NetworkMessageType type);
 
@@ -412,6 +414,11 @@ namespace Glest {
 
 			//access functions
 			void requestCommand(const NetworkCommand *networkCommand, bool insertAtStart = false);
+			int getRequestedCommandCount();
+			// AI factions request commands from their own worker threads, this
+			// puts the commands requested from firstCommand on back into faction
+			// order so they are given the same way on every run
+			void orderRequestedCommandsByFaction(int firstCommand, const World *world);
 			int getPendingCommandCount() const {
 				return (int) pendingCommands.size();
 			}
@@ -1641,6 +1641,7 @@ namespace Glest {
 		NetworkMessageCommandList::NetworkMessageCommandList(int32 frameCount) {
 			data.messageType = nmtCommandList;
 			data.header.frameCount = frameCount;
+			data.header.commandDelay = 0;
 			data.header.commandCount = 0;
 			for (int index = 0; index < GameConstants::maxPlayers; ++index) {
 				data.header.networkPlayerFactionCRC[index] = 0;
@@ -1654,7 +1655,7 @@ namespace Glest {
 		}
 
 		const char * NetworkMessageCommandList::getPackedMessageFormatHeader() const {
-			return "cHlLLLLLLLL";
+			return "cHlHLLLLLLLL";
 		}
 
 		unsigned int NetworkMessageCommandList::getPackedSizeHeader() {
@@ -1667,6 +1668,7 @@ namespace Glest {
 					packedData.messageType,
 					packedData.header.commandCount,
 					packedData.header.frameCount,
+					packedData.header.commandDelay,
 					packedData.header.networkPlayerFactionCRC[0],
 					packedData.header.networkPlayerFactionCRC[1],
 					packedData.header.networkPlayerFactionCRC[2],
@@ -1684,6 +1686,7 @@ namespace Glest {
 				&data.messageType,
 				&data.header.commandCount,
 				&data.header.frameCount,
+				&data.header.commandDelay,
 				&data.header.networkPlayerFactionCRC[0],
 				&data.header.networkPlayerFactionCRC[1],
 				&data.header.networkPlayerFactionCRC[2],
@@ -1700,6 +1703,7 @@ namespace Glest {
 				data.messageType,
 				data.header.commandCount,
 				data.header.frameCount,
+				data.header.commandDelay,
 				data.header.networkPlayerFactionCRC[0],
 				data.header.networkPlayerFactionCRC[1],
 				data.header.networkPlayerFactionCRC[2],
@@ -1961,6 +1965,7 @@ namespace Glest {
 				data.messageType = Shared::PlatformByteOrder::toCommonEndian(data.messageType);
 				data.header.commandCount = Shared::PlatformByteOrder::toCommonEndian(data.header.commandCount);
 				data.header.frameCount = Shared::PlatformByteOrder::toCommonEndian(data.header.frameCount);
+				data.header.commandDelay = Shared::PlatformByteOrder::toCommonEndian(data.header.commandDelay);
 				for (int index = 0; index < GameConstants::maxPlayers; ++index) {
 					data.header.networkPlayerFactionCRC[index] = Shared::PlatformByteOrder::toCommonEndian(data.header.networkPlayerFactionCRC[index]);
 				}
@@ -1972,6 +1977,7 @@ namespace Glest {
 				data.messageType = Shared::PlatformByteOrder::fromCommonEndian(data.messageType);
 				data.header.commandCount = Shared::PlatformByteOrder::fromCommonEndian(data.header.commandCount);
 				data.header.frameCount = Shared::PlatformByteOrder::fromCommonEndian(data.header.frameCount);
+				data.header.commandDelay = Shared::PlatformByteOrder::fromCommonEndian(data.header.commandDelay);
 				for (int index = 0; index < GameConstants::maxPlayers; ++index) {
 					data.header.networkPlayerFactionCRC[index] = Shared::PlatformByteOrder::fromCommonEndian(data.header.networkPlayerFactionCRC[index]);
 				}
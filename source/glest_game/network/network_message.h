@@ -291,6 +291,10 @@ namespace Glest {
 				return nmtPing;
 			}
 
+			// ping frequency of a ping the receiver sends straight back,
+			// so the sender can time the round trip
+			static const int32 echoRequest = -1;
+
 			int32 getPingFrequency() const {
 				return data.pingFrequency;
 			}
@@ -486,6 +490,8 @@ namespace Glest {
 
 				uint16 commandCount;
 				int32 frameCount;
+				// frames between the keyframe the list was made on and frameCount
+				uint16 commandDelay;
 				uint32 networkPlayerFactionCRC[GameConstants::maxPlayers];
 			};
 
@@ -500,6 +506,7 @@ namespace Glest {
 				data_ref.messageType = 0;
 				data_ref.header.commandCount = 0;
 				data_ref.header.frameCount = 0;
+				data_ref.header.commandDelay = 0;
 				for (int index = 0; index < GameConstants::maxPlayers; ++index) {
 					data_ref.header.networkPlayerFactionCRC[index] = 0;
 				}
@@ -558,6 +565,12 @@ namespace Glest {
 			int getFrameCount() const {
 				return data.header.frameCount;
 			}
+			int getCommandDelay() const {
+				return data.header.commandDelay;
+			}
+			void setCommandDelay(int value) {
+				data.header.commandDelay = value;
+			}
 			uint32 getNetworkPlayerFactionCRC(int index) const {
 				return data.header.networkPlayerFactionCRC[index];
 			}
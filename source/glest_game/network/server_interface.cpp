@@ -34,7 +34,9 @@
 #include "util.h"
 #include "game_util.h"
 #include "miniftpserver.h"
+#include "content_sync.h"
 #include "map_preview.h"
+#include "map_info_index.h"
 #include "stats.h"
 #include <time.h>
 #include <set>
@@ -69,7 +71,7 @@ namespace Glest {
 			switchSetupRequestsSynchAccessor = new Mutex(CODE_AT_LINE);
 
 			for (int index = 0; index < GameConstants::maxPlayers; ++index) {
-				slotAccessorMutexes[index] = new Mutex(CODE_AT_LINE);
+				slotAccessorMutexes[index] = new Mutex(CODE_AT_LINE_X(slotAccessorMutexes));
 			}
 			masterServerThreadAccessor = new Mutex(CODE_AT_LINE);
 			textMessageQueueThreadAccessor = new Mutex(CODE_AT_LINE);
@@ -88,8 +90,10 @@ namespace Glest {
 			lastMasterserverHeartbeatTime = 0;
 			needToRepublishToMasterserver = false;
 			ftpServer = NULL;
+			contentSyncServer = NULL;
 			inBroadcastMessage = false;
 			lastGlobalLagCheckTime = 0;
+			lastCommandListFrame = -1;
 			masterserverAdminRequestLaunch = false;
 			lastListenerSlotCheckTime = 0;
 
@@ -236,11 +240,27 @@ namespace Glest {
 					allowInternetTechtreeFileTransfers, portNumber, GameConstants::maxPlayers,
 					this, tempFilePath);
 				ftpServer->start();
+
+				if (Config::getInstance().getBool("EnableContentDeltaSync", "false") == true) {
+					contentSyncServer = new ContentSyncServerThread(portNumber + ContentSyncServerThread::ftpPortOffset, this);
+					// user data first, that is where clients download to
+					contentSyncServer->addFolder(csit_Map, mapsPath.second);
+					contentSyncServer->addFolder(csit_Map, mapsPath.first);
+					if (allowInternetTilesetFileTransfers == true) {
+						contentSyncServer->addFolder(csit_Tileset, tilesetsPath.second);
+						contentSyncServer->addFolder(csit_Tileset, tilesetsPath.first);
+					}
+					if (allowInternetTechtreeFileTransfers == true) {
+						contentSyncServer->addFolder(csit_Techtree, techtreesPath.second);
+						contentSyncServer->addFolder(csit_Techtree, techtreesPath.first);
+					}
+					contentSyncServer->start();
+				}
 			}
 
 			if (publishToMasterserverThread == NULL) {
 				if (needToRepublishToMasterserver == true || GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
-					static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+					static const char *mutexOwnerId = CODE_AT_LINE;
 					publishToMasterserverThread = new SimpleTaskThread(this, 0, 125);
 					publishToMasterserverThread->setUniqueID(mutexOwnerId);
 					publishToMasterserverThread->start();
@@ -281,6 +301,12 @@ namespace Glest {
 
 			masterController.clearSlaves(true);
 			exitServer = true;
+
+			if (slotWaitTimes.getCount() > 0) {
+				if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "Server waits for slot threads: %s\n", slotWaitTimes.getReport("updates").c_str());
+				if (SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled) SystemFlags::OutputDebug(SystemFlags::debugPerformance, "Server waits for slot threads: %s\n", slotWaitTimes.getReport("updates").c_str());
+			}
+
 			for (int index = 0; index < GameConstants::maxPlayers; ++index) {
 				if (slots[index] != NULL) {
 					MutexSafeWrapper safeMutex(slotAccessorMutexes[index], CODE_AT_LINE_X(index));
@@ -1011,6 +1037,10 @@ namespace Glest {
 			for (bool threadsDone = false; exitServer == false && threadsDone == false &&
 				waitForThreadElapsed.getMillis() <= MAX_SLOT_THREAD_WAIT_TIME_MILLISECONDS;) {
 
+				// drop wakeups already accounted for by the checks below, so
+				// the wait only returns early for completions after them
+				while (slotTasksCompleted.tryDecrement() == true) {
+				}
 				threadsDone = true;
 				// Examine all threads for completion of delegation
 				for (int index = 0; exitServer == false && index < GameConstants::maxPlayers; ++index) {
@@ -1053,7 +1083,12 @@ namespace Glest {
 						}
 					}
 				}
+				if (threadsDone == false) {
+					// sleep until a slot thread reports back instead of spinning
+					slotTasksCompleted.waitTillSignalled(SLOT_THREAD_COMPLETED_WAIT_MILLISECONDS);
+				}
 			}
+			slotWaitTimes.add(waitForThreadElapsed.getMicros());
 		}
 
 		std::string ServerInterface::getIpAddress(bool mutexLock) {
@@ -1135,6 +1170,8 @@ namespace Glest {
 					exitServer == false && threadsDone == false &&
 					waitForThreadElapsed.getMillis() <= MAX_SLOT_THREAD_WAIT_TIME_MILLISECONDS;) {
 
+					while (slotTasksCompleted.tryDecrement() == true) {
+					}
 					threadsDone = true;
 					// Examine all threads for completion of delegation
 					for (int index = 0; exitServer == false && index < GameConstants::maxPlayers; ++index) {
@@ -1251,6 +1288,9 @@ namespace Glest {
 
 						//printf("#5 Check lag for i: %d\n",i);
 					}
+					if (threadsDone == false) {
+						slotTasksCompleted.waitTillSignalled(SLOT_THREAD_COMPLETED_WAIT_MILLISECONDS);
+					}
 				}
 			}
 			if (lastGlobalLagCheckTimeUpdate == true) {
@@ -1658,16 +1698,49 @@ namespace Glest {
 			currentFrameCount = frameCount;
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s Line: %d] currentFrameCount = %d, requestedCommands.size() = %d\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, currentFrameCount, requestedCommands.size());
 
-			NetworkMessageCommandList networkMessageCommandList(frameCount);
+			int framePeriod = gameSettings.getNetworkFramePeriod();
+			if (commandDelay.isEnabled() == true) {
+				// time the round trip to every client
+				NetworkMessagePing networkMessagePing(NetworkMessagePing::echoRequest, LatencyEstimator::getCurrentMicros());
+				broadcastMessage(&networkMessagePing);
+			}
+			int delayFrames = commandDelay.update(getSlowestClientLatency());
+			int commandFrame = frameCount + delayFrames;
+			int nextCommandListFrame = frameCount;
+			if (commandDelay.isEnabled() == true) {
+				nextCommandListFrame = max(lastCommandListFrame + framePeriod, frameCount);
+			}
+
+			// a growing delay skips keyframes, clients still need a list for them
+			for (; nextCommandListFrame < commandFrame; nextCommandListFrame += framePeriod) {
+				NetworkMessageCommandList networkMessageCommandList(nextCommandListFrame);
+				networkMessageCommandList.setCommandDelay(nextCommandListFrame - frameCount);
+				for (int index = 0; index < GameConstants::maxPlayers; ++index) {
+					networkMessageCommandList.setNetworkPlayerFactionCRC(index, this->getNetworkPlayerFactionCRC(index));
+				}
+				broadcastMessage(&networkMessageCommandList);
+				lastCommandListFrame = nextCommandListFrame;
+			}
+			// a shrinking delay finds the list for this keyframe already sent,
+			// requested commands wait for the next keyframe
+			if (commandFrame < nextCommandListFrame) {
+				giveScheduledCommands(frameCount);
+				return;
+			}
+			lastCommandListFrame = commandFrame;
+
+			NetworkMessageCommandList networkMessageCommandList(commandFrame);
+			networkMessageCommandList.setCommandDelay(delayFrames);
 			for (int index = 0; index < GameConstants::maxPlayers; ++index) {
 				networkMessageCommandList.setNetworkPlayerFactionCRC(index, this->getNetworkPlayerFactionCRC(index));
 			}
 
+			Commands &frameCommands = scheduledCommands[commandFrame];
 			while (requestedCommands.empty() == false) {
 				// First add the command to the broadcast list (for all clients)
 				if (networkMessageCommandList.addCommand(&requestedCommands.back())) {
 					// Add the command to the local server command list
-					pendingCommands.push_back(requestedCommands.back());
+					frameCommands.push_back(requestedCommands.back());
 					requestedCommands.pop_back();
 				} else {
 					break;
@@ -1724,6 +1797,29 @@ namespace Glest {
 				if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s Line: %d] error detected [%s]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, ex.what());
 				DisplayErrorMessage(ex.what());
 			}
+			giveScheduledCommands(frameCount);
+		}
+
+		int64 ServerInterface::getSlowestClientLatency() {
+			int64 result = 0;
+			for (int index = 0; index < GameConstants::maxPlayers; ++index) {
+				MutexSafeWrapper safeMutexSlot(slotAccessorMutexes[index], CODE_AT_LINE_X(index));
+				ConnectionSlot *connectionSlot = slots[index];
+				if (connectionSlot != NULL && connectionSlot->isConnected() == true) {
+					// one way is half the round trip
+					int64 roundTrip = connectionSlot->getRoundTripTimeQuantile(CommandDelayController::stallProbability);
+					result = max(result, roundTrip / 2);
+				}
+			}
+			return result;
+		}
+
+		void ServerInterface::giveScheduledCommands(int frameCount) {
+			std::map<int, Commands>::iterator iterFind = scheduledCommands.find(frameCount);
+			if (iterFind != scheduledCommands.end()) {
+				pendingCommands.insert(pendingCommands.end(), iterFind->second.begin(), iterFind->second.end());
+				scheduledCommands.erase(iterFind);
+			}
 		}
 
 		bool ServerInterface::shouldDiscardNetworkMessage(NetworkMessageType networkMessageType,
@@ -1899,6 +1995,11 @@ namespace Glest {
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s] START\n", __FUNCTION__);
 			Logger & logger = Logger::getInstance();
 			gameHasBeenInitiated = true;
+			// clients joining a running game would miss the lists sent ahead
+			commandDelay.init(Config::getInstance().getBool("NetworkAdaptiveCommandDelay", "false") == true &&
+				allowInGameConnections == false, gameSettings.getNetworkFramePeriod());
+			lastCommandListFrame = -1;
+			scheduledCommands.clear();
 			Chrono chrono;
 			chrono.start();
 
@@ -2390,7 +2491,7 @@ namespace Glest {
 					if (needToRepublishToMasterserver == true ||
 						GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
 
-						static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+						static const char *mutexOwnerId = CODE_AT_LINE;
 						publishToMasterserverThread = new SimpleTaskThread(this, 0, 125);
 						publishToMasterserverThread->setUniqueID(mutexOwnerId);
 						publishToMasterserverThread->start();
@@ -2423,6 +2524,11 @@ namespace Glest {
 				delete ftpServer;
 				ftpServer = NULL;
 			}
+			if (contentSyncServer != NULL) {
+				contentSyncServer->shutdownAndWait();
+				delete contentSyncServer;
+				contentSyncServer = NULL;
+			}
 		}
 
 		void ServerInterface::checkListenerSlots() {
@@ -2657,10 +2763,8 @@ namespace Glest {
 				printf("map %s not found on this server. Switching to map %s\n", serverGameSettings->getMap().c_str(), foundMap.c_str());
 				serverGameSettings->setMap(foundMap);
 			}
-			Checksum checksum;
 			string file = Config::getMapPath(serverGameSettings->getMap(), "", false);
-			checksum.addFile(file);
-			serverGameSettings->setMapCRC(checksum.getSum());
+			serverGameSettings->setMapCRC(MapInfoIndex::getCRC(file));
 
 			string tilesetFile = serverGameSettings->getTileset();
 			if (find(tilesetFiles.begin(), tilesetFiles.end(), tilesetFile) == tilesetFiles.end()) {
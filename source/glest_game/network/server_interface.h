@@ -32,15 +32,20 @@
 #include "game_constants.h"
 #include "network_interface.h"
 #include "connection_slot.h"
+#include "command_delay.h"
 #include "socket.h"
+#include "time_histogram.h"
 #include "leak_dumper.h"
 
 using std::vector;
 using Shared::Platform::ServerSocket;
+using Shared::Platform::Semaphore;
+using Shared::Util::TimeHistogram;
 
 namespace Shared {
 	namespace PlatformCommon {
 		class FTPServerThread;
+		class ContentSyncServerThread;
 	}
 }
 
@@ -59,6 +64,8 @@ namespace Glest {
 		const int MAX_CLIENT_WAIT_SECONDS_FOR_PAUSE_MILLISECONDS = 15000;
 		const int MAX_CLIENT_PAUSE_FOR_LAG_COUNT = 5;
 		const int MAX_SLOT_THREAD_WAIT_TIME_MILLISECONDS = 1500;
+		// longest sleep between checks while slot threads are busy
+		const int SLOT_THREAD_COMPLETED_WAIT_MILLISECONDS = 5;
 		const int MASTERSERVER_HEARTBEAT_GAME_STATUS_SECONDS = 30;
 
 		const int MAX_EMPTY_NETWORK_COMMAND_LIST_BROADCAST_INTERVAL_MILLISECONDS = 4000;
@@ -104,6 +111,7 @@ namespace Glest {
 			bool needToRepublishToMasterserver;
 
 			::Shared::PlatformCommon::FTPServerThread *ftpServer;
+			::Shared::PlatformCommon::ContentSyncServerThread *contentSyncServer;
 			bool exitServer;
 			int64 nextEventId;
 
@@ -145,6 +153,18 @@ namespace Glest {
 			Chrono lastBroadcastCommandsTimer;
 			ClientLagCallbackInterface *clientLagCallbackInterface;
 
+			// signalled by slot threads as they finish their events
+			Semaphore slotTasksCompleted;
+			// how long each update waited for the slot threads
+			TimeHistogram slotWaitTimes;
+
+			// how far ahead of the current frame command lists are scheduled
+			CommandDelayController commandDelay;
+			// frame the newest broadcast command list runs on
+			int lastCommandListFrame;
+			// broadcast commands by the frame they run on
+			std::map<int, Commands> scheduledCommands;
+
 		public:
 			ServerInterface(bool publishEnabled, ClientLagCallbackInterface *clientLagCallbackInterface);
 			virtual ~ServerInterface();
@@ -242,6 +262,9 @@ namespace Glest {
 
 			virtual void slotUpdateTask(ConnectionSlotEvent *event) {
 			};
+			virtual void slotTaskCompleted(int index) {
+				slotTasksCompleted.signal();
+			}
 			bool hasClientConnection();
 			virtual bool isClientConnected(int index);
 
@@ -324,6 +347,8 @@ namespace Glest {
 			void checkForAutoPauseForLaggingClient(int index,
 				ConnectionSlot* connectionSlot);
 			void checkForAutoResumeForLaggingClients();
+			int64 getSlowestClientLatency();
+			void giveScheduledCommands(int frameCount);
 
 		protected:
 			void signalClientsToRecieveData(std::map<PLATFORM_SOCKET, bool> & socketTriggeredList, std::map<int, ConnectionSlotEvent> & eventList, std::map<int, bool> & mapSlotSignalledList);
@@ -56,7 +56,7 @@ namespace Glest {
 			cleanup();
 			stopAllSounds();
 
-			MutexSafeWrapper safeMutex(NULL, string(__FILE__) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutex(NULL, CODE_AT_LINE);
 			if (runThreadSafe == true) {
 				safeMutex.setMutex(mutex);
 			}
@@ -70,6 +70,11 @@ namespace Glest {
 			}
 			safeMutex.ReleaseLock();
 
+			// Decoded static sounds beyond this size are dropped least recently
+			// played first and decoded again when next played
+			int soundCacheMemoryMB = config.getInt("SoundCacheMemoryMB", "96");
+			StaticSoundCache::getInstance().setMaxDecodedBytes((std::size_t)max(0, soundCacheMemoryMB) * 1024 * 1024);
+
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s %d]\n", __FILE__, __FUNCTION__, __LINE__);
 
 			return wasInitOk();
@@ -82,7 +87,7 @@ namespace Glest {
 
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s %d]\n", __FILE__, __FUNCTION__, __LINE__);
 
-			MutexSafeWrapper safeMutex(NULL, string(__FILE__) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutex(NULL, CODE_AT_LINE);
 			if (runThreadSafe == true) {
 				safeMutex.setMutex(mutex);
 			}
@@ -124,7 +129,7 @@ namespace Glest {
 
 		void SoundRenderer::update() {
 			if (wasInitOk() == true && soundPlayer != NULL) {
-				MutexSafeWrapper safeMutex(NULL, string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex(NULL, CODE_AT_LINE);
 				if (runThreadSafe == true) {
 					safeMutex.setMutex(mutex);
 				}
@@ -141,7 +146,7 @@ namespace Glest {
 				strSound->setVolume(musicVolume);
 				strSound->restart();
 				if (soundPlayer != NULL) {
-					MutexSafeWrapper safeMutex(NULL, string(__FILE__) + "_" + intToStr(__LINE__));
+					MutexSafeWrapper safeMutex(NULL, CODE_AT_LINE);
 					if (runThreadSafe == true) {
 						safeMutex.setMutex(mutex);
 					}
@@ -161,7 +166,7 @@ namespace Glest {
 
 		void SoundRenderer::stopMusic(StrSound *strSound) {
 			if (soundPlayer != NULL) {
-				MutexSafeWrapper safeMutex(NULL, string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex(NULL, CODE_AT_LINE);
 				if (runThreadSafe == true) {
 					safeMutex.setMutex(mutex);
 				}
@@ -190,7 +195,7 @@ namespace Glest {
 					staticSound->setVolume(correctedVol);
 
 					if (soundPlayer != NULL) {
-						MutexSafeWrapper safeMutex(NULL, string(__FILE__) + "_" + intToStr(__LINE__));
+						MutexSafeWrapper safeMutex(NULL, CODE_AT_LINE);
 						if (runThreadSafe == true) {
 							safeMutex.setMutex(mutex);
 						}
@@ -207,7 +212,7 @@ namespace Glest {
 			if (staticSound != NULL) {
 				staticSound->setVolume(fxVolume);
 				if (soundPlayer != NULL) {
-					MutexSafeWrapper safeMutex(NULL, string(__FILE__) + "_" + intToStr(__LINE__));
+					MutexSafeWrapper safeMutex(NULL, CODE_AT_LINE);
 					if (runThreadSafe == true) {
 						safeMutex.setMutex(mutex);
 					}
@@ -225,7 +230,7 @@ namespace Glest {
 			if (strSound != NULL) {
 				strSound->setVolume(ambientVolume);
 				if (soundPlayer != NULL) {
-					MutexSafeWrapper safeMutex(NULL, string(__FILE__) + "_" + intToStr(__LINE__));
+					MutexSafeWrapper safeMutex(NULL, CODE_AT_LINE);
 					if (runThreadSafe == true) {
 						safeMutex.setMutex(mutex);
 					}
@@ -239,7 +244,7 @@ namespace Glest {
 
 		void SoundRenderer::stopAmbient(StrSound *strSound) {
 			if (soundPlayer != NULL) {
-				MutexSafeWrapper safeMutex(NULL, string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex(NULL, CODE_AT_LINE);
 				if (runThreadSafe == true) {
 					safeMutex.setMutex(mutex);
 				}
@@ -254,7 +259,7 @@ namespace Glest {
 
 		void SoundRenderer::stopAllSounds(int64 fadeOff) {
 			if (soundPlayer != NULL) {
-				MutexSafeWrapper safeMutex(NULL, string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex(NULL, CODE_AT_LINE);
 				if (runThreadSafe == true) {
 					safeMutex.setMutex(mutex);
 				}
@@ -27,6 +27,22 @@ namespace Glest {
 		// =====================================================
 		//      class Command
 		// =====================================================
+#ifndef SL_LEAK_DUMP
+		// every order given to every unit allocates one
+		static ObjectPool & getCommandPool() {
+			static ObjectPool pool(sizeof(Command), 256);
+			return pool;
+		}
+
+		void *Command::operator new(size_t size) {
+			return getCommandPool().allocate(size);
+		}
+
+		void Command::operator delete(void *command, size_t size) {
+			getCommandPool().release(command, size);
+		}
+#endif
+
 		Command::Command() :unitRef() {
 			this->commandType = NULL;
 			unitType = NULL;
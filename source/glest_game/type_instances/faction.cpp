@@ -166,8 +166,7 @@ namespace Glest {
 
 		void Faction::sortUnitsByCommandGroups() {
 			MutexSafeWrapper safeMutex(unitsMutex,
-				string(__FILE__) + "_" +
-				intToStr(__LINE__));
+				CODE_AT_LINE);
 			//printf("====== sortUnitsByCommandGroups for faction # %d [%s] unitCount = %d\n",this->getIndex(),this->getType()->getName().c_str(),units.size());
 			//for(unsigned int i = 0; i < units.size(); ++i) {
 			//      printf("%d / %d [%p] <>",i,units.size(),&units[i]);
@@ -266,8 +265,7 @@ namespace Glest {
 
 		void FactionThread::signalPathfinder(int frameIndex) {
 			if (frameIndex >= 0) {
-				static string mutexOwnerId =
-					string(__FILE__) + string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				MutexSafeWrapper safeMutex(triggerIdMutex, mutexOwnerId);
 				this->frameIndex.first = frameIndex;
 				this->frameIndex.second = false;
@@ -279,8 +277,7 @@ namespace Glest {
 
 		void FactionThread::setTaskCompleted(int frameIndex) {
 			if (frameIndex >= 0) {
-				static string mutexOwnerId =
-					string(__FILE__) + string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				MutexSafeWrapper safeMutex(triggerIdMutex, mutexOwnerId);
 				if (this->frameIndex.first == frameIndex) {
 					this->frameIndex.second = true;
@@ -304,8 +301,7 @@ namespace Glest {
 			if (getRunningStatus() == false) {
 				return true;
 			}
-			static string mutexOwnerId =
-				string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(triggerIdMutex, mutexOwnerId);
 			//bool result = (event != NULL ? event->eventCompleted : true);
 			bool result = (this->frameIndex.first == frameIndex
@@ -367,8 +363,7 @@ namespace Glest {
 						break;
 					}
 
-					static string mutexOwnerId =
-						string(__FILE__) + string("_") + intToStr(__LINE__);
+					static const char *mutexOwnerId = CODE_AT_LINE;
 					MutexSafeWrapper safeMutex(triggerIdMutex, mutexOwnerId);
 					bool executeTask = (this->frameIndex.first >= 0);
 					int currentTriggeredFrameIndex = this->frameIndex.first;
@@ -404,8 +399,7 @@ namespace Glest {
 						//}
 
 						codeLocation = "8";
-						static string mutexOwnerId2 =
-							string(__FILE__) + string("_") + intToStr(__LINE__);
+						static const char *mutexOwnerId2 = CODE_AT_LINE;
 						MutexSafeWrapper safeMutex(faction->getUnitMutex(),
 							mutexOwnerId2);
 
@@ -595,7 +589,7 @@ namespace Glest {
 		}
 
 		void Faction::init() {
-			unitsMutex = new Mutex(CODE_AT_LINE);
+			unitsMutex = new Mutex(CODE_AT_LINE_X(unitsMutex));
 			texture = NULL;
 			//lastResourceTargettListPurge = 0;
 			cachingDisabled = false;
@@ -654,10 +648,11 @@ namespace Glest {
 			}
 
 			MutexSafeWrapper safeMutex(unitsMutex,
-				string(__FILE__) + "_" +
-				intToStr(__LINE__));
+				CODE_AT_LINE);
 			deleteValues(units.begin(), units.end());
 			units.clear();
+			unitMap.clear();
+			unitSlots.clear();
 
 			safeMutex.ReleaseLock();
 
@@ -695,10 +690,11 @@ namespace Glest {
 			}
 
 			MutexSafeWrapper safeMutex(unitsMutex,
-				string(__FILE__) + "_" +
-				intToStr(__LINE__));
+				CODE_AT_LINE);
 			deleteValues(units.begin(), units.end());
 			units.clear();
+			unitMap.clear();
+			unitSlots.clear();
 
 			safeMutex.ReleaseLock();
 
@@ -924,9 +920,7 @@ namespace Glest {
 					}
 					workerThread = NULL;
 				}
-				static string mutexOwnerId =
-					string(extractFileFromDirectoryPath(__FILE__).c_str()) +
-					string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				this->workerThread = new FactionThread(this);
 				this->workerThread->setUniqueID(mutexOwnerId);
 				this->workerThread->start();
@@ -1607,16 +1601,15 @@ namespace Glest {
 
 		void Faction::addUnit(Unit * unit) {
 			MutexSafeWrapper safeMutex(unitsMutex,
-				string(__FILE__) + "_" +
-				intToStr(__LINE__));
+				CODE_AT_LINE);
 			units.push_back(unit);
 			unitMap[unit->getId()] = unit;
+			unit->setSlotHandle(unitSlots.add(unit));
 		}
 
 		void Faction::removeUnit(Unit * unit) {
 			MutexSafeWrapper safeMutex(unitsMutex,
-				string(__FILE__) + "_" +
-				intToStr(__LINE__));
+				CODE_AT_LINE);
 
 			assert(units.size() == unitMap.size());
 
@@ -1625,6 +1618,8 @@ namespace Glest {
 				if (units[i]->getId() == unitId) {
 					units.erase(units.begin() + i);
 					unitMap.erase(unitId);
+					unitSlots.remove(unit->getSlotHandle());
+					unit->setSlotHandle(SlotHandle());
 					assert(units.size() == unitMap.size());
 					return;
 				}
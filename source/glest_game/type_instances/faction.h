@@ -19,6 +19,7 @@
 
 #   include <vector>
 #   include <map>
+#   include <unordered_map>
 #   include "upgrade.h"
 #   include "texture.h"
 #   include "resource.h"
@@ -27,6 +28,7 @@
 #   include "base_thread.h"
 #   include <set>
 #   include "faction_type.h"
+#   include "object_pool.h"
 #   include "leak_dumper.h"
 
 using std::map;
@@ -34,6 +36,8 @@ using std::vector;
 using std::set;
 
 using Shared::Graphics::Texture2D;
+using Shared::Util::SlotHandle;
+using Shared::Util::SlotTable;
 using namespace Shared::PlatformCommon;
 
 namespace Glest {
@@ -66,8 +70,9 @@ namespace Glest {
 				ExploredCellsLookupItemCacheTimerCountIndex = 0;
 			}
 			int ExploredCellsLookupItemCacheTimerCountIndex;
-			std::vector < SurfaceCell * >exploredCellList;
-			std::vector < SurfaceCell * >visibleCellList;
+			// surface cell indices, see Map::getSurfaceCellIndex
+			std::vector < int >exploredCellList;
+			std::vector < int >visibleCellList;
 
 			static time_t lastDebug;
 		};
@@ -134,7 +139,7 @@ namespace Glest {
 			typedef vector < Resource > Store;
 			typedef vector < Faction * >Allies;
 			typedef vector < Unit * >Units;
-			typedef map < int, Unit * >UnitMap;
+			typedef std::unordered_map < int, Unit * >UnitMap;
 
 		private:
 			UpgradeManager upgradeManager;
@@ -146,6 +151,7 @@ namespace Glest {
 			Mutex *unitsMutex;
 			Units units;
 			UnitMap unitMap;
+			SlotTable < Unit > unitSlots;
 			World *world;
 			ScriptManager *scriptManager;
 
@@ -402,6 +408,10 @@ namespace Glest {
 
 			//other
 			Unit *findUnit(int id) const;
+			// NULL once the unit left the faction
+			inline Unit *findUnit(const SlotHandle &handle) const {
+				return unitSlots.get(handle);
+			}
 			void addUnit(Unit * unit);
 			void removeUnit(Unit * unit);
 			void addStore(const UnitType * unitType);
@@ -50,6 +50,28 @@ namespace Glest {
 		std::map < UnitPathInterface *, int >Unit::mapMemoryList2;
 #endif
 
+#ifndef SL_LEAK_DUMP
+		// units and their paths come and go by the hundred in big battles,
+		// so they are carved out of pooled chunks instead of the heap
+		static ObjectPool & getUnitPool() {
+			static ObjectPool pool(sizeof(Unit), 64);
+			return pool;
+		}
+
+		static ObjectPool & getUnitPathPool() {
+			static ObjectPool pool(sizeof(UnitPathBasic), 64);
+			return pool;
+		}
+
+		void *UnitPathBasic::operator new(size_t size) {
+			return getUnitPathPool().allocate(size);
+		}
+
+		void UnitPathBasic::operator delete(void *path, size_t size) {
+			getUnitPathPool().release(path, size);
+		}
+#endif
+
 		UnitPathBasic::UnitPathBasic() :UnitPathInterface() {
 #ifdef LEAK_CHECK_UNITS
 			UnitPathBasic::mapMemoryList[this] = true;
@@ -265,9 +287,11 @@ namespace Glest {
 			if (unit == NULL) {
 				id = -1;
 				faction = NULL;
+				handle = SlotHandle();
 			} else {
 				id = unit->getId();
 				faction = unit->getFaction();
+				handle = unit->getSlotHandle();
 			}
 
 			return *this;
@@ -275,6 +299,11 @@ namespace Glest {
 
 		Unit *UnitReference::getUnit() const {
 			if (faction != NULL) {
+				// a live handle can only point at the referenced unit
+				Unit *unit = faction->findUnit(handle);
+				if (unit != NULL) {
+					return unit;
+				}
 				return faction->findUnit(id);
 			}
 			return NULL;
@@ -296,6 +325,7 @@ namespace Glest {
 			const XmlNode *unitRefNode = rootNode->getChild("UnitReference");
 
 			id = unitRefNode->getAttribute("id")->getIntValue();
+			handle = SlotHandle();
 			if (unitRefNode->hasAttribute("factionIndex") == true) {
 				int factionIndex =
 					unitRefNode->getAttribute("factionIndex")->getIntValue();
@@ -674,6 +704,14 @@ namespace Glest {
 			rotationZ = .0f;
 			rotationX = .0f;
 
+			crcLevel = NULL;
+			crcPreMorphType = NULL;
+			crcType = NULL;
+			crcLoadType = NULL;
+			crcCurrSkill = NULL;
+			crcTypeNamesSum = 0;
+			crcTypeNamesValid = false;
+
 			this->fire = NULL;
 			this->unitPath = unitpath;
 			this->unitPath->setMap(map);
@@ -779,7 +817,7 @@ namespace Glest {
 			calculateFogOfWarRadius();
 
 			//      if(isUnitDeleted(this) == true) {
-			//              MutexSafeWrapper safeMutex(&mutexDeletedUnits,string(__FILE__) + "_" + intToStr(__LINE__));
+			//              MutexSafeWrapper safeMutex(&mutexDeletedUnits,CODE_AT_LINE);
 			//              deletedUnits.erase(this);
 			//      }
 
@@ -794,8 +832,7 @@ namespace Glest {
 			this->faction->deleteLivingUnitsp(this);
 
 			//remove commands
-			static string mutexOwnerId =
-				string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexCommands, mutexOwnerId);
 
 			changedActiveCommand = false;
@@ -835,7 +872,7 @@ namespace Glest {
 				game->removeUnitFromSelection(this);
 			}
 
-			//MutexSafeWrapper safeMutex1(&mutexDeletedUnits,string(__FILE__) + "_" + intToStr(__LINE__));
+			//MutexSafeWrapper safeMutex1(&mutexDeletedUnits,CODE_AT_LINE);
 			//deletedUnits[this]=true;
 
 			delete mutexCommands;
@@ -846,6 +883,16 @@ namespace Glest {
 #endif
 		}
 
+#ifndef SL_LEAK_DUMP
+		void *Unit::operator new(size_t size) {
+			return getUnitPool().allocate(size);
+		}
+
+		void Unit::operator delete(void *unit, size_t size) {
+			getUnitPool().release(unit, size);
+		}
+#endif
+
 		void Unit::cleanupAllParticlesystems() {
 
 			Renderer::
@@ -1000,7 +1047,7 @@ namespace Glest {
 
 		//bool Unit::isUnitDeleted(void *unit) {
 		//      bool result = false;
-		//      MutexSafeWrapper safeMutex(&mutexDeletedUnits,string(__FILE__) + "_" + intToStr(__LINE__));
+		//      MutexSafeWrapper safeMutex(&mutexDeletedUnits,CODE_AT_LINE);
 		//      if(deletedUnits.find(unit) != deletedUnits.end()) {
 		//              result = true;
 		//      }
@@ -1026,8 +1073,7 @@ namespace Glest {
 		// ====================================== get ======================================
 
 		Vec2i Unit::getCenteredPos() const {
-			static string mutexOwnerId =
-				string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexCommands, mutexOwnerId);
 
 			if (type == NULL) {
@@ -1043,8 +1089,7 @@ namespace Glest {
 		}
 
 		Vec2f Unit::getFloatCenteredPos() const {
-			static string mutexOwnerId =
-				string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexCommands, mutexOwnerId);
 
 			if (type == NULL) {
@@ -1607,8 +1652,7 @@ namespace Glest {
 					pos.getString());
 			}
 
-			static string mutexOwnerId =
-				string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexCommands, mutexOwnerId);
 
 			if (threaded) {
@@ -1695,8 +1739,7 @@ namespace Glest {
 			if (game->getWorld()->getFogOfWar() == true) {
 				if (forceRefresh || this->pos != this->cachedFowPos) {
 					cachedFow = getFogOfWarRadius(false);
-					static string mutexOwnerId =
-						string(__FILE__) + string("_") + intToStr(__LINE__);
+					static const char *mutexOwnerId = CODE_AT_LINE;
 					MutexSafeWrapper safeMutex(mutexCommands, mutexOwnerId);
 					this->cachedFowPos = this->pos;
 				}
@@ -1894,6 +1937,86 @@ namespace Glest {
 			return result;
 		}
 
+		void Unit::placeParticleSystems(const Vec3f &offset, float rotation) {
+			if (Renderer::
+				getInstance().validateParticleSystemStillExists(this->fire,
+					rsGame) == false) {
+				this->fire = NULL;
+			}
+
+			if (this->fire != NULL) {
+				this->fire->setPos(getCurrBurnVector() + offset);
+			}
+			for (UnitParticleSystems::iterator it = unitParticleSystems.begin();
+				it != unitParticleSystems.end(); ++it) {
+				if (Renderer::
+					getInstance().validateParticleSystemStillExists((*it),
+						rsGame) == true) {
+					(*it)->setPos(getCurrVectorForParticlesystems() + offset);
+					(*it)->setRotation(rotation);
+					setMeshPosInParticleSystem(*it);
+				}
+			}
+			for (UnitParticleSystems::iterator it = damageParticleSystems.begin();
+				it != damageParticleSystems.end(); ++it) {
+				if (Renderer::
+					getInstance().validateParticleSystemStillExists((*it),
+						rsGame) == true) {
+					(*it)->setPos(getCurrVectorForParticlesystems() + offset);
+					(*it)->setRotation(rotation);
+					setMeshPosInParticleSystem(*it);
+				}
+			}
+
+			for (UnitParticleSystems::iterator it = smokeParticleSystems.begin();
+				it != smokeParticleSystems.end(); ++it) {
+				if (Renderer::
+					getInstance().validateParticleSystemStillExists((*it),
+						rsGame) == true) {
+					(*it)->setPos(getCurrMidHeightVector() + offset);
+					(*it)->setRotation(rotation);
+					setMeshPosInParticleSystem(*it);
+				}
+			}
+
+			//printf("Unit has attack boost? unit = [%d - %s] size = %d\n",this->getId(), this->getType()->getName(false).c_str(),(int)currentAttackBoostEffects.size());
+			for (unsigned int i = 0; i < currentAttackBoostEffects.size(); ++i) {
+				UnitAttackBoostEffect *effect = currentAttackBoostEffects[i];
+				if (effect != NULL && effect->ups != NULL) {
+					bool particleValid =
+						Renderer::
+						getInstance().validateParticleSystemStillExists(effect->ups,
+							rsGame);
+					if (particleValid == true) {
+						effect->ups->setPos(getCurrVectorForParticlesystems() + offset);
+						effect->ups->setRotation(rotation);
+						setMeshPosInParticleSystem(effect->ups);
+					}
+
+					//printf("i = %d particleValid = %d\n",i,particleValid);
+				}
+				//printf("i = %d effect = %p effect->ups = %p\n",i,effect,(effect ? effect->ups : NULL));
+			}
+
+			if (currentAttackBoostOriginatorEffect.currentAppliedEffect != NULL) {
+				if (currentAttackBoostOriginatorEffect.currentAppliedEffect->ups !=
+					NULL) {
+					bool particleValid =
+						Renderer::getInstance().validateParticleSystemStillExists
+						(currentAttackBoostOriginatorEffect.currentAppliedEffect->ups,
+							rsGame);
+					if (particleValid == true) {
+						currentAttackBoostOriginatorEffect.currentAppliedEffect->
+							ups->setPos(getCurrVectorForParticlesystems() + offset);
+						currentAttackBoostOriginatorEffect.currentAppliedEffect->
+							ups->setRotation(rotation);
+						setMeshPosInParticleSystem
+						(currentAttackBoostOriginatorEffect.currentAppliedEffect->ups);
+					}
+				}
+			}
+		}
+
 		Vec3f Unit::getCurrVectorForParticlesystems() const {
 			if (getFaction()->getType()->isFlatParticlePositions()) {
 				return getCurrVectorFlat();
@@ -2032,8 +2155,7 @@ namespace Glest {
 
 		//return current command, assert that there is always one command
 		Command *Unit::getCurrentCommandThreadSafe() {
-			static string mutexOwnerId =
-				string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexCommands, mutexOwnerId);
 
 			if (commands.empty() == false) {
@@ -2046,8 +2168,7 @@ namespace Glest {
 		void Unit::replaceCurrCommand(Command * cmd) {
 			if (cmd == NULL)
 				return;
-			static string mutexOwnerId =
-				string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexCommands, mutexOwnerId);
 
 			assert(commands.empty() == false);
@@ -2159,8 +2280,7 @@ namespace Glest {
 									__LINE__,
 									(*i)->toString(false).c_str());
 
-							static string mutexOwnerId =
-								string(__FILE__) + string("_") + intToStr(__LINE__);
+							static const char *mutexOwnerId = CODE_AT_LINE;
 							MutexSafeWrapper safeMutex(mutexCommands, mutexOwnerId);
 
 							deleteQueuedCommand(*i);
@@ -2304,8 +2424,7 @@ namespace Glest {
 
 			//push back command
 			if (result.first == crSuccess) {
-				static string mutexOwnerId =
-					string(__FILE__) + string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				MutexSafeWrapper safeMutex(mutexCommands, mutexOwnerId);
 
 				commands.push_back(command);
@@ -2347,8 +2466,7 @@ namespace Glest {
 			}
 
 			//pop front
-			static string mutexOwnerId =
-				string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexCommands, mutexOwnerId);
 
 			delete commands.front();
@@ -2397,8 +2515,7 @@ namespace Glest {
 			undoCommand(commands.back());
 
 			//delete ans pop command
-			static string mutexOwnerId =
-				string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexCommands, mutexOwnerId);
 
 			delete commands.back();
@@ -3423,84 +3540,7 @@ namespace Glest {
 				rotationX = .0f;
 			}
 
-			if (Renderer::
-				getInstance().validateParticleSystemStillExists(this->fire,
-					rsGame) == false) {
-				this->fire = NULL;
-			}
-
-			if (this->fire != NULL) {
-				this->fire->setPos(getCurrBurnVector());
-			}
-			for (UnitParticleSystems::iterator it = unitParticleSystems.begin();
-				it != unitParticleSystems.end(); ++it) {
-				if (Renderer::
-					getInstance().validateParticleSystemStillExists((*it),
-						rsGame) == true) {
-					(*it)->setPos(getCurrVectorForParticlesystems());
-					(*it)->setRotation(getRotation());
-					setMeshPosInParticleSystem(*it);
-				}
-			}
-			for (UnitParticleSystems::iterator it = damageParticleSystems.begin();
-				it != damageParticleSystems.end(); ++it) {
-				if (Renderer::
-					getInstance().validateParticleSystemStillExists((*it),
-						rsGame) == true) {
-					(*it)->setPos(getCurrVectorForParticlesystems());
-					(*it)->setRotation(getRotation());
-					setMeshPosInParticleSystem(*it);
-				}
-			}
-
-			for (UnitParticleSystems::iterator it = smokeParticleSystems.begin();
-				it != smokeParticleSystems.end(); ++it) {
-				if (Renderer::
-					getInstance().validateParticleSystemStillExists((*it),
-						rsGame) == true) {
-					(*it)->setPos(getCurrMidHeightVector());
-					(*it)->setRotation(getRotation());
-					setMeshPosInParticleSystem(*it);
-				}
-			}
-
-			//printf("Unit has attack boost? unit = [%d - %s] size = %d\n",this->getId(), this->getType()->getName(false).c_str(),(int)currentAttackBoostEffects.size());
-			for (unsigned int i = 0; i < currentAttackBoostEffects.size(); ++i) {
-				UnitAttackBoostEffect *effect = currentAttackBoostEffects[i];
-				if (effect != NULL && effect->ups != NULL) {
-					bool particleValid =
-						Renderer::
-						getInstance().validateParticleSystemStillExists(effect->ups,
-							rsGame);
-					if (particleValid == true) {
-						effect->ups->setPos(getCurrVectorForParticlesystems());
-						effect->ups->setRotation(getRotation());
-						setMeshPosInParticleSystem(effect->ups);
-					}
-
-					//printf("i = %d particleValid = %d\n",i,particleValid);
-				}
-				//printf("i = %d effect = %p effect->ups = %p\n",i,effect,(effect ? effect->ups : NULL));
-			}
-
-
-			if (currentAttackBoostOriginatorEffect.currentAppliedEffect != NULL) {
-				if (currentAttackBoostOriginatorEffect.currentAppliedEffect->ups !=
-					NULL) {
-					bool particleValid =
-						Renderer::getInstance().validateParticleSystemStillExists
-						(currentAttackBoostOriginatorEffect.currentAppliedEffect->ups,
-							rsGame);
-					if (particleValid == true) {
-						currentAttackBoostOriginatorEffect.currentAppliedEffect->
-							ups->setPos(getCurrVectorForParticlesystems());
-						currentAttackBoostOriginatorEffect.currentAppliedEffect->
-							ups->setRotation(getRotation());
-						setMeshPosInParticleSystem
-						(currentAttackBoostOriginatorEffect.currentAppliedEffect->ups);
-					}
-				}
-			}
+			placeParticleSystems(Vec3f(0.f), getRotation());
 
 			//checks
 			if (this->animProgress > ANIMATION_SPEED_MULTIPLIER) {
@@ -4663,8 +4703,7 @@ namespace Glest {
 			while (commands.empty() == false) {
 				undoCommand(commands.back());
 
-				static string mutexOwnerId =
-					string(__FILE__) + string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				MutexSafeWrapper safeMutex(mutexCommands, mutexOwnerId);
 
 				delete commands.back();
@@ -5519,6 +5558,10 @@ namespace Glest {
 			bool threadedMode) {
 			if (SystemFlags::
 				getSystemSettingType(SystemFlags::debugWorldSynch).enabled == true) {
+				if (threadedMode == false) {
+					faction->getWorld()->getSynchTrace()->add(getFrameCount(), id, sttLogSite, line);
+				}
+
 				char szBuf[8096] = "";
 				snprintf(szBuf, 8096,
 					"FrameCount [%d] Unit = %d [%s][%s] pos = %s, lastPos = %s, targetPos = %s, targetVec = %s, meetingPos = %s, progress ["
@@ -5723,8 +5766,7 @@ namespace Glest {
 		Vec2i Unit::getPos() {
 			Vec2i result;
 
-			static string mutexOwnerId =
-				string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexCommands, mutexOwnerId);
 			result = this->pos;
 			safeMutex.ReleaseLock();
@@ -6625,8 +6667,7 @@ namespace Glest {
 				XmlNode *node = commandNodeList[i];
 				Command *command = Command::loadGame(node, ut, world);
 
-				static string mutexOwnerId =
-					string(__FILE__) + string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				MutexSafeWrapper safeMutex(result->mutexCommands, mutexOwnerId);
 				result->commands.push_back(command);
 				safeMutex.ReleaseLock();
@@ -6960,6 +7001,57 @@ namespace Glest {
 			return result;
 			}
 
+		void Unit::addSynchTrace(SynchTrace * synchTrace, int frame) {
+			synchTrace->add(frame, id, sttPos, (pos.x << 16) | (pos.y & 0xFFFF));
+			synchTrace->add(frame, id, sttLastPos, (lastPos.x << 16) | (lastPos.y & 0xFFFF));
+			synchTrace->add(frame, id, sttTargetPos, (targetPos.x << 16) | (targetPos.y & 0xFFFF));
+			synchTrace->add(frame, id, sttMeetingPos, (meetingPos.x << 16) | (meetingPos.y & 0xFFFF));
+			synchTrace->add(frame, id, sttProgress, (int32) progress);
+			synchTrace->add(frame, id, sttProgress2, progress2);
+			synchTrace->add(frame, id, sttHp, hp);
+			synchTrace->add(frame, id, sttEp, ep);
+			synchTrace->add(frame, id, sttLoadCount, loadCount);
+			synchTrace->add(frame, id, sttRandom, random.getLastNumber());
+			synchTrace->add(frame, id, sttSkillClass, (currSkill != NULL ? currSkill->getClass() : -1));
+			synchTrace->add(frame, id, sttCommandCount, (int32) commands.size());
+			if (unitPath != NULL) {
+				synchTrace->add(frame, id, sttPathBlockCount, unitPath->getBlockCount());
+				synchTrace->add(frame, id, sttPathQueueSize, unitPath->getQueueCount());
+			}
+		}
+
+		uint32 Unit::getTypeNamesCRC() {
+			if (crcTypeNamesValid == false || crcLevel != level ||
+				crcPreMorphType != preMorph_type || crcType != type ||
+				crcLoadType != loadType || crcCurrSkill != currSkill) {
+				Checksum crcForNames;
+				if (level != NULL) {
+					crcForNames.addString(level->getName(false));
+				}
+				if (preMorph_type != NULL) {
+					crcForNames.addString(preMorph_type->getName(false));
+				}
+				if (type != NULL) {
+					crcForNames.addString(type->getName(false));
+				}
+				if (loadType != NULL) {
+					crcForNames.addString(loadType->getName(false));
+				}
+				if (currSkill != NULL) {
+					crcForNames.addString(currSkill->getName());
+				}
+
+				crcLevel = level;
+				crcPreMorphType = preMorph_type;
+				crcType = type;
+				crcLoadType = loadType;
+				crcCurrSkill = currSkill;
+				crcTypeNamesSum = crcForNames.getSum();
+				crcTypeNamesValid = true;
+			}
+			return crcTypeNamesSum;
+		}
+
 		Checksum Unit::getCRC() {
 			const bool consoleDebug = false;
 
@@ -6999,9 +7091,12 @@ namespace Glest {
 				printf("#4 Unit: %d CRC: %u\n", id, crcForUnit.getSum());
 
 			//const Level *level;
-			if (level != NULL) {
-				crcForUnit.addString(level->getName(false));
-			}
+			//const UnitType *preMorph_type;
+			//const UnitType *type;
+			//const ResourceType *loadType;
+			//const SkillType *currSkill;
+			uint32 typeNamesCrc = getTypeNamesCRC();
+			crcForUnit.addBytes(&typeNamesCrc, sizeof(uint32));
 
 			if (consoleDebug)
 				printf("#5 Unit: %d CRC: %u\n", id, crcForUnit.getSum());
@@ -7032,29 +7127,6 @@ namespace Glest {
 			//float rotationZ;
 			//float rotationX;
 
-			//const UnitType *preMorph_type;
-			if (preMorph_type != NULL) {
-				crcForUnit.addString(preMorph_type->getName(false));
-			}
-
-			if (consoleDebug)
-				printf("#8 Unit: %d CRC: %u\n", id, crcForUnit.getSum());
-
-			//const UnitType *type;
-			if (type != NULL) {
-				crcForUnit.addString(type->getName(false));
-			}
-
-			//const ResourceType *loadType;
-			if (loadType != NULL) {
-				crcForUnit.addString(loadType->getName(false));
-			}
-
-			//const SkillType *currSkill;
-			if (currSkill != NULL) {
-				crcForUnit.addString(currSkill->getName());
-			}
-
 			//printf("#9 Unit: %d CRC: %u lastModelIndexForCurrSkillType: %d\n",id,crcForUnit.getSum(),lastModelIndexForCurrSkillType);
 			//printf("#9a Unit: %d CRC: %u\n",id,crcForUnit.getSum());
 			//crcForUnit.addInt(lastModelIndexForCurrSkillType);
@@ -7083,7 +7155,7 @@ namespace Glest {
 			}
 
 			//TotalUpgrade totalUpgrade;
-			uint32 crc = totalUpgrade.getCRC().getSum();
+			uint32 crc = totalUpgrade.getCRCSum();
 			crcForUnit.addBytes(&crc, sizeof(uint32));
 
 			//Map *map;
@@ -22,6 +22,7 @@
 #   include "skill_type.h"
 #   include "game_constants.h"
 #   include "platform_common.h"
+#   include "synch_trace.h"
 #   include <vector>
 #   include "faction.h"
 #   include "leak_dumper.h"
@@ -40,6 +41,7 @@ namespace Glest {
 		using Shared::Graphics::Model;
 		using Shared::PlatformCommon::Chrono;
 		using Shared::PlatformCommon::ValueCheckerVault;
+		using Shared::Util::SynchTrace;
 
 		class Map;
 		//class Faction;
@@ -123,6 +125,8 @@ namespace Glest {
 		private:
 			int id;
 			Faction *faction;
+			// lets getUnit skip the id lookup while the unit lives
+			SlotHandle handle;
 
 		public:
 			UnitReference();
@@ -193,6 +197,11 @@ namespace Glest {
 			UnitPathBasic();
 			virtual ~UnitPathBasic();
 
+#   ifndef SL_LEAK_DUMP
+			static void *operator new(size_t size);
+			static void operator delete(void *path, size_t size);
+#   endif
+
 #   ifdef LEAK_CHECK_UNITS
 			static void dumpMemoryList();
 #   endif
@@ -433,6 +442,7 @@ namespace Glest {
 
 		private:
 			const int32 id;
+			SlotHandle slotHandle;
 			int32 hp;
 			int32 ep;
 			int32 loadCount;
@@ -575,12 +585,28 @@ namespace Glest {
 			vector < string > networkCRCDecHpList;
 			vector < string > networkCRCParticleInfoList;
 
+			// names hashed into getCRC(), refreshed when one of the types changes
+			const Level *crcLevel;
+			const UnitType *crcPreMorphType;
+			const UnitType *crcType;
+			const ResourceType *crcLoadType;
+			const SkillType *crcCurrSkill;
+			uint32 crcTypeNamesSum;
+			bool crcTypeNamesValid;
+
+			uint32 getTypeNamesCRC();
+
 		public:
 			Unit(int id, UnitPathInterface * path, const Vec2i & pos,
 				const UnitType * type, Faction * faction, Map * map,
 				CardinalDir placeFacing);
 			virtual ~Unit();
 
+#   ifndef SL_LEAK_DUMP
+			static void *operator new(size_t size);
+			static void operator delete(void *unit, size_t size);
+#   endif
+
 			//static bool isUnitDeleted(void *unit);
 
 			static void setGame(Game * value) {
@@ -632,6 +658,13 @@ namespace Glest {
 			inline int getId() const {
 				return id;
 			}
+			// slot in the faction's unit table, unset while not in a faction
+			inline const SlotHandle &getSlotHandle() const {
+				return slotHandle;
+			}
+			inline void setSlotHandle(const SlotHandle &handle) {
+				slotHandle = handle;
+			}
 			inline Field getCurrField() const {
 				return currField;
 			}
@@ -853,6 +886,9 @@ namespace Glest {
 			Vec3f getCurrVectorFlat() const;
 			Vec3f getVectorFlat(const Vec2i & lastPosValue,
 				const Vec2i & curPosValue) const;
+			// moves the attached particle systems to where the unit is drawn,
+			// offset from where the simulation has it
+			void placeParticleSystems(const Vec3f & offset, float rotation);
 
 			//command related
 			bool anyCommand(bool validateCommandtype = false) const;
@@ -1063,6 +1099,7 @@ namespace Glest {
 			void addAttackParticleSystem(ParticleSystem * ps);
 
 			Checksum getCRC();
+			void addSynchTrace(SynchTrace * synchTrace, int frame);
 
 			virtual void end(ParticleSystem * particleSystem);
 			virtual void logParticleInfo(string info);
@@ -1299,6 +1299,9 @@ namespace Glest {
 		}
 
 		void TotalUpgrade::reset() {
+			cachedCRCSum = 0;
+			cachedCRCValid = false;
+
 			maxHp = 0;
 			maxHpIsMultiplier = false;
 			maxHpRegeneration = 0;
@@ -1335,6 +1338,7 @@ namespace Glest {
 
 		void TotalUpgrade::sum(const UpgradeTypeBase * ut, const Unit * unit,
 			bool boostMode) {
+			cachedCRCValid = false;
 			maxHpIsMultiplier = ut->getMaxHpIsMultiplier();
 			sightIsMultiplier = ut->getSightIsMultiplier();
 			maxEpIsMultiplier = ut->getMaxEpIsMultiplier();
@@ -1624,6 +1628,7 @@ namespace Glest {
 		void TotalUpgrade::apply(int sourceUnitId, const UpgradeTypeBase * ut,
 			const Unit * unit) {
 			//sum(ut, unit);
+			cachedCRCValid = false;
 
 			//printf("====> About to apply boost: %s\nTo unit: %d\n\n",ut->toString().c_str(),unit->getId());
 			TotalUpgrade *boostUpgrade = new TotalUpgrade();
@@ -1638,6 +1643,7 @@ namespace Glest {
 
 		void TotalUpgrade::deapply(int sourceUnitId, const UpgradeTypeBase * ut,
 			int destUnitId) {
+			cachedCRCValid = false;
 			//printf("<****** About to de-apply boost: %s\nTo unit: %d\n\n",ut->toString().c_str(),destUnitId);
 
 			bool removedBoost = false;
@@ -1800,6 +1806,7 @@ namespace Glest {
 		}
 
 		void TotalUpgrade::incLevel(const UnitType * ut) {
+			cachedCRCValid = false;
 			maxHp += ut->getMaxHp() * 50 / 100;
 			maxEp += ut->getMaxEp() * 50 / 100;
 			sight += ut->getSight() * 20 / 100;
@@ -2024,6 +2031,7 @@ namespace Glest {
 		}
 
 		void TotalUpgrade::loadGame(const XmlNode * rootNode) {
+			cachedCRCValid = false;
 			const XmlNode *upgradeTypeBaseNode =
 				rootNode->getChild("TotalUpgrade");
 
@@ -2220,6 +2228,14 @@ namespace Glest {
 
 		}
 
+		uint32 TotalUpgrade::getCRCSum() {
+			if (cachedCRCValid == false) {
+				cachedCRCSum = getCRC().getSum();
+				cachedCRCValid = true;
+			}
+			return cachedCRCSum;
+		}
+
 
 	}
 }                              //end namespace
@@ -446,6 +446,10 @@ namespace Glest {
 			int boostUpgradeDestUnit;
 			std::vector < TotalUpgrade * >boostUpgrades;
 
+			// getCRC() sum, kept until one of the modifying methods runs
+			uint32 cachedCRCSum;
+			bool cachedCRCValid;
+
 		public:
 			TotalUpgrade();
 			virtual ~TotalUpgrade() {
@@ -531,6 +535,11 @@ namespace Glest {
 		 * @rootNode The node of the unit that this TotalUpgrade object belongs to.
 		 */
 			void loadGame(const XmlNode * rootNode);
+
+			/**
+		 * Same value as getCRC().getSum(), only recalculated after the upgrade changed.
+		 */
+			uint32 getCRCSum();
 		};
 
 	}
@@ -36,13 +36,16 @@
 #include "faction.h"
 #include "command.h"
 #include "map_preview.h"
+#include "map_file_reader.h"
 #include "world.h"
 #include "byte_order.h"
+#include "simple_threads.h"
 #include "leak_dumper.h"
 
 using namespace Shared::Graphics;
 using namespace Shared::Util;
 using namespace Shared::Platform;
+using namespace Shared::PlatformCommon;
 
 namespace Glest {
 	namespace Game {
@@ -142,11 +145,6 @@ namespace Glest {
 			surfaceTexture = NULL;
 			nearSubmerged = false;
 			cellChangedFromOriginalMapLoad = false;
-
-			for (int index = 0; index < GameConstants::maxPlayers + GameConstants::specialFactions; ++index) {
-				setVisible(index, false);
-				setExplored(index, false);
-			}
 		}
 
 		SurfaceCell::~SurfaceCell() {
@@ -180,67 +178,6 @@ namespace Glest {
 
 			return object->getResource()->decAmount(value);
 		}
-		void SurfaceCell::setExplored(int teamIndex, bool explored) {
-			if (teamIndex < 0 || teamIndex >= GameConstants::maxPlayers + GameConstants::specialFactions) {
-				char szBuf[8096] = "";
-				snprintf(szBuf, 8096, "Invalid value for teamIndex [%d]", teamIndex);
-				printf("%s\n", szBuf);
-				throw megaglest_runtime_error(szBuf);
-			}
-
-			this->explored[teamIndex] = explored;
-			//printf("Setting explored to %d for teamIndex %d\n",explored,teamIndex);
-		}
-
-		void SurfaceCell::setVisible(int teamIndex, bool visible) {
-			if (teamIndex < 0 || teamIndex >= GameConstants::maxPlayers + GameConstants::specialFactions) {
-				char szBuf[8096] = "";
-				snprintf(szBuf, 8096, "Invalid value for teamIndex [%d]", teamIndex);
-				printf("%s\n", szBuf);
-				throw megaglest_runtime_error(szBuf);
-			}
-
-			this->visible[teamIndex] = visible;
-
-			if (SystemFlags::getSystemSettingType(SystemFlags::debugWorldSynch).enabled == true &&
-				SystemFlags::getSystemSettingType(SystemFlags::debugWorldSynchMax).enabled == true) {
-				char szBuf[8096] = "";
-				snprintf(szBuf, 8096, "In setVisible() teamIndex %d visible %d", teamIndex, visible);
-
-				//		if(frameIndex < 0) {
-				//			unit->logSynchData(__FILE__,__LINE__,szBuf);
-				//		}
-				//		else {
-				//			unit->logSynchDataThreaded(__FILE__,__LINE__,szBuf);
-				//		}
-
-				if (Thread::isCurrentThreadMainThread()) {
-					//unit->logSynchDataThreaded(__FILE__,__LINE__,szBuf);
-					SystemFlags::OutputDebug(SystemFlags::debugWorldSynch, szBuf);
-				} else {
-					//unit->logSynchData(__FILE__,__LINE__,szBuf);
-					printf("%s", szBuf);
-				}
-
-			}
-
-		}
-
-		string SurfaceCell::isVisibleString() const {
-			string result = "isVisibleList = ";
-			for (int index = 0; index < GameConstants::maxPlayers + GameConstants::specialFactions; ++index) {
-				result += string(visible[index] ? "true" : "false");
-			}
-			return result;
-		}
-		string SurfaceCell::isExploredString() const {
-			string result = "isExploredList = ";
-			for (int index = 0; index < GameConstants::maxPlayers + GameConstants::specialFactions; ++index) {
-				result += string(explored[index] ? "true" : "false");
-			}
-			return result;
-		}
-
 		void SurfaceCell::saveGame(XmlNode *rootNode, int index) const {
 			bool saveCell = (this->getCellChangedFromOriginalMapLoad() == true);
 
@@ -345,6 +282,73 @@ namespace Glest {
 
 		const int Map::cellScale = 2;
 		const int Map::mapScale = 2;
+		const int Map::minSurfaceRowsPerWorker = 16;
+
+		// =====================================================
+		// 	class MapTerrainRowsTask
+		// =====================================================
+
+		class MapTerrainRowsTask : public ParallelRowsCallbackInterface {
+		public:
+			enum Pass {
+				tpSmoothHeights,
+				tpSetHeights,
+				tpTerrain
+			};
+
+		private:
+			Map *map;
+			Pass pass;
+			const float *oldHeights;
+			float *heights;
+			char *cliffCells;
+			Mutex mutex;
+			float startMaxHeight;
+			float maxHeight;
+
+		public:
+			MapTerrainRowsTask(Map *map, Pass pass, const float *oldHeights = NULL,
+				float *heights = NULL, char *cliffCells = NULL, float maxHeight = 0.0f)
+				: mutex(CODE_AT_LINE) {
+				this->map = map;
+				this->pass = pass;
+				this->oldHeights = oldHeights;
+				this->heights = heights;
+				this->cliffCells = cliffCells;
+				this->startMaxHeight = maxHeight;
+				this->maxHeight = maxHeight;
+			}
+
+			float getMaxHeight() const {
+				return maxHeight;
+			}
+
+			virtual void processRows(int firstRow, int endRow) {
+				switch (pass) {
+					case tpSmoothHeights:
+					{
+						float bandMaxHeight = startMaxHeight;
+						map->smoothSurfaceRows(oldHeights, heights, cliffCells, bandMaxHeight, firstRow, endRow);
+						MutexSafeWrapper safeMutex(&mutex, CODE_AT_LINE);
+						if (maxHeight < bandMaxHeight) {
+							maxHeight = bandMaxHeight;
+						}
+					}
+					break;
+					case tpSetHeights:
+						map->setSurfaceHeightsRows(heights, firstRow, endRow);
+						break;
+					case tpTerrain:
+						// the passes only read heights, so a band runs
+						// them all while its cells are still cached
+						map->computeNormalsRows(firstRow, endRow);
+						map->computeInterpolatedHeightsRows(firstRow, endRow);
+						map->computeNearSubmergedRows(firstRow, endRow);
+						map->computeCellColorsRows(firstRow, endRow);
+						break;
+				}
+			}
+		};
 
 		Map::Map() {
 			cells = NULL;
@@ -408,162 +412,104 @@ namespace Glest {
 		Checksum Map::load(const string &path, TechTree *techTree, Tileset *tileset) {
 			Checksum mapChecksum;
 			try {
-#ifdef WIN32
-				FILE *f = _wfopen(utf8_decode(path).c_str(), L"rb");
-#else
-				FILE *f = fopen(path.c_str(), "rb");
-#endif
-				if (f != NULL) {
-					mapFile = path;
-
-					mapChecksum.addFile(path);
-					checksumValue.addFile(path);
-					//read header
-					MapFileHeader header;
-					size_t readBytes = fread(&header, sizeof(MapFileHeader), 1, f);
-					if (readBytes != 1) {
-						throw megaglest_runtime_error("Invalid map header detected for file: " + path);
-					}
-					fromEndianMapFileHeader(header);
-
-					if (next2Power(header.width) != header.width) {
-						throw megaglest_runtime_error("Map width is not a power of 2");
+				MapFileReader reader;
+				reader.open(path);
+				mapFile = path;
+
+				mapChecksum.addFile(path);
+				checksumValue.addFile(path);
+				//read header
+				const MapFileHeader &header = reader.getHeader();
+
+				if (next2Power(header.width) != header.width) {
+					throw megaglest_runtime_error("Map width is not a power of 2");
+				}
+
+				if (next2Power(header.height) != header.height) {
+					throw megaglest_runtime_error("Map height is not a power of 2");
+				}
+
+				heightFactor = header.heightFactor;
+				if (heightFactor > 100) {
+					heightFactor = heightFactor / 100;
+					heightFactor = truncateDecimal<float>(heightFactor, 6);
+				}
+				waterLevel = static_cast<float>((header.waterLevel - 0.01f) / heightFactor);
+				waterLevel = truncateDecimal<float>(waterLevel, 6);
+				title = header.title;
+
+				//maxPlayers= header.maxFactions;
+				hardMaxPlayers = header.maxFactions;
+				maxPlayers = GameConstants::maxPlayers;
+
+				surfaceW = header.width;
+				surfaceH = header.height;
+				surfaceSize = (surfaceW * surfaceH);
+
+				w = surfaceW * cellScale;
+				h = surfaceH * cellScale;
+				cliffLevel = 0;
+				cameraHeight = 0;
+				if (header.version == 1) {
+					//desc = header.description;
+				} else if (header.version == 2) {
+					//desc = header.version2.short_desc;
+					if (header.version2.cliffLevel > 0 && header.version2.cliffLevel < 5000) {
+						cliffLevel = static_cast<float>((header.version2.cliffLevel - 0.01f) / (heightFactor));
+						cliffLevel = truncateDecimal<float>(cliffLevel, 6);
 					}
-
-					if (next2Power(header.height) != header.height) {
-						throw megaglest_runtime_error("Map height is not a power of 2");
-					}
-
-					heightFactor = header.heightFactor;
-					if (heightFactor > 100) {
-						heightFactor = heightFactor / 100;
-						heightFactor = truncateDecimal<float>(heightFactor, 6);
-					}
-					waterLevel = static_cast<float>((header.waterLevel - 0.01f) / heightFactor);
-					waterLevel = truncateDecimal<float>(waterLevel, 6);
-					title = header.title;
-
-					//maxPlayers= header.maxFactions;
-					hardMaxPlayers = header.maxFactions;
-					maxPlayers = GameConstants::maxPlayers;
-
-					surfaceW = header.width;
-					surfaceH = header.height;
-					surfaceSize = (surfaceW * surfaceH);
-
-					w = surfaceW * cellScale;
-					h = surfaceH * cellScale;
-					cliffLevel = 0;
-					cameraHeight = 0;
-					if (header.version == 1) {
-						//desc = header.description;
-					} else if (header.version == 2) {
-						//desc = header.version2.short_desc;
-						if (header.version2.cliffLevel > 0 && header.version2.cliffLevel < 5000) {
-							cliffLevel = static_cast<float>((header.version2.cliffLevel - 0.01f) / (heightFactor));
-							cliffLevel = truncateDecimal<float>(cliffLevel, 6);
-						}
-						if (header.version2.cameraHeight > 0 && header.version2.cameraHeight < 5000) {
-							cameraHeight = header.version2.cameraHeight;
-						}
+					if (header.version2.cameraHeight > 0 && header.version2.cameraHeight < 5000) {
+						cameraHeight = header.version2.cameraHeight;
 					}
+				}
 
-					//start locations
-					startLocations = new Vec2i[maxPlayers];
-					for (int i = 0; i < hardMaxPlayers; ++i) {
-						int x = 0, y = 0;
-						readBytes = fread(&x, sizeof(int32), 1, f);
-						if (readBytes != 1) {
-							char szBuf[8096] = "";
-							snprintf(szBuf, 8096, "fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.", readBytes, __LINE__);
-							throw megaglest_runtime_error(szBuf);
-						}
-						x = ::Shared::PlatformByteOrder::fromCommonEndian(x);
-
-						readBytes = fread(&y, sizeof(int32), 1, f);
-						if (readBytes != 1) {
-							char szBuf[8096] = "";
-							snprintf(szBuf, 8096, "fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.", readBytes, __LINE__);
-							throw megaglest_runtime_error(szBuf);
-						}
-						y = ::Shared::PlatformByteOrder::fromCommonEndian(y);
-
-						startLocations[i] = Vec2i(x, y)*cellScale;
-					}
-
-					//cells
-					cells = new Cell[getCellArraySize()];
-					surfaceCells = new SurfaceCell[getSurfaceCellArraySize()];
-
-					//read heightmap
-					for (int j = 0; j < surfaceH; ++j) {
-						for (int i = 0; i < surfaceW; ++i) {
-							float32 alt = 0;
-							readBytes = fread(&alt, sizeof(float32), 1, f);
-							if (readBytes != 1) {
-								char szBuf[8096] = "";
-								snprintf(szBuf, 8096, "fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.", readBytes, __LINE__);
-								throw megaglest_runtime_error(szBuf);
-							}
-							alt = ::Shared::PlatformByteOrder::fromCommonEndian(alt);
-
-							SurfaceCell *sc = getSurfaceCell(i, j);
-							sc->setVertex(Vec3f(i*mapScale, alt / heightFactor, j*mapScale));
-						}
-					}
+				//start locations
+				startLocations = new Vec2i[maxPlayers];
+				for (int i = 0; i < hardMaxPlayers; ++i) {
+					startLocations[i] = Vec2i(reader.getStartLocationX(i), reader.getStartLocationY(i))*cellScale;
+				}
 
-					//read surfaces
-					for (int j = 0; j < surfaceH; ++j) {
-						for (int i = 0; i < surfaceW; ++i) {
-							int8 surf = 0;
-							readBytes = fread(&surf, sizeof(int8), 1, f);
-							if (readBytes != 1) {
-								char szBuf[8096] = "";
-								snprintf(szBuf, 8096, "fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.", readBytes, __LINE__);
-								throw megaglest_runtime_error(szBuf);
-							}
-							surf = ::Shared::PlatformByteOrder::fromCommonEndian(surf);
+				//cells
+				cells = new Cell[getCellArraySize()];
+				surfaceCells = new SurfaceCell[getSurfaceCellArraySize()];
+				for (int i = 0; i < GameConstants::maxPlayers + GameConstants::specialFactions; ++i) {
+					exploredCells[i].init(getSurfaceCellArraySize());
+					visibleCells[i].init(getSurfaceCellArraySize());
+				}
 
-							getSurfaceCell(i, j)->setSurfaceType(surf - 1);
-						}
+				//read heightmap and surfaces
+				for (int j = 0; j < surfaceH; ++j) {
+					for (int i = 0; i < surfaceW; ++i) {
+						SurfaceCell *sc = getSurfaceCell(i, j);
+						sc->setVertex(Vec3f(i*mapScale, reader.getHeight(i, j) / heightFactor, j*mapScale));
+						sc->setSurfaceType(reader.getSurface(i, j) - 1);
 					}
+				}
 
-					//read objects and resources
-					for (int j = 0; j < h; j += cellScale) {
-						for (int i = 0; i < w; i += cellScale) {
-
-							int8 objNumber = 0;
-							readBytes = fread(&objNumber, sizeof(int8), 1, f);
-							if (readBytes != 1) {
-								char szBuf[8096] = "";
-								snprintf(szBuf, 8096, "fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.", readBytes, __LINE__);
-								throw megaglest_runtime_error(szBuf);
-							}
-							objNumber = ::Shared::PlatformByteOrder::fromCommonEndian(objNumber);
-
-							SurfaceCell *sc = getSurfaceCell(toSurfCoords(Vec2i(i, j)));
-							if (objNumber <= 0) {
-								sc->setObject(NULL);
-							} else if (objNumber <= Tileset::objCount) {
-								Object *o = new Object(tileset->getObjectType(objNumber - 1), sc->getVertex(), Vec2i(i, j));
-								sc->setObject(o);
-								for (int k = 0; k < techTree->getResourceTypeCount(); ++k) {
-									const ResourceType *rt = techTree->getResourceType(k);
-									if (rt->getClass() == rcTileset && rt->getTilesetObject() == objNumber) {
-										o->setResource(rt, Vec2i(i, j));
-									}
+				//read objects and resources
+				for (int j = 0; j < h; j += cellScale) {
+					for (int i = 0; i < w; i += cellScale) {
+						int8 objNumber = reader.getObject(i / cellScale, j / cellScale);
+
+						SurfaceCell *sc = getSurfaceCell(toSurfCoords(Vec2i(i, j)));
+						if (objNumber <= 0) {
+							sc->setObject(NULL);
+						} else if (objNumber <= Tileset::objCount) {
+							Object *o = new Object(tileset->getObjectType(objNumber - 1), sc->getVertex(), Vec2i(i, j));
+							sc->setObject(o);
+							for (int k = 0; k < techTree->getResourceTypeCount(); ++k) {
+								const ResourceType *rt = techTree->getResourceType(k);
+								if (rt->getClass() == rcTileset && rt->getTilesetObject() == objNumber) {
+									o->setResource(rt, Vec2i(i, j));
 								}
-							} else {
-								const ResourceType *rt = techTree->getTechResourceType(objNumber - Tileset::objCount);
-								Object *o = new Object(NULL, sc->getVertex(), Vec2i(i, j));
-								o->setResource(rt, Vec2i(i, j));
-								sc->setObject(o);
 							}
+						} else {
+							const ResourceType *rt = techTree->getTechResourceType(objNumber - Tileset::objCount);
+							Object *o = new Object(NULL, sc->getVertex(), Vec2i(i, j));
+							o->setResource(rt, Vec2i(i, j));
+							sc->setObject(o);
 						}
 					}
-					if (f) fclose(f);
-				} else {
-					throw megaglest_runtime_error("Can't open file");
 				}
 			} catch (const exception &e) {
 				SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] Error [%s]\n", __FILE__, __FUNCTION__, __LINE__, e.what());
@@ -576,13 +522,64 @@ namespace Glest {
 		void Map::init(Tileset *tileset) {
 			Logger::getInstance().add(Lang::getInstance().getString("LogScreenGameUnLoadingMap", ""), true);
 			maxMapHeight = 0.0f;
-			smoothSurface(tileset);
-			computeNormals();
-			computeInterpolatedHeights();
-			computeNearSubmerged();
-			computeCellColors();
+
+			// the terrain is worked on in bands of surface rows, giving the
+			// same values as a single thread so the synch is not affected
+			int workerCount = ParallelRowsThread::getWorkerCount(surfaceH,
+				minSurfaceRowsPerWorker, Config::getInstance().getInt("MapInitWorkerThreads", "0"));
+			smoothSurface(tileset, workerCount);
+			computeTerrain(workerCount);
+			resourceIndex.build(this);
+		}
+
+
+		void Map::deleteResource(const Vec2i &surfacePos) {
+			SurfaceCell *sc = getSurfaceCell(surfacePos);
+			Resource *r = sc->getResource();
+			if (r != NULL) {
+				resourceIndex.remove(surfacePos, r->getType());
+			}
+			sc->deleteResource();
 		}
 
+		bool Map::findHarvestCell(const Vec2i &pos, int maxRadius,
+			const HarvestCommandType *hct, const Unit *unit, Vec2i &resultPos) const {
+			const Vec2i surfaceMin = toSurfCoords(Vec2i(max(pos.x - maxRadius, 0), max(pos.y - maxRadius, 0)));
+			const Vec2i surfaceMax = toSurfCoords(Vec2i(pos.x + maxRadius, pos.y + maxRadius));
+
+			bool resourcesNear = false;
+			for (int typeIndex = 0; typeIndex < resourceIndex.getResourceTypeCount() &&
+				resourcesNear == false; ++typeIndex) {
+				const ResourceType *rt = resourceIndex.getResourceType(typeIndex);
+				resourcesNear = (hct->canHarvest(rt) &&
+					resourceIndex.hasResources(rt, surfaceMin, surfaceMax));
+			}
+			if (resourcesNear == false) {
+				return false;
+			}
+
+			// the cells of each ring by x, then y. The inner cells were all
+			// tested on the smaller rings, so only the border is walked
+			for (int radius = 0; radius <= maxRadius; radius++) {
+				for (int i = pos.x - radius; i <= pos.x + radius; ++i) {
+					int step = (i == pos.x - radius || i == pos.x + radius ? 1 : 2 * radius);
+					for (int j = pos.y - radius; j <= pos.y + radius; j += step) {
+						if (isInside(i, j) == false) {
+							continue;
+						}
+						int typeIndex = resourceIndex.getCellTypeIndex(toSurfCoords(Vec2i(i, j)));
+						if (typeIndex >= 0 && hct->canHarvest(resourceIndex.getResourceType(typeIndex))) {
+							const Vec2i newPos = Vec2i(i, j);
+							if (unit == NULL || unit->isBadHarvestPos(newPos) == false) {
+								resultPos = newPos;
+								return true;
+							}
+						}
+					}
+				}
+			}
+			return false;
+		}
 
 		// ==================== is ====================
 
@@ -832,11 +829,12 @@ namespace Glest {
 
 		bool Map::isAproxFreeCell(const Vec2i &pos, Field field, int teamIndex) const {
 			if (isInside(pos) && isInsideSurface(toSurfCoords(pos))) {
-				const SurfaceCell *sc = getSurfaceCell(toSurfCoords(pos));
+				const Vec2i sPos = toSurfCoords(pos);
+				const SurfaceCell *sc = getSurfaceCell(sPos);
 
-				if (sc->isVisible(teamIndex)) {
+				if (isSurfaceVisible(sPos, teamIndex)) {
 					return isFreeCell(pos, field);
-				} else if (sc->isExplored(teamIndex)) {
+				} else if (isSurfaceExplored(sPos, teamIndex)) {
 					return field == fLand ? sc->isFree() && !getDeepSubmerged(getCell(pos)) : true;
 				} else {
 					return true;
@@ -1623,9 +1621,17 @@ namespace Glest {
 
 		//compute normals
 		void Map::computeNormals() {
+			computeNormalsRows(0, surfaceH);
+		}
+
+		void Map::computeInterpolatedHeights() {
+			computeInterpolatedHeightsRows(0, surfaceH);
+		}
+
+		void Map::computeNormalsRows(int firstRow, int endRow) {
 			//compute center normals
-			for (int i = 1; i < surfaceW - 1; ++i) {
-				for (int j = 1; j < surfaceH - 1; ++j) {
+			for (int j = max(firstRow, 1); j < min(endRow, surfaceH - 1); ++j) {
+				for (int i = 1; i < surfaceW - 1; ++i) {
 					getSurfaceCell(i, j)->setNormal(
 						getSurfaceCell(i, j)->getVertex().normal(getSurfaceCell(i, j - 1)->getVertex(),
 							getSurfaceCell(i + 1, j)->getVertex(),
@@ -1635,16 +1641,16 @@ namespace Glest {
 			}
 		}
 
-		void Map::computeInterpolatedHeights() {
-
-			for (int i = 0; i < w; ++i) {
-				for (int j = 0; j < h; ++j) {
+		void Map::computeInterpolatedHeightsRows(int firstRow, int endRow) {
+			// the cells of a surface row are only written by its own band
+			for (int j = firstRow * cellScale; j < min(endRow * cellScale, h); ++j) {
+				for (int i = 0; i < w; ++i) {
 					getCell(i, j)->setHeight(getSurfaceCell(toSurfCoords(Vec2i(i, j)))->getHeight());
 				}
 			}
 
-			for (int i = 1; i < surfaceW - 1; ++i) {
-				for (int j = 1; j < surfaceH - 1; ++j) {
+			for (int j = max(firstRow, 1); j < min(endRow, surfaceH - 1); ++j) {
+				for (int i = 1; i < surfaceW - 1; ++i) {
 					for (int k = 0; k < cellScale; ++k) {
 						for (int l = 0; l < cellScale; ++l) {
 							if (k == 0 && l == 0) {
@@ -1670,30 +1676,36 @@ namespace Glest {
 			}
 		}
 
-		void Map::smoothSurface(Tileset *tileset) {
-			float *oldHeights = new float[getSurfaceCellArraySize()];
-			//int arraySize=getSurfaceCellArraySize();
-
-			for (int i = 0; i < getSurfaceCellArraySize(); ++i) {
+		void Map::smoothSurface(Tileset *tileset, int workerCount) {
+			int arraySize = getSurfaceCellArraySize();
+			vector<float> oldHeights(arraySize);
+			for (int i = 0; i < arraySize; ++i) {
 				oldHeights[i] = surfaceCells[i].getHeight();
 			}
+			vector<float> smoothedHeights(oldHeights);
+			vector<char> cliffCells(arraySize, 0);
 
+			MapTerrainRowsTask smoothTask(this, MapTerrainRowsTask::tpSmoothHeights,
+				&oldHeights[0], &smoothedHeights[0], &cliffCells[0], maxMapHeight);
+			ParallelRowsThread::run(&smoothTask, surfaceH, workerCount);
+			maxMapHeight = smoothTask.getMaxHeight();
+
+			// objects are replaced on the calling thread, in the order of
+			// the single threaded pass, as they register with the renderer
 			for (int i = 1; i < surfaceW - 1; ++i) {
 				for (int j = 1; j < surfaceH - 1; ++j) {
-					float height = 0.f;
-					float numUsedToSmooth = 0.f;
-					for (int k = -1; k <= 1; ++k) {
-						for (int l = -1; l <= 1; ++l) {
+					if (cliffCells[j * surfaceW + i] != 0) {
+						for (int k = -1; k <= 1; ++k) {
+							for (int l = -1; l <= 1; ++l) {
 #ifdef USE_STREFLOP
-							if (cliffLevel <= 0.1f || cliffLevel > streflop::fabs(static_cast<streflop::Simple>(oldHeights[(j) * surfaceW + (i)]
-								- oldHeights[(j + k) * surfaceW + (i + l)]))) {
+								if (cliffLevel <= 0.1f || cliffLevel > streflop::fabs(static_cast<streflop::Simple>(oldHeights[(j) * surfaceW + (i)]
+									- oldHeights[(j + k) * surfaceW + (i + l)]))) {
 #else
-							if (cliffLevel <= 0.1f || cliffLevel > fabs(oldHeights[(j) * surfaceW + (i)]
-								- oldHeights[(j + k) * surfaceW + (i + l)])) {
+								if (cliffLevel <= 0.1f || cliffLevel > fabs(oldHeights[(j) * surfaceW + (i)]
+									- oldHeights[(j + k) * surfaceW + (i + l)])) {
 #endif
-								height += oldHeights[(j + k) * surfaceW + (i + l)];
-								numUsedToSmooth++;
-							} else {
+									continue;
+								}
 								// we have something which should not be smoothed!
 								// This is a cliff and must be textured -> set cliff texture
 								getSurfaceCell(i, j)->setSurfaceType(5);
@@ -1715,28 +1727,70 @@ namespace Glest {
 									getSurfaceCell(i, j)->setObject(o);
 								}
 							}
-							}
 						}
-
-					height /= numUsedToSmooth;
-					if (maxMapHeight < height) {
-						maxMapHeight = height;
 					}
 
-					getSurfaceCell(i, j)->setHeight(height);
 					Object *object = getSurfaceCell(i, j)->getObject();
 					if (object != NULL) {
-						object->setHeight(height);
+						object->setHeight(smoothedHeights[j * surfaceW + i]);
 					}
+				}
+			}
+
+			MapTerrainRowsTask heightsTask(this, MapTerrainRowsTask::tpSetHeights,
+				NULL, &smoothedHeights[0]);
+			ParallelRowsThread::run(&heightsTask, surfaceH, workerCount);
+		}
+
+		void Map::smoothSurfaceRows(const float *oldHeights, float *smoothedHeights,
+			char *cliffCells, float &maxHeight, int firstRow, int endRow) const {
+			for (int j = max(firstRow, 1); j < min(endRow, surfaceH - 1); ++j) {
+				for (int i = 1; i < surfaceW - 1; ++i) {
+					float height = 0.f;
+					float numUsedToSmooth = 0.f;
+					for (int k = -1; k <= 1; ++k) {
+						for (int l = -1; l <= 1; ++l) {
+#ifdef USE_STREFLOP
+							if (cliffLevel <= 0.1f || cliffLevel > streflop::fabs(static_cast<streflop::Simple>(oldHeights[(j) * surfaceW + (i)]
+								- oldHeights[(j + k) * surfaceW + (i + l)]))) {
+#else
+							if (cliffLevel <= 0.1f || cliffLevel > fabs(oldHeights[(j) * surfaceW + (i)]
+								- oldHeights[(j + k) * surfaceW + (i + l)])) {
+#endif
+								height += oldHeights[(j + k) * surfaceW + (i + l)];
+								numUsedToSmooth++;
+							} else {
+								// a cliff, textured and blocked by smoothSurface
+								cliffCells[j * surfaceW + i] = 1;
+							}
+						}
 					}
+
+					height /= numUsedToSmooth;
+					if (maxHeight < height) {
+						maxHeight = height;
+					}
+					smoothedHeights[j * surfaceW + i] = height;
 				}
-			delete[] oldHeights;
 			}
+		}
 
-		void Map::computeNearSubmerged() {
+		void Map::setSurfaceHeightsRows(const float *heights, int firstRow, int endRow) {
+			for (int j = max(firstRow, 1); j < min(endRow, surfaceH - 1); ++j) {
+				for (int i = 1; i < surfaceW - 1; ++i) {
+					getSurfaceCell(i, j)->setHeight(heights[j * surfaceW + i]);
+				}
+			}
+		}
 
-			for (int i = 0; i < surfaceW - 1; ++i) {
-				for (int j = 0; j < surfaceH - 1; ++j) {
+		void Map::computeTerrain(int workerCount) {
+			MapTerrainRowsTask terrainTask(this, MapTerrainRowsTask::tpTerrain);
+			ParallelRowsThread::run(&terrainTask, surfaceH, workerCount);
+		}
+
+		void Map::computeNearSubmergedRows(int firstRow, int endRow) {
+			for (int j = firstRow; j < min(endRow, surfaceH - 1); ++j) {
+				for (int i = 0; i < surfaceW - 1; ++i) {
 					bool anySubmerged = false;
 					for (int k = -1; k <= 2; ++k) {
 						for (int l = -1; l <= 2; ++l) {
@@ -1752,9 +1806,9 @@ namespace Glest {
 			}
 		}
 
-		void Map::computeCellColors() {
-			for (int i = 0; i < surfaceW; ++i) {
-				for (int j = 0; j < surfaceH; ++j) {
+		void Map::computeCellColorsRows(int firstRow, int endRow) {
+			for (int j = firstRow; j < endRow; ++j) {
+				for (int i = 0; i < surfaceW; ++i) {
 					SurfaceCell *sc = getSurfaceCell(i, j);
 					if (getDeepSubmerged(sc)) {
 						float factor = clamp(waterLevel - sc->getHeight()*1.5f, 1.f, 1.5f);
@@ -1766,6 +1820,93 @@ namespace Glest {
 			}
 		}
 
+		// ==================== visibility ====================
+
+		static void checkVisibilityTeamIndex(int teamIndex) {
+			if (teamIndex < 0 || teamIndex >= GameConstants::maxPlayers + GameConstants::specialFactions) {
+				char szBuf[8096] = "";
+				snprintf(szBuf, 8096, "Invalid value for teamIndex [%d]", teamIndex);
+				printf("%s\n", szBuf);
+				throw megaglest_runtime_error(szBuf);
+			}
+		}
+
+		static void logSetVisible(int teamIndex, bool visible) {
+			if (SystemFlags::getSystemSettingType(SystemFlags::debugWorldSynch).enabled == true &&
+				SystemFlags::getSystemSettingType(SystemFlags::debugWorldSynchMax).enabled == true) {
+				char szBuf[8096] = "";
+				snprintf(szBuf, 8096, "In setVisible() teamIndex %d visible %d", teamIndex, visible);
+
+				if (Thread::isCurrentThreadMainThread()) {
+					SystemFlags::OutputDebug(SystemFlags::debugWorldSynch, szBuf);
+				} else {
+					printf("%s", szBuf);
+				}
+			}
+		}
+
+		void Map::setSurfaceExplored(int surfaceIndex, int teamIndex, bool explored) {
+			checkVisibilityTeamIndex(teamIndex);
+			exploredCells[teamIndex].set(surfaceIndex, explored);
+		}
+
+		void Map::setSurfaceVisible(int surfaceIndex, int teamIndex, bool visible) {
+			checkVisibilityTeamIndex(teamIndex);
+			visibleCells[teamIndex].set(surfaceIndex, visible);
+			logSetVisible(teamIndex, visible);
+		}
+
+		void Map::setAllSurfaceExplored(int teamIndex, bool explored) {
+			checkVisibilityTeamIndex(teamIndex);
+			exploredCells[teamIndex].setAll(explored);
+		}
+
+		void Map::setAllSurfaceVisible(int teamIndex, bool visible) {
+			checkVisibilityTeamIndex(teamIndex);
+			visibleCells[teamIndex].setAll(visible);
+			logSetVisible(teamIndex, visible);
+		}
+
+		int Map::getSurfaceVisibleTeams(const Vec2i &sPos) const {
+			int surfaceIndex = getSurfaceCellIndex(sPos);
+			int teams = 0;
+			for (int index = 0; index < GameConstants::maxPlayers + GameConstants::specialFactions; ++index) {
+				if (visibleCells[index].get(surfaceIndex) == true) {
+					teams |= (1 << index);
+				}
+			}
+			return teams;
+		}
+
+		int Map::getSurfaceExploredTeams(const Vec2i &sPos) const {
+			int surfaceIndex = getSurfaceCellIndex(sPos);
+			int teams = 0;
+			for (int index = 0; index < GameConstants::maxPlayers + GameConstants::specialFactions; ++index) {
+				if (exploredCells[index].get(surfaceIndex) == true) {
+					teams |= (1 << index);
+				}
+			}
+			return teams;
+		}
+
+		string Map::getSurfaceVisibleString(const Vec2i &sPos) const {
+			int teams = getSurfaceVisibleTeams(sPos);
+			string result = "isVisibleList = ";
+			for (int index = 0; index < GameConstants::maxPlayers + GameConstants::specialFactions; ++index) {
+				result += string((teams & (1 << index)) != 0 ? "true" : "false");
+			}
+			return result;
+		}
+
+		string Map::getSurfaceExploredString(const Vec2i &sPos) const {
+			int teams = getSurfaceExploredTeams(sPos);
+			string result = "isExploredList = ";
+			for (int index = 0; index < GameConstants::maxPlayers + GameConstants::specialFactions; ++index) {
+				result += string((teams & (1 << index)) != 0 ? "true" : "false");
+			}
+			return result;
+		}
+
 		void Map::saveGame(XmlNode *rootNode) const {
 			std::map<string, string> mapTagReplacements;
 			XmlNode *mapNode = rootNode->addChild("Map");
@@ -1799,54 +1940,16 @@ namespace Glest {
 			//	SurfaceCell *surfaceCells;
 				//printf("getSurfaceCellArraySize() = %d\n",getSurfaceCellArraySize());
 
-			string exploredList = "";
-			string visibleList = "";
-
 			for (unsigned int i = 0; i < (unsigned int) getSurfaceCellArraySize(); ++i) {
 				SurfaceCell &surfaceCell = surfaceCells[i];
-
-				if (exploredList != "") {
-					exploredList += ",";
-				}
-
-				for (unsigned int j = 0; j < (unsigned int) GameConstants::maxPlayers; ++j) {
-					if (j > 0) {
-						exploredList += "|";
-					}
-
-					exploredList += intToStr(surfaceCell.isExplored(j));
-				}
-
-				if (visibleList != "") {
-					visibleList += ",";
-				}
-
-				for (unsigned int j = 0; j < (unsigned int) GameConstants::maxPlayers; ++j) {
-					if (j > 0) {
-						visibleList += "|";
-					}
-
-					visibleList += intToStr(surfaceCell.isVisible(j));
-				}
-
 				surfaceCell.saveGame(mapNode, i);
-
-				if (i > 0 && i % 100 == 0) {
-					XmlNode *surfaceCellNode = mapNode->addChild("SurfaceCell");
-					surfaceCellNode->addAttribute("batchIndex", intToStr(i), mapTagReplacements);
-					surfaceCellNode->addAttribute("exploredList", exploredList, mapTagReplacements);
-					surfaceCellNode->addAttribute("visibleList", visibleList, mapTagReplacements);
-
-					exploredList = "";
-					visibleList = "";
-				}
 			}
 
-			if (exploredList != "") {
-				XmlNode *surfaceCellNode = mapNode->addChild("SurfaceCell");
-				surfaceCellNode->addAttribute("batchIndex", intToStr(getSurfaceCellArraySize()), mapTagReplacements);
-				surfaceCellNode->addAttribute("exploredList", exploredList, mapTagReplacements);
-				surfaceCellNode->addAttribute("visibleList", visibleList, mapTagReplacements);
+			for (int i = 0; i < GameConstants::maxPlayers + GameConstants::specialFactions; ++i) {
+				XmlNode *teamCellsNode = mapNode->addChild("TeamCells");
+				teamCellsNode->addAttribute("team", intToStr(i), mapTagReplacements);
+				teamCellsNode->addAttribute("explored", exploredCells[i].toHexString(), mapTagReplacements);
+				teamCellsNode->addAttribute("visible", visibleCells[i].toHexString(), mapTagReplacements);
 			}
 
 			//	Vec2i *startLocations;
@@ -1888,6 +1991,20 @@ namespace Glest {
 				surfaceCell.loadGame(mapNode, i, world);
 			}
 
+			vector<XmlNode *> teamCellsNodeList = mapNode->getChildList("TeamCells");
+			for (unsigned int i = 0; i < teamCellsNodeList.size(); ++i) {
+				XmlNode *teamCellsNode = teamCellsNodeList[i];
+				int teamIndex = teamCellsNode->getAttribute("team")->getIntValue();
+				if (teamIndex < 0 || teamIndex >= GameConstants::maxPlayers + GameConstants::specialFactions) {
+					throw megaglest_runtime_error("Invalid team index in saved map cells: " + intToStr(teamIndex));
+				}
+				if (exploredCells[teamIndex].fromHexString(teamCellsNode->getAttribute("explored")->getValue()) == false ||
+					visibleCells[teamIndex].fromHexString(teamCellsNode->getAttribute("visible")->getValue()) == false) {
+					throw megaglest_runtime_error("Saved map cells do not match the map size for team: " + intToStr(teamIndex));
+				}
+			}
+
+			// saves made before the per team bitsets list every cell
 			int surfaceCellIndexExplored = 0;
 			int surfaceCellIndexVisible = 0;
 			vector<XmlNode *> surfaceCellNodeList = mapNode->getChildList("SurfaceCell");
@@ -1912,8 +2029,6 @@ namespace Glest {
 
 					//int surfaceCellIndex = (i * tokensExplored.size()) + j;
 					//printf("Loading sc = %d batchIndex = %d\n",surfaceCellIndexExplored,batchIndex);
-					SurfaceCell &surfaceCell = surfaceCells[surfaceCellIndexExplored];
-
 					vector<string> tokensExploredValue;
 					Tokenize(valueList, tokensExploredValue, "|");
 
@@ -1927,11 +2042,7 @@ namespace Glest {
 					for (unsigned int k = 0; k < tokensExploredValue.size(); ++k) {
 						string value = tokensExploredValue[k];
 
-						surfaceCell.setExplored(k, strToInt(value) != 0);
-
-						//if(surfaceCell.isExplored(k) == true) {
-						//	printf("Setting cell at index: %d for team: %d to: %d [%s]\n",surfaceCellIndexExplored,k,surfaceCell.isExplored(k),value.c_str());
-						//}
+						setSurfaceExplored(surfaceCellIndexExplored, k, strToInt(value) != 0);
 					}
 					surfaceCellIndexExplored++;
 				}
@@ -1942,8 +2053,6 @@ namespace Glest {
 					string valueList = tokensVisible[j];
 
 					//int surfaceCellIndex = (i * tokensVisible.size()) + j;
-					SurfaceCell &surfaceCell = surfaceCells[surfaceCellIndexVisible];
-
 					vector<string> tokensVisibleValue;
 					Tokenize(valueList, tokensVisibleValue, "|");
 
@@ -1954,7 +2063,7 @@ namespace Glest {
 					for (unsigned int k = 0; k < tokensVisibleValue.size(); ++k) {
 						string value = tokensVisibleValue[k];
 
-						surfaceCell.setVisible(k, strToInt(value) != 0);
+						setSurfaceVisible(surfaceCellIndexVisible, k, strToInt(value) != 0);
 					}
 					surfaceCellIndexVisible++;
 				}
@@ -1962,6 +2071,7 @@ namespace Glest {
 
 			computeNormals();
 			computeInterpolatedHeights();
+			resourceIndex.build(this);
 		}
 
 		// =====================================================
@@ -2046,5 +2156,223 @@ namespace Glest {
 			return pos;
 		}
 
+		// =====================================================
+		//	class FreeCellsTable
+		// =====================================================
+
+		FreeCellsTable::FreeCellsTable() {
+			w = 0;
+			h = 0;
+		}
+
+		void FreeCellsTable::build(const Map *map, const Vec2i &pos, int w, int h, Field field) {
+			this->origin = pos;
+			this->w = max(w, 0);
+			this->h = max(h, 0);
+
+			int stride = this->w + 1;
+			sums.assign(stride * (this->h + 1), 0);
+			for (int j = 0; j < this->h; ++j) {
+				int rowSum = 0;
+				for (int i = 0; i < this->w; ++i) {
+					if (map->isFreeCell(Vec2i(pos.x + i, pos.y + j), field) == false) {
+						rowSum++;
+					}
+					sums[(j + 1) * stride + (i + 1)] = sums[j * stride + (i + 1)] + rowSum;
+				}
+			}
+		}
+
+		bool FreeCellsTable::isInside(const Vec2i &pos, int size) const {
+			return pos.x >= origin.x && pos.y >= origin.y &&
+				pos.x + size <= origin.x + w && pos.y + size <= origin.y + h;
+		}
+
+		bool FreeCellsTable::isFreeCells(const Vec2i &pos, int size) const {
+			if (isInside(pos, size) == false) {
+				throw megaglest_runtime_error("FreeCellsTable query outside of table, pos = " + pos.getString() + " size = " + intToStr(size));
+			}
+
+			int stride = w + 1;
+			int x0 = pos.x - origin.x;
+			int y0 = pos.y - origin.y;
+			int x1 = x0 + size;
+			int y1 = y0 + size;
+			int occupied = sums[y1 * stride + x1] - sums[y0 * stride + x1] -
+				sums[y1 * stride + x0] + sums[y0 * stride + x0];
+			return occupied == 0;
+		}
+
+		// =====================================================
+		//	class SurfaceCellBits
+		// =====================================================
+
+		SurfaceCellBits::SurfaceCellBits() {
+			cellCount = 0;
+		}
+
+		void SurfaceCellBits::init(int cellCount) {
+			this->cellCount = cellCount;
+			words.assign((cellCount + 63) / 64, 0);
+		}
+
+		void SurfaceCellBits::setAll(bool value) {
+			if (words.empty() == true) {
+				return;
+			}
+			memset(&words[0], (value == true ? 0xFF : 0), words.size() * sizeof(uint64));
+			// keep the bits past the last cell clear so saves stay stable
+			int lastBits = cellCount & 63;
+			if (value == true && lastBits != 0) {
+				words.back() &= ((uint64) 1 << lastBits) - 1;
+			}
+		}
+
+		string SurfaceCellBits::toHexString() const {
+			static const char hexDigits[] = "0123456789abcdef";
+			int byteCount = (cellCount + 7) / 8;
+			string result(byteCount * 2, '0');
+			for (int i = 0; i < byteCount; ++i) {
+				int byteValue = (int) ((words[i / 8] >> ((i % 8) * 8)) & 0xFF);
+				result[i * 2] = hexDigits[byteValue >> 4];
+				result[i * 2 + 1] = hexDigits[byteValue & 0x0F];
+			}
+			return result;
+		}
+
+		bool SurfaceCellBits::fromHexString(const string &hex) {
+			int byteCount = (cellCount + 7) / 8;
+			if ((int) hex.size() != byteCount * 2) {
+				return false;
+			}
+			std::fill(words.begin(), words.end(), 0);
+			for (int i = 0; i < byteCount * 2; ++i) {
+				char digit = hex[i];
+				uint64 nibble = 0;
+				if (digit >= '0' && digit <= '9') {
+					nibble = digit - '0';
+				} else if (digit >= 'a' && digit <= 'f') {
+					nibble = digit - 'a' + 10;
+				} else if (digit >= 'A' && digit <= 'F') {
+					nibble = digit - 'A' + 10;
+				} else {
+					return false;
+				}
+				int byteIndex = i / 2;
+				int shift = (byteIndex % 8) * 8 + (i % 2 == 0 ? 4 : 0);
+				words[byteIndex / 8] |= nibble << shift;
+			}
+			int lastBits = cellCount & 63;
+			if (lastBits != 0 && words.empty() == false) {
+				words.back() &= ((uint64) 1 << lastBits) - 1;
+			}
+			return true;
+		}
+
+		// =====================================================
+		//	class ResourceIndex
+		// =====================================================
+
+		ResourceIndex::ResourceIndex() {
+			surfaceW = 0;
+			surfaceH = 0;
+			bucketsW = 0;
+			bucketsH = 0;
+		}
+
+		int ResourceIndex::getTypeIndex(const ResourceType *rt) const {
+			for (unsigned int i = 0; i < resourceTypes.size(); ++i) {
+				if (resourceTypes[i] == rt) {
+					return i;
+				}
+			}
+			return -1;
+		}
+
+		void ResourceIndex::build(const Map *map) {
+			surfaceW = map->getSurfaceW();
+			surfaceH = map->getSurfaceH();
+			bucketsW = (surfaceW + bucketSize - 1) / bucketSize;
+			bucketsH = (surfaceH + bucketSize - 1) / bucketSize;
+			resourceTypes.clear();
+			buckets.clear();
+			cellTypes.assign(surfaceW * surfaceH, 0);
+
+			for (int j = 0; j < surfaceH; ++j) {
+				for (int i = 0; i < surfaceW; ++i) {
+					Resource *r = map->getSurfaceCell(i, j)->getResource();
+					if (r == NULL) {
+						continue;
+					}
+					int typeIndex = getTypeIndex(r->getType());
+					if (typeIndex < 0) {
+						if (resourceTypes.size() >= 255) {
+							throw megaglest_runtime_error("Map holds more than 255 resource types");
+						}
+						typeIndex = (int) resourceTypes.size();
+						resourceTypes.push_back(r->getType());
+						buckets.push_back(std::vector<SurfacePosList>(bucketsW * bucketsH));
+					}
+					cellTypes[j * surfaceW + i] = (unsigned char) (typeIndex + 1);
+					buckets[typeIndex][(j / bucketSize) * bucketsW + (i / bucketSize)].push_back(Vec2i(i, j));
+				}
+			}
+		}
+
+		void ResourceIndex::remove(const Vec2i &surfacePos, const ResourceType *rt) {
+			int typeIndex = getTypeIndex(rt);
+			if (typeIndex < 0 || surfacePos.x < 0 || surfacePos.y < 0 ||
+				surfacePos.x >= surfaceW || surfacePos.y >= surfaceH) {
+				return;
+			}
+			cellTypes[surfacePos.y * surfaceW + surfacePos.x] = 0;
+			SurfacePosList &bucket = buckets[typeIndex][(surfacePos.y / bucketSize) * bucketsW + (surfacePos.x / bucketSize)];
+			for (unsigned int i = 0; i < bucket.size(); ++i) {
+				if (bucket[i] == surfacePos) {
+					bucket[i] = bucket.back();
+					bucket.pop_back();
+					return;
+				}
+			}
+		}
+
+		bool ResourceIndex::hasResources(const ResourceType *rt, const Vec2i &surfaceMin,
+			const Vec2i &surfaceMax) const {
+			int typeIndex = getTypeIndex(rt);
+			if (typeIndex < 0) {
+				return false;
+			}
+			int bx0 = max(surfaceMin.x, 0) / bucketSize;
+			int by0 = max(surfaceMin.y, 0) / bucketSize;
+			int bx1 = min(surfaceMax.x, surfaceW - 1) / bucketSize;
+			int by1 = min(surfaceMax.y, surfaceH - 1) / bucketSize;
+			for (int by = by0; by <= by1; ++by) {
+				for (int bx = bx0; bx <= bx1; ++bx) {
+					if (buckets[typeIndex][by * bucketsW + bx].empty() == false) {
+						return true;
+					}
+				}
+			}
+			return false;
+		}
+
+		void ResourceIndex::findResources(const ResourceType *rt, const Vec2i &surfaceMin,
+			const Vec2i &surfaceMax, std::vector<Vec2i> &surfacePosList) const {
+			int typeIndex = getTypeIndex(rt);
+			if (typeIndex < 0) {
+				return;
+			}
+			int bx0 = max(surfaceMin.x, 0) / bucketSize;
+			int by0 = max(surfaceMin.y, 0) / bucketSize;
+			int bx1 = min(surfaceMax.x, surfaceW - 1) / bucketSize;
+			int by1 = min(surfaceMax.y, surfaceH - 1) / bucketSize;
+			for (int by = by0; by <= by1; ++by) {
+				for (int bx = bx0; bx <= bx1; ++bx) {
+					const SurfacePosList &bucket = buckets[typeIndex][by * bucketsW + bx];
+					surfacePosList.insert(surfacePosList.end(), bucket.begin(), bucket.end());
+				}
+			}
+		}
+
 		}
 	}//end namespace
@@ -52,6 +52,7 @@ namespace Glest {
 		using Shared::Graphics::Vec2f;
 		using Shared::Graphics::Vec2i;
 		using Shared::Graphics::Texture2D;
+		using Shared::Platform::uint64;
 
 		class Tileset;
 		class Unit;
@@ -59,6 +60,7 @@ namespace Glest {
 		class TechTree;
 		class GameSettings;
 		class World;
+		class Map;
 
 		// =====================================================
 		// 	class Cell
@@ -162,10 +164,6 @@ namespace Glest {
 			//object & resource
 			Object *object;
 
-			//visibility
-			bool visible[GameConstants::maxPlayers + GameConstants::specialFactions];
-			bool explored[GameConstants::maxPlayers + GameConstants::specialFactions];
-
 			//cache
 			bool nearSubmerged;
 			bool cellChangedFromOriginalMapLoad;
@@ -210,15 +208,6 @@ namespace Glest {
 				return nearSubmerged;
 			}
 
-			inline bool isVisible(int teamIndex) const {
-				return visible[teamIndex];
-			}
-			inline bool isExplored(int teamIndex) const {
-				return explored[teamIndex];
-			}
-			string isVisibleString() const;
-			string isExploredString() const;
-
 			//set
 			inline void setVertex(const Vec3f &vertex) {
 				this->vertex = vertex;
@@ -245,8 +234,6 @@ namespace Glest {
 			inline void setSurfTexCoord(const Vec2f &stc) {
 				this->surfTexCoord = stc;
 			}
-			void setExplored(int teamIndex, bool explored);
-			void setVisible(int teamIndex, bool visible);
 			inline void setNearSubmerged(bool nearSubmerged) {
 				this->nearSubmerged = nearSubmerged;
 			}
@@ -271,6 +258,100 @@ namespace Glest {
 		};
 
 
+		// =====================================================
+		// 	class SurfaceCellBits
+		//
+		///	One flag per surface cell packed into 64 bit words,
+		///	used for the per team explored and visible state
+		// =====================================================
+
+		class SurfaceCellBits {
+		private:
+			int cellCount;
+			std::vector<uint64> words;
+
+		public:
+			SurfaceCellBits();
+
+			void init(int cellCount);
+
+			inline int getCellCount() const {
+				return cellCount;
+			}
+			inline bool get(int index) const {
+				return ((words[index >> 6] >> (index & 63)) & 1) != 0;
+			}
+			inline void set(int index, bool value) {
+				uint64 bit = (uint64) 1 << (index & 63);
+				if (value == true) {
+					words[index >> 6] |= bit;
+				} else {
+					words[index >> 6] &= ~bit;
+				}
+			}
+			void setAll(bool value);
+
+			// two hex digits per byte, lowest cells first
+			string toHexString() const;
+			// false if the string does not hold exactly cellCount bits
+			bool fromHexString(const string &hex);
+		};
+
+		// =====================================================
+		// 	class ResourceIndex
+		//
+		///	Surface cells holding a resource, bucketed by resource
+		///	type and map area so resource searches do not have to
+		///	walk every cell around the searcher. The type of each
+		///	cell is also kept in one byte so the cells that must
+		///	be walked are read without going through the objects
+		// =====================================================
+
+		class ResourceIndex {
+		public:
+			// surface cells per bucket side
+			static const int bucketSize = 8;
+
+		private:
+			typedef std::vector<Vec2i> SurfacePosList;
+
+			int surfaceW;
+			int surfaceH;
+			int bucketsW;
+			int bucketsH;
+			std::vector<const ResourceType *> resourceTypes;
+			std::vector<std::vector<SurfacePosList> > buckets;
+			// resource type index + 1 of every surface cell, 0 for none
+			std::vector<unsigned char> cellTypes;
+
+			int getTypeIndex(const ResourceType *rt) const;
+
+		public:
+			ResourceIndex();
+
+			void build(const Map *map);
+			void remove(const Vec2i &surfacePos, const ResourceType *rt);
+
+			inline int getResourceTypeCount() const {
+				return (int) resourceTypes.size();
+			}
+			inline const ResourceType *getResourceType(int i) const {
+				return resourceTypes[i];
+			}
+			// resource type index of the surface cell, -1 if it has none
+			inline int getCellTypeIndex(const Vec2i &surfacePos) const {
+				return (int) cellTypes[surfacePos.y * surfaceW + surfacePos.x] - 1;
+			}
+			// true if a resource of this type may lie inside the given
+			// surface rectangle
+			bool hasResources(const ResourceType *rt, const Vec2i &surfaceMin,
+				const Vec2i &surfaceMax) const;
+			// appends every indexed surface position of this type that may lie
+			// inside the given surface rectangle (whole buckets are returned)
+			void findResources(const ResourceType *rt, const Vec2i &surfaceMin,
+				const Vec2i &surfaceMax, std::vector<Vec2i> &surfacePosList) const;
+		};
+
 		// =====================================================
 		// 	class Map
 		//
@@ -286,10 +367,16 @@ namespace Glest {
 			std::map<Vec2i, std::map<Vec2i, bool> > cachedCanMoveSoonList;
 		};
 
+		class MapTerrainRowsTask;
+
 		class Map {
+			friend class MapTerrainRowsTask;
+
 		public:
 			static const int cellScale;	//number of cells per surfaceCell
 			static const int mapScale;	//horizontal scale of surface
+			//fewest surface rows worth a terrain worker thread
+			static const int minSurfaceRowsPerWorker;
 
 		private:
 			string title;
@@ -311,6 +398,9 @@ namespace Glest {
 			Checksum checksumValue;
 			float maxMapHeight;
 			string mapFile;
+			ResourceIndex resourceIndex;
+			SurfaceCellBits exploredCells[GameConstants::maxPlayers + GameConstants::specialFactions];
+			SurfaceCellBits visibleCells[GameConstants::maxPlayers + GameConstants::specialFactions];
 
 		private:
 			Map(Map&);
@@ -327,6 +417,16 @@ namespace Glest {
 			void init(Tileset *tileset);
 			Checksum load(const string &path, TechTree *techTree, Tileset *tileset);
 
+			inline const ResourceIndex *getResourceIndex() const {
+				return &resourceIndex;
+			}
+			void deleteResource(const Vec2i &surfacePos);
+			// the nearest cell no more than maxRadius from pos holding a
+			// resource hct can harvest that is not a bad harvest position of
+			// unit (if given), ties go to the lower x, then the lower y
+			bool findHarvestCell(const Vec2i &pos, int maxRadius,
+				const HarvestCommandType *hct, const Unit *unit, Vec2i &resultPos) const;
+
 			//get
 			inline Cell *getCell(int x, int y, bool errorOnInvalid = true) const {
 				int arrayIndex = y * w + x;
@@ -371,6 +471,38 @@ namespace Glest {
 			inline SurfaceCell *getSurfaceCell(const Vec2i &sPos) const {
 				return getSurfaceCell(sPos.x, sPos.y);
 			}
+			inline int getSurfaceCellIndex(const Vec2i &sPos) const {
+				return sPos.y * surfaceW + sPos.x;
+			}
+
+			//visibility, kept per team outside the surface cells
+			inline bool isSurfaceVisible(int surfaceIndex, int teamIndex) const {
+				return visibleCells[teamIndex].get(surfaceIndex);
+			}
+			inline bool isSurfaceVisible(const Vec2i &sPos, int teamIndex) const {
+				return visibleCells[teamIndex].get(getSurfaceCellIndex(sPos));
+			}
+			inline bool isSurfaceExplored(int surfaceIndex, int teamIndex) const {
+				return exploredCells[teamIndex].get(surfaceIndex);
+			}
+			inline bool isSurfaceExplored(const Vec2i &sPos, int teamIndex) const {
+				return exploredCells[teamIndex].get(getSurfaceCellIndex(sPos));
+			}
+			void setSurfaceVisible(int surfaceIndex, int teamIndex, bool visible);
+			inline void setSurfaceVisible(const Vec2i &sPos, int teamIndex, bool visible) {
+				setSurfaceVisible(getSurfaceCellIndex(sPos), teamIndex, visible);
+			}
+			void setSurfaceExplored(int surfaceIndex, int teamIndex, bool explored);
+			inline void setSurfaceExplored(const Vec2i &sPos, int teamIndex, bool explored) {
+				setSurfaceExplored(getSurfaceCellIndex(sPos), teamIndex, explored);
+			}
+			void setAllSurfaceVisible(int teamIndex, bool visible);
+			void setAllSurfaceExplored(int teamIndex, bool explored);
+			// bit n is set when team n sees / has explored the cell
+			int getSurfaceVisibleTeams(const Vec2i &sPos) const;
+			int getSurfaceExploredTeams(const Vec2i &sPos) const;
+			string getSurfaceVisibleString(const Vec2i &sPos) const;
+			string getSurfaceExploredString(const Vec2i &sPos) const;
 
 			inline int getW() const {
 				return w;
@@ -487,11 +619,12 @@ namespace Glest {
 
 			inline bool isAproxFreeCellOrMightBeFreeSoon(Vec2i originPos, const Vec2i &pos, Field field, int teamIndex) const {
 				if (isInside(pos) && isInsideSurface(toSurfCoords(pos))) {
-					const SurfaceCell *sc = getSurfaceCell(toSurfCoords(pos));
+					const Vec2i sPos = toSurfCoords(pos);
+					const SurfaceCell *sc = getSurfaceCell(sPos);
 
-					if (sc->isVisible(teamIndex)) {
+					if (isSurfaceVisible(sPos, teamIndex)) {
 						return isFreeCellOrMightBeFreeSoon(originPos, pos, field);
-					} else if (sc->isExplored(teamIndex)) {
+					} else if (isSurfaceExplored(sPos, teamIndex)) {
 						return field == fLand ? sc->isFree() && !getDeepSubmerged(getCell(pos)) : true;
 					} else {
 						return true;
@@ -538,16 +671,16 @@ namespace Glest {
 						SystemFlags::getSystemSettingType(SystemFlags::debugWorldSynchMax).enabled == true) {
 						string extraInfo = (string("tryPosResult = ") + (tryPosResult ? string("true") : string("false")));
 						const SurfaceCell *sc = getSurfaceCell(toSurfCoords(pos2));
-						if (sc->isVisible(teamIndex)) {
+						if (isSurfaceVisible(toSurfCoords(pos2), teamIndex)) {
 							bool testCond = isFreeCellOrMightBeFreeSoon(unit->getPosNotThreadSafe(), pos2, field);
 							extraInfo += (string("isFreeCellOrMightBeFreeSoon = ") + (testCond ? string("true") : string("false")));
-						} else if (sc->isExplored(teamIndex)) {
+						} else if (isSurfaceExplored(toSurfCoords(pos2), teamIndex)) {
 							bool testCond = field == fLand ? sc->isFree() && !getDeepSubmerged(getCell(pos2)) : true;
 							extraInfo += (string("field==fLand = ") + (testCond ? string("true") : string("false")));
 						}
 
 						char szBuf[8096] = "";
-						snprintf(szBuf, 8096, "In aproxCanMoveSoon() pos2 = %s extraInfo = %s %s %s", pos2.getString().c_str(), extraInfo.c_str(), sc->isVisibleString().c_str(), sc->isExploredString().c_str());
+						snprintf(szBuf, 8096, "In aproxCanMoveSoon() pos2 = %s extraInfo = %s %s %s", pos2.getString().c_str(), extraInfo.c_str(), getSurfaceVisibleString(toSurfCoords(pos2)).c_str(), getSurfaceExploredString(toSurfCoords(pos2)).c_str());
 						if (Thread::isCurrentThreadMainThread() == false) {
 							unit->logSynchDataThreaded(__FILE__, __LINE__, szBuf);
 						} else {
@@ -566,10 +699,10 @@ namespace Glest {
 							SystemFlags::getSystemSettingType(SystemFlags::debugWorldSynchMax).enabled == true) {
 							string extraInfo = (string("tryPosResult = ") + (tryPosResult ? string("true") : string("false")));
 							const SurfaceCell *sc = getSurfaceCell(toSurfCoords(tryPos));
-							if (sc->isVisible(teamIndex)) {
+							if (isSurfaceVisible(toSurfCoords(tryPos), teamIndex)) {
 								bool testCond = isFreeCellOrMightBeFreeSoon(unit->getPosNotThreadSafe(), tryPos, field);
 								extraInfo += (string("isFreeCellOrMightBeFreeSoon = ") + (testCond ? string("true") : string("false")));
-							} else if (sc->isExplored(teamIndex)) {
+							} else if (isSurfaceExplored(toSurfCoords(tryPos), teamIndex)) {
 								bool testCond = field == fLand ? sc->isFree() && !getDeepSubmerged(getCell(tryPos)) : true;
 								extraInfo += (string("field==fLand = ") + (testCond ? string("true") : string("false")));
 							}
@@ -594,10 +727,10 @@ namespace Glest {
 							SystemFlags::getSystemSettingType(SystemFlags::debugWorldSynchMax).enabled == true) {
 							string extraInfo = (string("tryPosResult = ") + (tryPosResult ? string("true") : string("false")));
 							const SurfaceCell *sc = getSurfaceCell(toSurfCoords(tryPos));
-							if (sc->isVisible(teamIndex)) {
+							if (isSurfaceVisible(toSurfCoords(tryPos), teamIndex)) {
 								bool testCond = isFreeCellOrMightBeFreeSoon(unit->getPosNotThreadSafe(), tryPos, field);
 								extraInfo += (string("isFreeCellOrMightBeFreeSoon = ") + (testCond ? string("true") : string("false")));
-							} else if (sc->isExplored(teamIndex)) {
+							} else if (isSurfaceExplored(toSurfCoords(tryPos), teamIndex)) {
 								bool testCond = field == fLand ? sc->isFree() && !getDeepSubmerged(getCell(tryPos)) : true;
 								extraInfo += (string("field==fLand = ") + (testCond ? string("true") : string("false")));
 							}
@@ -720,9 +853,17 @@ namespace Glest {
 
 		private:
 			//compute
-			void smoothSurface(Tileset *tileset);
-			void computeNearSubmerged();
-			void computeCellColors();
+			void smoothSurface(Tileset *tileset, int workerCount);
+			void computeTerrain(int workerCount);
+
+			//compute, for the surface rows firstRow up to endRow
+			void smoothSurfaceRows(const float *oldHeights, float *smoothedHeights,
+				char *cliffCells, float &maxHeight, int firstRow, int endRow) const;
+			void setSurfaceHeightsRows(const float *heights, int firstRow, int endRow);
+			void computeNormalsRows(int firstRow, int endRow);
+			void computeInterpolatedHeightsRows(int firstRow, int endRow);
+			void computeNearSubmergedRows(int firstRow, int endRow);
+			void computeCellColorsRows(int firstRow, int endRow);
 			void putUnitCellsPrivate(Unit *unit, const Vec2i &pos, const UnitType *ut, bool isMorph, bool threaded);
 		};
 
@@ -763,6 +904,30 @@ namespace Glest {
 			const Vec2i &getPos();
 		};
 
+		// ===============================
+		// 	class FreeCellsTable
+		//
+		///	Summed-area table of the cells that are not free in a
+		///	rectangle of the map, so any square inside it can be
+		///	tested with Map::isFreeCells semantics in constant time
+		// ===============================
+
+		class FreeCellsTable {
+		private:
+			Vec2i origin;
+			int w;
+			int h;
+			// (w + 1) * (h + 1) prefix sums, first row and column are zero
+			std::vector<int> sums;
+
+		public:
+			FreeCellsTable();
+
+			void build(const Map *map, const Vec2i &pos, int w, int h, Field field);
+			bool isInside(const Vec2i &pos, int size) const;
+			bool isFreeCells(const Vec2i &pos, int size) const;
+		};
+
 	}
 } //end namespace
 
@@ -0,0 +1,251 @@
+//
+//      render_snapshot.cpp:
+//
+//      This file is part of ZetaGlest <https://github.com/ZetaGlest>
+//
+//      Copyright (C) 2018  The ZetaGlest team
+//
+//      ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+//      This program is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program.  If not, see <https://www.gnu.org/licenses/>
+
+#include "render_snapshot.h"
+
+#include <algorithm>
+#include <chrono>
+#include "world.h"
+#include "faction.h"
+#include "unit.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Platform;
+
+namespace Glest {
+	namespace Game {
+
+		// a unit that moved further than this between two snapshots was
+		// placed somewhere new and is not slid across the map
+		static const float maxInterpolationDistance = 4.f;
+
+		// =====================================================
+		//      class UnitRenderState
+		// =====================================================
+
+		UnitRenderState::UnitRenderState() {
+			unitId = -1;
+			rotation = 0.f;
+			rotationX = 0.f;
+			rotationZ = 0.f;
+			animProgress = 0.f;
+			skill = NULL;
+			alive = false;
+			renderInMap = false;
+		}
+
+		void UnitRenderState::capture(const World *world, const Unit *unit) {
+			unitId = unit->getId();
+			cellPos = unit->getPosNotThreadSafe();
+			vectorFlat = unit->getCurrVectorFlat();
+			rotation = unit->getRotation();
+			rotationX = unit->getRotationX();
+			rotationZ = unit->getRotationZ();
+			animProgress = unit->getAnimProgressAsFloat();
+			skill = unit->getCurrSkill();
+			alive = unit->isAlive();
+			renderInMap = (world != NULL && world->toRenderUnit(unit) == true);
+		}
+
+		// =====================================================
+		//      class RenderSnapshot
+		// =====================================================
+
+		RenderSnapshot::RenderSnapshot() {
+			frame = -1;
+			publishMicros = 0;
+		}
+
+		const UnitRenderState *RenderSnapshot::findUnit(int unitId) const {
+			UnitRenderState key;
+			key.unitId = unitId;
+			std::vector<UnitRenderState>::const_iterator iterFind =
+				std::lower_bound(units.begin(), units.end(), key);
+			if (iterFind == units.end() || iterFind->unitId != unitId) {
+				return NULL;
+			}
+			return &(*iterFind);
+		}
+
+		// =====================================================
+		//      class RenderSnapshots
+		// =====================================================
+
+		RenderSnapshots::RenderSnapshots() {
+			mutex = new Mutex(CODE_AT_LINE);
+			interpolate = true;
+			clear();
+		}
+
+		RenderSnapshots::~RenderSnapshots() {
+			delete mutex;
+			mutex = NULL;
+		}
+
+		void RenderSnapshots::init(bool interpolate) {
+			this->interpolate = interpolate;
+			clear();
+		}
+
+		void RenderSnapshots::clear() {
+			MutexSafeWrapper safeMutex(mutex, CODE_AT_LINE);
+			current = -1;
+			previous = -1;
+			readCurrent = -1;
+			readPrevious = -1;
+			renderCurrent = NULL;
+			renderPrevious = NULL;
+			renderAlpha = 1.f;
+		}
+
+		int RenderSnapshots::getWriteIndex() const {
+			for (int i = 0; i < snapshotCount; ++i) {
+				if (i != current && i != previous && i != readCurrent && i != readPrevious) {
+					return i;
+				}
+			}
+			throw megaglest_runtime_error("No free render snapshot");
+		}
+
+		void RenderSnapshots::publish(const World *world) {
+			MutexSafeWrapper safeMutex(mutex, CODE_AT_LINE);
+			int writeIndex = getWriteIndex();
+			safeMutex.ReleaseLock();
+
+			// nobody else looks at this snapshot until it is published
+			RenderSnapshot &snapshot = snapshots[writeIndex];
+			snapshot.frame = world->getFrameCount();
+			snapshot.units.clear();
+			for (int i = 0; i < world->getFactionCount(); ++i) {
+				const Faction *faction = world->getFaction(i);
+				for (int j = 0; j < faction->getUnitCount(); ++j) {
+					UnitRenderState state;
+					state.capture(world, faction->getUnit(j));
+					snapshot.units.push_back(state);
+				}
+			}
+			std::sort(snapshot.units.begin(), snapshot.units.end());
+			snapshot.publishMicros = getCurrentMicros();
+
+			safeMutex.Lock();
+			previous = current;
+			current = writeIndex;
+		}
+
+		void RenderSnapshots::beginRender() {
+			MutexSafeWrapper safeMutex(mutex, CODE_AT_LINE);
+			readCurrent = current;
+			readPrevious = previous;
+			safeMutex.ReleaseLock();
+
+			renderCurrent = (readCurrent >= 0 ? &snapshots[readCurrent] : NULL);
+			renderPrevious = (readPrevious >= 0 ? &snapshots[readPrevious] : NULL);
+			renderAlpha = 1.f;
+			if (interpolate == true && renderCurrent != NULL && renderPrevious != NULL) {
+				int64 interval = renderCurrent->publishMicros - renderPrevious->publishMicros;
+				if (interval > 0) {
+					// drawn one world update behind, reaching the newest
+					// snapshot when the next one is due
+					renderAlpha = (float) (getCurrentMicros() - renderCurrent->publishMicros) / interval;
+					renderAlpha = std::max(0.f, std::min(1.f, renderAlpha));
+				}
+			}
+		}
+
+		void RenderSnapshots::endRender() {
+			renderCurrent = NULL;
+			renderPrevious = NULL;
+
+			MutexSafeWrapper safeMutex(mutex, CODE_AT_LINE);
+			readCurrent = -1;
+			readPrevious = -1;
+		}
+
+		static float interpolateAngle(float from, float to, float alpha) {
+			float diff = to - from;
+			while (diff > 180.f) {
+				diff -= 360.f;
+			}
+			while (diff < -180.f) {
+				diff += 360.f;
+			}
+			return from + diff * alpha;
+		}
+
+		bool RenderSnapshots::getUnitRenderInMap(int unitId, bool &renderInMap) const {
+			if (renderCurrent == NULL) {
+				return false;
+			}
+			const UnitRenderState *currentState = renderCurrent->findUnit(unitId);
+			if (currentState == NULL) {
+				return false;
+			}
+			renderInMap = currentState->renderInMap;
+			return true;
+		}
+
+		bool RenderSnapshots::getUnitState(int unitId, UnitRenderState &state) const {
+			if (renderCurrent == NULL) {
+				return false;
+			}
+			const UnitRenderState *currentState = renderCurrent->findUnit(unitId);
+			if (currentState == NULL) {
+				return false;
+			}
+			state = *currentState;
+			if (renderPrevious == NULL || renderAlpha >= 1.f) {
+				return true;
+			}
+
+			const UnitRenderState *previousState = renderPrevious->findUnit(unitId);
+			if (previousState == NULL || previousState->alive != currentState->alive ||
+				previousState->vectorFlat.dist(currentState->vectorFlat) > maxInterpolationDistance) {
+				return true;
+			}
+
+			state.vectorFlat = previousState->vectorFlat +
+				(currentState->vectorFlat - previousState->vectorFlat) * renderAlpha;
+			state.rotation = interpolateAngle(previousState->rotation, currentState->rotation, renderAlpha);
+			state.rotationX = interpolateAngle(previousState->rotationX, currentState->rotationX, renderAlpha);
+			state.rotationZ = interpolateAngle(previousState->rotationZ, currentState->rotationZ, renderAlpha);
+			if (previousState->skill == currentState->skill) {
+				// looping animations wrap around between the two snapshots
+				float nextProgress = currentState->animProgress;
+				if (nextProgress < previousState->animProgress) {
+					nextProgress += 1.f;
+				}
+				state.animProgress = previousState->animProgress +
+					(nextProgress - previousState->animProgress) * renderAlpha;
+				if (state.animProgress >= 1.f) {
+					state.animProgress -= 1.f;
+				}
+			}
+			return true;
+		}
+
+		int64 RenderSnapshots::getCurrentMicros() {
+			return std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+	}
+}//end namespace
@@ -0,0 +1,148 @@
+//
+//      render_snapshot.h:
+//
+//      This file is part of ZetaGlest <https://github.com/ZetaGlest>
+//
+//      Copyright (C) 2018  The ZetaGlest team
+//
+//      ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+//      This program is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program.  If not, see <https://www.gnu.org/licenses/>
+
+#ifndef _GLEST_GAME_RENDERSNAPSHOT_H_
+#   define _GLEST_GAME_RENDERSNAPSHOT_H_
+
+#   include <vector>
+#   include "vec.h"
+#   include "thread.h"
+#   include "data_types.h"
+#   include "leak_dumper.h"
+
+using Shared::Graphics::Vec2i;
+using Shared::Graphics::Vec3f;
+using Shared::Platform::Mutex;
+using Shared::Platform::int64;
+
+namespace Glest {
+	namespace Game {
+
+		class World;
+		class Unit;
+		class SkillType;
+
+		// =====================================================
+		//      class UnitRenderState
+		//
+		///     What the renderer needs to draw one unit, copied
+		///     from the unit at the end of a world update
+		// =====================================================
+
+		class UnitRenderState {
+		public:
+			UnitRenderState();
+
+			void capture(const World *world, const Unit *unit);
+
+			int unitId;
+			Vec2i cellPos;
+			Vec3f vectorFlat;
+			float rotation;
+			float rotationX;
+			float rotationZ;
+			float animProgress;
+			const SkillType *skill;
+			bool alive;
+			bool renderInMap;
+
+			inline bool operator<(const UnitRenderState &state) const {
+				return unitId < state.unitId;
+			}
+		};
+
+		// =====================================================
+		//      class RenderSnapshot
+		// =====================================================
+
+		class RenderSnapshot {
+		public:
+			RenderSnapshot();
+
+			int frame;
+			int64 publishMicros;
+			// sorted by unit id
+			std::vector<UnitRenderState> units;
+
+			const UnitRenderState *findUnit(int unitId) const;
+		};
+
+		// =====================================================
+		//      class RenderSnapshots
+		//
+		///     The simulation publishes an immutable snapshot of
+		///     all units after each world update; the renderer
+		///     draws between the last two, so unit movement stays
+		///     smooth however world frames and render frames
+		///     line up and rendering never reads a unit while
+		///     the simulation is changing it
+		// =====================================================
+
+		class RenderSnapshots {
+		private:
+			// published, previous, the two the renderer holds
+			// and one to write: the simulation never waits
+			static const int snapshotCount = 5;
+
+			Mutex *mutex;
+			RenderSnapshot snapshots[snapshotCount];
+			int current;
+			int previous;
+			int readCurrent;
+			int readPrevious;
+			bool interpolate;
+
+			// render side, only valid between beginRender and endRender
+			const RenderSnapshot *renderCurrent;
+			const RenderSnapshot *renderPrevious;
+			float renderAlpha;
+
+			int getWriteIndex() const;
+
+		public:
+			RenderSnapshots();
+			~RenderSnapshots();
+
+			void init(bool interpolate);
+			void clear();
+
+			// simulation side
+			void publish(const World *world);
+
+			// render side
+			void beginRender();
+			void endRender();
+			inline bool hasSnapshot() const {
+				return renderCurrent != NULL;
+			}
+			// false when the unit was not in the last snapshot
+			bool getUnitState(int unitId, UnitRenderState &state) const;
+			// same, for the visibility test alone
+			bool getUnitRenderInMap(int unitId, bool &renderInMap) const;
+
+			static int64 getCurrentMicros();
+		};
+
+	}
+}//end namespace
+
+#endif
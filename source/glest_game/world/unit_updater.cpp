@@ -58,7 +58,7 @@ namespace Glest {
 		// ===================== PUBLIC ========================
 
 		UnitUpdater::UnitUpdater() : mutexAttackWarnings(new Mutex(CODE_AT_LINE)),
-			mutexUnitRangeCellsLookupItemCache(new Mutex(CODE_AT_LINE)) {
+			mutexUnitRangeCellsLookupItemCache(new Mutex(CODE_AT_LINE_X(mutexUnitRangeCellsLookupItemCache))) {
 			this->game = NULL;
 			this->gui = NULL;
 			this->gameCamera = NULL;
@@ -112,7 +112,7 @@ namespace Glest {
 			delete pathFinder;
 			pathFinder = NULL;
 
-			MutexSafeWrapper safeMutex(mutexAttackWarnings, string(__FILE__) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutex(mutexAttackWarnings, CODE_AT_LINE);
 			while (attackWarnings.empty() == false) {
 				AttackWarningData* awd = attackWarnings.back();
 				attackWarnings.pop_back();
@@ -147,7 +147,7 @@ namespace Glest {
 			for (SkillSoundList::const_iterator it = currSkill->getSkillSoundList()->begin(); it != currSkill->getSkillSoundList()->end(); ++it) {
 				float soundStartTime = (*it)->getStartTime();
 				if (soundStartTime >= unit->getLastAnimProgressAsFloat() && soundStartTime < unit->getAnimProgressAsFloat()) {
-					if (map->getSurfaceCell(Map::toSurfCoords(unit->getPos()))->isVisible(world->getThisTeamIndex()) ||
+					if (map->isSurfaceVisible(Map::toSurfCoords(unit->getPos()), world->getThisTeamIndex()) ||
 						(game->getWorld()->showWorldForPlayer(game->getWorld()->getThisTeamIndex()) == true)) {
 						soundRenderer.playFx((*it)->getSoundContainer()->getRandSound(), unit->getCurrMidHeightVector(), gameCamera->getPos());
 					}
@@ -180,7 +180,7 @@ namespace Glest {
 						enabled = currSkill->getShakeEnemyEnabled();
 					}
 
-					bool visibility = (!visibleAffected) || (map->getSurfaceCell(Map::toSurfCoords(unit->getPos()))->isVisible(world->getThisTeamIndex()) ||
+					bool visibility = (!visibleAffected) || (map->isSurfaceVisible(Map::toSurfCoords(unit->getPos()), world->getThisTeamIndex()) ||
 						(game->getWorld()->showWorldForPlayer(game->getWorld()->getThisTeamIndex()) == true));
 
 					bool cameraAffected = (!cameraViewAffected) || unit->getVisible();
@@ -1805,7 +1805,7 @@ namespace Glest {
 										//if resource exausted, then delete it and stop
 										if (sc->decAmount(1)) {
 											//const ResourceType *rt = r->getType();
-											sc->deleteResource();
+											map->deleteResource(Map::toSurfCoords(unitTargetPos));
 											world->removeResourceTargetFromCache(unitTargetPos);
 
 											switch (this->game->getGameSettings()->getPathFinderType()) {
@@ -2691,9 +2691,8 @@ namespace Glest {
 			Vec3f endPos = unit->getTargetVec();
 
 			//make particle system
-			const SurfaceCell *sc = map->getSurfaceCell(Map::toSurfCoords(unit->getPos()));
-			const SurfaceCell *tsc = map->getSurfaceCell(Map::toSurfCoords(unit->getTargetPos()));
-			bool visible = sc->isVisible(world->getThisTeamIndex()) || tsc->isVisible(world->getThisTeamIndex());
+			bool visible = map->isSurfaceVisible(Map::toSurfCoords(unit->getPos()), world->getThisTeamIndex()) ||
+				map->isSurfaceVisible(Map::toSurfCoords(unit->getTargetPos()), world->getThisTeamIndex());
 			if (visible == false && world->showWorldForPlayer(world->getThisFactionIndex()) == true) {
 				visible = true;
 			}
@@ -2752,25 +2751,11 @@ namespace Glest {
 		//resource the unit can harvest
 		bool UnitUpdater::searchForResource(Unit *unit, const HarvestCommandType *hct) {
 			Vec2i pos = unit->getCurrCommand()->getPos();
+			Vec2i newPos;
+			if (map->findHarvestCell(pos, maxResSearchRadius - 1, hct, unit, newPos) == true) {
+				unit->getCurrCommand()->setPos(newPos);
 
-			for (int radius = 0; radius < maxResSearchRadius; radius++) {
-				for (int i = pos.x - radius; i <= pos.x + radius; ++i) {
-					for (int j = pos.y - radius; j <= pos.y + radius; ++j) {
-						if (map->isInside(i, j)) {
-							Resource *r = map->getSurfaceCell(Map::toSurfCoords(Vec2i(i, j)))->getResource();
-							if (r != NULL) {
-								if (hct->canHarvest(r->getType())) {
-									const Vec2i newPos = Vec2i(i, j);
-									if (unit->isBadHarvestPos(newPos) == false) {
-										unit->getCurrCommand()->setPos(newPos);
-
-										return true;
-									}
-								}
-							}
-						}
-					}
-				}
+				return true;
 			}
 
 			return false;
@@ -2795,7 +2780,7 @@ namespace Glest {
 			const AttackSkillType *ast, const Unit *unit,
 			const Unit *commandTarget) {
 			bool result = false;
-			MutexSafeWrapper safeMutex(mutexUnitRangeCellsLookupItemCache, string(__FILE__) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutex(mutexUnitRangeCellsLookupItemCache, CODE_AT_LINE);
 			std::map<Vec2i, std::map<int, std::map<int, UnitRangeCellsLookupItem > > >::iterator iterFind = UnitRangeCellsLookupItemCache.find(center);
 
 			if (iterFind != UnitRangeCellsLookupItemCache.end()) {
@@ -2920,7 +2905,7 @@ namespace Glest {
 
 					// Ok update our caches with the latest info
 					if (cacheItem.rangeCellList.empty() == false) {
-						MutexSafeWrapper safeMutex(mutexUnitRangeCellsLookupItemCache, string(__FILE__) + "_" + intToStr(__LINE__));
+						MutexSafeWrapper safeMutex(mutexUnitRangeCellsLookupItemCache, CODE_AT_LINE);
 
 						UnitRangeCellsLookupItemCache[center][size][range] = cacheItem;
 					}
@@ -3021,7 +3006,7 @@ namespace Glest {
 						float nearestDistance = 0.f;
 
 
-						MutexSafeWrapper safeMutex(mutexAttackWarnings, string(__FILE__) + "_" + intToStr(__LINE__));
+						MutexSafeWrapper safeMutex(mutexAttackWarnings, CODE_AT_LINE);
 						for (int i = (int) attackWarnings.size() - 1; i >= 0; --i) {
 							if (world->getFrameCount() - attackWarnings[i]->lastFrameCount > 200) { //after 200 frames attack break we warn again
 								AttackWarningData *toDelete = attackWarnings[i];
@@ -3067,7 +3052,7 @@ namespace Glest {
 							awd->attackPosition.x = enemyFloatCenter.x;
 							awd->attackPosition.y = enemyFloatCenter.y;
 
-							MutexSafeWrapper safeMutex(mutexAttackWarnings, string(__FILE__) + "_" + intToStr(__LINE__));
+							MutexSafeWrapper safeMutex(mutexAttackWarnings, CODE_AT_LINE);
 							attackWarnings.push_back(awd);
 
 							if (world->getAttackWarningsEnabled() == true) {
@@ -3150,7 +3135,7 @@ namespace Glest {
 
 					// Ok update our caches with the latest info
 					if (cacheItem.rangeCellList.empty() == false) {
-						MutexSafeWrapper safeMutex(mutexUnitRangeCellsLookupItemCache, string(__FILE__) + "_" + intToStr(__LINE__));
+						MutexSafeWrapper safeMutex(mutexUnitRangeCellsLookupItemCache, CODE_AT_LINE);
 
 						UnitRangeCellsLookupItemCache[center][size][range] = cacheItem;
 					}
@@ -3240,7 +3225,7 @@ namespace Glest {
 			int rangeCount = 0;
 			int rangeCountCellCount = 0;
 
-			MutexSafeWrapper safeMutex(mutexUnitRangeCellsLookupItemCache, string(__FILE__) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutex(mutexUnitRangeCellsLookupItemCache, CODE_AT_LINE);
 			for (std::map<Vec2i, std::map<int, std::map<int, UnitRangeCellsLookupItem > > >::iterator iterMap1 = UnitRangeCellsLookupItemCache.begin();
 				iterMap1 != UnitRangeCellsLookupItemCache.end(); ++iterMap1) {
 				posCount++;
@@ -3358,7 +3343,7 @@ namespace Glest {
 
 					//Unit *attacked= map->getCell(targetPos)->getUnit(targetField);
 					Vec2i surfaceTargetPos = Map::toSurfCoords(targetPos);
-					bool visibility = (!projectileType->isShakeVisible()) || (map->getSurfaceCell(surfaceTargetPos)->isVisible(world->getThisTeamIndex()) ||
+					bool visibility = (!projectileType->isShakeVisible()) || (map->isSurfaceVisible(surfaceTargetPos, world->getThisTeamIndex()) ||
 						(game->getWorld()->showWorldForPlayer(game->getWorld()->getThisTeamIndex()) == true));
 
 					bool isInCameraView = (!projectileType->isShakeInCameraView()) || Renderer::getInstance().posInCellQuadCache(surfaceTargetPos).first;
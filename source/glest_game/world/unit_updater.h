@@ -114,6 +114,10 @@ namespace Glest {
 			void init(Game *game);
 			~UnitUpdater();
 
+			static int getMaxResSearchRadius() {
+				return maxResSearchRadius;
+			}
+
 			//update skills
 			bool updateUnit(Unit *unit);
 
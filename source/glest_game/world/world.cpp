@@ -307,7 +307,7 @@ namespace Glest {
 				for (int j = 0; j < map.getSurfaceH(); ++j) {
 					for (int k = 0; k < GameConstants::maxPlayers + GameConstants::specialFactions; ++k) {
 						if (k == thisTeamIndex) {
-							if (map.getSurfaceCell(i, j)->isExplored(k) == true) {
+							if (map.isSurfaceExplored(Vec2i(i, j), k) == true) {
 								const Vec2i pos(i, j);
 								Vec2i surfPos = pos;
 								//compute max alpha
@@ -332,6 +332,31 @@ namespace Glest {
 			}
 		}
 
+		string World::getSynchTraceTagName(int tag) {
+			static const char *tagNames[sttCount] = {
+				"worldRandom",
+				"pos",
+				"lastPos",
+				"targetPos",
+				"meetingPos",
+				"progress",
+				"progress2",
+				"hp",
+				"ep",
+				"loadCount",
+				"random",
+				"skillClass",
+				"commandCount",
+				"pathBlockCount",
+				"pathQueueSize",
+				"logSite"
+			};
+			if (tag < 0 || tag >= sttCount) {
+				return "unknown(" + intToStr(tag) + ")";
+			}
+			return tagNames[tag];
+		}
+
 		void World::init(Game *game, bool createUnits, bool initFactions) {
 
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d]\n", __FILE__, __FUNCTION__, __LINE__);
@@ -346,6 +371,15 @@ namespace Glest {
 			if (fogOfWarOverride == false) {
 				fogOfWar = gs->getFogOfWar();
 			}
+
+			// the binary synch trace is only needed to compare network peers.
+			// The ring keeps the last SynchTraceRecords records (16 bytes
+			// each) and is only written out when a peer loses synch
+			int synchTraceRecords = 0;
+			if (gs->isNetworkGame() == true) {
+				synchTraceRecords = max(Config::getInstance().getInt("SynchTraceRecords", "65536"), 0);
+			}
+			synchTrace.init(synchTraceRecords);
 			originalGameFogOfWar = fogOfWar;
 
 			if (loadWorldNode != NULL) {
@@ -398,23 +432,12 @@ namespace Glest {
 				map.loadGame(loadWorldNode, this);
 
 				if (fogOfWar == false) {
-					for (int i = 0; i < map.getSurfaceW(); ++i) {
-						for (int j = 0; j < map.getSurfaceH(); ++j) {
-
-							SurfaceCell *sc = map.getSurfaceCell(i, j);
-							if (sc == NULL) {
-								throw megaglest_runtime_error("sc == NULL");
-							}
-
-							for (int k = 0; k < GameConstants::maxPlayers; k++) {
-								//sc->setExplored(k, (game->getGameSettings()->getFlagTypes1() & ft1_show_map_resources) == ft1_show_map_resources);
-								sc->setVisible(k, !fogOfWar);
-							}
-							for (int k = GameConstants::maxPlayers; k < GameConstants::maxPlayers + GameConstants::specialFactions; k++) {
-								sc->setExplored(k, true);
-								sc->setVisible(k, true);
-							}
-						}
+					for (int k = 0; k < GameConstants::maxPlayers; k++) {
+						map.setAllSurfaceVisible(k, !fogOfWar);
+					}
+					for (int k = GameConstants::maxPlayers; k < GameConstants::maxPlayers + GameConstants::specialFactions; k++) {
+						map.setAllSurfaceExplored(k, true);
+						map.setAllSurfaceVisible(k, true);
 					}
 				} else {
 					restoreExploredFogOfWarCells();
@@ -726,7 +749,11 @@ namespace Glest {
 					//bool isStuckWithinTolerance = unit->isLastStuckFrameWithinCurrentFrameTolerance(false);
 					//uint32 lastStuckFrame = unit->getLastStuckFrame();
 
-					if (unitUpdater.updateUnit(unit) == true) {
+					bool unitUpdated = unitUpdater.updateUnit(unit);
+					if (synchTrace.isEnabled() == true) {
+						unit->addSynchTrace(&synchTrace, frameCount);
+					}
+					if (unitUpdated == true) {
 						unitCountUpdated++;
 
 						if (unit->getLastStuckFrame() == (unsigned int) frameCount) {
@@ -846,6 +873,7 @@ namespace Glest {
 			Chrono chronoGamePerformanceCounts;
 
 			++frameCount;
+			synchTrace.add(frameCount, -1, sttWorldRandom, random.getLastNumber());
 
 			//time
 			timeFlow.update();
@@ -872,7 +900,7 @@ namespace Glest {
 
 			updateAllTilesetObjects();
 
-			if (this->game) this->game->addPerformanceCount("updateAllTilesetObjects", chronoGamePerformanceCounts.getMillis());
+			if (this->game) this->game->addPerformanceCount("updateAllTilesetObjects", chronoGamePerformanceCounts.getMicros());
 
 			if (showPerfStats) {
 				sprintf(perfBuf, "In [%s::%s] Line: %d took msecs: " MG_I64_SPECIFIER "\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, chronoPerf.getMillis());
@@ -885,7 +913,7 @@ namespace Glest {
 
 				updateAllFactionUnits();
 
-				if (this->game) this->game->addPerformanceCount("updateAllFactionUnits", chronoGamePerformanceCounts.getMillis());
+				if (this->game) this->game->addPerformanceCount("updateAllFactionUnits", chronoGamePerformanceCounts.getMicros());
 
 				if (showPerfStats) {
 					sprintf(perfBuf, "In [%s::%s] Line: %d took msecs: " MG_I64_SPECIFIER "\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, chronoPerf.getMillis());
@@ -897,7 +925,7 @@ namespace Glest {
 
 				underTakeDeadFactionUnits();
 
-				if (this->game) this->game->addPerformanceCount("underTakeDeadFactionUnits", chronoGamePerformanceCounts.getMillis());
+				if (this->game) this->game->addPerformanceCount("underTakeDeadFactionUnits", chronoGamePerformanceCounts.getMicros());
 
 				if (showPerfStats) {
 					sprintf(perfBuf, "In [%s::%s] Line: %d took msecs: " MG_I64_SPECIFIER "\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, chronoPerf.getMillis());
@@ -911,7 +939,7 @@ namespace Glest {
 
 				updateAllFactionConsumableCosts();
 
-				if (this->game) this->game->addPerformanceCount("updateAllFactionConsumableCosts", chronoGamePerformanceCounts.getMillis());
+				if (this->game) this->game->addPerformanceCount("updateAllFactionConsumableCosts", chronoGamePerformanceCounts.getMicros());
 
 				if (showPerfStats) {
 					sprintf(perfBuf, "In [%s::%s] Line: %d took msecs: " MG_I64_SPECIFIER "\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, chronoPerf.getMillis());
@@ -926,7 +954,7 @@ namespace Glest {
 					float fogFactor = static_cast<float>(frameCount % GameConstants::updateFps) / GameConstants::updateFps;
 					minimap.updateFowTex(clamp(fogFactor, 0.f, 1.f));
 
-					if (this->game) this->game->addPerformanceCount("minimap.updateFowTex", chronoGamePerformanceCounts.getMillis());
+					if (this->game) this->game->addPerformanceCount("minimap.updateFowTex", chronoGamePerformanceCounts.getMicros());
 				}
 
 				if (showPerfStats) {
@@ -951,7 +979,7 @@ namespace Glest {
 
 					tick();
 
-					if (this->game) this->game->addPerformanceCount("world->tick", chronoGamePerformanceCounts.getMillis());
+					if (this->game) this->game->addPerformanceCount("world->tick", chronoGamePerformanceCounts.getMicros());
 				}
 
 				if (showPerfStats) {
@@ -991,7 +1019,7 @@ namespace Glest {
 
 			computeFow();
 
-			if (this->game) this->game->addPerformanceCount("world->computeFow", chronoGamePerformanceCounts.getMillis());
+			if (this->game) this->game->addPerformanceCount("world->computeFow", chronoGamePerformanceCounts.getMicros());
 
 			if (showPerfStats) {
 				sprintf(perfBuf, "In [%s::%s] Line: %d took msecs: " MG_I64_SPECIFIER " fogOfWar: %d\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, chronoPerf.getMillis(), fogOfWar);
@@ -1003,7 +1031,7 @@ namespace Glest {
 
 				minimap.updateFowTex(1.f);
 
-				if (this->game) this->game->addPerformanceCount("minimap.updateFowTex", chronoGamePerformanceCounts.getMillis());
+				if (this->game) this->game->addPerformanceCount("minimap.updateFowTex", chronoGamePerformanceCounts.getMicros());
 			}
 
 			if (showPerfStats) {
@@ -1028,7 +1056,7 @@ namespace Glest {
 					unit->tick();
 				}
 			}
-			if (this->game) this->game->addPerformanceCount("world unit->tick()", chronoGamePerformanceCounts.getMillis());
+			if (this->game) this->game->addPerformanceCount("world unit->tick()", chronoGamePerformanceCounts.getMicros());
 
 			if (showPerfStats) {
 				sprintf(perfBuf, "In [%s::%s] Line: %d took msecs: " MG_I64_SPECIFIER "\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, chronoPerf.getMillis());
@@ -1079,7 +1107,7 @@ namespace Glest {
 					}
 				}
 			}
-			if (this->game) this->game->addPerformanceCount("world faction->setResourceBalance()", chronoGamePerformanceCounts.getMillis());
+			if (this->game) this->game->addPerformanceCount("world faction->setResourceBalance()", chronoGamePerformanceCounts.getMicros());
 
 			if (showPerfStats) {
 				sprintf(perfBuf, "In [%s::%s] Line: %d took msecs: " MG_I64_SPECIFIER "\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, chronoPerf.getMillis());
@@ -1094,6 +1122,14 @@ namespace Glest {
 		}
 
 		Unit* World::findUnitById(int id) const {
+			// the id block names the owning faction, see getNextUnitId
+			int idFactionIndex = id / unitIdsPerFaction;
+			if (id >= 0 && idFactionIndex < getFactionCount()) {
+				Unit* unit = getFaction(idFactionIndex)->findUnit(id);
+				if (unit != NULL) {
+					return unit;
+				}
+			}
 			for (int i = 0; i < getFactionCount(); ++i) {
 				const Faction* faction = getFaction(i);
 				Unit* unit = faction->findUnit(id);
@@ -1255,11 +1291,11 @@ namespace Glest {
 			}
 
 			return
-				(map.getSurfaceCell(Map::toSurfCoords(unit->getCenteredPos()))->isVisible(thisTeamIndex) &&
-					map.getSurfaceCell(Map::toSurfCoords(unit->getCenteredPos()))->isExplored(thisTeamIndex)) ||
+				(map.isSurfaceVisible(Map::toSurfCoords(unit->getCenteredPos()), thisTeamIndex) &&
+					map.isSurfaceExplored(Map::toSurfCoords(unit->getCenteredPos()), thisTeamIndex)) ||
 					(unit->getCurrSkill()->getClass() == scAttack &&
-						map.getSurfaceCell(Map::toSurfCoords(unit->getTargetPos()))->isVisible(thisTeamIndex) &&
-						map.getSurfaceCell(Map::toSurfCoords(unit->getTargetPos()))->isExplored(thisTeamIndex));
+						map.isSurfaceVisible(Map::toSurfCoords(unit->getTargetPos()), thisTeamIndex) &&
+						map.isSurfaceExplored(Map::toSurfCoords(unit->getTargetPos()), thisTeamIndex));
 		}
 
 		bool World::toRenderUnit(const UnitBuildInfo &pendingUnit) const {
@@ -1275,8 +1311,8 @@ namespace Glest {
 			}
 
 			return
-				(map.getSurfaceCell(Map::toSurfCoords(pendingUnit.pos))->isVisible(thisTeamIndex) &&
-					map.getSurfaceCell(Map::toSurfCoords(pendingUnit.pos))->isExplored(thisTeamIndex));
+				(map.isSurfaceVisible(Map::toSurfCoords(pendingUnit.pos), thisTeamIndex) &&
+					map.isSurfaceExplored(Map::toSurfCoords(pendingUnit.pos), thisTeamIndex));
 		}
 
 		void World::morphToUnit(int unitId, const string &morphName, bool ignoreRequirements) {
@@ -1950,6 +1986,15 @@ namespace Glest {
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d]\n", __FILE__, __FUNCTION__, __LINE__);
 
 			Logger::getInstance().add(Lang::getInstance().getString("LogScreenGameLoadingStateCells", ""), true);
+			for (int k = 0; k < GameConstants::maxPlayers; k++) {
+				map.setAllSurfaceExplored(k, (game->getGameSettings()->getFlagTypes1() & ft1_show_map_resources) == ft1_show_map_resources);
+				map.setAllSurfaceVisible(k, !fogOfWar);
+			}
+			for (int k = GameConstants::maxPlayers; k < GameConstants::maxPlayers + GameConstants::specialFactions; k++) {
+				map.setAllSurfaceExplored(k, true);
+				map.setAllSurfaceVisible(k, true);
+			}
+
 			for (int i = 0; i < map.getSurfaceW(); ++i) {
 				for (int j = 0; j < map.getSurfaceH(); ++j) {
 
@@ -1964,19 +2009,9 @@ namespace Glest {
 						i / (next2Power(map.getSurfaceW()) - 1.f),
 						j / (next2Power(map.getSurfaceH()) - 1.f)));
 
-					for (int k = 0; k < GameConstants::maxPlayers; k++) {
-						sc->setExplored(k, (game->getGameSettings()->getFlagTypes1() & ft1_show_map_resources) == ft1_show_map_resources);
-						sc->setVisible(k, !fogOfWar);
-					}
-
-					for (int k = GameConstants::maxPlayers; k < GameConstants::maxPlayers + GameConstants::specialFactions; k++) {
-						sc->setExplored(k, true);
-						sc->setVisible(k, true);
-					}
-
 					if (SystemFlags::getSystemSettingType(SystemFlags::debugWorldSynch).enabled == true) {
 						char szBuf[8096] = "";
-						snprintf(szBuf, 8096, "In initCells() x = %d y = %d %s %s", i, j, sc->isVisibleString().c_str(), sc->isExploredString().c_str());
+						snprintf(szBuf, 8096, "In initCells() x = %d y = %d %s %s", i, j, map.getSurfaceVisibleString(Vec2i(i, j)).c_str(), map.getSurfaceExploredString(Vec2i(i, j)).c_str());
 						if (Thread::isCurrentThreadMainThread()) {
 							//unit->logSynchDataThreaded(__FILE__,__LINE__,szBuf);
 							SystemFlags::OutputDebug(SystemFlags::debugWorldSynch, szBuf);
@@ -2107,7 +2142,7 @@ namespace Glest {
 
 				//printf("**LOAD World thisFactionIndex = %d\n",thisFactionIndex);
 
-				MutexSafeWrapper safeMutex(mutexFactionNextUnitId, string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex(mutexFactionNextUnitId, CODE_AT_LINE);
 				//	std::map<int,int> mapFactionNextUnitId;
 			//		for(std::map<int,int>::iterator iterMap = mapFactionNextUnitId.begin();
 			//				iterMap != mapFactionNextUnitId.end(); ++iterMap) {
@@ -2334,15 +2369,13 @@ namespace Glest {
 		}
 
 		void World::exploreCells(int teamIndex, ExploredCellsLookupItem &exploredCellsCache) {
-			std::vector<SurfaceCell*> &cellList = exploredCellsCache.exploredCellList;
+			std::vector<int> &cellList = exploredCellsCache.exploredCellList;
 			for (int idx2 = 0; idx2 < (int) cellList.size(); ++idx2) {
-				SurfaceCell* sc = cellList[idx2];
-				sc->setExplored(teamIndex, true);
+				map.setSurfaceExplored(cellList[idx2], teamIndex, true);
 			}
 			cellList = exploredCellsCache.visibleCellList;
 			for (int idx2 = 0; idx2 < (int) cellList.size(); ++idx2) {
-				SurfaceCell* sc = cellList[idx2];
-				sc->setVisible(teamIndex, true);
+				map.setSurfaceVisible(cellList[idx2], teamIndex, true);
 			}
 		}
 
@@ -2443,14 +2476,15 @@ namespace Glest {
 							}
 						}
 
+						int surfaceIndex = map.getSurfaceCellIndex(currPos);
 						if (updateExplored) {
-							sc->setExplored(teamIndex, true);
-							exploredCellsCache.exploredCellList.push_back(sc);
+							map.setSurfaceExplored(surfaceIndex, teamIndex, true);
+							exploredCellsCache.exploredCellList.push_back(surfaceIndex);
 						}
 						//visible
 						if (updateVisible) {
-							sc->setVisible(teamIndex, true);
-							exploredCellsCache.visibleCellList.push_back(sc);
+							map.setSurfaceVisible(surfaceIndex, teamIndex, true);
+							exploredCellsCache.visibleCellList.push_back(surfaceIndex);
 						}
 					}
 				}
@@ -2535,7 +2569,7 @@ namespace Glest {
 
 			minimap.resetFowTex();
 
-			if (this->game) this->game->addPerformanceCount("world minimap.resetFowTex", chronoGamePerformanceCounts.getMillis());
+			if (this->game) this->game->addPerformanceCount("world minimap.resetFowTex", chronoGamePerformanceCounts.getMicros());
 
 			// reset cells
 			if (SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s] Line: %d in frame: %d\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, getFrameCount());
@@ -2564,12 +2598,8 @@ namespace Glest {
 
 						// If fog of war enabled set cell visible to false and later set those close to units to true
 				if (fogOfWar) {
-					for (int indexSurfaceW = 0; indexSurfaceW < map.getSurfaceW(); ++indexSurfaceW) {
-						for (int indexSurfaceH = 0; indexSurfaceH < map.getSurfaceH(); ++indexSurfaceH) {
-							// set all cells to not visible
-							map.getSurfaceCell(indexSurfaceW, indexSurfaceH)->setVisible(faction->getTeam(), false);
-						}
-					}
+					// set all cells to not visible, a word at a time
+					map.setAllSurfaceVisible(faction->getTeam(), false);
 				}
 
 				// Remove fog of war for factions NOT on my team which i can see
@@ -2650,7 +2680,7 @@ namespace Glest {
 				minimap.copyFowTexAlphaSurface();
 			}
 
-			if (this->game) this->game->addPerformanceCount("world reset cells", chronoGamePerformanceCounts.getMillis());
+			if (this->game) this->game->addPerformanceCount("world reset cells", chronoGamePerformanceCounts.getMicros());
 
 			if (SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s] Line: %d in frame: %d\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, getFrameCount());
 
@@ -2674,9 +2704,8 @@ namespace Glest {
 						bool cellVisible = cellVisibleForFaction;
 						if (cellVisible == false) {
 							Vec2i sCoords = Map::toSurfCoords(unit->getPos());
-							SurfaceCell *sc = map.getSurfaceCell(sCoords);
-							if (sc != NULL) {
-								cellVisible = sc->isVisible(thisTeamIndex);
+							if (map.isInsideSurface(sCoords) == true) {
+								cellVisible = map.isSurfaceVisible(sCoords, thisTeamIndex);
 							}
 						}
 
@@ -2700,7 +2729,7 @@ namespace Glest {
 				}
 			}
 
-			if (this->game) this->game->addPerformanceCount("world compute cells", chronoGamePerformanceCounts.getMillis());
+			if (this->game) this->game->addPerformanceCount("world compute cells", chronoGamePerformanceCounts.getMicros());
 		}
 
 		GameSettings * World::getGameSettingsPtr() {
@@ -2718,9 +2747,9 @@ namespace Glest {
 		// Calculates the unit unit ID for each faction
 		//
 		int World::getNextUnitId(Faction *faction) {
-			MutexSafeWrapper safeMutex(mutexFactionNextUnitId, string(__FILE__) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutex(mutexFactionNextUnitId, CODE_AT_LINE);
 			if (mapFactionNextUnitId.find(faction->getIndex()) == mapFactionNextUnitId.end()) {
-				mapFactionNextUnitId[faction->getIndex()] = faction->getIndex() * 100000;
+				mapFactionNextUnitId[faction->getIndex()] = faction->getIndex() * unitIdsPerFaction;
 			}
 			return mapFactionNextUnitId[faction->getIndex()]++;
 		}
@@ -3064,7 +3093,7 @@ namespace Glest {
 			worldNode->addAttribute("frameCount", intToStr(frameCount), mapTagReplacements);
 			//	//int nextUnitId;
 			//	Mutex mutexFactionNextUnitId;
-			MutexSafeWrapper safeMutex(mutexFactionNextUnitId, string(__FILE__) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutex(mutexFactionNextUnitId, CODE_AT_LINE);
 			//	std::map<int,int> mapFactionNextUnitId;
 			for (std::map<int, int>::iterator iterMap = mapFactionNextUnitId.begin();
 				iterMap != mapFactionNextUnitId.end(); ++iterMap) {
@@ -45,6 +45,7 @@
 #include "faction.h"
 #include "unit_updater.h"
 #include "randomgen.h"
+#include "synch_trace.h"
 #include "game_constants.h"
 #include "leak_dumper.h"
 
@@ -54,6 +55,7 @@ namespace Glest {
 		using Shared::Graphics::Quad2i;
 		using Shared::Graphics::Rect2i;
 		using Shared::Util::RandomGen;
+		using Shared::Util::SynchTrace;
 
 		class Faction;
 		class Unit;
@@ -75,6 +77,28 @@ namespace Glest {
 		///	The game world: Map + Tileset + TechTree
 		// =====================================================
 
+		// field tags of the binary synch trace
+		enum SynchTraceTag {
+			sttWorldRandom,
+			sttPos,
+			sttLastPos,
+			sttTargetPos,
+			sttMeetingPos,
+			sttProgress,
+			sttProgress2,
+			sttHp,
+			sttEp,
+			sttLoadCount,
+			sttRandom,
+			sttSkillClass,
+			sttCommandCount,
+			sttPathBlockCount,
+			sttPathQueueSize,
+			sttLogSite,
+
+			sttCount
+		};
+
 		class ExploredCellsLookupKey {
 		public:
 
@@ -94,6 +118,8 @@ namespace Glest {
 		public:
 			static const int generationArea = 100;
 			static const int indirectSightRange = 5;
+			// each faction hands out unit ids from its own block
+			static const int unitIdsPerFaction = 100000;
 
 		private:
 
@@ -112,6 +138,7 @@ namespace Glest {
 			Factions factions;
 
 			RandomGen random;
+			SynchTrace synchTrace;
 
 			ScriptManager* scriptManager;
 
@@ -235,6 +262,11 @@ namespace Glest {
 				return &minimap;
 			}
 
+			inline SynchTrace *getSynchTrace() {
+				return &synchTrace;
+			}
+			static string getSynchTraceTagName(int tag);
+
 			inline const Stats *getStats() const {
 				return &stats;
 			};
@@ -12,8 +12,10 @@
 
 #include "program.h"
 #include "util.h"
+#include <algorithm>
 #include <iostream>
 #include "platform_util.h"
+#include "compression_utils.h"
 
 using namespace Shared::Util;
 
@@ -22,120 +24,70 @@ namespace MapEditor {
 	////////////////////////////
 	// class UndoPoint
 	////////////////////////////
-	int UndoPoint::w = 0;
-	int UndoPoint::h = 0;
+	static const int undoCompressionLevel = 6;
 
 	UndoPoint::UndoPoint()
 		: change(ctNone)
-		, surface(0)
-		, object(0)
-		, resource(0)
-		, height(0) {
-		w = Program::map->getW();
-		h = Program::map->getH();
+		, compressed(false) {
 	}
-	/*
-	UndoPoint::UndoPoint(ChangeType change) {
-		w = Program::map->getW();
-		h = Program::map->getH();
-
-		init(change);
-	}*/
 
 	void UndoPoint::init(ChangeType change) {
 		this->change = change;
-		switch (change) {
-			// Back up everything
-			case ctAll:
-				// Back up heights
-			case ctHeight:
-			case ctGradient:
-				// Build an array of heights from the map
-				//std::cout << "Building an array of heights to use for our UndoPoint" << std::endl;
-				height = new float[w * h];
-				for (int i = 0; i < w; ++i) {
-					for (int j = 0; j < h; ++j) {
-						height[j * w + i] = Program::map->getHeight(i, j);
-					}
-				}
-				//std::cout << "Built the array" << std::endl;
-				if (change != ctAll) break;
-				// Back up surfaces
-			case ctSurface:
-				surface = new int[w * h];
-				for (int i = 0; i < w; ++i) {
-					for (int j = 0; j < h; ++j) {
-						surface[j * w + i] = Program::map->getSurface(i, j);
-					}
-				}
-				if (change != ctAll) break;
-				// Back up both objects and resources if either changes
-			case ctObject:
-			case ctResource:
-				object = new int[w * h];
-				for (int i = 0; i < w; ++i) {
-					for (int j = 0; j < h; ++j) {
-						object[j * w + i] = Program::map->getObject(i, j);
-					}
-				}
-				resource = new int[w * h];
-				for (int i = 0; i < w; ++i) {
-					for (int j = 0; j < h; ++j) {
-						resource[j * w + i] = Program::map->getResource(i, j);
-					}
-				}
-				break;
-		}
-	}
-
-	UndoPoint::~UndoPoint() {
-		delete[] height;
-		delete[] resource;
-		delete[] object;
-		delete[] surface;
-	}
-
-	void UndoPoint::revert() {
-		//std::cout << "attempting to revert last changes to " << undoID << std::endl;
-		switch (change) {
-			// Revert Everything
-			case ctAll:
-				// Revert Heights
-			case ctHeight:
-			case ctGradient:
-				// Restore the array of heights to the map
-				//std::cout << "attempting to restore the height array" << std::endl;
-				for (int i = 0; i < w; i++) {
-					for (int j = 0; j < h; j++) {
-						Program::map->setHeight(i, j, height[j * w + i]);
-					}
-				}
-				if (change != ctAll) break;
-				// Revert surfaces
-			case ctSurface:
-				//std::cout << "attempting to restore the surface array" << std::endl;
-				for (int i = 0; i < w; i++) {
-					for (int j = 0; j < h; j++) {
-						Program::map->setSurface(i, j, static_cast<MapSurfaceType>(surface[j * w + i]));
-					}
-				}
-				if (change != ctAll) break;
-				// Revert objects and resources
-			case ctObject:
-			case ctResource:
-				for (int i = 0; i < w; i++) {
-					for (int j = 0; j < h; j++) {
-						Program::map->setObject(i, j, object[j * w + i]);
-					}
-				}
-				for (int i = 0; i < w; i++) {
-					for (int j = 0; j < h; j++) {
-						Program::map->setResource(i, j, resource[j * w + i]);
-					}
+		tiles.clear();
+		tileSizes.clear();
+		tileData.clear();
+		compressed = false;
+	}
+
+	void UndoPoint::setTiles(const std::vector<int> &tiles, const std::vector<string> &tileData) {
+		this->tiles = tiles;
+		tileSizes.clear();
+		string rawData;
+		for (unsigned int i = 0; i < tileData.size(); ++i) {
+			tileSizes.push_back((int) tileData[i].size());
+			rawData += tileData[i];
+		}
+
+		compressed = false;
+		if (rawData.empty() == false) {
+			try {
+				std::pair<unsigned char *, unsigned long> deflated =
+					Shared::CompressionUtil::compressMemoryToMemory((unsigned char *) &rawData[0], (unsigned long) rawData.size(), undoCompressionLevel);
+				if (deflated.second < (unsigned long) rawData.size()) {
+					this->tileData.assign((const char *) deflated.first, deflated.second);
+					compressed = true;
 				}
-				break;
+				delete[] deflated.first;
+			} catch (const exception &) {
+				// kept as it is
+			}
+		}
+		if (compressed == false) {
+			this->tileData.swap(rawData);
+		}
+	}
+
+	void UndoPoint::getTileData(std::vector<string> &tileData) const {
+		string rawData;
+		if (compressed == true) {
+			unsigned long rawSize = 0;
+			for (unsigned int i = 0; i < tileSizes.size(); ++i) {
+				rawSize += tileSizes[i];
+			}
+			std::pair<unsigned char *, unsigned long> inflated =
+				Shared::CompressionUtil::extractMemoryToMemory((unsigned char *) this->tileData.data(), (unsigned long) this->tileData.size(), rawSize);
+			rawData.assign((const char *) inflated.first, inflated.second);
+			delete[] inflated.first;
+		} else {
+			rawData = this->tileData;
+		}
+
+		tileData.clear();
+		size_t pos = 0;
+		for (unsigned int i = 0; i < tileSizes.size(); ++i) {
+			tileData.push_back(rawData.substr(pos, tileSizes[i]));
+			pos += tileSizes[i];
 		}
-		//std::cout << "reverted changes (we hope)" << std::endl;
 	}
 
 	// ===============================================
@@ -152,6 +104,10 @@ namespace MapEditor {
 		ofsetX = 0;
 		ofsetY = 0;
 
+		undoBaselineW = 0;
+		undoBaselineH = 0;
+		undoPending = false;
+
 		map = new MapPreview();
 		resetFactions(8);
 		renderer.initMapSurface(w, h);
@@ -161,6 +117,9 @@ namespace MapEditor {
 	void Program::init() {
 		undoStack = ChangeStack();
 		redoStack = ChangeStack();
+		undoBaselineW = 0;
+		undoBaselineH = 0;
+		undoPending = false;
 		cellSize = 5;
 		grid = false;
 		heightmap = false;
@@ -227,37 +186,124 @@ namespace MapEditor {
 		if (map) map->changeStartLocation((x - ofsetX) / cellSize, (y + ofsetY) / cellSize, player);
 	}
 
+	bool Program::syncUndoBaseline(std::vector<int> *changedTiles, std::vector<string> *oldTileData) {
+		if (map == NULL) {
+			return false;
+		}
+		int tilesW = map->getEditTilesW();
+		int tilesH = map->getEditTilesH();
+		if (map->getW() != undoBaselineW || map->getH() != undoBaselineH) {
+			// undo points cannot span a change of the map size
+			clearUndoHistory();
+			undoBaselineW = map->getW();
+			undoBaselineH = map->getH();
+			for (int tileY = 0; tileY < tilesH; ++tileY) {
+				for (int tileX = 0; tileX < tilesW; ++tileX) {
+					undoBaseline.push_back(map->getEditTile(tileX, tileY));
+				}
+			}
+			map->clearDirtyEditTiles();
+			return false;
+		}
+
+		// only tiles the map edits wrote to can differ from the baseline
+		std::vector<int> dirtyTiles;
+		map->getDirtyEditTiles(dirtyTiles);
+		map->clearDirtyEditTiles();
+		std::sort(dirtyTiles.begin(), dirtyTiles.end());
+		for (unsigned int i = 0; i < dirtyTiles.size(); ++i) {
+			int tile = dirtyTiles[i];
+			string tileData = map->getEditTile(tile % tilesW, tile / tilesW);
+			if (tileData != undoBaseline[tile]) {
+				if (changedTiles != NULL) {
+					changedTiles->push_back(tile);
+					oldTileData->push_back(undoBaseline[tile]);
+				}
+				undoBaseline[tile].swap(tileData);
+			}
+		}
+		return true;
+	}
+
+	bool Program::finishUndoPoint() {
+		if (undoPending == false) {
+			return syncUndoBaseline(NULL, NULL);
+		}
+		undoPending = false;
+
+		// keep the tiles the edit since the undo point changed
+		std::vector<int> changedTiles;
+		std::vector<string> oldTileData;
+		if (syncUndoBaseline(&changedTiles, &oldTileData) == false) {
+			return false;
+		}
+		if (changedTiles.empty() == true) {
+			undoStack.pop();
+		} else {
+			undoStack.top().setTiles(changedTiles, oldTileData);
+		}
+		return true;
+	}
+
+	void Program::applyUndoPoint(const UndoPoint &point, ChangeStack &inverseStack) {
+		int tilesW = map->getEditTilesW();
+		const std::vector<int> &tiles = point.getTiles();
+
+		// the baseline matches the map once the undo point is finished
+		std::vector<string> currentTileData;
+		for (unsigned int i = 0; i < tiles.size(); ++i) {
+			currentTileData.push_back(undoBaseline[tiles[i]]);
+		}
+		inverseStack.push(UndoPoint());
+		inverseStack.top().init(point.getChange());
+		inverseStack.top().setTiles(tiles, currentTileData);
+
+		std::vector<string> tileData;
+		point.getTileData(tileData);
+		for (unsigned int i = 0; i < tiles.size(); ++i) {
+			map->setEditTile(tiles[i] % tilesW, tiles[i] / tilesW, tileData[i]);
+			undoBaseline[tiles[i]] = tileData[i];
+		}
+	}
+
+	void Program::clearUndoHistory() {
+		undoStack.clear();
+		redoStack.clear();
+		undoPending = false;
+		undoBaseline.clear();
+		undoBaselineW = 0;
+		undoBaselineH = 0;
+	}
+
 	void Program::setUndoPoint(ChangeType change) {
 		if (change == ctLocation) return;
 
+		finishUndoPoint();
 		undoStack.push(UndoPoint());
 		undoStack.top().init(change);
+		undoPending = true;
 
 		redoStack.clear();
 	}
 
 	bool Program::undo() {
+		finishUndoPoint();
 		if (undoStack.empty()) {
 			return false;
 		}
 		// push current state onto redo stack
-		redoStack.push(UndoPoint());
-		redoStack.top().init(undoStack.top().getChange());
-
-		undoStack.top().revert();
+		applyUndoPoint(undoStack.top(), redoStack);
 		undoStack.pop();
 		return true;
 	}
 
 	bool Program::redo() {
+		finishUndoPoint();
 		if (redoStack.empty()) {
 			return false;
 		}
 		// push current state onto undo stack
-		undoStack.push(UndoPoint());
-		undoStack.top().init(redoStack.top().getChange());
-
-		redoStack.top().revert();
+		applyUndoPoint(redoStack.top(), undoStack);
 		redoStack.pop();
 		return true;
 	}
@@ -569,12 +615,12 @@ namespace MapEditor {
 	}
 
 	void Program::reset(int w, int h, int alt, int surf) {
-		undoStack.clear();
-		redoStack.clear();
+		clearUndoHistory();
 		if (map) map->reset(w, h, (float) alt, static_cast<MapSurfaceType>(surf));
 	}
 
 	void Program::resize(int w, int h, int alt, int surf) {
+		clearUndoHistory();
 		if (map) map->resize(w, h, (float) alt, static_cast<MapSurfaceType>(surf));
 	}
 
@@ -655,8 +701,7 @@ namespace MapEditor {
 	}
 
 	void Program::loadMap(const string &path) {
-		undoStack.clear();
-		redoStack.clear();
+		clearUndoHistory();
 
 		std::string encodedPath = path;
 		map->loadFromFile(encodedPath);
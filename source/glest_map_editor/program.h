@@ -18,6 +18,7 @@
 #include "base_renderer.h"
 
 #include <stack>
+#include <vector>
 
 using std::stack;
 using namespace Shared::Map;
@@ -40,43 +41,37 @@ namespace MapEditor {
 
 	// =============================================
 	// class Undo Point
-	// A linked list class that is more of an extension / modification on
-	// the already existing Cell struct in map.h
-	// Provides the ability to only specify a certain property of the map to change
+	// The map tiles one edit changed, as they were on one side of
+	// the edit, deflated together so the history costs memory in
+	// proportion to the area edited
 	// =============================================
 	class UndoPoint {
 	private:
-		// Only keep a certain number of undo points in memory otherwise
-		// Big projects could hog a lot of memory
-		const static int MAX_UNDO_LIST_SIZE = 100;
-		static int undoCount;
-
 		ChangeType change;
 
-		// Pointers to arrays of each property
-		int *surface;
-		int *object;
-		int *resource;
-		float *height;
-
-		// Map width and height
-		static int w;
-		static int h;
+		// tile indices, row by row, and the raw length of each tile
+		std::vector<int> tiles;
+		std::vector<int> tileSizes;
+		string tileData;
+		bool compressed;
 
 	public:
 		UndoPoint();
-		~UndoPoint();
 		void init(ChangeType change);
-		void revert();
+		void setTiles(const std::vector<int> &tiles, const std::vector<string> &tileData);
+		void getTileData(std::vector<string> &tileData) const;
 
 		inline ChangeType getChange() const {
 			return change;
 		}
+		inline const std::vector<int> & getTiles() const {
+			return tiles;
+		}
 	};
 
 	class ChangeStack : public std::stack<UndoPoint> {
 	public:
-		static const unsigned int maxSize = 100;
+		static const unsigned int maxSize = 1000;
 
 		ChangeStack() : std::stack<UndoPoint>() {
 		}
@@ -107,10 +102,19 @@ namespace MapEditor {
 		bool hideWater;
 		//static Map *map;
 		static MapPreview *map;
-		friend class UndoPoint;
 		ChangeStack undoStack, redoStack;
+		// map tiles as of the last undo point, compared with the map to
+		// find what an edit changed
+		std::vector<string> undoBaseline;
+		int undoBaselineW, undoBaselineH;
+		// the top undo point still waits for its edit to finish
+		bool undoPending;
 
 		void init();
+		bool syncUndoBaseline(std::vector<int> *changedTiles, std::vector<string> *oldTileData);
+		bool finishUndoPoint();
+		void applyUndoPoint(const UndoPoint &point, ChangeStack &inverseStack);
+		void clearUndoHistory();
 	public:
 		Program(int w, int h, string playerName);
 		~Program();
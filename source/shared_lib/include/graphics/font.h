@@ -14,6 +14,7 @@
 
 #include <string>
 #include <vector>
+#include <map>
 #include "font_text.h"
 #include "leak_dumper.h"
 
@@ -24,6 +25,82 @@ using std::string;
 namespace Shared {
 	namespace Graphics {
 
+		// =====================================================
+		//	class TextLayout
+		//
+		///	A string prepared for rendering: bidi converted and
+		///	split on tabs and newlines
+		// =====================================================
+
+		class TextLayout {
+		public:
+			TextLayout();
+
+			string renderText;
+			// runs of text, "\t" and "\n" in render order, empty when
+			// renderText has no tabs or newlines
+			std::vector<string> parts;
+			// measured with the font text handler on first use, -1 until then
+			float advance;
+			float lineHeight;
+
+			static void splitParts(const string &text, std::vector<string> &parts);
+		};
+
+		// =====================================================
+		//	class TextLayoutCache
+		//
+		///	Per font cache of laid out strings and text widths
+		// =====================================================
+
+		class TextLayoutCache {
+		private:
+			typedef std::map<string, TextLayout> LayoutMap;
+			typedef std::map<string, float> WidthMap;
+
+			static int maxEntries;
+
+			// indexed by whether right to left text gets reversed
+			LayoutMap layouts[2];
+			WidthMap textWidths;
+			TextLayout uncachedLayout;
+
+			bool fontIsMultibyte;
+			bool fontIsRightToLeft;
+			bool fontSupportMixedRightToLeft;
+			float scaleFontValue;
+
+			unsigned int hitCount;
+			unsigned int missCount;
+
+			void validate();
+			void buildLayout(const string &text, bool reverseRightToLeft, TextLayout &layout) const;
+
+		public:
+			TextLayoutCache();
+
+			static void setMaxEntries(int value);
+			static int getMaxEntries() {
+				return maxEntries;
+			}
+
+			TextLayout & getLayout(const string &text, bool reverseRightToLeft);
+			float getAdvance(Text *textHandler, TextLayout &layout);
+			float getLineHeight(Text *textHandler, TextLayout &layout);
+
+			bool findTextWidth(const string &str, float &width);
+			void addTextWidth(const string &str, float width);
+
+			void clear();
+
+			unsigned int getHitCount() const {
+				return hitCount;
+			}
+			unsigned int getMissCount() const {
+				return missCount;
+			}
+		};
+
 		// =====================================================
 		//	class FontMetrics
 		// =====================================================
@@ -36,6 +113,7 @@ namespace Shared {
 
 			//float yOffsetFactor;
 			Text *textHandler;
+			TextLayoutCache layoutCache;
 
 		public:
 			//static float DEFAULT_Y_OFFSET_FACTOR;
@@ -51,11 +129,16 @@ namespace Shared {
 
 			void setWidth(int i, float width) {
 				this->widths[i] = width;
+				layoutCache.clear();
 			}
 			void setHeight(float height) {
 				this->height = height;
 			}
 
+			TextLayoutCache * getLayoutCache() {
+				return &layoutCache;
+			}
+
 			float getTextWidth(const string &str);
 			float getHeight(const string &str) const;
 
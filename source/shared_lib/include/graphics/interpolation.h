@@ -33,9 +33,17 @@ namespace Shared {
 
 			int raw_frame_ofs;
 
+			// t and cycle the vertices and normals were last computed for, so
+			// units drawn one after another with the same model and progress
+			// reuse them
+			float verticesT;
+			bool verticesCycle;
+			float normalsT;
+			bool normalsCycle;
+
 			static bool enableInterpolation;
 
-			void update(const Vec3f* src, Vec3f* &dest, float t, bool cycle);
+			void update(const Vec3f* src, Vec3f* &dest, float t, bool cycle, float &lastT, bool &lastCycle);
 
 		public:
 			InterpolationData(const Mesh *mesh);
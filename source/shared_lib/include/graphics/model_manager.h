@@ -14,6 +14,7 @@
 
 #include "model.h"
 #include <vector>
+#include <map>
 #include "leak_dumper.h"
 
 using namespace std;
@@ -30,11 +31,21 @@ namespace Shared {
 		class ModelManager {
 		protected:
 			typedef vector<Model*> ModelContainer;
+			typedef map<string, Model*> ModelPathLookup;
+			typedef map<Model*, int> ModelRefCountLookup;
+			typedef map<Model*, vector<string> > ModelFileLookup;
 
 		protected:
 			ModelContainer models;
+			ModelPathLookup modelPathLookup;
+			ModelRefCountLookup modelRefCounts;
+			// files read by the first load, reported again on reuse
+			ModelFileLookup modelFiles;
 			TextureManager *textureManager;
 
+			static string getModelLookupKey(const string &path, bool deletePixMapAfterLoad);
+			void removeModelFromLookups(Model *model);
+
 		public:
 			ModelManager();
 			virtual ~ModelManager();
@@ -46,6 +57,8 @@ namespace Shared {
 			void endModel(Model *model, bool mustExistInList = false);
 			void endLastModel(bool mustExistInList = false);
 
+			int getModelRefCount(Model *model) const;
+
 			void setTextureManager(TextureManager *textureManager) {
 				this->textureManager = textureManager;
 			}
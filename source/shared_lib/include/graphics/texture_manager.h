@@ -13,10 +13,16 @@
 #define _SHARED_GRAPHICS_TEXTUREMANAGER_H_
 
 #include <vector>
+#include <map>
+#include <list>
+#include <set>
 #include "texture.h"
 #include "leak_dumper.h"
 
 using std::vector;
+using std::map;
+using std::list;
+using std::set;
 
 namespace Shared {
 	namespace Graphics {
@@ -27,14 +33,47 @@ namespace Shared {
 		typedef vector<Texture*> TextureContainer;
 
 		//manages textures, creation on request and deletion on destruction
+		//textures are indexed by path (and optionally pixel content) and
+		//reference counted so meshes and models can share them, released
+		//model textures may be kept alive in an LRU up to a memory budget so
+		//they can be reused without being reloaded
 		class TextureManager {
 
 		protected:
+			typedef map<string, Texture *> TexturePathLookup;
+			typedef map<uint32, Texture *> TextureContentLookup;
+			typedef map<Texture *, int> TextureRefCountLookup;
+			typedef list<Texture *> TextureList;
+			typedef set<Texture *> TextureSet;
+
 			TextureContainer textures;
 
+			// textures created but not yet indexed, they usually get their path
+			// on load() which happens after the manager creates them
+			TextureContainer unindexedTextures;
+			TexturePathLookup texturePathLookup;
+			TextureContentLookup textureContentLookup;
+			TextureRefCountLookup textureRefCounts;
+			// textures model loading looks up by path, only these can be
+			// acquired again after their release and so are worth keeping
+			TextureSet reusableTextures;
+
+			// released textures still resident, most recently released first
+			TextureList unusedTextures;
+			std::size_t unusedTextureBytes;
+			std::size_t maxUnusedTextureBytes;
+			bool shareDuplicateContent;
+
 			Texture::Filter textureFilter;
 			int maxAnisotropy;
 
+			void indexPendingTextures();
+			void removeTextureFromLookups(Texture *texture);
+			void deleteTexture(Texture *texture);
+			void trimUnusedTextures(std::size_t maxBytes);
+			Texture *findTexture(const string &path, bool includeUnused);
+			void addTexture(Texture *texture);
+
 		public:
 			TextureManager();
 			~TextureManager();
@@ -55,7 +94,25 @@ namespace Shared {
 				return maxAnisotropy;
 			}
 
+			void setMaxUnusedTextureBytes(std::size_t maxBytes);
+			std::size_t getMaxUnusedTextureBytes() const {
+				return maxUnusedTextureBytes;
+			}
+			std::size_t getUnusedTextureBytes() const {
+				return unusedTextureBytes;
+			}
+			void setShareDuplicateContent(bool value) {
+				shareDuplicateContent = value;
+			}
+			bool getShareDuplicateContent() const {
+				return shareDuplicateContent;
+			}
+
 			Texture *getTexture(const string &path);
+			Texture *acquireTexture(const string &path);
+			Texture2D *shareDuplicateTexture2D(Texture2D *texture);
+			int getTextureRefCount(Texture *texture) const;
+
 			Texture1D *newTexture1D();
 			Texture2D *newTexture2D();
 			Texture3D *newTexture3D();
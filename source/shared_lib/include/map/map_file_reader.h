@@ -0,0 +1,101 @@
+// ==============================================================
+//	This file is part of ZetaGlest Shared Library (www.zetaglest.org)
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 3 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_MAP_MAPFILEREADER_H_
+#define _SHARED_MAP_MAPFILEREADER_H_
+
+#include "map_preview.h"
+#include "byte_order.h"
+#include <cstring>
+#include <vector>
+#include <string>
+#include "leak_dumper.h"
+
+using std::string;
+using Shared::Platform::int64;
+
+namespace Shared {
+	namespace Map {
+
+		// =====================================================
+		//	class MapFileReader
+		//
+		///	Whole map file in memory (mapped where the platform
+		///	allows), with the cell layers read in place instead
+		///	of one fread per value
+		// =====================================================
+
+		class MapFileReader {
+		private:
+			string path;
+			const char *data;
+			int64 dataSize;
+			// holds the file where it is not mapped
+			std::vector<char> buffer;
+			void *mappedData;
+
+			MapFileHeader header;
+			int64 startLocationsOffset;
+			int64 heightsOffset;
+			int64 surfacesOffset;
+			int64 objectsOffset;
+
+			template<typename T> T readValue(int64 offset) const {
+				T value;
+				memcpy(&value, data + offset, sizeof(T));
+				return Shared::PlatformByteOrder::fromCommonEndian(value);
+			}
+
+		public:
+			MapFileReader();
+			~MapFileReader();
+
+			// throws when the file cannot be read or is shorter than
+			// its header says
+			void open(const string &path);
+			void close();
+
+			const MapFileHeader & getHeader() const {
+				return header;
+			}
+			int getW() const {
+				return header.width;
+			}
+			int getH() const {
+				return header.height;
+			}
+			int getMaxFactions() const {
+				return header.maxFactions;
+			}
+
+			int getStartLocationX(int index) const {
+				return readValue<int32>(startLocationsOffset + index * 2 * sizeof(int32));
+			}
+			int getStartLocationY(int index) const {
+				return readValue<int32>(startLocationsOffset + (index * 2 + 1) * sizeof(int32));
+			}
+			float32 getHeight(int x, int y) const {
+				return readValue<float32>(heightsOffset + ((int64) y * header.width + x) * sizeof(float32));
+			}
+			int8 getSurface(int x, int y) const {
+				return readValue<int8>(surfacesOffset + (int64) y * header.width + x);
+			}
+			// objects and resources share one layer, resources
+			// above the tileset object count
+			int8 getObject(int x, int y) const {
+				return readValue<int8>(objectsOffset + (int64) y * header.width + x);
+			}
+		};
+
+	}
+}//end namespace
+
+#endif
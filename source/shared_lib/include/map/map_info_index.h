@@ -0,0 +1,112 @@
+// ==============================================================
+//	This file is part of ZetaGlest Shared Library (www.zetaglest.org)
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 3 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_MAP_MAPINFOINDEX_H_
+#define _SHARED_MAP_MAPINFOINDEX_H_
+
+#include "data_types.h"
+#include "thread.h"
+#include <map>
+#include <vector>
+#include <string>
+#include "leak_dumper.h"
+
+using std::string;
+using Shared::Platform::int8;
+using Shared::Platform::int64;
+using Shared::Platform::uint32;
+using Shared::Platform::float32;
+using Shared::Platform::Mutex;
+
+namespace Shared {
+	namespace Map {
+
+		// =====================================================
+		//	class MapIndexEntry
+		// =====================================================
+
+		class MapIndexEntry {
+		public:
+			// longest side of the preview, in cells
+			static const int previewDimension = 64;
+
+			string path;
+			int64 fileSize;
+			int64 modTime;
+
+			// header passed the checks of MapPreview::loadMapInfo
+			// and the cell layers are complete
+			bool valid;
+			int version;
+			int width;
+			int height;
+			int players;
+			int heightFactor;
+			int waterLevel;
+			int cliffLevel;
+			int cameraHeight;
+			string title;
+			string author;
+			string desc;
+			uint32 crc;
+
+			// every previewStep'th cell of the map
+			int previewStep;
+			int previewW;
+			int previewH;
+			std::vector<float32> previewHeights;
+			std::vector<int8> previewSurfaces;
+			std::vector<int8> previewObjects;
+			// x, y pairs in preview cells
+			std::vector<int> previewStartLocations;
+
+			MapIndexEntry();
+		};
+
+		// =====================================================
+		//	class MapInfoIndex
+		//
+		///	Header, CRC and a small preview of every map file
+		///	seen, kept in the cache folder between runs and
+		///	rebuilt when a file's size or modification time
+		///	changes, so map lists do not reopen every map
+		// =====================================================
+
+		class MapInfoIndex {
+		private:
+			static Mutex mutex;
+			static std::map<string, MapIndexEntry> entries;
+			static bool loaded;
+			static bool changed;
+
+			static string getIndexFilePath();
+			static void load();
+			static void buildEntry(const string &path, MapIndexEntry &entry);
+			// call with the mutex held
+			static const MapIndexEntry * findEntry(const string &path);
+
+		public:
+			static const char *indexFileName;
+
+			// false when the file does not exist
+			static bool getEntry(const string &path, MapIndexEntry &entry);
+			static uint32 getCRC(const string &path);
+
+			// writes the index when entries were added or rebuilt,
+			// dropping maps that no longer exist
+			static void save();
+			static void clear();
+		};
+
+	}
+}//end namespace
+
+#endif
@@ -119,6 +119,9 @@ namespace Shared {
 		public:
 			static const int maxHeight = 20;
 			static const int minHeight = 0;
+			// side of the square cell tiles the editor's undo
+			// history stores
+			static const int editTileSize = 16;
 
 		private:
 			struct Cell {
@@ -157,6 +160,15 @@ namespace Shared {
 			string mapFileLoaded;
 			bool hasChanged;
 
+			// edit tiles written to since clearDirtyEditTiles, so the
+			// editor's undo only compares those
+			std::vector<bool> dirtyEditTileFlags;
+			std::vector<int> dirtyEditTiles;
+			bool allEditTilesDirty;
+
+			void markEditTileDirty(int x, int y);
+			void markAllEditTilesDirty();
+
 		public:
 			MapPreview();
 			~MapPreview();
@@ -240,8 +252,25 @@ namespace Shared {
 			void switchSurfaces(MapSurfaceType surf1, MapSurfaceType surf2);
 
 			void loadFromFile(const string &path);
+			// a downsampled copy from the map info index, enough for
+			// the menu thumbnails
+			void loadPreviewFromFile(const string &path);
 			void saveToFile(const string &path);
 
+			int getEditTilesW() const {
+				return (w + editTileSize - 1) / editTileSize;
+			}
+			int getEditTilesH() const {
+				return (h + editTileSize - 1) / editTileSize;
+			}
+			// heights, surfaces, objects and resources of the tile's cells
+			string getEditTile(int tileX, int tileY) const;
+			void setEditTile(int tileX, int tileY, const string &data);
+			// indices (tileY * getEditTilesW() + tileX) of the tiles
+			// that may have changed, every tile after whole map edits
+			void getDirtyEditTiles(std::vector<int> &tiles) const;
+			void clearDirtyEditTiles();
+
 			void resetHeights(int height);
 			void realRandomize(int minimumHeight, int maximumHeight, int chanceDivider, int smoothRecursions);
 			void applyNewHeight(float newHeight, int x, int y, int strength);
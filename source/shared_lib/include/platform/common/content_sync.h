@@ -0,0 +1,264 @@
+// ==============================================================
+//	This file is part of ZetaGlest Shared Library (www.zetaglest.org)
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 3 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_PLATFORMCOMMON_CONTENTSYNC_H_
+#define _SHARED_PLATFORMCOMMON_CONTENTSYNC_H_
+
+#include "base_thread.h"
+#include <vector>
+#include <string>
+#include <map>
+#include "data_types.h"
+#include "thread.h"
+#include "leak_dumper.h"
+
+using std::string;
+using std::vector;
+using Shared::Platform::int64;
+using Shared::Platform::uint32;
+using Shared::Platform::Mutex;
+
+namespace Shared {
+	namespace Platform {
+		class Socket;
+		class FTPClientValidationInterface;
+	}
+}
+
+namespace Shared {
+	namespace PlatformCommon {
+
+		enum ContentSyncItemType {
+			csit_Map,
+			csit_Tileset,
+			csit_Techtree,
+
+			csit_Count
+		};
+
+		// =====================================================
+		//	class ContentSyncFile
+		// =====================================================
+
+		class ContentSyncFile {
+		public:
+			ContentSyncFile();
+
+			// relative to the item folder, '/' separated
+			string path;
+			int64 size;
+			uint32 crc;
+			vector<uint32> blockCRCs;
+
+			int getBlockCount() const {
+				return (int) blockCRCs.size();
+			}
+			int getBlockSize(int block) const;
+		};
+
+		// =====================================================
+		//	class ContentSyncManifest
+		//
+		///	Per file and per block checksums of a map, tileset
+		///	or techtree, compared by the client to find the
+		///	blocks it is missing
+		// =====================================================
+
+		class ContentSyncManifest {
+		public:
+			static const int blockSize = 65536;
+
+			vector<ContentSyncFile> files;
+
+			// every file below the folder
+			void buildFromFolder(const string &folder);
+			// a single file inside the folder
+			void buildFromFile(const string &folder, const string &fileName);
+
+			const ContentSyncFile * findFile(const string &path) const;
+			int64 getTotalSize() const;
+
+			string toBytes() const;
+			bool fromBytes(const string &data);
+
+			static uint32 getBlockCRC(const void *data, int size);
+			// checksums of the blocks the file has, shorter than the
+			// full list when the file is cut off
+			static vector<uint32> getFileBlockCRCs(const string &filePath, int64 *fileSize = NULL);
+		};
+
+		// =====================================================
+		//	class ContentSyncSource
+		//
+		///	Server side: finds shared items in the content
+		///	folders and hands out their manifests and blocks
+		// =====================================================
+
+		class ContentSyncSource {
+		private:
+			vector<string> folders[csit_Count];
+			// guards the cache, every client session shares this source
+			Mutex mutex;
+			std::map<string, std::pair<string, ContentSyncManifest> > manifestCache;
+
+			bool findItem(ContentSyncItemType type, const string &name, string &itemFolder, string &fileName) const;
+			// folder and manifest, built on first use
+			const std::pair<string, ContentSyncManifest> * getItem(ContentSyncItemType type, const string &name);
+
+		public:
+			ContentSyncSource();
+
+			void addFolder(ContentSyncItemType type, const string &folder);
+
+			// false when the item is not shared
+			bool getManifest(ContentSyncItemType type, const string &name, ContentSyncManifest &manifest);
+			// false unless the file is part of the item; the block is
+			// sent deflated unless that does not make it smaller
+			bool getBlock(ContentSyncItemType type, const string &name, const string &path, int block,
+				string &blockData, bool &compressed);
+		};
+
+		// =====================================================
+		//	class ContentSyncTarget
+		//
+		///	Client side: builds each changed file next to the
+		///	original as <file>.partial, taking unchanged blocks
+		///	from the local copy, so an interrupted sync only
+		///	asks for the blocks it never got
+		// =====================================================
+
+		class ContentSyncTarget {
+		private:
+			ContentSyncItemType type;
+			string destFolder;
+			string baseFolder;
+			ContentSyncManifest remote;
+
+			string getPartialPath(const ContentSyncFile &file) const;
+			void preparePartialFile(const ContentSyncFile &file, vector<int> &neededBlocks);
+
+		public:
+			static const char *partialFileExtension;
+
+			// files are written to destFolder; baseFolder may hold an
+			// older read only copy to take unchanged blocks from
+			ContentSyncTarget(ContentSyncItemType type, const string &destFolder, const string &baseFolder);
+
+			void setRemoteManifest(const ContentSyncManifest &manifest);
+			const ContentSyncManifest & getRemoteManifest() const {
+				return remote;
+			}
+
+			// blocks still to fetch per file index of the remote manifest
+			std::map<int, vector<int> > getNeededBlocks();
+			// checks the block against the manifest before writing it
+			bool applyBlock(int fileIndex, int block, const string &blockData, bool compressed);
+			// moves finished files into place and removes files the
+			// server does not have
+			bool finish(string &errorText);
+		};
+
+		// =====================================================
+		//	class ContentSyncProgressInterface
+		// =====================================================
+
+		class ContentSyncProgressInterface {
+		public:
+			virtual ~ContentSyncProgressInterface() {
+			}
+			// return false to cancel the sync
+			virtual bool ContentSync_Progress(const string &itemName, int64 bytesNow, int64 bytesTotal) = 0;
+		};
+
+		// =====================================================
+		//	class ContentSyncClient
+		// =====================================================
+
+		class ContentSyncClient {
+		private:
+			string serverIp;
+			int portNumber;
+			ContentSyncProgressInterface *progress;
+
+			int blocksReceived;
+			int64 bytesReceived;
+
+		public:
+			ContentSyncClient(const string &serverIp, int portNumber, ContentSyncProgressInterface *progress = NULL);
+
+			// brings the item in destFolder up to date with the server;
+			// false when the server does not share it, cannot be
+			// reached or the transfer breaks off
+			bool syncItem(ContentSyncItemType type, const string &name,
+				const string &destFolder, const string &baseFolder, string &errorText);
+
+			// blocks and bytes on the wire for the last sync
+			int getBlocksReceived() const {
+				return blocksReceived;
+			}
+			int64 getBytesReceived() const {
+				return bytesReceived;
+			}
+		};
+
+		// =====================================================
+		//	class ContentSyncSessionThread
+		//
+		///	Answers the requests of one connected client, so a
+		///	slow or idle client does not hold up the others
+		// =====================================================
+
+		class ContentSyncSessionThread : public BaseThread {
+		protected:
+			Shared::Platform::Socket *socket;
+			ContentSyncSource *source;
+
+		public:
+			// takes ownership of the socket
+			ContentSyncSessionThread(Shared::Platform::Socket *socket, ContentSyncSource *source);
+			virtual ~ContentSyncSessionThread();
+
+			virtual void execute();
+		};
+
+		// =====================================================
+		//	class ContentSyncServerThread
+		// =====================================================
+
+		class ContentSyncServerThread : public BaseThread {
+		protected:
+			int portNumber;
+			Shared::Platform::FTPClientValidationInterface *clientValidator;
+			ContentSyncSource source;
+			vector<ContentSyncSessionThread *> sessions;
+
+			// deletes finished sessions, or stops all of them
+			void cleanupSessions(bool stopAll);
+
+		public:
+			// listens next to the FTP server, on its port plus this
+			static const int ftpPortOffset = 100;
+			static const int maxSessions = 8;
+
+			// only clients the validator knows, i.e. players connected
+			// to the game, are served, the same as by the FTP server
+			ContentSyncServerThread(int portNumber, Shared::Platform::FTPClientValidationInterface *clientValidator);
+
+			// only before the thread is started
+			void addFolder(ContentSyncItemType type, const string &folder);
+
+			virtual void execute();
+		};
+
+	}
+}//end namespace
+
+#endif
@@ -249,6 +249,7 @@ namespace Shared {
 		bool renameFile(string oldFile, string newFile);
 		void removeFolder(const string &path);
 		off_t getFileSize(string filename);
+		time_t getFileModTime(string filename);
 		bool searchAndReplaceTextInFile(string fileName, string findText, string replaceText, bool simulateOnly);
 		void copyFileTo(string fromFileName, string toFileName);
 
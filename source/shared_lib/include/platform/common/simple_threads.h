@@ -14,6 +14,7 @@
 #include "base_thread.h"
 #include <vector>
 #include <string>
+#include <atomic>
 #include "util.h"
 #include "texture.h"
 #include "leak_dumper.h"
@@ -151,32 +152,162 @@ namespace Shared {
 			void setSimpleTaskInterfaceValid(bool value);
 		};
 
+		// =====================================================
+		//	class ParallelRowsThread
+		// =====================================================
+		//
+		// This interface describes the methods a callback object must implement
+		//
+		class ParallelRowsCallbackInterface {
+		public:
+			// called for the rows firstRow up to, not including, endRow
+			virtual void processRows(int firstRow, int endRow) = 0;
+
+			virtual ~ParallelRowsCallbackInterface() {
+			}
+		};
+
+		class ParallelRowsThread : public BaseThread {
+		protected:
+			ParallelRowsCallbackInterface *callback;
+			int firstRow;
+			int endRow;
+			string errorText;
+
+		public:
+			ParallelRowsThread(ParallelRowsCallbackInterface *callback,
+				int firstRow, int endRow);
+			virtual void execute();
+
+			string getErrorText() const {
+				return errorText;
+			}
+
+			// the cpu count (or maxWorkers when above 0), limited so that
+			// every worker gets at least minRowsPerWorker rows
+			static int getWorkerCount(int rowCount, int minRowsPerWorker, int maxWorkers = 0);
+			// splits the rows into workerCount bands, works the first band
+			// on the calling thread and returns when all bands are done
+			static void run(ParallelRowsCallbackInterface *callback, int rowCount, int workerCount);
+		};
+
 		// =====================================================
 		//	class LogFileThread
 		// =====================================================
 
 		class LogFileEntry {
 		public:
+			uint64 sequence;
 			SystemFlags::DebugType type;
 			string entry;
 			time_t entryDateTime;
 		};
 
+		// =====================================================
+		//	class LogEntryRing
+		//
+		///	Single producer / single consumer byte ring holding the
+		///	formatted entries of one logging thread. Only the owning
+		///	thread pushes and only the log thread pops, so neither
+		///	side takes a lock. The ring is shared by the owning thread
+		///	and the log thread and is deleted by whichever lets go last.
+		// =====================================================
+
+		class LogEntryRing {
+		public:
+			static const uint64 noPendingSequence = 0xFFFFFFFFFFFFFFFFULL;
+
+		private:
+			class Header {
+			public:
+				uint64 sequence;
+				int64 entryDateTime;
+				int32 type;
+				uint32 length;
+			};
+			static const uint32 wrapMarker = 0xFFFFFFFF;
+
+			const void *owner;
+			char *buffer;
+			std::size_t capacity;
+			std::atomic<std::size_t> head;
+			std::atomic<std::size_t> tail;
+			std::atomic<uint64> pendingSequence;
+			std::atomic<bool> orphaned;
+			std::atomic<bool> closed;
+			std::atomic<int> refCount;
+
+			static std::size_t getRecordSize(std::size_t length);
+
+		public:
+			LogEntryRing(const void *owner, std::size_t capacity);
+			~LogEntryRing();
+
+			const void *getOwner() const {
+				return owner;
+			}
+
+			// producer side, called by the owning thread only
+			bool push(uint64 sequence, SystemFlags::DebugType type, time_t entryDateTime,
+				const char *text, std::size_t length);
+			void setPendingSequence(uint64 value) {
+				pendingSequence.store(value);
+			}
+
+			// consumer side, called by the log thread only
+			bool pop(LogFileEntry &entry);
+			bool isEmpty() const {
+				return head.load() == tail.load();
+			}
+			uint64 getPendingSequence() const {
+				return pendingSequence.load();
+			}
+
+			void setOrphaned() {
+				orphaned.store(true);
+			}
+			bool isOrphaned() const {
+				return orphaned.load();
+			}
+			void setClosed() {
+				closed.store(true);
+			}
+			bool isClosed() const {
+				return closed.load();
+			}
+			void release();
+		};
+
+		// =====================================================
+		//	class LogFileThread
+		// =====================================================
+
 		class LogFileThread : public BaseThread {
+		public:
+			static const std::size_t threadLogBufferSize = 1024 * 1024;
+
 		protected:
 
+			// guards the ring list, entries themselves never take it
 			Mutex *mutexLogList;
+			vector<LogEntryRing *> logRings;
+			// entries taken from the rings that can not be written in order yet,
+			// only touched by the log thread
 			vector<LogFileEntry> logList;
-			time_t lastSaveToDisk;
 
-			void saveToDisk(bool forceSaveAll, bool logListAlreadyLocked);
-			bool checkSaveCurrentLogBufferToDisk();
+			std::atomic<uint64> nextSequence;
+			std::atomic<std::size_t> queuedEntryCount;
+			std::atomic<unsigned int> droppedEntryCount[SystemFlags::debugError + 1];
+
+			LogEntryRing *getThreadLogEntryRing();
+			void saveToDisk(bool forceSaveAll);
 
 		public:
 			LogFileThread();
 			virtual ~LogFileThread();
 			virtual void execute();
-			void addLogEntry(SystemFlags::DebugType type, string logEntry);
+			void addLogEntry(SystemFlags::DebugType type, const char *logEntry, std::size_t length);
+			void addLogEntry(SystemFlags::DebugType type, const string &logEntry);
 			std::size_t getLogEntryBufferCount();
 			virtual bool canShutdown(bool deleteSelfIfShutdownDelayed = false);
 		};
@@ -16,6 +16,7 @@
 #include <vector>
 #include <string>
 #include "platform_common.h"
+#include "content_sync.h"
 #include "leak_dumper.h"
 
 using namespace std;
@@ -65,10 +66,13 @@ namespace Shared {
 				void *userdata) = 0;
 		};
 
-		class FTPClientThread : public BaseThread, public ShellCommandOutputCallbackInterface {
+		class FTPClientThread : public BaseThread, public ShellCommandOutputCallbackInterface,
+			public ContentSyncProgressInterface {
 		protected:
 			int portNumber;
 			string serverUrl;
+			int contentSyncPort;
+			FTP_Client_CallbackType contentSyncDownloadType;
 			FTPClientCallbackInterface *pCBObject;
 			std::pair<string, string> mapsPath;
 			std::pair<string, string> tilesetsPath;
@@ -103,6 +107,12 @@ namespace Shared {
 			void getTechtreeFromServer(pair<string, string> techtreeName);
 			pair<FTP_Client_ResultType, string> getTechtreeFromServer(pair<string, string> techtreeName, string ftpUser, string ftpUserPassword);
 
+			// only the blocks that differ from the local copy, tried
+			// before the FTP download when the server offers it
+			pair<FTP_Client_ResultType, string> getItemFromContentSync(ContentSyncItemType type, string itemName,
+				FTP_Client_CallbackType downloadType, std::pair<string, string> itemPaths);
+			virtual bool ContentSync_Progress(const string &itemName, int64 bytesNow, int64 bytesTotal);
+
 			void getScenarioFromServer(pair<string, string> fileName);
 			pair<FTP_Client_ResultType, string> getScenarioInternalFromServer(pair<string, string> fileName);
 
@@ -152,6 +162,10 @@ namespace Shared {
 			void addFileToRequests(string fileName, string URL = "");
 			void addTempFileToRequests(string fileName, string URL = "");
 
+			void setContentSyncPort(int value) {
+				contentSyncPort = value;
+			}
+
 			FTPClientCallbackInterface * getCallBackObject();
 			void setCallBackObject(FTPClientCallbackInterface *value);
 
@@ -151,6 +151,8 @@ namespace Shared {
 
 			Mutex *dataSynchAccessorRead;
 			Mutex *dataSynchAccessorWrite;
+			// held across a blocking select, see hasDataToReadWithWait
+			Mutex *dataSynchAccessorWait;
 
 			Mutex *inSocketDestructorSynchAccessor;
 			bool inSocketDestructor;
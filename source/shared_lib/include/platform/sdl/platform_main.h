@@ -88,6 +88,11 @@ const char  *GAME_ARGS[] = {
 	"--show-techtree-crc",
 	"--show-scenario-crc",
 	"--show-path-crc",
+	"--diff-synch-traces",
+	"--ai-rule-summary",
+	"--simulate-replay",
+	"--benchmark-map-init",
+	"--benchmark-harvest",
 	"--disable-backtrace",
 	"--disable-sigsegv-handler",
 	"--disable-vbo",
@@ -173,6 +178,11 @@ enum GAME_ARG_TYPE {
 	GAME_ARG_SHOW_TECHTREE_CRC,
 	GAME_ARG_SHOW_SCENARIO_CRC,
 	GAME_ARG_SHOW_PATH_CRC,
+	GAME_ARG_DIFF_SYNCH_TRACES,
+	GAME_ARG_AI_RULE_SUMMARY,
+	GAME_ARG_SIMULATE_REPLAY,
+	GAME_ARG_BENCHMARK_MAP_INIT,
+	GAME_ARG_BENCHMARK_HARVEST,
 
 	GAME_ARG_DISABLE_BACKTRACE,
 	GAME_ARG_DISABLE_SIGSEGV_HANDLER,
@@ -490,6 +500,37 @@ GAME_ARGS[GAME_ARG_VALIDATE_TECHTREES]);
 	printf("\n\n                     \tWhere x is a path name and y is file(s) filter.");
 	printf("\n\n                     \texample: %s %s=techs/=zetapack.7z", extractFileFromDirectoryPath(argv0).c_str(), GAME_ARGS[GAME_ARG_SHOW_PATH_CRC]);
 
+	printf("\n\n%s=x,y  \tCompare the binary synch traces x and y saved by", GAME_ARGS[GAME_ARG_DIFF_SYNCH_TRACES]);
+	printf("\n\n                     \t    two players of a network game and show the first");
+	printf("\n\n                     \t    frame, unit and field where they differ. The");
+	printf("\n\n                     \t    traces are written when a client loses synch.");
+	printf("\n\n                     \texample: %s %s=synchTrace.bin_faction_1,synchTrace.bin_client", extractFileFromDirectoryPath(argv0).c_str(), GAME_ARGS[GAME_ARG_DIFF_SYNCH_TRACES]);
+
+	printf("\n\n%s=x,y  \tShow the time each AI rule took in the rule traces", GAME_ARGS[GAME_ARG_AI_RULE_SUMMARY]);
+	printf("\n\n                     \t    x, y, ... written with AiRuleTrace=true, most");
+	printf("\n\n                     \t    expensive rule first.");
+	printf("\n\n                     \texample: %s %s=ai1_rules.csv,ai2_rules.csv", extractFileFromDirectoryPath(argv0).c_str(), GAME_ARGS[GAME_ARG_AI_RULE_SUMMARY]);
+
+	printf("\n\n%s=x,n,y  \tRun the replay of the saved game x without graphics,", GAME_ARGS[GAME_ARG_SIMULATE_REPLAY]);
+	printf("\n\n                     \t    as fast as possible, for n frames (0 runs to the");
+	printf("\n\n                     \t    end of the replay), write the time spent per frame");
+	printf("\n\n                     \t    and update phase to csv file y and quit.");
+	printf("\n\n                     \t    The game must have been saved with SaveCommandsForReplay=true.");
+	printf("\n\n                     \texample: %s %s=saved/test.xml,3000,test.csv", extractFileFromDirectoryPath(argv0).c_str(), GAME_ARGS[GAME_ARG_SIMULATE_REPLAY]);
+
+	printf("\n\n%s=x,y,n,t  \tLoad every map with tileset x and techtree y and time the", GAME_ARGS[GAME_ARG_BENCHMARK_MAP_INIT]);
+	printf("\n\n                     \t    terrain preprocessing on one thread and on t worker threads");
+	printf("\n\n                     \t    (default one per cpu), best of n runs (default 3). Also checks");
+	printf("\n\n                     \t    that both give the same terrain.");
+	printf("\n\n                     \texample: %s %s=desert2,zetapack,5", extractFileFromDirectoryPath(argv0).c_str(), GAME_ARGS[GAME_ARG_BENCHMARK_MAP_INIT]);
+
+	printf("\n\n%s=x,y,n,w  \tLoad every map with tileset x and techtree y, place w workers", GAME_ARGS[GAME_ARG_BENCHMARK_HARVEST]);
+	printf("\n\n                     \t    (default 400) around the map resources and time n rounds");
+	printf("\n\n                     \t    (default 100) of their resource searches with the old ring");
+	printf("\n\n                     \t    scan and with the resource index. Also checks that both");
+	printf("\n\n                     \t    pick the same cells.");
+	printf("\n\n                     \texample: %s %s=desert2,zetapack,100,400", extractFileFromDirectoryPath(argv0).c_str(), GAME_ARGS[GAME_ARG_BENCHMARK_HARVEST]);
+
 	printf("\n\n%s  \tDisables stack backtrace on errors.", GAME_ARGS[GAME_ARG_DISABLE_BACKTRACE]);
 
 	printf("\n\n%s  ", GAME_ARGS[GAME_ARG_DISABLE_SIGSEGV_HANDLER]);
@@ -695,6 +736,7 @@ int mainSetup(int argc, char **argv) {
 		hasCommandArgument(argc, argv, GAME_ARGS[GAME_ARG_VALIDATE_FACTIONS]) == true ||
 		hasCommandArgument(argc, argv, GAME_ARGS[GAME_ARG_VALIDATE_SCENARIO]) == true ||
 		hasCommandArgument(argc, argv, GAME_ARGS[GAME_ARG_VALIDATE_TILESET]) == true ||
+		hasCommandArgument(argc, argv, GAME_ARGS[GAME_ARG_BENCHMARK_MAP_INIT]) == true ||
 		hasCommandArgument(argc, argv, GAME_ARGS[GAME_ARG_LIST_MAPS]) == true ||
 		hasCommandArgument(argc, argv, GAME_ARGS[GAME_ARG_LIST_TECHTRESS]) == true ||
 		hasCommandArgument(argc, argv, GAME_ARGS[GAME_ARG_LIST_SCENARIOS]) == true ||
@@ -718,6 +760,7 @@ int mainSetup(int argc, char **argv) {
 		hasCommandArgument(argc, argv, string(GAME_ARGS[GAME_ARG_VERSION])) == true ||
 		hasCommandArgument(argc, argv, string(GAME_ARGS[GAME_ARG_SHOW_INI_SETTINGS])) == true ||
 		hasCommandArgument(argc, argv, string(GAME_ARGS[GAME_ARG_MASTERSERVER_MODE])) == true ||
+		hasCommandArgument(argc, argv, string(GAME_ARGS[GAME_ARG_SIMULATE_REPLAY])) == true ||
 		hasCommandArgument(argc, argv, string(GAME_ARGS[GAME_ARG_MASTERSERVER_STATUS]))) {
 		// Use this for masterserver mode for timers like Chrono
 		if (SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d]\n", __FILE__, __FUNCTION__, __LINE__);
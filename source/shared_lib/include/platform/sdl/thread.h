@@ -22,6 +22,9 @@
 #include "common_scoped_ptr.h"
 
 #include "data_types.h"
+#ifdef MUTEX_PROFILING
+#include <atomic>
+#endif
 #ifdef DEBUG_PERFORMANCE_MUTEXES
 #include "platform_common.h"
 #endif
@@ -119,6 +122,8 @@ namespace Shared {
 			}
 
 			void start();
+			// blocks until the thread function has returned
+			void join();
 			virtual void execute() = 0;
 			void setPriority(Thread::Priority threadPriority);
 			void suspend();
@@ -138,26 +143,28 @@ namespace Shared {
 
 			SDL_mutex* mutex;
 			int refCount;
-			string ownerId;
-			string deleteownerId;
+			// both point at string literals such as CODE_AT_LINE,
+			// so locking never copies or allocates
+			const char *ownerId;
+			const char *creatorId;
 
 			SDL_mutex* mutexAccessor;
-			string lastownerId;
-
-			int maxRefCount;
-			Shared::PlatformCommon::Chrono *chronoPerf;
 
 			bool isStaticMutexListMutex;
 			static auto_ptr<Mutex> mutexMutexList;
 			static vector<Mutex *> mutexList;
 
 		public:
-			Mutex(string ownerId = "");
+			Mutex(const char *creatorId = "");
 			~Mutex();
-			inline void setOwnerId(string ownerId) {
-				if (this->ownerId != ownerId) {
-					this->ownerId = ownerId;
-				}
+			inline void setOwnerId(const char *ownerId) {
+				this->ownerId = ownerId;
+			}
+			inline const char *getOwnerId() const {
+				return ownerId;
+			}
+			inline const char *getCreatorId() const {
+				return creatorId;
 			}
 			inline void p() {
 				SDL_LockMutex(mutex);
@@ -185,40 +192,81 @@ namespace Shared {
 			}
 		};
 
+#ifdef MUTEX_PROFILING
+		// =====================================================
+		//	class MutexLockSite
+		//
+		///	Lock counts, wait and hold times of every lock taken
+		///	from one source location. Sites are found by the address
+		///	of their owner id literal in a fixed table, so recording
+		///	never allocates or locks.
+		// =====================================================
+
+		class MutexLockSite {
+		private:
+			static const int maxLockSites = 4096;
+			static MutexLockSite lockSites[maxLockSites];
+
+			std::atomic<const char *> location;
+			std::atomic<const char *> mutexCreatorId;
+			std::atomic<uint64> lockCount;
+			std::atomic<uint64> contendedCount;
+			std::atomic<uint64> waitMicroseconds;
+			std::atomic<uint64> maxWaitMicroseconds;
+			std::atomic<uint64> holdMicroseconds;
+			std::atomic<uint64> maxHoldMicroseconds;
+
+			static void updateMax(std::atomic<uint64> &value, uint64 sample);
+
+		public:
+			static MutexLockSite *get(const char *ownerId, const Mutex *mutex);
+			static int64 getCurrentMicroseconds();
+
+			void addLock(bool contended, int64 waitMicros);
+			void addHold(int64 holdMicros);
+
+			// the sites that waited longest, one per line
+			static string getReport(unsigned int maxSites);
+			static void reset();
+		};
+#endif
+
 		class MutexSafeWrapper {
 		protected:
 			Mutex *mutex;
-			string ownerId;
+			const char *ownerId;
+#ifdef MUTEX_PROFILING
+			MutexLockSite *lockSite;
+			int64 lockedMicros;
+#endif
 #ifdef DEBUG_PERFORMANCE_MUTEXES
 			Chrono chrono;
 #endif
 
 		public:
 
-			MutexSafeWrapper(Mutex *mutex, string ownerId = "") {
+			MutexSafeWrapper(Mutex *mutex, const char *ownerId = "") {
 				this->mutex = mutex;
-				if (this->ownerId != ownerId) {
-					this->ownerId = ownerId;
-				}
+				this->ownerId = ownerId;
+#ifdef MUTEX_PROFILING
+				this->lockSite = NULL;
+				this->lockedMicros = 0;
+#endif
 				Lock();
 			}
 			~MutexSafeWrapper() {
 				ReleaseLock();
 			}
 
-			inline void setMutex(Mutex *mutex, string ownerId = "") {
+			inline void setMutex(Mutex *mutex, const char *ownerId = "") {
 				this->mutex = mutex;
-				if (this->ownerId != ownerId) {
-					this->ownerId = ownerId;
-				}
+				this->ownerId = ownerId;
 				Lock();
 			}
-			inline int setMutexAndTryLock(Mutex *mutex, string ownerId = "") {
+			inline int setMutexAndTryLock(Mutex *mutex, const char *ownerId = "") {
 				this->mutex = mutex;
-				if (this->ownerId != ownerId) {
-					this->ownerId = ownerId;
-				}
-				return this->mutex->TryLock();
+				this->ownerId = ownerId;
+				return TryLock();
 			}
 
 			inline bool isValidMutex() const {
@@ -228,8 +276,8 @@ namespace Shared {
 			inline void Lock() {
 				if (this->mutex != NULL) {
 #ifdef DEBUG_MUTEXES
-					if (this->ownerId != "") {
-						printf("Locking Mutex [%s] refCount: %d\n", this->ownerId.c_str(), this->mutex->getRefCount());
+					if (this->ownerId[0] != '\0') {
+						printf("Locking Mutex [%s] refCount: %d\n", this->ownerId, this->mutex->getRefCount());
 					}
 #endif
 
@@ -237,19 +285,30 @@ namespace Shared {
 					chrono.start();
 #endif
 
-					this->mutex->p();
-					if (this->mutex != NULL) {
-						this->mutex->setOwnerId(ownerId);
+#ifdef MUTEX_PROFILING
+					lockSite = MutexLockSite::get(ownerId, this->mutex);
+					int64 waitStartMicros = MutexLockSite::getCurrentMicroseconds();
+					bool contended = (this->mutex->TryLock() != 0);
+					if (contended == true) {
+						this->mutex->p();
+					}
+					lockedMicros = MutexLockSite::getCurrentMicroseconds();
+					if (lockSite != NULL) {
+						lockSite->addLock(contended, lockedMicros - waitStartMicros);
 					}
+#else
+					this->mutex->p();
+#endif
+					this->mutex->setOwnerId(ownerId);
 
 #ifdef DEBUG_PERFORMANCE_MUTEXES
-					if (chrono.getMillis() > 5) printf("In [%s::%s Line: %d] MUTEX LOCK took msecs: %lld, this->mutex->getRefCount() = %d ownerId [%s]\n", __FILE__, __FUNCTION__, __LINE__, (long long int)chrono.getMillis(), this->mutex->getRefCount(), ownerId.c_str());
+					if (chrono.getMillis() > 5) printf("In [%s::%s Line: %d] MUTEX LOCK took msecs: %lld, this->mutex->getRefCount() = %d ownerId [%s]\n", __FILE__, __FUNCTION__, __LINE__, (long long int)chrono.getMillis(), this->mutex->getRefCount(), ownerId);
 					chrono.start();
 #endif
 
 #ifdef DEBUG_MUTEXES
-					if (this->ownerId != "") {
-						printf("Locked Mutex [%s] refCount: %d\n", this->ownerId.c_str(), this->mutex->getRefCount());
+					if (this->ownerId[0] != '\0') {
+						printf("Locked Mutex [%s] refCount: %d\n", this->ownerId, this->mutex->getRefCount());
 					}
 #endif
 				}
@@ -258,8 +317,8 @@ namespace Shared {
 			inline int TryLock(int millisecondsToWait = 0) {
 				if (this->mutex != NULL) {
 #ifdef DEBUG_MUTEXES
-					if (this->ownerId != "") {
-						printf("TryLocking Mutex [%s] refCount: %d\n", this->ownerId.c_str(), this->mutex->getRefCount());
+					if (this->ownerId[0] != '\0') {
+						printf("TryLocking Mutex [%s] refCount: %d\n", this->ownerId, this->mutex->getRefCount());
 					}
 #endif
 
@@ -268,18 +327,25 @@ namespace Shared {
 #endif
 
 					int result = this->mutex->TryLock(millisecondsToWait);
-					if (result == 0 && this->mutex != NULL) {
+					if (result == 0) {
 						this->mutex->setOwnerId(ownerId);
+#ifdef MUTEX_PROFILING
+						lockSite = MutexLockSite::get(ownerId, this->mutex);
+						lockedMicros = MutexLockSite::getCurrentMicroseconds();
+						if (lockSite != NULL) {
+							lockSite->addLock(false, 0);
+						}
+#endif
 					}
 
 #ifdef DEBUG_PERFORMANCE_MUTEXES
-					if (chrono.getMillis() > 5) printf("In [%s::%s Line: %d] MUTEX LOCK took msecs: %lld, this->mutex->getRefCount() = %d ownerId [%s]\n", __FILE__, __FUNCTION__, __LINE__, (long long int)chrono.getMillis(), this->mutex->getRefCount(), ownerId.c_str());
+					if (chrono.getMillis() > 5) printf("In [%s::%s Line: %d] MUTEX LOCK took msecs: %lld, this->mutex->getRefCount() = %d ownerId [%s]\n", __FILE__, __FUNCTION__, __LINE__, (long long int)chrono.getMillis(), this->mutex->getRefCount(), ownerId);
 					chrono.start();
 #endif
 
 #ifdef DEBUG_MUTEXES
-					if (this->ownerId != "") {
-						printf("Locked Mutex [%s] refCount: %d\n", this->ownerId.c_str(), this->mutex->getRefCount());
+					if (this->ownerId[0] != '\0') {
+						printf("Locked Mutex [%s] refCount: %d\n", this->ownerId, this->mutex->getRefCount());
 					}
 #endif
 
@@ -291,20 +357,26 @@ namespace Shared {
 			inline void ReleaseLock(bool keepMutex = false, bool deleteMutexOnRelease = false) {
 				if (this->mutex != NULL) {
 #ifdef DEBUG_MUTEXES
-					if (this->ownerId != "") {
-						printf("UnLocking Mutex [%s] refCount: %d\n", this->ownerId.c_str(), this->mutex->getRefCount());
+					if (this->ownerId[0] != '\0') {
+						printf("UnLocking Mutex [%s] refCount: %d\n", this->ownerId, this->mutex->getRefCount());
 					}
 #endif
 
+#ifdef MUTEX_PROFILING
+					if (lockSite != NULL) {
+						lockSite->addHold(MutexLockSite::getCurrentMicroseconds() - lockedMicros);
+						lockSite = NULL;
+					}
+#endif
 					this->mutex->v();
 
 #ifdef DEBUG_PERFORMANCE_MUTEXES
-					if (chrono.getMillis() > 100) printf("In [%s::%s Line: %d] MUTEX UNLOCKED and held locked for msecs: %lld, this->mutex->getRefCount() = %d ownerId [%s]\n", __FILE__, __FUNCTION__, __LINE__, (long long int)chrono.getMillis(), this->mutex->getRefCount(), ownerId.c_str());
+					if (chrono.getMillis() > 100) printf("In [%s::%s Line: %d] MUTEX UNLOCKED and held locked for msecs: %lld, this->mutex->getRefCount() = %d ownerId [%s]\n", __FILE__, __FUNCTION__, __LINE__, (long long int)chrono.getMillis(), this->mutex->getRefCount(), ownerId);
 #endif
 
 #ifdef DEBUG_MUTEXES
-					if (this->ownerId != "") {
-						printf("UnLocked Mutex [%s] refCount: %d\n", this->ownerId.c_str(), this->mutex->getRefCount());
+					if (this->ownerId[0] != '\0') {
+						printf("UnLocked Mutex [%s] refCount: %d\n", this->ownerId, this->mutex->getRefCount());
 					}
 #endif
 
@@ -13,7 +13,9 @@
 #define _SHARED_SOUND_SOUND_H_
 
 #include <string>
-#include "sound_file_loader.h" 
+#include <map>
+#include "sound_file_loader.h"
+#include "thread.h"
 #include "leak_dumper.h"
 
 using namespace std;
@@ -107,23 +109,94 @@ namespace Shared {
 			}
 		};
 
+		// =====================================================
+		//	class StaticSoundData
+		//
+		///	Decoded samples of one sound file, shared by every
+		///	StaticSound that refers to the same file
+		// =====================================================
+
+		class StaticSoundData {
+		public:
+			string path;
+			uint32 fileCRC;
+			SoundInfo info;
+			int8 *samples;
+			int refCount;
+			uint64 lastUsed;
+
+			StaticSoundData();
+			~StaticSoundData();
+
+			void decode();
+			void unload();
+		};
+
+		// =====================================================
+		//	class StaticSoundCache
+		//
+		///	Process wide cache of static sounds keyed by canonical
+		///	path and file CRC. Samples are decoded on first play and
+		///	the least recently played clips are dropped again when
+		///	the decoded size goes over the configured limit
+		// =====================================================
+
+		class StaticSoundCache {
+		private:
+			typedef map<string, StaticSoundData *> SoundPathLookup;
+			// different files can share a CRC, candidates are compared
+			typedef multimap<uint32, StaticSoundData *> SoundCRCLookup;
+
+			Mutex mutex;
+			SoundPathLookup soundPathLookup;
+			SoundCRCLookup soundCRCLookup;
+			uint64 useCounter;
+			std::size_t decodedBytes;
+			std::size_t maxDecodedBytes;
+
+			StaticSoundCache();
+			~StaticSoundCache();
+
+			void evictDecodedSamples(StaticSoundData *keepData);
+			static bool isSameFileContent(const string &path1, const string &path2);
+
+		public:
+			static StaticSoundCache &getInstance();
+			static string getCanonicalPath(string path);
+
+			StaticSoundData *acquire(const string &path);
+			void release(StaticSoundData *data);
+			int8 *getSamples(StaticSoundData *data);
+			void prefetch(StaticSoundData *data);
+
+			void setMaxDecodedBytes(std::size_t maxBytes);
+			std::size_t getMaxDecodedBytes() const {
+				return maxDecodedBytes;
+			}
+			std::size_t getDecodedBytes() const {
+				return decodedBytes;
+			}
+			std::size_t getSoundCount() const {
+				return soundPathLookup.size();
+			}
+		};
+
 		// =====================================================
 		//	class StaticSound
 		// =====================================================
 
 		class StaticSound : public Sound {
 		private:
-			int8 * samples;
+			StaticSoundData *data;
 
 		public:
 			StaticSound();
 			virtual ~StaticSound();
 
-			int8 *getSamples() const {
-				return samples;
-			}
+			int8 *getSamples() const;
 
 			void load(const string &path);
+			void prefetch();
 			void close();
 		};
 
@@ -0,0 +1,64 @@
+// ==============================================================
+//	This file is part of ZetaGlest Shared Library (www.zetaglest.org)
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 3 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_UTIL_LATENCYESTIMATOR_H_
+#define _SHARED_UTIL_LATENCYESTIMATOR_H_
+
+#include <vector>
+#include "data_types.h"
+#include "leak_dumper.h"
+
+using Shared::Platform::int64;
+
+namespace Shared {
+	namespace Util {
+
+		// =====================================================
+		//	class LatencyEstimator
+		//
+		///	Round trip time and jitter of a connection over its
+		///	most recent samples
+		// =====================================================
+
+		class LatencyEstimator {
+		private:
+			std::vector<int64> samples;
+			int nextSample;
+			int sampleCount;
+
+		public:
+			explicit LatencyEstimator(int windowSize = 32);
+
+			void addSample(int64 micros);
+			void clear();
+
+			// samples seen since the last clear, not only those in the window
+			inline int getSampleCount() const {
+				return sampleCount;
+			}
+			int64 getMeanMicros() const;
+			// standard deviation of the samples in the window
+			int64 getJitterMicros() const;
+			// latency only exceeded with the given probability, taking the
+			// samples as normally distributed
+			int64 getQuantileMicros(double exceedProbability) const;
+
+			// z for which a standard normal sample exceeds z with the
+			// given probability
+			static double getNormalQuantile(double exceedProbability);
+			// clock for timestamping samples
+			static int64 getCurrentMicros();
+		};
+
+	}
+}//end namespace
+
+#endif
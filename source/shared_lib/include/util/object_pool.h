@@ -0,0 +1,170 @@
+// ==============================================================
+//	This file is part of ZetaGlest Shared Library (www.zetaglest.org)
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 3 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_UTIL_OBJECTPOOL_H_
+#define _SHARED_UTIL_OBJECTPOOL_H_
+
+#include <cstddef>
+#include <vector>
+#include "data_types.h"
+#include "thread.h"
+#include "leak_dumper.h"
+
+using Shared::Platform::uint32;
+using Shared::Platform::Mutex;
+
+namespace Shared {
+	namespace Util {
+
+		// =====================================================
+		//	class ObjectPool
+		//
+		///	Fixed size blocks carved out of large chunks and
+		///	recycled through a free list, for objects that are
+		///	created and deleted all the time. Chunks are kept
+		///	until the pool itself goes away
+		// =====================================================
+
+		class ObjectPool {
+		private:
+			Mutex mutex;
+			size_t blockSize;
+			int blocksPerChunk;
+			std::vector<char *> chunks;
+			void *freeList;
+			int usedCount;
+			int freeCount;
+
+			void addChunk();
+
+		public:
+			ObjectPool(size_t objectSize, int blocksPerChunk = 256);
+			~ObjectPool();
+
+			// requests larger than the block size, e.g. from a derived
+			// class, go to the global heap
+			void *allocate(size_t size);
+			void release(void *block, size_t size);
+
+			inline size_t getBlockSize() const {
+				return blockSize;
+			}
+			int getUsedCount();
+			int getFreeCount();
+			int getChunkCount();
+		};
+
+		// =====================================================
+		//	class SlotHandle
+		//
+		///	Slot in a SlotTable plus the generation the slot had
+		///	when the object was added, so a handle to a removed
+		///	object never finds the slot's next occupant
+		// =====================================================
+
+		class SlotHandle {
+		public:
+			int slot;
+			uint32 generation;
+
+			SlotHandle() : slot(-1), generation(0) {
+			}
+			SlotHandle(int slot, uint32 generation) : slot(slot), generation(generation) {
+			}
+
+			inline bool isSet() const {
+				return slot >= 0;
+			}
+			inline bool operator==(const SlotHandle &handle) const {
+				return slot == handle.slot && generation == handle.generation;
+			}
+		};
+
+		// =====================================================
+		//	class SlotTable
+		//
+		///	Objects addressed by SlotHandle, added and removed in
+		///	constant time with slots reused through a free list
+		// =====================================================
+
+		template<typename T>
+		class SlotTable {
+		private:
+			class Slot {
+			public:
+				T *object;
+				uint32 generation;
+				int nextFree;
+			};
+
+			std::vector<Slot> slots;
+			int firstFree;
+			int count;
+
+		public:
+			SlotTable() : firstFree(-1), count(0) {
+			}
+
+			SlotHandle add(T *object) {
+				int slot = firstFree;
+				if (slot >= 0) {
+					firstFree = slots[slot].nextFree;
+				} else {
+					slot = (int) slots.size();
+					Slot newSlot;
+					newSlot.generation = 0;
+					slots.push_back(newSlot);
+				}
+				slots[slot].object = object;
+				slots[slot].nextFree = -1;
+				count++;
+				return SlotHandle(slot, slots[slot].generation);
+			}
+
+			// false if the handle is stale
+			bool remove(const SlotHandle &handle) {
+				if (get(handle) == NULL) {
+					return false;
+				}
+				Slot &entry = slots[handle.slot];
+				entry.object = NULL;
+				entry.generation++;
+				entry.nextFree = firstFree;
+				firstFree = handle.slot;
+				count--;
+				return true;
+			}
+
+			// NULL once the object was removed
+			inline T *get(const SlotHandle &handle) const {
+				if (handle.slot < 0 || handle.slot >= (int) slots.size() ||
+					slots[handle.slot].generation != handle.generation) {
+					return NULL;
+				}
+				return slots[handle.slot].object;
+			}
+
+			inline int size() const {
+				return count;
+			}
+
+			// generations restart, so only clear when no handles are left
+			void clear() {
+				slots.clear();
+				firstFree = -1;
+				count = 0;
+			}
+		};
+
+	}
+}//end namespace
+
+#endif
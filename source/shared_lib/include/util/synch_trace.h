@@ -0,0 +1,132 @@
+// ==============================================================
+//	This file is part of ZetaGlest Shared Library (www.zetaglest.org)
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 3 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_UTIL_SYNCHTRACE_H_
+#define _SHARED_UTIL_SYNCHTRACE_H_
+
+#include <string>
+#include <vector>
+#include "data_types.h"
+#include "leak_dumper.h"
+
+using std::string;
+using Shared::Platform::int32;
+using Shared::Platform::uint32;
+
+namespace Shared {
+	namespace Util {
+
+		// =====================================================
+		//	class SynchTraceRecord
+		// =====================================================
+
+		class SynchTraceRecord {
+		public:
+			int32 frame;
+			int32 id;
+			int32 tag;
+			int32 value;
+
+			SynchTraceRecord() : frame(0), id(0), tag(0), value(0) {
+			}
+			SynchTraceRecord(int32 frame, int32 id, int32 tag, int32 value) :
+				frame(frame), id(id), tag(tag), value(value) {
+			}
+
+			bool operator==(const SynchTraceRecord &other) const {
+				return frame == other.frame && id == other.id &&
+					tag == other.tag && value == other.value;
+			}
+			bool operator!=(const SynchTraceRecord &other) const {
+				return !(*this == other);
+			}
+		};
+
+		// =====================================================
+		//	class SynchTraceDivergence
+		// =====================================================
+
+		class SynchTraceDivergence {
+		public:
+			// index into the overlapping part of both traces
+			int recordIndex;
+			// a trace that ran out of records in the overlapping range
+			// leaves its side marked as missing
+			bool firstMissing;
+			bool secondMissing;
+			SynchTraceRecord first;
+			SynchTraceRecord second;
+
+			SynchTraceDivergence() : recordIndex(-1), firstMissing(false), secondMissing(false) {
+			}
+		};
+
+		// =====================================================
+		//	class SynchTrace
+		//
+		///	Fixed size ring buffer of binary simulation state records
+		///	(frame, id, field tag, value). Two peers running the same
+		///	game produce identical traces until they desync, so the
+		///	saved traces can be diffed offline. Only the simulation
+		///	thread may add records.
+		// =====================================================
+
+		class SynchTrace {
+		private:
+			static const char fileId[4];
+			static const int32 fileVersion;
+
+			std::vector<SynchTraceRecord> records;
+			unsigned int nextRecord;
+			bool wrapped;
+
+		public:
+			SynchTrace();
+
+			void init(unsigned int capacity);
+			void clear();
+
+			inline bool isEnabled() const {
+				return records.empty() == false;
+			}
+			inline void add(int32 frame, int32 id, int32 tag, int32 value) {
+				if (records.empty() == true) {
+					return;
+				}
+				SynchTraceRecord &record = records[nextRecord];
+				record.frame = frame;
+				record.id = id;
+				record.tag = tag;
+				record.value = value;
+				if (++nextRecord >= records.size()) {
+					nextRecord = 0;
+					wrapped = true;
+				}
+			}
+
+			// records in the order they were added; once the buffer wrapped
+			// the oldest, possibly incomplete, frame is left out
+			void getRecords(std::vector<SynchTraceRecord> &result) const;
+
+			void save(const string &path) const;
+			static void load(const string &path, std::vector<SynchTraceRecord> &result);
+
+			// compares the frames both traces cover and reports the first record
+			// that differs, returns false when the traces agree
+			static bool findFirstDivergence(const std::vector<SynchTraceRecord> &first,
+				const std::vector<SynchTraceRecord> &second,
+				SynchTraceDivergence &result);
+		};
+
+	}
+}//end namespace
+
+#endif
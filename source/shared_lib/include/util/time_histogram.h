@@ -0,0 +1,61 @@
+// ==============================================================
+//	This file is part of ZetaGlest Shared Library (www.zetaglest.org)
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 3 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_UTIL_TIMEHISTOGRAM_H_
+#define _SHARED_UTIL_TIMEHISTOGRAM_H_
+
+#include <string>
+#include <vector>
+#include "data_types.h"
+#include "leak_dumper.h"
+
+using std::string;
+using Shared::Platform::int64;
+
+namespace Shared {
+	namespace Util {
+
+		// =====================================================
+		//	class TimeHistogram
+		//
+		///	Distribution of measured durations in fixed size
+		///	buckets; samples past the last bucket only count
+		///	towards the mean and the maximum
+		// =====================================================
+
+		class TimeHistogram {
+		private:
+			int bucketMicros;
+			std::vector<int> buckets;
+			int count;
+			int64 totalMicros;
+			int64 maxMicros;
+
+		public:
+			// 0.1 ms buckets up to 50 ms by default
+			explicit TimeHistogram(int bucketMicros = 100, int bucketCount = 500);
+
+			void add(int64 micros);
+			void clear();
+
+			inline int getCount() const {
+				return count;
+			}
+			// upper end of the bucket holding the given fraction of samples
+			double getPercentileMillis(double percentile) const;
+			// sample count, mean, percentiles and worst sample in ms
+			string getReport(const string &sampleName) const;
+		};
+
+	}
+}//end namespace
+
+#endif
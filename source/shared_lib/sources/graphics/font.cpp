@@ -31,6 +31,7 @@ using namespace Shared::Graphics::Gl;
 #include "util.h"
 #include "platform_common.h"
 #include "platform_util.h"
+#include "string_utils.h"
 
 #ifdef	HAVE_FRIBIDI
 #include <fribidi.h>
@@ -94,6 +95,158 @@ namespace Shared {
 #endif
 		}
 
+		// =====================================================
+		//	class TextLayout
+		// =====================================================
+
+		TextLayout::TextLayout() {
+			advance = -1;
+			lineHeight = -1;
+		}
+
+		void TextLayout::splitParts(const string &text, std::vector<string> &parts) {
+			parts.clear();
+			if (text.find("\n") == text.npos && text.find("\t") == text.npos) {
+				return;
+			}
+
+			bool lastCharacterWasSpecial = true;
+			for (size_t i = 0; i < text.size(); ++i) {
+				switch (text[i]) {
+					case '\t':
+					case '\n':
+						parts.push_back(string(1, text[i]));
+						lastCharacterWasSpecial = true;
+						break;
+					default:
+						if (lastCharacterWasSpecial == true) {
+							parts.push_back(string(1, text[i]));
+						} else {
+							parts[parts.size() - 1] += text[i];
+						}
+						lastCharacterWasSpecial = false;
+						break;
+				}
+			}
+		}
+
+		// =====================================================
+		//	class TextLayoutCache
+		// =====================================================
+
+		int TextLayoutCache::maxEntries = 2048;
+
+		TextLayoutCache::TextLayoutCache() {
+			fontIsMultibyte = Font::fontIsMultibyte;
+			fontIsRightToLeft = Font::fontIsRightToLeft;
+			fontSupportMixedRightToLeft = Font::fontSupportMixedRightToLeft;
+			scaleFontValue = Font::scaleFontValue;
+
+			hitCount = 0;
+			missCount = 0;
+		}
+
+		void TextLayoutCache::setMaxEntries(int value) {
+			maxEntries = value;
+		}
+
+		void TextLayoutCache::validate() {
+			// language changes switch these at runtime and every cached
+			// layout depends on them
+			if (fontIsMultibyte != Font::fontIsMultibyte ||
+				fontIsRightToLeft != Font::fontIsRightToLeft ||
+				fontSupportMixedRightToLeft != Font::fontSupportMixedRightToLeft ||
+				scaleFontValue != Font::scaleFontValue) {
+				clear();
+			}
+		}
+
+		void TextLayoutCache::buildLayout(const string &text, bool reverseRightToLeft, TextLayout &layout) const {
+			layout.renderText = text;
+			Font::bidi_cvt(layout.renderText);
+			if (reverseRightToLeft == true && Font::fontIsRightToLeft == true) {
+				if (is_string_all_ascii(layout.renderText) == false) {
+					strrev_utf8(layout.renderText);
+				}
+			}
+			TextLayout::splitParts(layout.renderText, layout.parts);
+			layout.advance = -1;
+			layout.lineHeight = -1;
+		}
+
+		TextLayout & TextLayoutCache::getLayout(const string &text, bool reverseRightToLeft) {
+			validate();
+
+			if (maxEntries <= 0) {
+				missCount++;
+				buildLayout(text, reverseRightToLeft, uncachedLayout);
+				return uncachedLayout;
+			}
+
+			LayoutMap &layoutMap = layouts[reverseRightToLeft ? 1 : 0];
+			LayoutMap::iterator iterFind = layoutMap.find(text);
+			if (iterFind != layoutMap.end()) {
+				hitCount++;
+				return iterFind->second;
+			}
+
+			missCount++;
+			if ((int) layoutMap.size() >= maxEntries) {
+				layoutMap.clear();
+			}
+			TextLayout &layout = layoutMap[text];
+			buildLayout(text, reverseRightToLeft, layout);
+			return layout;
+		}
+
+		float TextLayoutCache::getAdvance(Text *textHandler, TextLayout &layout) {
+			if (layout.advance < 0 && textHandler != NULL) {
+				layout.advance = textHandler->Advance(layout.renderText.c_str());
+			}
+			return layout.advance;
+		}
+
+		float TextLayoutCache::getLineHeight(Text *textHandler, TextLayout &layout) {
+			if (layout.lineHeight < 0 && textHandler != NULL) {
+				layout.lineHeight = textHandler->LineHeight(layout.renderText.c_str());
+			}
+			return layout.lineHeight;
+		}
+
+		bool TextLayoutCache::findTextWidth(const string &str, float &width) {
+			validate();
+
+			WidthMap::const_iterator iterFind = textWidths.find(str);
+			if (iterFind != textWidths.end()) {
+				hitCount++;
+				width = iterFind->second;
+				return true;
+			}
+			missCount++;
+			return false;
+		}
+
+		void TextLayoutCache::addTextWidth(const string &str, float width) {
+			if (maxEntries <= 0) {
+				return;
+			}
+			if ((int) textWidths.size() >= maxEntries) {
+				textWidths.clear();
+			}
+			textWidths[str] = width;
+		}
+
+		void TextLayoutCache::clear() {
+			layouts[0].clear();
+			layouts[1].clear();
+			textWidths.clear();
+
+			fontIsMultibyte = Font::fontIsMultibyte;
+			fontIsRightToLeft = Font::fontIsRightToLeft;
+			fontSupportMixedRightToLeft = Font::fontSupportMixedRightToLeft;
+			scaleFontValue = Font::scaleFontValue;
+		}
+
 		// =====================================================
 		//	class FontMetrics
 		// =====================================================
@@ -116,6 +269,7 @@ namespace Shared {
 
 		void FontMetrics::setTextHandler(Text *textHandler) {
 			this->textHandler = textHandler;
+			layoutCache.clear();
 			//SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] this->textHandler = [%p] Owner = [%p]\n", __FILE__, __FUNCTION__, __LINE__, this->textHandler, this);
 		}
 
@@ -124,6 +278,11 @@ namespace Shared {
 		}
 
 		float FontMetrics::getTextWidth(const string &str) {
+			float cachedWidth = 0.f;
+			if (layoutCache.findTextWidth(str, cachedWidth) == true) {
+				return cachedWidth;
+			}
+
 			string longestLine = "";
 			size_t found = str.find("\n");
 			if (found == string::npos) {
@@ -142,7 +301,9 @@ namespace Shared {
 			}
 
 			if (textHandler != NULL) {
-				return (textHandler->Advance(longestLine.c_str()) * Font::scaleFontValue);
+				float width = (textHandler->Advance(longestLine.c_str()) * Font::scaleFontValue);
+				layoutCache.addTextWidth(str, width);
+				return width;
 			} else {
 				float width = 0.f;
 				for (unsigned int i = 0; i < longestLine.size() && (int) i < Font::charCount; ++i) {
@@ -157,6 +318,7 @@ namespace Shared {
 						width += widths[(int) longestLine[i]];
 					}
 				}
+				layoutCache.addTextWidth(str, width);
 				return width;
 			}
 		}
@@ -289,6 +451,7 @@ namespace Shared {
 			}
 		}
 		void Font::setSize(int size) {
+			metrics.getLayoutCache()->clear();
 			if (textHandler) {
 				return textHandler->SetFaceSize(size);
 			} else {
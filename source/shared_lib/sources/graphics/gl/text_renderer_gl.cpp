@@ -60,8 +60,11 @@ namespace Shared {
 					glColor4fv(color->ptr());
 				}
 
-				string renderText = text;
-				Font::bidi_cvt(renderText);
+				// bidi conversion, right to left reversal and splitting on tabs
+				// and newlines are done once per string and font
+				TextLayoutCache *layoutCache = font->getMetrics()->getLayoutCache();
+				TextLayout &layout = layoutCache->getLayout(text, font->getTextHandler() != NULL);
+				const string &renderText = layout.renderText;
 				int line = 0;
 				int size = font->getSize();
 				const unsigned char *utext = NULL;
@@ -71,13 +74,9 @@ namespace Shared {
 
 				Vec2f rasterPos;
 				if (font->getTextHandler() != NULL) {
-					//char *utfStr = String::ConvertToUTF8(renderText.c_str());
-					//renderText = utfStr;
-					//delete [] utfStr;
-
 					if (centered) {
-						rasterPos.x = x - font->getTextHandler()->Advance(renderText.c_str()) / 2.f;
-						rasterPos.y = y + font->getTextHandler()->LineHeight(renderText.c_str()) / 2;
+						rasterPos.x = x - layoutCache->getAdvance(font->getTextHandler(), layout) / 2.f;
+						rasterPos.y = y + layoutCache->getLineHeight(font->getTextHandler(), layout) / 2;
 						//printf("text [%s] x = %f, y = %f rasterPos [%s]\n",text.c_str(),x,y,rasterPos.getString().c_str());
 					} else {
 						rasterPos = Vec2f(static_cast<float>(x), static_cast<float>(y));
@@ -97,243 +96,47 @@ namespace Shared {
 				}
 				glRasterPos2f(rasterPos.x, rasterPos.y);
 
-				//fontFTGL->Render("مرحبا العالم"); //Arabic Works!
-				//wstring temp = L"المدى";
-				//temp = wstring (temp.rbegin(), temp.rend());
-				//font->getTextHandler()->Render(temp.c_str());
-				//return;
-
-				//font->getTextHandler()->Render("Zurück");
-				//return;
-
-				if (Font::fontIsMultibyte == true) {
-					if (font->getTextHandler() != NULL) {
-						//string renderText = text;
-						if (Font::fontIsRightToLeft == true) {
-							//printf("\n\n#A [%s]\n",renderText.c_str());
-							//bool isRLM = utf8::starts_with_rlm(text.begin(), text.end() + text.size());
-
-							//printf("\n\nORIGINAL TEXT [%s] isRLM = %d\n\n",text.c_str(),isRLM);
-							//for(int i = 0; i < renderText.size(); ++i) {
-							//	printf("i = %d c [%c][%d][%X]\n",i,renderText[i],renderText[i],renderText[i]);
-							//}
-							//if(isRLM == true) {
-							if (is_string_all_ascii(renderText) == false) {
-								strrev_utf8(renderText);
-							}
-						}
-
-						//String str("資料");
-						//WString wstr(str);
-						//fontFTGL->Render(wstr.cw_str());
-
-						//String str(L"資料");
-						//WString wstr(str);
-						//fontFTGL->Render(wstr.cw_str());
-
-						//WString wstr(L"資料");
-						//fontFTGL->Render(wstr.cw_str());
-
-						//size_t length = text.length();
-
-				//		string temp = String::ConvertToUTF8("資料");
-				//		size_t length = temp.length();
-				//		wchar_t *utf32 = (wchar_t*)malloc((length+1) * sizeof(wchar_t));
-				//		mbstowcs(utf32, temp.c_str(), length);
-				//		utf32[length] = 0;
-				//		fontFTGL->Render(utf32);
-				//		free(utf32);
-
-						//wstring wstr(L"資料");
-						//fontFTGL->Render(wstr.c_str());
-
-						//fontFTGL->Render(text.c_str());
-
-						//const wchar_t *str = L" 中文";
-						//fontFTGL->Render(str);
-
-						//fontFTGL->Render(" 中文"); // Chinese Works!
-						//fontFTGL->Render("ёшзхсдертбнйуимлопьжющэъ́"); // Russian Works!
-						//fontFTGL->Render("更新履歴はこちらをご覧下さい。"); // Japanese Works!
-
-						//fontFTGL->Render("مرحبا العالم"); //Arabic Works!
-						//wstring temp = L"مرحبا العالم";
-						//temp = wstring (temp.rbegin(), temp.rend());
-						//fontFTGL->Render(temp.c_str());
-
-						// Hebrew is Right To Left
-						//wstring temp = L"שלום העולם";
-						//temp = wstring (temp.rbegin(), temp.rend());
-						//fontFTGL->Render(temp.c_str());
-
-						//fontFTGL->Render("testování slovanský jazyk"); // Czech Works!
-
-						// This works
-						//fontFTGL->Render(text.c_str());
-
-						if (renderText.find("\n") == renderText.npos && renderText.find("\t") == renderText.npos) {
-							font->getTextHandler()->Render(renderText.c_str());
-						} else {
-							bool lastCharacterWasSpecial = true;
-							vector<string> parts;
-							char szBuf[8096] = "";
-
-							for (int i = 0; renderText[i] != '\0'; ++i) {
-								szBuf[0] = '\0';
-								snprintf(szBuf, 8096, "%c", renderText[i]);
-
-								switch (renderText[i]) {
-									case '\t':
-										parts.push_back(szBuf);
-										lastCharacterWasSpecial = true;
-										//rasterPos= Vec2f((rasterPos.x / size + 3.f) * size, y-(size + 1.f) * line);
-										//glRasterPos2f(rasterPos.x, rasterPos.y);
-										break;
-									case '\n':
-										parts.push_back(szBuf);
-										lastCharacterWasSpecial = true;
-										//line++;
-										//rasterPos= Vec2f(static_cast<float>(x), y - (fontFTGL->LineHeight(text.c_str()) * 2.f) * line);
-										//glRasterPos2f(rasterPos.x, rasterPos.y);
-										break;
-									default:
-										//glCallList(font->getHandle()+utext[i]);
-										if (lastCharacterWasSpecial == true) {
-											parts.push_back(szBuf);
-										} else {
-											parts[parts.size() - 1] += szBuf;
-										}
-										lastCharacterWasSpecial = false;
-										break;
-								}
-							}
-
-							for (unsigned int i = 0; i < parts.size(); ++i) {
-								switch (parts[i][0]) {
-									case '\t':
-										rasterPos = Vec2f((rasterPos.x / size + 3.f) * size, y - (size + 1.f) * line);
-										glRasterPos2f(rasterPos.x, rasterPos.y);
-										break;
-									case '\n':
-										line++;
-										rasterPos = Vec2f(static_cast<float>(x), y - (font->getTextHandler()->LineHeight(parts[i].c_str())) * line);
-										glRasterPos2f(rasterPos.x, rasterPos.y);
-										break;
-									default:
-										font->getTextHandler()->Render(parts[i].c_str());
-										break;
-								}
-							}
-						}
-					} else {
-						//setlocale(LC_CTYPE, "en_ca.UTF-8");
-
-						//wstring wText = widen(text);
-						//glListBase(font->getHandle());
-						//glCallLists(wText.length(), GL_UNSIGNED_SHORT, &wText[0]);
-
-						//string utfText = text;
-						//glListBase(font->getHandle());
-						//glCallLists(utfText.length(), GL_UNSIGNED_SHORT, &utfText[0]);
-
-						string utfText = renderText;
-						if (Font::fontIsRightToLeft == true) {
-							if (is_string_all_ascii(utfText) == false) {
-								strrev_utf8(utfText);
-							}
-						}
-
-						glListBase(font->getHandle());
-						glCallLists((GLsizei) renderText.length(), GL_UNSIGNED_SHORT, &utext[0]);
-
-						//std::locale loc("");
-						//wstring wText = widen(text);
-						//std::string strBuffer(Text.size() * 4 + 1, 0);
-						//std::use_facet<std::ctype<wchar_t> >(loc).narrow(&Text[0], &Text[0] + Text.size(), '?', &strBuffer[0]);
-						//string utfText = std::string(&strBuffer[0]);
-						//glListBase(font->getHandle());
-						//glCallLists(utfText.length(), GL_UNSIGNED_SHORT, &utfText[0]);
-					}
-				} else {
-					if (font->getTextHandler() != NULL) {
-						//string renderText = text;
-						if (Font::fontIsRightToLeft == true) {
-							if (is_string_all_ascii(renderText) == false) {
-								strrev_utf8(renderText);
-							}
-						}
-
-						if (renderText.find("\n") == renderText.npos && renderText.find("\t") == renderText.npos) {
-							font->getTextHandler()->Render(renderText.c_str());
-						} else {
-							bool lastCharacterWasSpecial = true;
-							vector<string> parts;
-							char szBuf[8096] = "";
-
-							for (int i = 0; renderText[i] != '\0'; ++i) {
-								szBuf[0] = '\0';
-								snprintf(szBuf, 8096, "%c", renderText[i]);
-
-								switch (renderText[i]) {
-									case '\t':
-										parts.push_back(szBuf);
-										lastCharacterWasSpecial = true;
-										//rasterPos= Vec2f((rasterPos.x / size + 3.f) * size, y-(size + 1.f) * line);
-										//glRasterPos2f(rasterPos.x, rasterPos.y);
-										break;
-									case '\n':
-										parts.push_back(szBuf);
-										lastCharacterWasSpecial = true;
-										//line++;
-										//rasterPos= Vec2f(static_cast<float>(x), y - (fontFTGL->LineHeight(text.c_str()) * 2.f) * line);
-										//glRasterPos2f(rasterPos.x, rasterPos.y);
-										break;
-									default:
-										//glCallList(font->getHandle()+utext[i]);
-										if (lastCharacterWasSpecial == true) {
-											parts.push_back(szBuf);
-										} else {
-											parts[parts.size() - 1] += szBuf;
-										}
-										lastCharacterWasSpecial = false;
-										break;
-								}
-							}
-
-							for (unsigned int i = 0; i < parts.size(); ++i) {
-								switch (parts[i][0]) {
-									case '\t':
-										rasterPos = Vec2f((rasterPos.x / size + 3.f) * size, y - (size + 1.f) * line);
-										glRasterPos2f(rasterPos.x, rasterPos.y);
-										break;
-									case '\n':
-										line++;
-										rasterPos = Vec2f(static_cast<float>(x), y - (font->getTextHandler()->LineHeight(parts[i].c_str())) * line);
-										glRasterPos2f(rasterPos.x, rasterPos.y);
-										break;
-									default:
-										font->getTextHandler()->Render(parts[i].c_str());
-										break;
-								}
-							}
-						}
+				if (font->getTextHandler() != NULL) {
+					if (layout.parts.empty() == true) {
+						font->getTextHandler()->Render(renderText.c_str());
 					} else {
-						for (int i = 0; utext[i] != '\0'; ++i) {
-							switch (utext[i]) {
+						const vector<string> &parts = layout.parts;
+						for (unsigned int i = 0; i < parts.size(); ++i) {
+							switch (parts[i][0]) {
 								case '\t':
-									rasterPos = Vec2f((rasterPos.x / size + 3.f)*size, y - (size + 1.f)*line);
+									rasterPos = Vec2f((rasterPos.x / size + 3.f) * size, y - (size + 1.f) * line);
 									glRasterPos2f(rasterPos.x, rasterPos.y);
 									break;
 								case '\n':
 									line++;
-									rasterPos = Vec2f(static_cast<float>(x), y - (metrics->getHeight("W")*2.f)*line);
+									rasterPos = Vec2f(static_cast<float>(x), y - (font->getTextHandler()->LineHeight(parts[i].c_str())) * line);
 									glRasterPos2f(rasterPos.x, rasterPos.y);
 									break;
 								default:
-									glCallList(font->getHandle() + utext[i]);
+									font->getTextHandler()->Render(parts[i].c_str());
+									break;
 							}
 						}
 					}
+				} else if (Font::fontIsMultibyte == true) {
+					glListBase(font->getHandle());
+					glCallLists((GLsizei) renderText.length(), GL_UNSIGNED_SHORT, &utext[0]);
+				} else {
+					for (int i = 0; utext[i] != '\0'; ++i) {
+						switch (utext[i]) {
+							case '\t':
+								rasterPos = Vec2f((rasterPos.x / size + 3.f)*size, y - (size + 1.f)*line);
+								glRasterPos2f(rasterPos.x, rasterPos.y);
+								break;
+							case '\n':
+								line++;
+								rasterPos = Vec2f(static_cast<float>(x), y - (metrics->getHeight("W")*2.f)*line);
+								glRasterPos2f(rasterPos.x, rasterPos.y);
+								break;
+							default:
+								glCallList(font->getHandle() + utext[i]);
+						}
+					}
 				}
 
 				if (color != NULL) {
@@ -381,33 +184,11 @@ namespace Shared {
 				assert(rendering);
 
 				if (text.empty() == false) {
-					string renderText = text;
-					Font::bidi_cvt(renderText);
+					// right to left text is only reversed for multibyte fonts here
+					TextLayoutCache *layoutCache = font->getMetrics()->getLayoutCache();
+					TextLayout &layout = layoutCache->getLayout(text, Font::fontIsMultibyte == true && font->getTextHandler() != NULL);
 
-					if (Font::fontIsMultibyte == true) {
-						if (font->getTextHandler() != NULL) {
-							if (Font::fontIsRightToLeft == true) {
-								//printf("\n\n#A [%s]\n",renderText.c_str());
-								//bool isRLM = utf8::starts_with_rlm(text.begin(), text.end() + text.size());
-
-								//printf("\n\nORIGINAL TEXT [%s] isRLM = %d\n\n",text.c_str(),isRLM);
-								//for(int i = 0; i < renderText.size(); ++i) {
-								//	printf("i = %d c [%c][%d][%X]\n",i,renderText[i],renderText[i],renderText[i]);
-								//}
-								//if(isRLM == true) {
-								if (is_string_all_ascii(renderText) == false) {
-									//printf("\n\nORIGINAL TEXT [%s]\n\n",text.c_str());
-									//for(int i = 0; i < renderText.size(); ++i) {
-									//	printf("i = %d c [%c][%d][%X]\n",i,renderText[i],renderText[i],renderText[i]);
-									//}
-
-									strrev_utf8(renderText);
-								}
-							}
-						}
-					}
-
-					internalRender(renderText, x, y, centered, color);
+					internalRender(layout, x, y, centered, color);
 				}
 			}
 
@@ -433,7 +214,7 @@ namespace Shared {
 				//}
 			}
 
-			void TextRenderer3DGl::internalRender(const string &text, float  x, float y, bool centered, Vec4f *color) {
+			void TextRenderer3DGl::internalRender(TextLayout &layout, float  x, float y, bool centered, Vec4f *color) {
 				//assert(rendering);
 
 				if (color != NULL) {
@@ -447,7 +228,7 @@ namespace Shared {
 					//assertGl();
 				}
 
-				string renderText = text;
+				const string &renderText = layout.renderText;
 				const unsigned char *utext = NULL;
 				//assertGl();
 
@@ -483,10 +264,10 @@ namespace Shared {
 			//			translatePos.x = x - scale * font->getTextHandler()->Advance(text.c_str()) / 2.f;
 			//			translatePos.y = y - scale * font->getTextHandler()->LineHeight(text.c_str()) / font->getYOffsetFactor();
 						//assertGl();
-						translatePos.x = x - (font->getTextHandler()->Advance(renderText.c_str()) / 2.f);
+						translatePos.x = x - (metrics->getLayoutCache()->getAdvance(font->getTextHandler(), layout) / 2.f);
 						//assertGl();
 						//translatePos.y = y - (font->getTextHandler()->LineHeight(text.c_str()) / font->getYOffsetFactor());
-						translatePos.y = y - ((font->getTextHandler()->LineHeight(renderText.c_str()) * Font::scaleFontValue) / 2.f);
+						translatePos.y = y - ((metrics->getLayoutCache()->getLineHeight(font->getTextHandler(), layout) * Font::scaleFontValue) / 2.f);
 						//assertGl();
 
 						translatePos.z = 0;
@@ -554,40 +335,13 @@ namespace Shared {
 					float scaleZ = 1.0;
 
 					glScalef(scaleX, scaleY, scaleZ);
-					if (renderText.find("\n") == renderText.npos && renderText.find("\t") == renderText.npos) {
+					if (layout.parts.empty() == true) {
 						//assertGl();
 						font->getTextHandler()->Render(renderText.c_str());
 						specialFTGLErrorCheckWorkaround(renderText);
 					} else {
 						int line = 0;
-						bool lastCharacterWasSpecial = true;
-						vector<string> parts;
-						char szBuf[8096] = "";
-
-						//for (int i=0; renderText[i] != '\0'; ++i) {
-						for (size_t i = 0; i < renderText.size(); ++i) {
-							szBuf[0] = '\0';
-							snprintf(szBuf, 8096, "%c", renderText[i]);
-
-							switch (renderText[i]) {
-								case '\t':
-									parts.push_back(szBuf);
-									lastCharacterWasSpecial = true;
-									break;
-								case '\n':
-									parts.push_back(szBuf);
-									lastCharacterWasSpecial = true;
-									break;
-								default:
-									if (lastCharacterWasSpecial == true) {
-										parts.push_back(szBuf);
-									} else {
-										parts[parts.size() - 1] += szBuf;
-									}
-									lastCharacterWasSpecial = false;
-									break;
-							}
-						}
+						const vector<string> &parts = layout.parts;
 
 						bool needsRecursiveRender = false;
 						for (unsigned int i = 0; i < parts.size(); ++i) {
@@ -42,6 +42,10 @@ namespace Shared {
 			normals = NULL;
 
 			raw_frame_ofs = 0;
+			verticesT = -1.f;
+			verticesCycle = false;
+			normalsT = -1.f;
+			normalsCycle = false;
 
 			this->mesh = mesh;
 		}
@@ -59,14 +63,14 @@ namespace Shared {
 		}
 
 		void InterpolationData::updateVertices(float t, bool cycle) {
-			update(mesh->getVertices(), vertices, t, cycle);
+			update(mesh->getVertices(), vertices, t, cycle, verticesT, verticesCycle);
 		}
 
 		void InterpolationData::updateNormals(float t, bool cycle) {
-			update(mesh->getNormals(), normals, t, cycle);
+			update(mesh->getNormals(), normals, t, cycle, normalsT, normalsCycle);
 		}
 
-		void InterpolationData::update(const Vec3f* src, Vec3f* &dest, float t, bool cycle) {
+		void InterpolationData::update(const Vec3f* src, Vec3f* &dest, float t, bool cycle, float &lastT, bool &lastCycle) {
 
 			if (t <0.0f || t>1.0f) {
 				printf("ERROR t = [%f] for cycle [%d] f [%d] v [%d]\n", t, cycle, mesh->getFrameCount(), mesh->getVertexCount());
@@ -106,12 +110,17 @@ namespace Shared {
 				assert(nextFrame < frameCount);
 
 				if (enableInterpolation) {
+					if (dest != NULL && t == lastT && cycle == lastCycle) {
+						return;
+					}
 					if (!dest) { // not previously allocated
 						dest = new Vec3f[vertexCount];
 					}
 					for (uint32 j = 0; j < vertexCount; ++j) {
 						dest[j] = src[prevFrameBase + j].lerp(localT, src[nextFrameBase + j]);
 					}
+					lastT = t;
+					lastCycle = cycle;
 				} else {
 					raw_frame_ofs = prevFrameBase;
 				}
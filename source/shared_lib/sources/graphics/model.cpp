@@ -463,8 +463,10 @@ namespace Shared {
 
 				if (SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] v2 model texture [%s] meshIndex = %d modelFile [%s]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, texPath.c_str(), meshIndex, modelFile.c_str());
 
-				textures[0] = dynamic_cast<Texture2D*>(textureManager->getTexture(texPath));
-				if (textures[0] == NULL) {
+				textures[0] = dynamic_cast<Texture2D*>(textureManager->acquireTexture(texPath));
+				if (textures[0] != NULL) {
+					texturesOwned[0] = true;
+				} else {
 					if (fileExists(texPath) == false) {
 						vector<string> conversionList;
 						conversionList.push_back("png");
@@ -481,6 +483,7 @@ namespace Shared {
 						if (loadedFileList) {
 							(*loadedFileList)[texPath].push_back(make_pair(sourceLoader, sourceLoader));
 						}
+						textures[0] = textureManager->shareDuplicateTexture2D(textures[0]);
 						texturesOwned[0] = true;
 						textures[0]->init(textureManager->getTextureFilter(), textureManager->getMaxAnisotropy());
 						if (deletePixMapAfterLoad == true) {
@@ -605,8 +608,10 @@ namespace Shared {
 
 				if (SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] v3 model texture [%s] meshIndex = %d modelFile [%s]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, texPath.c_str(), meshIndex, modelFile.c_str());
 
-				textures[0] = dynamic_cast<Texture2D*>(textureManager->getTexture(texPath));
-				if (textures[0] == NULL) {
+				textures[0] = dynamic_cast<Texture2D*>(textureManager->acquireTexture(texPath));
+				if (textures[0] != NULL) {
+					texturesOwned[0] = true;
+				} else {
 					if (fileExists(texPath) == false) {
 						vector<string> conversionList;
 						conversionList.push_back("png");
@@ -624,6 +629,7 @@ namespace Shared {
 						if (loadedFileList) {
 							(*loadedFileList)[texPath].push_back(make_pair(sourceLoader, sourceLoader));
 						}
+						textures[0] = textureManager->shareDuplicateTexture2D(textures[0]);
 
 						texturesOwned[0] = true;
 						textures[0]->init(textureManager->getTextureFilter(), textureManager->getMaxAnisotropy());
@@ -704,8 +710,10 @@ namespace Shared {
 
 			if (SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s] #1 load texture [%s] modelFile [%s]\n", __FUNCTION__, textureFile.c_str(), modelFile.c_str());
 
-			Texture2D* texture = dynamic_cast<Texture2D*>(textureManager->getTexture(textureFile));
-			if (texture == NULL) {
+			Texture2D* texture = dynamic_cast<Texture2D*>(textureManager->acquireTexture(textureFile));
+			if (texture != NULL) {
+				textureOwned = true;
+			} else {
 				if (fileExists(textureFile) == false) {
 					vector<string> conversionList;
 					conversionList.push_back("png");
@@ -729,6 +737,7 @@ namespace Shared {
 					if (loadedFileList) {
 						(*loadedFileList)[textureFile].push_back(make_pair(sourceLoader, sourceLoader));
 					}
+					texture = textureManager->shareDuplicateTexture2D(texture);
 
 					//if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s] texture loaded [%s]\n",__FUNCTION__,textureFile.c_str());
 
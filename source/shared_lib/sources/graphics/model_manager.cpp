@@ -41,12 +41,72 @@ namespace Shared {
 			end();
 		}
 
+		string ModelManager::getModelLookupKey(const string &path, bool deletePixMapAfterLoad) {
+			return path + (deletePixMapAfterLoad == true ? "|1" : "|0");
+		}
+
 		Model *ModelManager::newModel(const string &path, bool deletePixMapAfterLoad, std::map<string, vector<pair<string, string> > > *loadedFileList, string *sourceLoader) {
-			Model *model = GraphicsInterface::getInstance().getFactory()->newModel(path, textureManager, deletePixMapAfterLoad, loadedFileList, sourceLoader);
+			// Models loaded from the same file are shared, callers release
+			// them through endModel which only deletes the last reference
+			const string lookupKey = getModelLookupKey(path, deletePixMapAfterLoad);
+			ModelPathLookup::iterator iterFind = modelPathLookup.find(lookupKey);
+			if (path != "" && iterFind != modelPathLookup.end()) {
+				Model *model = iterFind->second;
+				modelRefCounts[model]++;
+
+				if (loadedFileList != NULL) {
+					string sourceLoaderName = (sourceLoader != NULL ? *sourceLoader : "");
+					const vector<string> &files = modelFiles[model];
+					for (unsigned int fileIndex = 0; fileIndex < files.size(); ++fileIndex) {
+						(*loadedFileList)[files[fileIndex]].push_back(make_pair(sourceLoaderName, sourceLoaderName));
+					}
+				}
+				return model;
+			}
+
+			// collect the files locally so a later reuse can report them too
+			std::map<string, vector<pair<string, string> > > modelLoadedFiles;
+			Model *model = GraphicsInterface::getInstance().getFactory()->newModel(path, textureManager, deletePixMapAfterLoad, &modelLoadedFiles, sourceLoader);
 			models.push_back(model);
+			modelRefCounts[model] = 1;
+			if (path != "") {
+				modelPathLookup[lookupKey] = model;
+				vector<string> &files = modelFiles[model];
+				for (std::map<string, vector<pair<string, string> > >::iterator iterMap = modelLoadedFiles.begin();
+					iterMap != modelLoadedFiles.end(); ++iterMap) {
+					files.push_back(iterMap->first);
+				}
+			}
+			if (loadedFileList != NULL) {
+				for (std::map<string, vector<pair<string, string> > >::iterator iterMap = modelLoadedFiles.begin();
+					iterMap != modelLoadedFiles.end(); ++iterMap) {
+					vector<pair<string, string> > &loaders = (*loadedFileList)[iterMap->first];
+					loaders.insert(loaders.end(), iterMap->second.begin(), iterMap->second.end());
+				}
+			}
 			return model;
 		}
 
+		void ModelManager::removeModelFromLookups(Model *model) {
+			for (ModelPathLookup::iterator iterMap = modelPathLookup.begin();
+				iterMap != modelPathLookup.end(); ++iterMap) {
+				if (iterMap->second == model) {
+					modelPathLookup.erase(iterMap);
+					break;
+				}
+			}
+			modelRefCounts.erase(model);
+			modelFiles.erase(model);
+		}
+
+		int ModelManager::getModelRefCount(Model *model) const {
+			ModelRefCountLookup::const_iterator iterFind = modelRefCounts.find(model);
+			if (iterFind != modelRefCounts.end()) {
+				return iterFind->second;
+			}
+			return 0;
+		}
+
 		void ModelManager::init() {
 			for (size_t i = 0; i < models.size(); ++i) {
 				if (models[i] != NULL) {
@@ -64,10 +124,20 @@ namespace Shared {
 				}
 			}
 			models.clear();
+			modelPathLookup.clear();
+			modelRefCounts.clear();
+			modelFiles.clear();
 		}
 
 		void ModelManager::endModel(Model *model, bool mustExistInList) {
 			if (model != NULL) {
+				ModelRefCountLookup::iterator iterFindRef = modelRefCounts.find(model);
+				if (iterFindRef != modelRefCounts.end() && iterFindRef->second > 1) {
+					iterFindRef->second--;
+					return;
+				}
+				removeModelFromLookups(model);
+
 				bool found = false;
 				for (unsigned int idx = 0; idx < models.size(); idx++) {
 					Model *curModel = models[idx];
@@ -94,6 +164,7 @@ namespace Shared {
 				size_t index = models.size() - 1;
 				Model *curModel = models[index];
 				models.erase(models.begin() + index);
+				removeModelFromLookups(curModel);
 
 				curModel->end();
 				delete curModel;
@@ -12,12 +12,14 @@
 #include "texture_manager.h"
 
 #include <cstdlib>
+#include <cstring>
 #include <stdexcept>
 
 #include "graphics_interface.h"
 #include "graphics_factory.h"
 
 #include "util.h"
+#include "checksum.h"
 #include "platform_util.h"
 #include "leak_dumper.h"
 
@@ -39,6 +41,9 @@ namespace Shared {
 
 			textureFilter = Texture::fBilinear;
 			maxAnisotropy = 1;
+			unusedTextureBytes = 0;
+			maxUnusedTextureBytes = 0;
+			shareDuplicateContent = false;
 		}
 
 		TextureManager::~TextureManager() {
@@ -51,8 +56,103 @@ namespace Shared {
 			}
 		}
 
+		void TextureManager::addTexture(Texture *texture) {
+			textures.push_back(texture);
+			unindexedTextures.push_back(texture);
+			textureRefCounts[texture] = 1;
+		}
+
+		void TextureManager::indexPendingTextures() {
+			for (unsigned int idx = 0; idx < unindexedTextures.size();) {
+				Texture *texture = unindexedTextures[idx];
+				string path = texture->getPath();
+				if (path != "") {
+					if (texturePathLookup.find(path) == texturePathLookup.end()) {
+						texturePathLookup[path] = texture;
+					}
+					unindexedTextures[idx] = unindexedTextures.back();
+					unindexedTextures.pop_back();
+				} else {
+					idx++;
+				}
+			}
+		}
+
+		void TextureManager::removeTextureFromLookups(Texture *texture) {
+			for (unsigned int idx = 0; idx < unindexedTextures.size(); idx++) {
+				if (unindexedTextures[idx] == texture) {
+					unindexedTextures[idx] = unindexedTextures.back();
+					unindexedTextures.pop_back();
+					break;
+				}
+			}
+			for (TexturePathLookup::iterator iterMap = texturePathLookup.begin();
+				iterMap != texturePathLookup.end();) {
+				if (iterMap->second == texture) {
+					texturePathLookup.erase(iterMap++);
+				} else {
+					++iterMap;
+				}
+			}
+			for (TextureContentLookup::iterator iterMap = textureContentLookup.begin();
+				iterMap != textureContentLookup.end(); ++iterMap) {
+				if (iterMap->second == texture) {
+					textureContentLookup.erase(iterMap);
+					break;
+				}
+			}
+			textureRefCounts.erase(texture);
+			reusableTextures.erase(texture);
+		}
+
+		void TextureManager::deleteTexture(Texture *texture) {
+			removeTextureFromLookups(texture);
+			texture->end();
+			delete texture;
+		}
+
+		void TextureManager::trimUnusedTextures(std::size_t maxBytes) {
+			while (unusedTextures.empty() == false && unusedTextureBytes > maxBytes) {
+				Texture *texture = unusedTextures.back();
+				unusedTextures.pop_back();
+				unusedTextureBytes -= texture->getPixelByteCount();
+
+				for (unsigned int idx = 0; idx < textures.size(); idx++) {
+					if (textures[idx] == texture) {
+						textures.erase(textures.begin() + idx);
+						break;
+					}
+				}
+				deleteTexture(texture);
+			}
+		}
+
 		void TextureManager::endTexture(Texture *texture, bool mustExistInList) {
 			if (texture != NULL) {
+				TextureRefCountLookup::iterator iterFindRef = textureRefCounts.find(texture);
+				if (iterFindRef != textureRefCounts.end()) {
+					if (iterFindRef->second > 1) {
+						iterFindRef->second--;
+						return;
+					}
+					// Keep the texture resident so a later request for the same
+					// path does not have to reload it
+					if (iterFindRef->second == 1 && maxUnusedTextureBytes > 0 &&
+						reusableTextures.find(texture) != reusableTextures.end() &&
+						texture->getPath() != "" &&
+						texture->getPixelByteCount() <= maxUnusedTextureBytes) {
+						iterFindRef->second = 0;
+						unusedTextures.push_front(texture);
+						unusedTextureBytes += texture->getPixelByteCount();
+						trimUnusedTextures(maxUnusedTextureBytes);
+						return;
+					}
+					if (iterFindRef->second <= 0) {
+						unusedTextures.remove(texture);
+						unusedTextureBytes -= texture->getPixelByteCount();
+					}
+				}
+
 				bool found = false;
 				for (unsigned int idx = 0; idx < textures.size(); idx++) {
 					Texture *curTexture = textures[idx];
@@ -65,8 +165,7 @@ namespace Shared {
 				if (found == false && mustExistInList == true) {
 					throw std::runtime_error("found == false in endTexture");
 				}
-				texture->end();
-				delete texture;
+				deleteTexture(texture);
 			}
 		}
 
@@ -78,8 +177,12 @@ namespace Shared {
 				Texture *curTexture = textures[index];
 				textures.erase(textures.begin() + index);
 
-				curTexture->end();
-				delete curTexture;
+				if (textureRefCounts.find(curTexture) != textureRefCounts.end() &&
+					textureRefCounts[curTexture] == 0) {
+					unusedTextures.remove(curTexture);
+					unusedTextureBytes -= curTexture->getPixelByteCount();
+				}
+				deleteTexture(curTexture);
 			}
 			if (found == false && mustExistInList == true) {
 				throw std::runtime_error("found == false in endLastTexture");
@@ -110,6 +213,13 @@ namespace Shared {
 				}
 			}
 			textures.clear();
+			unindexedTextures.clear();
+			texturePathLookup.clear();
+			textureContentLookup.clear();
+			textureRefCounts.clear();
+			reusableTextures.clear();
+			unusedTextures.clear();
+			unusedTextureBytes = 0;
 		}
 
 		void TextureManager::setFilter(Texture::Filter textureFilter) {
@@ -120,32 +230,137 @@ namespace Shared {
 			this->maxAnisotropy = maxAnisotropy;
 		}
 
-		Texture *TextureManager::getTexture(const string &path) {
-			for (unsigned int i = 0; i < textures.size(); ++i) {
-				if (textures[i]->getPath() == path) {
-					return textures[i];
+		void TextureManager::setMaxUnusedTextureBytes(std::size_t maxBytes) {
+			this->maxUnusedTextureBytes = maxBytes;
+			trimUnusedTextures(maxBytes);
+		}
+
+		Texture *TextureManager::findTexture(const string &path, bool includeUnused) {
+			indexPendingTextures();
+
+			TexturePathLookup::iterator iterFind = texturePathLookup.find(path);
+			if (iterFind != texturePathLookup.end()) {
+				Texture *texture = iterFind->second;
+				if (includeUnused == false && textureRefCounts[texture] <= 0) {
+					return NULL;
 				}
+				return texture;
 			}
 			return NULL;
 		}
 
+		Texture *TextureManager::getTexture(const string &path) {
+			return findTexture(path, false);
+		}
+
+		Texture *TextureManager::acquireTexture(const string &path) {
+			Texture *texture = findTexture(path, true);
+			if (texture != NULL) {
+				int &refCount = textureRefCounts[texture];
+				if (refCount <= 0) {
+					unusedTextures.remove(texture);
+					unusedTextureBytes -= texture->getPixelByteCount();
+					refCount = 0;
+				}
+				refCount++;
+				reusableTextures.insert(texture);
+			}
+			return texture;
+		}
+
+		Texture2D *TextureManager::shareDuplicateTexture2D(Texture2D *texture) {
+			if (texture != NULL) {
+				// model textures come through here and are acquired by path
+				// when the model is loaded again
+				reusableTextures.insert(texture);
+			}
+			if (shareDuplicateContent == false || texture == NULL) {
+				return texture;
+			}
+			const Pixmap2D *pixmap = texture->getPixmapConst();
+			if (pixmap == NULL || pixmap->getPixels() == NULL) {
+				return texture;
+			}
+
+			Checksum crc;
+			crc.addInt(pixmap->getW());
+			crc.addInt(pixmap->getH());
+			crc.addInt(pixmap->getComponents());
+			crc.addBytes(pixmap->getPixels(), pixmap->getPixelByteCount());
+			uint32 contentSum = crc.getSum();
+
+			TextureContentLookup::iterator iterFind = textureContentLookup.find(contentSum);
+			if (iterFind == textureContentLookup.end()) {
+				textureContentLookup[contentSum] = texture;
+				return texture;
+			}
+
+			Texture2D *duplicate = dynamic_cast<Texture2D *>(iterFind->second);
+			if (duplicate == NULL || duplicate == texture ||
+				duplicate->getMipmap() != texture->getMipmap() ||
+				duplicate->getWrapMode() != texture->getWrapMode() ||
+				duplicate->getFormat() != texture->getFormat()) {
+				return texture;
+			}
+			// the checksum only finds candidates, share on equal pixels only
+			const Pixmap2D *duplicatePixmap = duplicate->getPixmapConst();
+			if (duplicatePixmap == NULL || duplicatePixmap->getPixels() == NULL ||
+				duplicatePixmap->getW() != pixmap->getW() ||
+				duplicatePixmap->getH() != pixmap->getH() ||
+				duplicatePixmap->getComponents() != pixmap->getComponents() ||
+				duplicatePixmap->getPixelByteCount() != pixmap->getPixelByteCount() ||
+				memcmp(duplicatePixmap->getPixels(), pixmap->getPixels(), pixmap->getPixelByteCount()) != 0) {
+				return texture;
+			}
+
+			int &refCount = textureRefCounts[duplicate];
+			if (refCount <= 0) {
+				unusedTextures.remove(duplicate);
+				unusedTextureBytes -= duplicate->getPixelByteCount();
+				refCount = 0;
+			}
+			refCount++;
+
+			// later requests for this path resolve to the shared texture
+			string path = texture->getPath();
+			for (unsigned int idx = 0; idx < textures.size(); idx++) {
+				if (textures[idx] == texture) {
+					textures.erase(textures.begin() + idx);
+					break;
+				}
+			}
+			deleteTexture(texture);
+			if (path != "") {
+				texturePathLookup[path] = duplicate;
+			}
+			return duplicate;
+		}
+
+		int TextureManager::getTextureRefCount(Texture *texture) const {
+			TextureRefCountLookup::const_iterator iterFind = textureRefCounts.find(texture);
+			if (iterFind != textureRefCounts.end()) {
+				return iterFind->second;
+			}
+			return 0;
+		}
+
 		Texture1D *TextureManager::newTexture1D() {
 			Texture1D *texture1D = GraphicsInterface::getInstance().getFactory()->newTexture1D();
-			textures.push_back(texture1D);
+			addTexture(texture1D);
 
 			return texture1D;
 		}
 
 		Texture2D *TextureManager::newTexture2D() {
 			Texture2D *texture2D = GraphicsInterface::getInstance().getFactory()->newTexture2D();
-			textures.push_back(texture2D);
+			addTexture(texture2D);
 
 			return texture2D;
 		}
 
 		Texture3D *TextureManager::newTexture3D() {
 			Texture3D *texture3D = GraphicsInterface::getInstance().getFactory()->newTexture3D();
-			textures.push_back(texture3D);
+			addTexture(texture3D);
 
 			return texture3D;
 		}
@@ -153,7 +368,7 @@ namespace Shared {
 
 		TextureCube *TextureManager::newTextureCube() {
 			TextureCube *textureCube = GraphicsInterface::getInstance().getFactory()->newTextureCube();
-			textures.push_back(textureCube);
+			addTexture(textureCube);
 
 			return textureCube;
 		}
@@ -0,0 +1,140 @@
+// ==============================================================
+//	This file is part of ZetaGlest Shared Library (www.zetaglest.org)
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 3 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "map_file_reader.h"
+
+#include <cstdio>
+#include "platform_util.h"
+#include "conversion.h"
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "leak_dumper.h"
+
+using namespace Shared::Util;
+
+namespace Shared {
+	namespace Map {
+
+		// =====================================================
+		//	class MapFileReader
+		// =====================================================
+
+		MapFileReader::MapFileReader() {
+			data = NULL;
+			dataSize = 0;
+			mappedData = NULL;
+			memset(&header, 0, sizeof(header));
+			startLocationsOffset = 0;
+			heightsOffset = 0;
+			surfacesOffset = 0;
+			objectsOffset = 0;
+		}
+
+		MapFileReader::~MapFileReader() {
+			close();
+		}
+
+		void MapFileReader::open(const string &path) {
+			close();
+			this->path = path;
+
+#ifndef WIN32
+			int fd = ::open(path.c_str(), O_RDONLY);
+			if (fd < 0) {
+				throw megaglest_runtime_error("Can't open map file: " + path);
+			}
+			struct stat stats;
+			if (fstat(fd, &stats) == 0 && stats.st_size > 0) {
+				void *mapped = mmap(NULL, stats.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (mapped != MAP_FAILED) {
+					mappedData = mapped;
+					data = static_cast<const char *>(mapped);
+					dataSize = stats.st_size;
+				}
+			}
+			::close(fd);
+#endif
+
+			if (data == NULL) {
+#ifdef WIN32
+				FILE *f = _wfopen(utf8_decode(path).c_str(), L"rb");
+#else
+				FILE *f = fopen(path.c_str(), "rb");
+#endif
+				if (f == NULL) {
+					throw megaglest_runtime_error("Can't open map file: " + path);
+				}
+				fseek(f, 0, SEEK_END);
+				long fileSize = ftell(f);
+				fseek(f, 0, SEEK_SET);
+				if (fileSize > 0) {
+					buffer.resize(fileSize);
+					size_t readBytes = fread(&buffer[0], 1, fileSize, f);
+					buffer.resize(readBytes);
+				}
+				fclose(f);
+
+				data = (buffer.empty() == false ? &buffer[0] : NULL);
+				dataSize = buffer.size();
+			}
+
+			if (dataSize < (int64) sizeof(MapFileHeader)) {
+				close();
+				throw megaglest_runtime_error("Invalid map header detected for file: " + path);
+			}
+			memcpy(&header, data, sizeof(MapFileHeader));
+			fromEndianMapFileHeader(header);
+
+			if (header.width <= 0 || header.height <= 0 ||
+				header.maxFactions < 0 || header.maxFactions > MAX_MAP_FACTIONCOUNT) {
+				char szBuf[8096] = "";
+				snprintf(szBuf, 8096, "Invalid map dimensions %d x %d, %d factions in file: %s",
+					header.width, header.height, header.maxFactions, path.c_str());
+				close();
+				throw megaglest_runtime_error(szBuf);
+			}
+
+			int64 cellCount = (int64) header.width * header.height;
+			startLocationsOffset = sizeof(MapFileHeader);
+			heightsOffset = startLocationsOffset + (int64) header.maxFactions * 2 * sizeof(int32);
+			surfacesOffset = heightsOffset + cellCount * sizeof(float32);
+			objectsOffset = surfacesOffset + cellCount * sizeof(int8);
+
+			int64 expectedSize = objectsOffset + cellCount * sizeof(int8);
+			if (dataSize < expectedSize) {
+				char szBuf[8096] = "";
+				snprintf(szBuf, 8096, "Map file is cut off, size %lld expected %lld: %s",
+					(long long) dataSize, (long long) expectedSize, path.c_str());
+				close();
+				throw megaglest_runtime_error(szBuf);
+			}
+		}
+
+		void MapFileReader::close() {
+#ifndef WIN32
+			if (mappedData != NULL) {
+				munmap(mappedData, dataSize);
+			}
+#endif
+			mappedData = NULL;
+			buffer.clear();
+			data = NULL;
+			dataSize = 0;
+		}
+
+	}
+}//end namespace
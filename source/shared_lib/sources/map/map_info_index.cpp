@@ -0,0 +1,430 @@
+// ==============================================================
+//	This file is part of ZetaGlest Shared Library (www.zetaglest.org)
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 3 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "map_info_index.h"
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include "map_preview.h"
+#include "map_file_reader.h"
+#include "checksum.h"
+#include "platform_common.h"
+#include "platform_util.h"
+#include "util.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Util;
+using namespace Shared::Platform;
+using namespace Shared::PlatformCommon;
+using namespace std;
+
+namespace Shared {
+	namespace Map {
+
+		// bump when the entry layout changes, older indexes are dropped
+		static const char *indexFileMagic = "ZGMI";
+		static const uint32 indexFileVersion = 1;
+
+		static void appendUInt32(string &data, uint32 value) {
+			for (int i = 0; i < 4; ++i) {
+				data += (char) ((value >> (i * 8)) & 0xFF);
+			}
+		}
+
+		static void appendInt64(string &data, int64 value) {
+			appendUInt32(data, (uint32) (value & 0xFFFFFFFF));
+			appendUInt32(data, (uint32) (((uint64) value) >> 32));
+		}
+
+		static void appendString(string &data, const string &value) {
+			appendUInt32(data, (uint32) value.size());
+			data += value;
+		}
+
+		static bool readUInt32(const string &data, size_t &pos, uint32 &value) {
+			if (pos + 4 > data.size()) {
+				return false;
+			}
+			value = 0;
+			for (int i = 0; i < 4; ++i) {
+				value |= ((uint32) (unsigned char) data[pos + i]) << (i * 8);
+			}
+			pos += 4;
+			return true;
+		}
+
+		static bool readInt32(const string &data, size_t &pos, int &value) {
+			uint32 rawValue = 0;
+			bool result = readUInt32(data, pos, rawValue);
+			value = (int) rawValue;
+			return result;
+		}
+
+		static bool readInt64(const string &data, size_t &pos, int64 &value) {
+			uint32 low = 0;
+			uint32 high = 0;
+			if (readUInt32(data, pos, low) == false || readUInt32(data, pos, high) == false) {
+				return false;
+			}
+			value = (int64) (((uint64) high << 32) | low);
+			return true;
+		}
+
+		static bool readString(const string &data, size_t &pos, string &value) {
+			uint32 length = 0;
+			if (readUInt32(data, pos, length) == false || pos + length > data.size()) {
+				return false;
+			}
+			value = data.substr(pos, length);
+			pos += length;
+			return true;
+		}
+
+		static string headerString(const int8 *text, int maxLength) {
+			const char *chars = reinterpret_cast<const char *>(text);
+			int length = 0;
+			while (length < maxLength && chars[length] != '\0') {
+				length++;
+			}
+			return string(chars, length);
+		}
+
+		// =====================================================
+		//	class MapIndexEntry
+		// =====================================================
+
+		MapIndexEntry::MapIndexEntry() {
+			fileSize = 0;
+			modTime = 0;
+			valid = false;
+			version = 0;
+			width = 0;
+			height = 0;
+			players = 0;
+			heightFactor = 0;
+			waterLevel = 0;
+			cliffLevel = 0;
+			cameraHeight = 0;
+			crc = 0;
+			previewStep = 1;
+			previewW = 0;
+			previewH = 0;
+		}
+
+		// =====================================================
+		//	class MapInfoIndex
+		// =====================================================
+
+		Mutex MapInfoIndex::mutex;
+		std::map<string, MapIndexEntry> MapInfoIndex::entries;
+		bool MapInfoIndex::loaded = false;
+		bool MapInfoIndex::changed = false;
+		const char *MapInfoIndex::indexFileName = "MAP_INFO_INDEX";
+
+		string MapInfoIndex::getIndexFilePath() {
+			string cachePath = getCRCCacheFilePath();
+			if (cachePath == "") {
+				return "";
+			}
+			return cachePath + indexFileName;
+		}
+
+		void MapInfoIndex::load() {
+			loaded = true;
+			string indexFile = getIndexFilePath();
+			if (indexFile == "" || fileExists(indexFile) == false) {
+				return;
+			}
+
+#ifdef WIN32
+			FILE *f = _wfopen(utf8_decode(indexFile).c_str(), L"rb");
+#else
+			FILE *f = fopen(indexFile.c_str(), "rb");
+#endif
+			if (f == NULL) {
+				return;
+			}
+			string data;
+			fseek(f, 0, SEEK_END);
+			long fileSize = ftell(f);
+			fseek(f, 0, SEEK_SET);
+			if (fileSize > 0) {
+				data.resize(fileSize);
+				data.resize(fread(&data[0], 1, fileSize, f));
+			}
+			fclose(f);
+
+			size_t pos = 4;
+			uint32 version = 0;
+			uint32 count = 0;
+			if (data.compare(0, 4, indexFileMagic) != 0 ||
+				readUInt32(data, pos, version) == false || version != indexFileVersion ||
+				readUInt32(data, pos, count) == false) {
+				return;
+			}
+
+			std::map<string, MapIndexEntry> loadedEntries;
+			for (uint32 i = 0; i < count; ++i) {
+				MapIndexEntry entry;
+				uint32 valid = 0;
+				bool ok = readString(data, pos, entry.path) &&
+					readInt64(data, pos, entry.fileSize) &&
+					readInt64(data, pos, entry.modTime) &&
+					readUInt32(data, pos, entry.crc) &&
+					readUInt32(data, pos, valid);
+				entry.valid = (valid != 0);
+
+				if (ok == true && entry.valid == true) {
+					ok = readInt32(data, pos, entry.version) &&
+						readInt32(data, pos, entry.width) &&
+						readInt32(data, pos, entry.height) &&
+						readInt32(data, pos, entry.players) &&
+						readInt32(data, pos, entry.heightFactor) &&
+						readInt32(data, pos, entry.waterLevel) &&
+						readInt32(data, pos, entry.cliffLevel) &&
+						readInt32(data, pos, entry.cameraHeight) &&
+						readString(data, pos, entry.title) &&
+						readString(data, pos, entry.author) &&
+						readString(data, pos, entry.desc) &&
+						readInt32(data, pos, entry.previewStep) &&
+						readInt32(data, pos, entry.previewW) &&
+						readInt32(data, pos, entry.previewH);
+
+					int cellCount = entry.previewW * entry.previewH;
+					if (ok == true && (entry.previewW <= 0 || entry.previewH <= 0 ||
+						cellCount > MapIndexEntry::previewDimension * MapIndexEntry::previewDimension ||
+						entry.players <= 0 || entry.players > MAX_MAP_FACTIONCOUNT ||
+						pos + (size_t) cellCount * 6 > data.size())) {
+						ok = false;
+					}
+					if (ok == true) {
+						entry.previewHeights.resize(cellCount);
+						for (int cell = 0; cell < cellCount; ++cell) {
+							uint32 rawHeight = 0;
+							readUInt32(data, pos, rawHeight);
+							memcpy(&entry.previewHeights[cell], &rawHeight, sizeof(float32));
+						}
+						entry.previewSurfaces.assign(data.begin() + pos, data.begin() + pos + cellCount);
+						pos += cellCount;
+						entry.previewObjects.assign(data.begin() + pos, data.begin() + pos + cellCount);
+						pos += cellCount;
+
+						entry.previewStartLocations.resize(entry.players * 2);
+						for (unsigned int location = 0; ok == true && location < entry.previewStartLocations.size(); ++location) {
+							ok = readInt32(data, pos, entry.previewStartLocations[location]);
+						}
+					}
+				}
+
+				if (ok == false) {
+					SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] map info index [%s] is damaged, rebuilding it\n", __FILE__, __FUNCTION__, __LINE__, indexFile.c_str());
+					return;
+				}
+				loadedEntries[entry.path] = entry;
+			}
+			entries.swap(loadedEntries);
+
+			if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] loaded %d maps from [%s]\n", __FILE__, __FUNCTION__, __LINE__, (int) entries.size(), indexFile.c_str());
+		}
+
+		void MapInfoIndex::buildEntry(const string &path, MapIndexEntry &entry) {
+			entry = MapIndexEntry();
+			entry.path = path;
+			entry.fileSize = getFileSize(path);
+			entry.modTime = getFileModTime(path);
+
+			Checksum checksum;
+			checksum.addFile(path);
+			entry.crc = checksum.getSum();
+
+			try {
+				MapFileReader reader;
+				reader.open(path);
+				const MapFileHeader &header = reader.getHeader();
+				if (header.version < mapver_1 || header.version >= mapver_MAX ||
+					header.maxFactions <= 0 || header.maxFactions > MAX_MAP_FACTIONCOUNT) {
+					return;
+				}
+
+				entry.version = header.version;
+				entry.width = header.width;
+				entry.height = header.height;
+				entry.players = header.maxFactions;
+				entry.heightFactor = header.heightFactor;
+				entry.waterLevel = header.waterLevel;
+				entry.title = headerString(header.title, MAX_TITLE_LENGTH);
+				entry.author = headerString(header.author, MAX_AUTHOR_LENGTH);
+				if (header.version == mapver_1) {
+					entry.desc = headerString(header.description, MAX_DESCRIPTION_LENGTH);
+				} else {
+					entry.desc = headerString(header.version2.short_desc, MAX_DESCRIPTION_LENGTH_VERSION2);
+					entry.cliffLevel = header.version2.cliffLevel;
+					entry.cameraHeight = header.version2.cameraHeight;
+				}
+
+				// power of two steps keep the preview sizes the
+				// renderer knows
+				while (max(entry.width, entry.height) / entry.previewStep > MapIndexEntry::previewDimension) {
+					entry.previewStep *= 2;
+				}
+				entry.previewW = (entry.width + entry.previewStep - 1) / entry.previewStep;
+				entry.previewH = (entry.height + entry.previewStep - 1) / entry.previewStep;
+
+				int cellCount = entry.previewW * entry.previewH;
+				entry.previewHeights.resize(cellCount);
+				entry.previewSurfaces.resize(cellCount);
+				entry.previewObjects.resize(cellCount);
+				for (int j = 0; j < entry.previewH; ++j) {
+					for (int i = 0; i < entry.previewW; ++i) {
+						int cell = j * entry.previewW + i;
+						int x = i * entry.previewStep;
+						int y = j * entry.previewStep;
+						entry.previewHeights[cell] = reader.getHeight(x, y);
+						entry.previewSurfaces[cell] = reader.getSurface(x, y);
+						entry.previewObjects[cell] = reader.getObject(x, y);
+					}
+				}
+
+				entry.previewStartLocations.resize(entry.players * 2);
+				for (int i = 0; i < entry.players; ++i) {
+					entry.previewStartLocations[i * 2] = reader.getStartLocationX(i) / entry.previewStep;
+					entry.previewStartLocations[i * 2 + 1] = reader.getStartLocationY(i) / entry.previewStep;
+				}
+				entry.valid = true;
+			} catch (const exception &e) {
+				SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] Error [%s] indexing map [%s]\n", __FILE__, __FUNCTION__, __LINE__, e.what(), path.c_str());
+			}
+		}
+
+		const MapIndexEntry * MapInfoIndex::findEntry(const string &path) {
+			if (fileExists(path) == false) {
+				return NULL;
+			}
+			if (loaded == false) {
+				load();
+			}
+
+			int64 fileSize = getFileSize(path);
+			int64 modTime = getFileModTime(path);
+			std::map<string, MapIndexEntry>::iterator iterFind = entries.find(path);
+			if (iterFind == entries.end() ||
+				iterFind->second.fileSize != fileSize ||
+				iterFind->second.modTime != modTime) {
+				if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] indexing map [%s]\n", __FILE__, __FUNCTION__, __LINE__, path.c_str());
+
+				MapIndexEntry &entry = entries[path];
+				buildEntry(path, entry);
+				changed = true;
+				return &entry;
+			}
+			return &iterFind->second;
+		}
+
+		bool MapInfoIndex::getEntry(const string &path, MapIndexEntry &entry) {
+			MutexSafeWrapper safeMutex(&mutex, CODE_AT_LINE);
+			const MapIndexEntry *found = findEntry(path);
+			if (found == NULL) {
+				return false;
+			}
+			entry = *found;
+			return true;
+		}
+
+		uint32 MapInfoIndex::getCRC(const string &path) {
+			MutexSafeWrapper safeMutex(&mutex, CODE_AT_LINE);
+			const MapIndexEntry *found = findEntry(path);
+			return (found != NULL ? found->crc : 0);
+		}
+
+		void MapInfoIndex::save() {
+			MutexSafeWrapper safeMutex(&mutex, CODE_AT_LINE);
+			string indexFile = getIndexFilePath();
+			if (changed == false || indexFile == "") {
+				return;
+			}
+
+			string data = indexFileMagic;
+			appendUInt32(data, indexFileVersion);
+			size_t countPos = data.size();
+			appendUInt32(data, 0);
+
+			uint32 count = 0;
+			for (std::map<string, MapIndexEntry>::iterator iterMap = entries.begin();
+				iterMap != entries.end();) {
+				const MapIndexEntry &entry = iterMap->second;
+				if (fileExists(entry.path) == false) {
+					entries.erase(iterMap++);
+					continue;
+				}
+
+				appendString(data, entry.path);
+				appendInt64(data, entry.fileSize);
+				appendInt64(data, entry.modTime);
+				appendUInt32(data, entry.crc);
+				appendUInt32(data, entry.valid ? 1 : 0);
+				if (entry.valid == true) {
+					appendUInt32(data, entry.version);
+					appendUInt32(data, entry.width);
+					appendUInt32(data, entry.height);
+					appendUInt32(data, entry.players);
+					appendUInt32(data, entry.heightFactor);
+					appendUInt32(data, entry.waterLevel);
+					appendUInt32(data, entry.cliffLevel);
+					appendUInt32(data, entry.cameraHeight);
+					appendString(data, entry.title);
+					appendString(data, entry.author);
+					appendString(data, entry.desc);
+					appendUInt32(data, entry.previewStep);
+					appendUInt32(data, entry.previewW);
+					appendUInt32(data, entry.previewH);
+					for (unsigned int cell = 0; cell < entry.previewHeights.size(); ++cell) {
+						uint32 rawHeight = 0;
+						memcpy(&rawHeight, &entry.previewHeights[cell], sizeof(float32));
+						appendUInt32(data, rawHeight);
+					}
+					data.append(entry.previewSurfaces.begin(), entry.previewSurfaces.end());
+					data.append(entry.previewObjects.begin(), entry.previewObjects.end());
+					for (unsigned int location = 0; location < entry.previewStartLocations.size(); ++location) {
+						appendUInt32(data, entry.previewStartLocations[location]);
+					}
+				}
+				count++;
+				++iterMap;
+			}
+			for (int i = 0; i < 4; ++i) {
+				data[countPos + i] = (char) ((count >> (i * 8)) & 0xFF);
+			}
+
+#ifdef WIN32
+			FILE *f = _wfopen(utf8_decode(indexFile).c_str(), L"wb");
+#else
+			FILE *f = fopen(indexFile.c_str(), "wb");
+#endif
+			if (f == NULL) {
+				SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] cannot write map info index [%s]\n", __FILE__, __FUNCTION__, __LINE__, indexFile.c_str());
+				return;
+			}
+			fwrite(data.data(), 1, data.size(), f);
+			fclose(f);
+			changed = false;
+		}
+
+		void MapInfoIndex::clear() {
+			MutexSafeWrapper safeMutex(&mutex, CODE_AT_LINE);
+			entries.clear();
+			loaded = false;
+			changed = false;
+		}
+
+	}
+}//end namespace
@@ -11,9 +11,12 @@
 
 
 #include "map_preview.h"
+#include "map_file_reader.h"
+#include "map_info_index.h"
 
 #include "math_wrapper.h"
 #include <cstdlib>
+#include <cstring>
 #include <stdexcept>
 #include <set>
 #include <iterator>
@@ -44,6 +47,7 @@ namespace Shared {
 			waterLevel = DEFAULT_MAP_WATER_DEPTH;
 			cliffLevel = DEFAULT_CLIFF_HEIGHT;
 			cameraHeight = 0;
+			allEditTilesDirty = true;
 			//cells = NULL;
 			cells.clear();
 			//startLocations = NULL;
@@ -141,6 +145,7 @@ namespace Shared {
 							if ((height > 0 && newAlt > oldAlt) || (height < 0 && newAlt < oldAlt) || height == 0) {
 								if (newAlt >= 0 && newAlt <= 20) {
 									cells[i][j].height = static_cast<float>(newAlt);
+									markEditTileDirty(i, j);
 									hasChanged = true;
 								}
 							}
@@ -167,6 +172,7 @@ namespace Shared {
 			if (radius == 1) {
 				if (inside(x, y)) {
 					cells[x][y].height = (float) goalAlt;
+					markEditTileDirty(x, y);
 					hasChanged = true;
 				}
 				return;
@@ -309,6 +315,7 @@ namespace Shared {
 							((newAlt - cells[i][j].height) < 0 && height < 0) ||
 							height == 0) {
 							cells[i][j].height = newAlt;
+							markEditTileDirty(i, j);
 							hasChanged = true;
 						}
 					}
@@ -318,6 +325,7 @@ namespace Shared {
 
 		void MapPreview::setHeight(int x, int y, float height) {
 			cells[x][y].height = height;
+			markEditTileDirty(x, y);
 			hasChanged = true;
 		}
 
@@ -346,6 +354,8 @@ namespace Shared {
 				}
 			}
 
+			markAllEditTilesDirty();
+
 			for (int i = 0; i < maxFactions; ++i) {
 				startLocations[i].x = w - startLocations[i].x - 1;
 			}
@@ -377,6 +387,8 @@ namespace Shared {
 				}
 			}
 
+			markAllEditTilesDirty();
+
 			for (int i = 0; i < maxFactions; ++i) {
 				startLocations[i].y = h - startLocations[i].y - 1;
 			}
@@ -395,6 +407,7 @@ namespace Shared {
 			cells[x][y].object = cells[sx][sy].object;
 			cells[x][y].resource = cells[sx][sy].resource;
 			cells[x][y].surface = cells[sx][sy].surface;
+			markEditTileDirty(x, y);
 
 			hasChanged = true;
 		}
@@ -417,6 +430,8 @@ namespace Shared {
 				int tmpSurface = cells[x][y].surface;
 				cells[x][y].surface = cells[sx][sy].surface;
 				cells[sx][sy].surface = tmpSurface;
+				markEditTileDirty(x, y);
+				markEditTileDirty(sx, sy);
 
 				hasChanged = true;
 			}
@@ -432,6 +447,7 @@ namespace Shared {
 						dist = get_dist(i - x, j - y);
 						if (radius > dist) {  // was >=
 							cells[i][j].surface = surface;
+							markEditTileDirty(i, j);
 							hasChanged = true;
 						}
 					}
@@ -441,6 +457,7 @@ namespace Shared {
 
 		void MapPreview::setSurface(int x, int y, MapSurfaceType surface) {
 			cells[x][y].surface = surface;
+			markEditTileDirty(x, y);
 			hasChanged = true;
 		}
 
@@ -455,6 +472,7 @@ namespace Shared {
 						if (radius > dist) {  // was >=
 							cells[i][j].object = object;
 							cells[i][j].resource = 0;
+							markEditTileDirty(i, j);
 							hasChanged = true;
 						}
 					}
@@ -467,6 +485,7 @@ namespace Shared {
 			if (object != 0) {
 				cells[x][y].resource = 0;
 			}
+			markEditTileDirty(x, y);
 			hasChanged = true;
 		}
 
@@ -481,6 +500,7 @@ namespace Shared {
 						if (radius > dist) {  // was >=
 							cells[i][j].resource = resource;
 							cells[i][j].object = 0;
+							markEditTileDirty(i, j);
 							hasChanged = true;
 						}
 					}
@@ -493,6 +513,7 @@ namespace Shared {
 			if (resource != 0) {
 				cells[x][y].object = 0;
 			}
+			markEditTileDirty(x, y);
 			hasChanged = true;
 		}
 
@@ -558,6 +579,7 @@ namespace Shared {
 					cells[i][j].surface = surf;
 				}
 			}
+			markAllEditTilesDirty();
 			hasChanged = true;
 		}
 
@@ -623,6 +645,8 @@ namespace Shared {
 					}
 				}
 			}
+			markAllEditTilesDirty();
+
 			for (int i = 0; i < maxFactions; ++i) {
 				startLocations[i].x += wOffset;
 				startLocations[i].y += hOffset;
@@ -739,10 +763,12 @@ namespace Shared {
 				}
 			}
 			delete[] oldHeights;
+			markAllEditTilesDirty();
 		}
 
 		void MapPreview::switchSurfaces(MapSurfaceType surf1, MapSurfaceType surf2) {
 			if (surf1 >= st_Grass && surf1 <= st_Ground && surf2 >= st_Grass && surf2 <= st_Ground) {
+				markAllEditTilesDirty();
 				for (int i = 0; i < w; ++i) {
 					for (int j = 0; j < h; ++j) {
 						if (cells[i][j].surface == surf1) {
@@ -789,125 +815,93 @@ namespace Shared {
 		}
 
 		void MapPreview::loadFromFile(const string &path) {
+			MapFileReader reader;
+			reader.open(path);
+			const MapFileHeader &header = reader.getHeader();
+
+			heightFactor = header.heightFactor;
+			waterLevel = header.waterLevel;
+			title = header.title;
+			author = header.author;
+			cliffLevel = 0;
+			if (header.version == 1) {
+				desc = header.description;
+			} else if (header.version == 2) {
+				desc = header.version2.short_desc;
+				cliffLevel = header.version2.cliffLevel;
+				cameraHeight = header.version2.cameraHeight;
+			}
 
-			// "Could not open file, result: 3 - 2 No such file or directory [C:\Documents and Settings\人間五\Application Data\megaglest\maps\clearings_in_the_woods.gbm]
+			//read start locations
+			resetFactions(header.maxFactions);
+			for (int i = 0; i < maxFactions; ++i) {
+				startLocations[i].x = reader.getStartLocationX(i);
+				startLocations[i].y = reader.getStartLocationY(i);
+			}
 
-#ifdef WIN32
-			wstring wstr = utf8_decode(path);
-			FILE* f1 = _wfopen(wstr.c_str(), L"rb");
-			int fileErrno = errno;
-#else
-			FILE *f1 = fopen(path.c_str(), "rb");
-#endif
-			if (f1 != NULL) {
+			//read heights, surfaces and objects
+			reset(header.width, header.height, (float) DEFAULT_MAP_CELL_HEIGHT, DEFAULT_MAP_CELL_SURFACE_TYPE);
+			for (int j = 0; j < h; ++j) {
+				for (int i = 0; i < w; ++i) {
+					Cell &cell = cells[i][j];
+					cell.height = reader.getHeight(i, j);
+					cell.surface = reader.getSurface(i, j);
 
-				//read header
-				MapFileHeader header;
-				size_t bytes = fread(&header, sizeof(MapFileHeader), 1, f1);
-				if (bytes != 1) {
-					char szBuf[8096] = "";
-					snprintf(szBuf, 8096, "fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.", bytes, __LINE__);
-					fclose(f1);
-					throw megaglest_runtime_error(szBuf);
-				}
-				fromEndianMapFileHeader(header);
-
-				heightFactor = header.heightFactor;
-				waterLevel = header.waterLevel;
-				title = header.title;
-				author = header.author;
-				cliffLevel = 0;
-				if (header.version == 1) {
-					desc = header.description;
-				} else if (header.version == 2) {
-					desc = header.version2.short_desc;
-					cliffLevel = header.version2.cliffLevel;
-					cameraHeight = header.version2.cameraHeight;
+					int8 obj = reader.getObject(i, j);
+					if (obj <= 10) {
+						cell.object = obj;
+					} else {
+						cell.resource = obj - 10;
+					}
 				}
+			}
 
-				//read start locations
-				resetFactions(header.maxFactions);
-				for (int i = 0; i < maxFactions; ++i) {
-					bytes = fread(&startLocations[i].x, sizeof(int32), 1, f1);
-					if (bytes != 1) {
-						char szBuf[8096] = "";
-						snprintf(szBuf, 8096, "fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.", bytes, __LINE__);
-						throw megaglest_runtime_error(szBuf);
-					}
-					startLocations[i].x = Shared::PlatformByteOrder::fromCommonEndian(startLocations[i].x);
+			fileLoaded = true;
+			mapFileLoaded = path;
+			hasChanged = false;
+		}
 
-					bytes = fread(&startLocations[i].y, sizeof(int32), 1, f1);
-					if (bytes != 1) {
-						char szBuf[8096] = "";
-						snprintf(szBuf, 8096, "fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.", bytes, __LINE__);
-						throw megaglest_runtime_error(szBuf);
-					}
-					startLocations[i].y = Shared::PlatformByteOrder::fromCommonEndian(startLocations[i].y);
-				}
 
-				//read Heights
-				reset(header.width, header.height, (float) DEFAULT_MAP_CELL_HEIGHT, DEFAULT_MAP_CELL_SURFACE_TYPE);
-				for (int j = 0; j < h; ++j) {
-					for (int i = 0; i < w; ++i) {
-						bytes = fread(&cells[i][j].height, sizeof(float), 1, f1);
-						if (bytes != 1) {
-							char szBuf[8096] = "";
-							snprintf(szBuf, 8096, "fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.", bytes, __LINE__);
-							throw megaglest_runtime_error(szBuf);
-						}
-						cells[i][j].height = Shared::PlatformByteOrder::fromCommonEndian(cells[i][j].height);
-					}
-				}
+		void MapPreview::loadPreviewFromFile(const string &path) {
+			MapIndexEntry entry;
+			if (MapInfoIndex::getEntry(path, entry) == false || entry.valid == false) {
+				// let the full load report what is wrong with the file
+				loadFromFile(path);
+				return;
+			}
 
-				//read surfaces
-				for (int j = 0; j < h; ++j) {
-					for (int i = 0; i < w; ++i) {
-						bytes = fread(&cells[i][j].surface, sizeof(int8), 1, f1);
-						if (bytes != 1) {
-							char szBuf[8096] = "";
-							snprintf(szBuf, 8096, "fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.", bytes, __LINE__);
-							throw megaglest_runtime_error(szBuf);
-						}
-						cells[i][j].surface = Shared::PlatformByteOrder::fromCommonEndian(cells[i][j].surface);
-					}
-				}
+			heightFactor = entry.heightFactor;
+			waterLevel = entry.waterLevel;
+			cliffLevel = entry.cliffLevel;
+			cameraHeight = entry.cameraHeight;
+			title = entry.title;
+			author = entry.author;
+			desc = entry.desc;
 
-				//read objects
-				for (int j = 0; j < h; ++j) {
-					for (int i = 0; i < w; ++i) {
-						int8 obj;
-						bytes = fread(&obj, sizeof(int8), 1, f1);
-						if (bytes != 1) {
-							char szBuf[8096] = "";
-							snprintf(szBuf, 8096, "fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.", bytes, __LINE__);
-							throw megaglest_runtime_error(szBuf);
-						}
-						obj = Shared::PlatformByteOrder::fromCommonEndian(obj);
+			resetFactions(entry.players);
+			for (int i = 0; i < maxFactions; ++i) {
+				startLocations[i].x = entry.previewStartLocations[i * 2];
+				startLocations[i].y = entry.previewStartLocations[i * 2 + 1];
+			}
 
-						if (obj <= 10) {
-							cells[i][j].object = obj;
-						} else {
-							cells[i][j].resource = obj - 10;
-						}
+			reset(entry.previewW, entry.previewH, (float) DEFAULT_MAP_CELL_HEIGHT, DEFAULT_MAP_CELL_SURFACE_TYPE);
+			for (int j = 0; j < h; ++j) {
+				for (int i = 0; i < w; ++i) {
+					int cell = j * entry.previewW + i;
+					cells[i][j].height = entry.previewHeights[cell];
+					cells[i][j].surface = entry.previewSurfaces[cell];
+					if (entry.previewObjects[cell] <= 10) {
+						cells[i][j].object = entry.previewObjects[cell];
+					} else {
+						cells[i][j].resource = entry.previewObjects[cell] - 10;
 					}
 				}
-
-				if (f1) fclose(f1);
-
-				fileLoaded = true;
-				mapFileLoaded = path;
-				hasChanged = false;
-			} else {
-#ifdef WIN32
-				DWORD error = GetLastError();
-				string strError = "[#5] Could not open file, result: " + intToStr(error) + " - " + intToStr(fileErrno) + " " + strerror(fileErrno) + " [" + path + "]";
-				throw strError;
-#else
-				throw megaglest_runtime_error("[#5] error opening map file: " + path);
-#endif
 			}
-		}
 
+			fileLoaded = true;
+			mapFileLoaded = path;
+			hasChanged = false;
+		}
 
 		void MapPreview::saveToFile(const string &path) {
 #ifdef WIN32
@@ -985,6 +979,7 @@ namespace Shared {
 		// ==================== PRIVATE ====================
 
 		void MapPreview::resetHeights(int height) {
+			markAllEditTilesDirty();
 			for (int i = 0; i < w; ++i) {
 				for (int j = 0; j < h; ++j) {
 					cells[i][j].height = static_cast<float>(height);
@@ -1007,6 +1002,7 @@ namespace Shared {
 			if (smoothRecursions < 0) smoothRecursions = 0;
 			if (smoothRecursions > 1000) smoothRecursions = 1000;
 
+			markAllEditTilesDirty();
 			for (int i = 1; i < w - 1; ++i) {
 				for (int j = 1; j < h - 1; ++j) {
 					if (rand() % chanceDivider == 1) {
@@ -1024,10 +1020,104 @@ namespace Shared {
 
 		void MapPreview::applyNewHeight(float newHeight, int x, int y, int strength) {
 			cells[x][y].height = static_cast<float>(((cells[x][y].height * strength) + newHeight) / (strength + 1));
+			markEditTileDirty(x, y);
 			hasChanged = true;
 		}
 
+		string MapPreview::getEditTile(int tileX, int tileY) const {
+			int startX = tileX * editTileSize;
+			int startY = tileY * editTileSize;
+			int endX = min(startX + editTileSize, w);
+			int endY = min(startY + editTileSize, h);
+
+			string data;
+			data.reserve(editTileSize * editTileSize * (sizeof(float) + 3));
+			for (int j = startY; j < endY; ++j) {
+				for (int i = startX; i < endX; ++i) {
+					const Cell &cell = cells[i][j];
+					data.append(reinterpret_cast<const char *>(&cell.height), sizeof(float));
+					data += (char) cell.surface;
+					data += (char) cell.object;
+					data += (char) cell.resource;
+				}
+			}
+			return data;
+		}
+
+		void MapPreview::setEditTile(int tileX, int tileY, const string &data) {
+			int startX = tileX * editTileSize;
+			int startY = tileY * editTileSize;
+			int endX = min(startX + editTileSize, w);
+			int endY = min(startY + editTileSize, h);
+			if (data.size() != (size_t) ((endX - startX) * (endY - startY)) * (sizeof(float) + 3)) {
+				throw megaglest_runtime_error("Map tile data does not match the map size");
+			}
+
+			size_t pos = 0;
+			for (int j = startY; j < endY; ++j) {
+				for (int i = startX; i < endX; ++i) {
+					Cell &cell = cells[i][j];
+					memcpy(&cell.height, data.data() + pos, sizeof(float));
+					pos += sizeof(float);
+					cell.surface = (int8) data[pos++];
+					cell.object = (int8) data[pos++];
+					cell.resource = (int8) data[pos++];
+				}
+			}
+			markEditTileDirty(startX, startY);
+			hasChanged = true;
+		}
+
+		void MapPreview::getDirtyEditTiles(std::vector<int> &tiles) const {
+			tiles.clear();
+			if (allEditTilesDirty == true) {
+				int tileCount = getEditTilesW() * getEditTilesH();
+				for (int tile = 0; tile < tileCount; ++tile) {
+					tiles.push_back(tile);
+				}
+			} else {
+				tiles = dirtyEditTiles;
+			}
+		}
+
+		void MapPreview::clearDirtyEditTiles() {
+			allEditTilesDirty = false;
+			dirtyEditTileFlags.assign(getEditTilesW() * getEditTilesH(), false);
+			dirtyEditTiles.clear();
+		}
+
+		void MapPreview::markEditTileDirty(int x, int y) {
+			if (allEditTilesDirty == true) {
+				return;
+			}
+			int tile = (y / editTileSize) * getEditTilesW() + (x / editTileSize);
+			if (tile < 0 || tile >= (int) dirtyEditTileFlags.size()) {
+				markAllEditTilesDirty();
+			} else if (dirtyEditTileFlags[tile] == false) {
+				dirtyEditTileFlags[tile] = true;
+				dirtyEditTiles.push_back(tile);
+			}
+		}
+
+		void MapPreview::markAllEditTilesDirty() {
+			allEditTilesDirty = true;
+			dirtyEditTiles.clear();
+		}
+
 		bool MapPreview::loadMapInfo(string file, MapInfo *mapInfo, string i18nMaxMapPlayersTitle, string i18nMapSizeTitle, bool errorOnInvalidMap) {
+			MapIndexEntry entry;
+			if (MapInfoIndex::getEntry(file, entry) == true && entry.valid == true) {
+				mapInfo->size.x = entry.width;
+				mapInfo->size.y = entry.height;
+				mapInfo->players = entry.players;
+				mapInfo->hardMaxPlayers = mapInfo->players;
+
+				mapInfo->desc = i18nMaxMapPlayersTitle + ": " + intToStr(mapInfo->players) + "\n";
+				mapInfo->desc += i18nMapSizeTitle + ": " + intToStr(mapInfo->size.x) + " x " + intToStr(mapInfo->size.y);
+				return true;
+			}
+
+			// not indexed or invalid, read the header for the details
 			bool validMap = false;
 			FILE *f = NULL;
 			try {
@@ -1197,6 +1287,7 @@ namespace Shared {
 					}
 				}
 			}
+			MapInfoIndex::save();
 
 			return results;
 		}
@@ -134,7 +134,7 @@ namespace Shared {
 		}
 
 		bool BaseThread::getStarted() {
-			static string mutexOwnerId = CODE_AT_LINE;
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexStarted, mutexOwnerId);
 			mutexStarted->setOwnerId(mutexOwnerId);
 			bool retval = started;
@@ -146,7 +146,7 @@ namespace Shared {
 		void BaseThread::setStarted(bool value) {
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] uniqueID [%s]\n", __FILE__, __FUNCTION__, __LINE__, uniqueID.c_str());
 
-			static string mutexOwnerId = CODE_AT_LINE;
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexStarted, mutexOwnerId);
 			mutexStarted->setOwnerId(mutexOwnerId);
 			started = value;
@@ -173,7 +173,7 @@ namespace Shared {
 		}
 
 		void BaseThread::setThreadOwnerValid(bool value) {
-			static string mutexOwnerId = CODE_AT_LINE;
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexThreadOwnerValid, mutexOwnerId);
 			mutexThreadOwnerValid->setOwnerId(mutexOwnerId);
 			threadOwnerValid = value;
@@ -182,7 +182,7 @@ namespace Shared {
 
 		bool BaseThread::getThreadOwnerValid() {
 			//bool ret = false;
-			static string mutexOwnerId = CODE_AT_LINE;
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexThreadOwnerValid, mutexOwnerId);
 			//mutexThreadOwnerValid.setOwnerId(mutexOwnerId);
 			bool ret = threadOwnerValid;
@@ -198,7 +198,7 @@ namespace Shared {
 		void BaseThread::setQuitStatus(bool value) {
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] uniqueID [%s]\n", __FILE__, __FUNCTION__, __LINE__, uniqueID.c_str());
 
-			static string mutexOwnerId = CODE_AT_LINE;
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexQuit, mutexOwnerId);
 			mutexQuit->setOwnerId(mutexOwnerId);
 			quit = value;
@@ -209,7 +209,7 @@ namespace Shared {
 
 		bool BaseThread::getQuitStatus() {
 			//bool retval = false;
-			//static string mutexOwnerId = CODE_AT_LINE;
+			//static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexQuit, CODE_AT_LINE);
 			//mutexQuit.setOwnerId(mutexOwnerId);
 			bool retval = quit;
@@ -220,7 +220,7 @@ namespace Shared {
 
 		bool BaseThread::getHasBeginExecution() {
 			//bool retval = false;
-			static string mutexOwnerId = CODE_AT_LINE;
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexBeginExecution, mutexOwnerId);
 			//mutexBeginExecution.setOwnerId(mutexOwnerId);
 			bool retval = hasBeginExecution;
@@ -232,7 +232,7 @@ namespace Shared {
 		void BaseThread::setHasBeginExecution(bool value) {
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] uniqueID [%s]\n", __FILE__, __FUNCTION__, __LINE__, uniqueID.c_str());
 
-			static string mutexOwnerId = CODE_AT_LINE;
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexBeginExecution, mutexOwnerId);
 			mutexBeginExecution->setOwnerId(mutexOwnerId);
 			hasBeginExecution = value;
@@ -244,7 +244,7 @@ namespace Shared {
 		bool BaseThread::getRunningStatus() {
 			//bool retval = false;
 
-			static string mutexOwnerId = CODE_AT_LINE;
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexRunning, mutexOwnerId);
 			bool retval = running;
 			safeMutex.ReleaseLock();
@@ -257,7 +257,7 @@ namespace Shared {
 		}
 
 		void BaseThread::setRunningStatus(bool value) {
-			static string mutexOwnerId = CODE_AT_LINE;
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexRunning, mutexOwnerId);
 			mutexRunning->setOwnerId(mutexOwnerId);
 			running = value;
@@ -268,7 +268,7 @@ namespace Shared {
 		}
 
 		void BaseThread::setExecutingTask(bool value) {
-			static string mutexOwnerId = CODE_AT_LINE;
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexExecutingTask, mutexOwnerId);
 			mutexExecutingTask->setOwnerId(mutexOwnerId);
 			executingTask = value;
@@ -277,7 +277,7 @@ namespace Shared {
 
 		bool BaseThread::getExecutingTask() {
 			//bool retval = false;
-			static string mutexOwnerId = CODE_AT_LINE;
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexExecutingTask, mutexOwnerId);
 			bool retval = executingTask;
 			safeMutex.ReleaseLock();
@@ -287,7 +287,7 @@ namespace Shared {
 
 		bool BaseThread::getDeleteSelfOnExecutionDone() {
 			//bool retval = false;
-			static string mutexOwnerId = CODE_AT_LINE;
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexDeleteSelfOnExecutionDone, mutexOwnerId);
 			bool retval = deleteSelfOnExecutionDone;
 			safeMutex.ReleaseLock();
@@ -296,7 +296,7 @@ namespace Shared {
 		}
 
 		void BaseThread::setDeleteSelfOnExecutionDone(bool value) {
-			static string mutexOwnerId = CODE_AT_LINE;
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexDeleteSelfOnExecutionDone, mutexOwnerId);
 			mutexDeleteSelfOnExecutionDone->setOwnerId(mutexOwnerId);
 			deleteSelfOnExecutionDone = value;
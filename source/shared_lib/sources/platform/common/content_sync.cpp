@@ -0,0 +1,913 @@
+// ==============================================================
+//	This file is part of ZetaGlest Shared Library (www.zetaglest.org)
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 3 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "content_sync.h"
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include "platform_common.h"
+#include "platform_util.h"
+#include "checksum.h"
+#include "compression_utils.h"
+#include "conversion.h"
+#include "socket.h"
+#include "util.h"
+#include "leak_dumper.h"
+
+using namespace std;
+using namespace Shared::Util;
+using namespace Shared::Platform;
+
+namespace Shared {
+	namespace PlatformCommon {
+
+		enum ContentSyncMessageType {
+			csmt_ManifestRequest = 1,
+			csmt_Manifest = 2,
+			csmt_BlockRequest = 3,
+			csmt_Block = 4
+		};
+
+		static const unsigned char contentSyncProtocolVersion = 1;
+		// keeps a reply to one request at a few MB
+		static const int maxBlocksPerRequest = 64;
+		static const uint32 maxFrameSize = 16 * 1024 * 1024;
+		static const int blockCompressionLevel = 6;
+		static const int replyWaitMicroseconds = 30 * 1000000;
+		static const int serverPollMicroseconds = 100000;
+		// the client asks for the next blocks as soon as it wrote the
+		// last ones, a longer pause means it is gone
+		static const int clientIdleSeconds = 5;
+
+		static const char *mapFileExtensions[] = { ".zgm", ".gbm", ".mgm" };
+
+		const char *ContentSyncTarget::partialFileExtension = ".partial";
+
+		static FILE * openFile(const string &path, const char *mode) {
+#ifdef WIN32
+			std::wstring wideMode(mode, mode + strlen(mode));
+			return _wfopen(utf8_decode(path).c_str(), wideMode.c_str());
+#else
+			return fopen(path.c_str(), mode);
+#endif
+		}
+
+		static void writeUInt32(string &out, uint32 value) {
+			for (int i = 0; i < 4; ++i) {
+				out.push_back((char) ((value >> (i * 8)) & 0xFF));
+			}
+		}
+
+		static bool readUInt32(const string &in, size_t &pos, uint32 &value) {
+			if (pos + 4 > in.size()) {
+				return false;
+			}
+			value = 0;
+			for (int i = 0; i < 4; ++i) {
+				value |= ((uint32) (unsigned char) in[pos + i]) << (i * 8);
+			}
+			pos += 4;
+			return true;
+		}
+
+		static void writeString(string &out, const string &value) {
+			writeUInt32(out, (uint32) value.size());
+			out += value;
+		}
+
+		static bool readString(const string &in, size_t &pos, string &value) {
+			uint32 length = 0;
+			if (readUInt32(in, pos, length) == false || pos + length > in.size()) {
+				return false;
+			}
+			value = in.substr(pos, length);
+			pos += length;
+			return true;
+		}
+
+		// item names and file paths come from the other side and must
+		// stay inside the item folder
+		static bool isSafeName(const string &name) {
+			return name != "" && name != "." && name != ".." &&
+				name.find_first_of("/\\:") == string::npos;
+		}
+
+		static bool isSafePath(const string &path) {
+			if (path == "" || path.find_first_of("\\:") != string::npos) {
+				return false;
+			}
+			size_t start = 0;
+			while (start <= path.size()) {
+				size_t end = path.find('/', start);
+				if (end == string::npos) {
+					end = path.size();
+				}
+				if (isSafeName(path.substr(start, end - start)) == false) {
+					return false;
+				}
+				start = end + 1;
+			}
+			return true;
+		}
+
+		static bool sendFrame(Socket *socket, const string &payload) {
+			string frame;
+			writeUInt32(frame, (uint32) payload.size());
+			frame += payload;
+
+			int sent = 0;
+			while (sent < (int) frame.size()) {
+				int result = socket->send(&frame[sent], (int) frame.size() - sent);
+				if (result <= 0) {
+					return false;
+				}
+				sent += result;
+			}
+			return true;
+		}
+
+		static bool receiveBytes(Socket *socket, char *data, int size) {
+			int received = 0;
+			while (received < size) {
+				if (socket->hasDataToReadWithWait(replyWaitMicroseconds) == false) {
+					return false;
+				}
+				int result = socket->receive(&data[received], size - received, false);
+				if (result <= 0) {
+					return false;
+				}
+				received += result;
+			}
+			return true;
+		}
+
+		static bool receiveFrame(Socket *socket, string &payload) {
+			char header[4];
+			if (receiveBytes(socket, header, 4) == false) {
+				return false;
+			}
+			size_t pos = 0;
+			uint32 size = 0;
+			readUInt32(string(header, 4), pos, size);
+			if (size == 0 || size > maxFrameSize) {
+				return false;
+			}
+			payload.resize(size);
+			return receiveBytes(socket, &payload[0], (int) size);
+		}
+
+		// =====================================================
+		//	class ContentSyncFile
+		// =====================================================
+
+		ContentSyncFile::ContentSyncFile() {
+			size = 0;
+			crc = 0;
+		}
+
+		int ContentSyncFile::getBlockSize(int block) const {
+			int64 offset = (int64) block * ContentSyncManifest::blockSize;
+			return (int) min<int64>(ContentSyncManifest::blockSize, size - offset);
+		}
+
+		// =====================================================
+		//	class ContentSyncManifest
+		// =====================================================
+
+		static bool compareFilePaths(const ContentSyncFile &file1, const ContentSyncFile &file2) {
+			return file1.path < file2.path;
+		}
+
+		void ContentSyncManifest::buildFromFolder(const string &folder) {
+			files.clear();
+
+			string rootFolder = folder;
+			endPathWithSlash(rootFolder);
+			vector<std::pair<string, uint32> > fileList =
+				getFolderTreeContentsCheckSumListRecursively(rootFolder + "*", "", NULL);
+			for (unsigned int i = 0; i < fileList.size(); ++i) {
+				const string &filePath = fileList[i].first;
+				if (StartsWith(filePath, rootFolder) == false ||
+					EndsWith(filePath, ContentSyncTarget::partialFileExtension) == true) {
+					continue;
+				}
+
+				ContentSyncFile file;
+				file.path = filePath.substr(rootFolder.size());
+				replaceAll(file.path, "\\", "/");
+				file.crc = fileList[i].second;
+				file.blockCRCs = getFileBlockCRCs(filePath, &file.size);
+				files.push_back(file);
+			}
+			std::sort(files.begin(), files.end(), compareFilePaths);
+		}
+
+		void ContentSyncManifest::buildFromFile(const string &folder, const string &fileName) {
+			files.clear();
+
+			string filePath = folder;
+			endPathWithSlash(filePath);
+			filePath += fileName;
+
+			Checksum checksum;
+			checksum.addFile(filePath);
+
+			ContentSyncFile file;
+			file.path = fileName;
+			file.crc = checksum.getSum();
+			file.blockCRCs = getFileBlockCRCs(filePath, &file.size);
+			files.push_back(file);
+		}
+
+		const ContentSyncFile * ContentSyncManifest::findFile(const string &path) const {
+			for (unsigned int i = 0; i < files.size(); ++i) {
+				if (files[i].path == path) {
+					return &files[i];
+				}
+			}
+			return NULL;
+		}
+
+		int64 ContentSyncManifest::getTotalSize() const {
+			int64 totalSize = 0;
+			for (unsigned int i = 0; i < files.size(); ++i) {
+				totalSize += files[i].size;
+			}
+			return totalSize;
+		}
+
+		string ContentSyncManifest::toBytes() const {
+			string data;
+			writeUInt32(data, (uint32) files.size());
+			for (unsigned int i = 0; i < files.size(); ++i) {
+				const ContentSyncFile &file = files[i];
+				writeString(data, file.path);
+				writeUInt32(data, (uint32) (file.size & 0xFFFFFFFF));
+				writeUInt32(data, (uint32) (file.size >> 32));
+				writeUInt32(data, file.crc);
+				for (unsigned int j = 0; j < file.blockCRCs.size(); ++j) {
+					writeUInt32(data, file.blockCRCs[j]);
+				}
+			}
+			return data;
+		}
+
+		bool ContentSyncManifest::fromBytes(const string &data) {
+			files.clear();
+
+			size_t pos = 0;
+			uint32 fileCount = 0;
+			if (readUInt32(data, pos, fileCount) == false) {
+				return false;
+			}
+			for (uint32 i = 0; i < fileCount; ++i) {
+				ContentSyncFile file;
+				uint32 sizeLow = 0;
+				uint32 sizeHigh = 0;
+				if (readString(data, pos, file.path) == false ||
+					readUInt32(data, pos, sizeLow) == false ||
+					readUInt32(data, pos, sizeHigh) == false ||
+					readUInt32(data, pos, file.crc) == false ||
+					isSafePath(file.path) == false) {
+					files.clear();
+					return false;
+				}
+				file.size = ((int64) sizeHigh << 32) | sizeLow;
+
+				int64 blockCount = (file.size + blockSize - 1) / blockSize;
+				if (file.size < 0 || blockCount > (int64) (data.size() - pos) / 4) {
+					files.clear();
+					return false;
+				}
+				file.blockCRCs.resize((size_t) blockCount);
+				for (int64 j = 0; j < blockCount; ++j) {
+					readUInt32(data, pos, file.blockCRCs[(size_t) j]);
+				}
+				files.push_back(file);
+			}
+			return pos == data.size();
+		}
+
+		uint32 ContentSyncManifest::getBlockCRC(const void *data, int size) {
+			Checksum checksum;
+			checksum.addBytes(data, size);
+			return checksum.getSum();
+		}
+
+		vector<uint32> ContentSyncManifest::getFileBlockCRCs(const string &filePath, int64 *fileSize) {
+			vector<uint32> blockCRCs;
+			int64 size = 0;
+
+			FILE *file = openFile(filePath, "rb");
+			if (file != NULL) {
+				vector<char> buffer(blockSize);
+				for (;;) {
+					size_t readBytes = fread(&buffer[0], 1, blockSize, file);
+					if (readBytes == 0) {
+						break;
+					}
+					blockCRCs.push_back(getBlockCRC(&buffer[0], (int) readBytes));
+					size += readBytes;
+					if (readBytes < (size_t) blockSize) {
+						break;
+					}
+				}
+				fclose(file);
+			}
+
+			if (fileSize != NULL) {
+				*fileSize = size;
+			}
+			return blockCRCs;
+		}
+
+		// =====================================================
+		//	class ContentSyncSource
+		// =====================================================
+
+		ContentSyncSource::ContentSyncSource() : mutex(CODE_AT_LINE) {
+		}
+
+		void ContentSyncSource::addFolder(ContentSyncItemType type, const string &folder) {
+			if (folder == "") {
+				return;
+			}
+			string path = folder;
+			endPathWithSlash(path);
+			folders[type].push_back(path);
+		}
+
+		bool ContentSyncSource::findItem(ContentSyncItemType type, const string &name, string &itemFolder, string &fileName) const {
+			if (isSafeName(name) == false) {
+				return false;
+			}
+			for (unsigned int i = 0; i < folders[type].size(); ++i) {
+				const string &folder = folders[type][i];
+				if (type == csit_Map) {
+					for (unsigned int j = 0; j < sizeof(mapFileExtensions) / sizeof(mapFileExtensions[0]); ++j) {
+						if (fileExists(folder + name + mapFileExtensions[j]) == true) {
+							itemFolder = folder;
+							fileName = name + mapFileExtensions[j];
+							return true;
+						}
+					}
+				} else if (folderExists(folder + name) == true) {
+					itemFolder = folder + name + "/";
+					fileName = "";
+					return true;
+				}
+			}
+			return false;
+		}
+
+		const std::pair<string, ContentSyncManifest> * ContentSyncSource::getItem(ContentSyncItemType type, const string &name) {
+			if (type < 0 || type >= csit_Count) {
+				return NULL;
+			}
+
+			string cacheKey = intToStr(type) + ":" + name;
+			// entries are never removed, so the returned item stays valid
+			MutexSafeWrapper safeMutex(&mutex, CODE_AT_LINE);
+			std::map<string, std::pair<string, ContentSyncManifest> >::iterator iterFind = manifestCache.find(cacheKey);
+			if (iterFind == manifestCache.end()) {
+				string itemFolder;
+				string fileName;
+				if (findItem(type, name, itemFolder, fileName) == false) {
+					return NULL;
+				}
+
+				std::pair<string, ContentSyncManifest> &item = manifestCache[cacheKey];
+				item.first = itemFolder;
+				if (fileName != "") {
+					item.second.buildFromFile(itemFolder, fileName);
+				} else {
+					item.second.buildFromFolder(itemFolder);
+				}
+				return &item;
+			}
+			return &iterFind->second;
+		}
+
+		bool ContentSyncSource::getManifest(ContentSyncItemType type, const string &name, ContentSyncManifest &manifest) {
+			const std::pair<string, ContentSyncManifest> *item = getItem(type, name);
+			if (item == NULL) {
+				return false;
+			}
+			manifest = item->second;
+			return true;
+		}
+
+		bool ContentSyncSource::getBlock(ContentSyncItemType type, const string &name, const string &path, int block,
+			string &blockData, bool &compressed) {
+			const std::pair<string, ContentSyncManifest> *item = getItem(type, name);
+			if (item == NULL) {
+				return false;
+			}
+			const ContentSyncFile *file = item->second.findFile(path);
+			if (file == NULL || block < 0 || block >= file->getBlockCount()) {
+				return false;
+			}
+
+			string filePath = item->first + path;
+			FILE *in = openFile(filePath, "rb");
+			if (in == NULL) {
+				return false;
+			}
+			int size = file->getBlockSize(block);
+			vector<unsigned char> buffer(max(size, 1));
+			bool readOk = (fseek(in, (long) block * ContentSyncManifest::blockSize, SEEK_SET) == 0 &&
+				fread(&buffer[0], 1, size, in) == (size_t) size);
+			fclose(in);
+			if (readOk == false) {
+				return false;
+			}
+
+			compressed = false;
+			blockData.assign((const char *) &buffer[0], size);
+			try {
+				std::pair<unsigned char *, unsigned long> deflated =
+					Shared::CompressionUtil::compressMemoryToMemory(&buffer[0], size, blockCompressionLevel);
+				if (deflated.second < (unsigned long) size) {
+					blockData.assign((const char *) deflated.first, deflated.second);
+					compressed = true;
+				}
+				delete[] deflated.first;
+			} catch (const exception &) {
+				// data that does not compress can overflow the
+				// deflate buffer, it is sent as it is
+			}
+			return true;
+		}
+
+		// =====================================================
+		//	class ContentSyncTarget
+		// =====================================================
+
+		ContentSyncTarget::ContentSyncTarget(ContentSyncItemType type, const string &destFolder, const string &baseFolder) {
+			this->type = type;
+			this->destFolder = destFolder;
+			endPathWithSlash(this->destFolder);
+			this->baseFolder = baseFolder;
+			if (this->baseFolder != "") {
+				endPathWithSlash(this->baseFolder);
+			}
+		}
+
+		void ContentSyncTarget::setRemoteManifest(const ContentSyncManifest &manifest) {
+			remote = manifest;
+		}
+
+		string ContentSyncTarget::getPartialPath(const ContentSyncFile &file) const {
+			return destFolder + file.path + partialFileExtension;
+		}
+
+		void ContentSyncTarget::preparePartialFile(const ContentSyncFile &file, vector<int> &neededBlocks) {
+			string partialPath = getPartialPath(file);
+
+			int64 partialSize = -1;
+			vector<uint32> partialCRCs;
+			if (fileExists(partialPath) == true) {
+				partialCRCs = ContentSyncManifest::getFileBlockCRCs(partialPath, &partialSize);
+			}
+
+			if (partialSize != file.size) {
+				// a fresh partial file starts from the local copy,
+				// blocks that are not there yet are zero filled
+				string basePath = destFolder + file.path;
+				if (fileExists(basePath) == false && baseFolder != "") {
+					basePath = baseFolder + file.path;
+				}
+
+				createDirectoryPaths(extractDirectoryPathFromFile(partialPath));
+				FILE *out = openFile(partialPath, "wb");
+				if (out == NULL) {
+					throw megaglest_runtime_error("Can not open file: " + partialPath);
+				}
+				FILE *in = openFile(basePath, "rb");
+
+				partialCRCs.clear();
+				vector<char> buffer(ContentSyncManifest::blockSize);
+				for (int block = 0; block < file.getBlockCount(); ++block) {
+					int size = file.getBlockSize(block);
+					size_t readBytes = (in != NULL ? fread(&buffer[0], 1, size, in) : 0);
+					memset(buffer.data() + readBytes, 0, size - readBytes);
+					if (fwrite(&buffer[0], 1, size, out) != (size_t) size) {
+						fclose(out);
+						if (in != NULL) {
+							fclose(in);
+						}
+						throw megaglest_runtime_error("Can not write file: " + partialPath);
+					}
+					partialCRCs.push_back(ContentSyncManifest::getBlockCRC(&buffer[0], size));
+				}
+				fclose(out);
+				if (in != NULL) {
+					fclose(in);
+				}
+			}
+
+			for (int block = 0; block < file.getBlockCount(); ++block) {
+				if (block >= (int) partialCRCs.size() || partialCRCs[block] != file.blockCRCs[block]) {
+					neededBlocks.push_back(block);
+				}
+			}
+		}
+
+		std::map<int, vector<int> > ContentSyncTarget::getNeededBlocks() {
+			std::map<int, vector<int> > neededBlocks;
+			for (int i = 0; i < (int) remote.files.size(); ++i) {
+				const ContentSyncFile &file = remote.files[i];
+				if (fileExists(getPartialPath(file)) == false) {
+					int64 size = -1;
+					vector<uint32> blockCRCs = ContentSyncManifest::getFileBlockCRCs(destFolder + file.path, &size);
+					if (fileExists(destFolder + file.path) == true && size == file.size && blockCRCs == file.blockCRCs) {
+						continue;
+					}
+				}
+
+				vector<int> blocks;
+				preparePartialFile(file, blocks);
+				if (blocks.empty() == false) {
+					neededBlocks[i] = blocks;
+				}
+			}
+			return neededBlocks;
+		}
+
+		bool ContentSyncTarget::applyBlock(int fileIndex, int block, const string &blockData, bool compressed) {
+			if (fileIndex < 0 || fileIndex >= (int) remote.files.size()) {
+				return false;
+			}
+			const ContentSyncFile &file = remote.files[fileIndex];
+			if (block < 0 || block >= file.getBlockCount()) {
+				return false;
+			}
+			int size = file.getBlockSize(block);
+
+			string data = blockData;
+			if (compressed == true) {
+				if (blockData.empty() == true) {
+					return false;
+				}
+				try {
+					std::pair<unsigned char *, unsigned long> inflated =
+						Shared::CompressionUtil::extractMemoryToMemory((unsigned char *) blockData.data(), (unsigned long) blockData.size(), size);
+					data.assign((const char *) inflated.first, inflated.second);
+					delete[] inflated.first;
+				} catch (const exception &) {
+					return false;
+				}
+			}
+			if ((int) data.size() != size || ContentSyncManifest::getBlockCRC(data.data(), size) != file.blockCRCs[block]) {
+				return false;
+			}
+
+			FILE *out = openFile(getPartialPath(file), "r+b");
+			if (out == NULL) {
+				return false;
+			}
+			bool writeOk = (fseek(out, (long) block * ContentSyncManifest::blockSize, SEEK_SET) == 0 &&
+				fwrite(data.data(), 1, size, out) == (size_t) size);
+			fclose(out);
+			return writeOk;
+		}
+
+		bool ContentSyncTarget::finish(string &errorText) {
+			for (unsigned int i = 0; i < remote.files.size(); ++i) {
+				const ContentSyncFile &file = remote.files[i];
+				string partialPath = getPartialPath(file);
+				if (fileExists(partialPath) == false) {
+					continue;
+				}
+
+				int64 size = -1;
+				vector<uint32> blockCRCs = ContentSyncManifest::getFileBlockCRCs(partialPath, &size);
+				if (size != file.size || blockCRCs != file.blockCRCs) {
+					errorText = "incomplete file " + file.path;
+					return false;
+				}
+
+				string destPath = destFolder + file.path;
+				if (fileExists(destPath) == true) {
+					removeFile(destPath);
+				}
+				if (renameFile(partialPath, destPath) == false) {
+					errorText = "can not write " + destPath;
+					return false;
+				}
+
+				Checksum::removeFileFromCache(destPath);
+				Checksum checksum;
+				checksum.addFile(destPath);
+				if (checksum.getSum() != file.crc) {
+					errorText = "checksum mismatch for " + file.path;
+					return false;
+				}
+			}
+
+			// only a whole folder is mirrored, maps share theirs
+			if (type != csit_Map && folderExists(destFolder) == true) {
+				vector<string> localFiles = getFolderTreeContentsListRecursively(destFolder + "*", "");
+				for (unsigned int i = 0; i < localFiles.size(); ++i) {
+					string path = localFiles[i].substr(min(destFolder.size(), localFiles[i].size()));
+					replaceAll(path, "\\", "/");
+					if (remote.findFile(path) == NULL) {
+						removeFile(localFiles[i]);
+					}
+				}
+			}
+			return true;
+		}
+
+		// =====================================================
+		//	class ContentSyncClient
+		// =====================================================
+
+		ContentSyncClient::ContentSyncClient(const string &serverIp, int portNumber, ContentSyncProgressInterface *progress) {
+			this->serverIp = serverIp;
+			this->portNumber = portNumber;
+			this->progress = progress;
+			blocksReceived = 0;
+			bytesReceived = 0;
+		}
+
+		bool ContentSyncClient::syncItem(ContentSyncItemType type, const string &name,
+			const string &destFolder, const string &baseFolder, string &errorText) {
+			blocksReceived = 0;
+			bytesReceived = 0;
+			errorText = "";
+
+			try {
+				ClientSocket socket;
+				// a server without content sync must not hold up the
+				// fallback for the whole connect timeout of the OS
+				socket.setBlock(false);
+				socket.connect(Ip(serverIp), portNumber);
+				socket.setBlock(true);
+				if (socket.isConnected() == false) {
+					errorText = "can not connect to " + serverIp + ":" + intToStr(portNumber);
+					return false;
+				}
+
+				string request;
+				request.push_back((char) csmt_ManifestRequest);
+				request.push_back((char) contentSyncProtocolVersion);
+				request.push_back((char) type);
+				writeString(request, name);
+
+				string reply;
+				if (sendFrame(&socket, request) == false || receiveFrame(&socket, reply) == false ||
+					reply.size() < 2 || reply[0] != csmt_Manifest) {
+					errorText = "no reply from " + serverIp;
+					return false;
+				}
+				bytesReceived += reply.size();
+				if (reply[1] == 0) {
+					errorText = name + " is not shared by " + serverIp;
+					return false;
+				}
+
+				ContentSyncManifest manifest;
+				if (manifest.fromBytes(reply.substr(2)) == false) {
+					errorText = "invalid manifest for " + name;
+					return false;
+				}
+
+				ContentSyncTarget target(type, destFolder, baseFolder);
+				target.setRemoteManifest(manifest);
+				std::map<int, vector<int> > neededBlocks = target.getNeededBlocks();
+
+				int64 bytesTotal = 0;
+				for (std::map<int, vector<int> >::iterator iterMap = neededBlocks.begin(); iterMap != neededBlocks.end(); ++iterMap) {
+					const ContentSyncFile &file = manifest.files[iterMap->first];
+					for (unsigned int i = 0; i < iterMap->second.size(); ++i) {
+						bytesTotal += file.getBlockSize(iterMap->second[i]);
+					}
+				}
+				if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "Content sync of [%s]: %d files, " MG_I64_SPECIFIER " of " MG_I64_SPECIFIER " bytes to fetch\n", name.c_str(), (int) neededBlocks.size(), bytesTotal, manifest.getTotalSize());
+
+				int64 bytesNow = 0;
+				for (std::map<int, vector<int> >::iterator iterMap = neededBlocks.begin(); iterMap != neededBlocks.end(); ++iterMap) {
+					const ContentSyncFile &file = manifest.files[iterMap->first];
+					const vector<int> &blocks = iterMap->second;
+					for (unsigned int start = 0; start < blocks.size(); start += maxBlocksPerRequest) {
+						unsigned int count = min<unsigned int>(maxBlocksPerRequest, (unsigned int) blocks.size() - start);
+
+						request = "";
+						request.push_back((char) csmt_BlockRequest);
+						request.push_back((char) type);
+						writeString(request, name);
+						writeString(request, file.path);
+						writeUInt32(request, count);
+						for (unsigned int i = 0; i < count; ++i) {
+							writeUInt32(request, blocks[start + i]);
+						}
+						if (sendFrame(&socket, request) == false) {
+							errorText = "connection to " + serverIp + " lost";
+							return false;
+						}
+
+						for (unsigned int i = 0; i < count; ++i) {
+							int block = blocks[start + i];
+							size_t pos = 1;
+							uint32 replyBlock = 0;
+							if (receiveFrame(&socket, reply) == false || reply[0] != csmt_Block ||
+								readUInt32(reply, pos, replyBlock) == false || (int) replyBlock != block ||
+								pos >= reply.size() ||
+								target.applyBlock(iterMap->first, block, reply.substr(pos + 1), reply[pos] != 0) == false) {
+								errorText = "transfer of " + file.path + " failed";
+								return false;
+							}
+							blocksReceived++;
+							bytesReceived += reply.size();
+							bytesNow += file.getBlockSize(block);
+
+							if (progress != NULL && progress->ContentSync_Progress(name, bytesNow, bytesTotal) == false) {
+								errorText = "cancelled";
+								return false;
+							}
+						}
+					}
+				}
+
+				return target.finish(errorText);
+			} catch (const exception &ex) {
+				SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] Error [%s]\n", __FILE__, __FUNCTION__, __LINE__, ex.what());
+				errorText = ex.what();
+			}
+			return false;
+		}
+
+		// =====================================================
+		//	class ContentSyncSessionThread
+		// =====================================================
+
+		ContentSyncSessionThread::ContentSyncSessionThread(Socket *socket, ContentSyncSource *source) : BaseThread() {
+			uniqueID = "ContentSyncSessionThread";
+			this->socket = socket;
+			this->source = source;
+		}
+
+		ContentSyncSessionThread::~ContentSyncSessionThread() {
+			delete socket;
+			socket = NULL;
+		}
+
+		void ContentSyncSessionThread::execute() {
+			RunningStatusSafeWrapper runningStatus(this);
+			try {
+				time_t lastRequestTime = time(NULL);
+				while (getQuitStatus() == false) {
+					if (socket->hasDataToReadWithWait(serverPollMicroseconds) == false) {
+						if (difftime(time(NULL), lastRequestTime) > clientIdleSeconds) {
+							break;
+						}
+						continue;
+					}
+
+					string request;
+					if (receiveFrame(socket, request) == false) {
+						break;
+					}
+					lastRequestTime = time(NULL);
+
+					size_t pos = 0;
+					string name;
+					if (request[0] == csmt_ManifestRequest) {
+						pos = 3;
+						if (request.size() < pos || readString(request, pos, name) == false) {
+							break;
+						}
+						ContentSyncItemType type = (ContentSyncItemType) (unsigned char) request[2];
+						ContentSyncManifest manifest;
+						bool found = ((unsigned char) request[1] == contentSyncProtocolVersion &&
+							source->getManifest(type, name, manifest) == true);
+
+						string reply;
+						reply.push_back((char) csmt_Manifest);
+						reply.push_back(found == true ? 1 : 0);
+						if (found == true) {
+							reply += manifest.toBytes();
+						}
+						if (sendFrame(socket, reply) == false) {
+							break;
+						}
+					} else if (request[0] == csmt_BlockRequest) {
+						string path;
+						uint32 count = 0;
+						pos = 2;
+						if (request.size() < pos || readString(request, pos, name) == false ||
+							readString(request, pos, path) == false || readUInt32(request, pos, count) == false ||
+							count > (uint32) maxBlocksPerRequest) {
+							break;
+						}
+						ContentSyncItemType type = (ContentSyncItemType) (unsigned char) request[1];
+
+						bool replyOk = true;
+						for (uint32 i = 0; i < count && replyOk == true; ++i) {
+							uint32 block = 0;
+							string blockData;
+							bool compressed = false;
+							replyOk = (readUInt32(request, pos, block) == true &&
+								source->getBlock(type, name, path, (int) block, blockData, compressed) == true);
+							if (replyOk == true) {
+								string reply;
+								reply.push_back((char) csmt_Block);
+								writeUInt32(reply, block);
+								reply.push_back(compressed == true ? 1 : 0);
+								reply += blockData;
+								replyOk = sendFrame(socket, reply);
+							}
+						}
+						if (replyOk == false) {
+							break;
+						}
+					} else {
+						break;
+					}
+				}
+			} catch (const exception &ex) {
+				SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] Error [%s]\n", __FILE__, __FUNCTION__, __LINE__, ex.what());
+			}
+		}
+
+		// =====================================================
+		//	class ContentSyncServerThread
+		// =====================================================
+
+		ContentSyncServerThread::ContentSyncServerThread(int portNumber, FTPClientValidationInterface *clientValidator) : BaseThread() {
+			uniqueID = "ContentSyncServerThread";
+			this->portNumber = portNumber;
+			this->clientValidator = clientValidator;
+		}
+
+		void ContentSyncServerThread::addFolder(ContentSyncItemType type, const string &folder) {
+			source.addFolder(type, folder);
+		}
+
+		void ContentSyncServerThread::cleanupSessions(bool stopAll) {
+			for (int i = (int) sessions.size() - 1; i >= 0; --i) {
+				ContentSyncSessionThread *session = sessions[i];
+				if (stopAll == true) {
+					session->signalQuit();
+				} else if (session->getHasBeginExecution() == false || session->getRunningStatus() == true) {
+					continue;
+				}
+				// the Thread destructor joins the finished thread
+				session->shutdownAndWait();
+				delete session;
+				sessions.erase(sessions.begin() + i);
+			}
+		}
+
+		void ContentSyncServerThread::execute() {
+			RunningStatusSafeWrapper runningStatus(this);
+			if (getQuitStatus() == true) {
+				return;
+			}
+
+			try {
+				ServerSocket serverSocket(true);
+				serverSocket.bind(portNumber);
+				serverSocket.listen(maxSessions);
+				if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "Content sync server listening on port %d\n", portNumber);
+
+				while (getQuitStatus() == false) {
+					cleanupSessions(false);
+					if (serverSocket.hasDataToReadWithWait(serverPollMicroseconds) == false) {
+						continue;
+					}
+					Socket *socket = serverSocket.accept(false);
+					if (socket == NULL) {
+						continue;
+					}
+
+					uint32 clientIp = socket->getConnectedIPAddress(socket->getIpAddress());
+					if (clientValidator == NULL || clientValidator->isValidClientType(clientIp) == 0 ||
+						(int) sessions.size() >= maxSessions) {
+						if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "Content sync refused client [%s], %d sessions\n", socket->getIpAddress().c_str(), (int) sessions.size());
+						delete socket;
+						continue;
+					}
+
+					ContentSyncSessionThread *session = new ContentSyncSessionThread(socket, &source);
+					sessions.push_back(session);
+					session->start();
+				}
+			} catch (const exception &ex) {
+				SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] Error [%s]\n", __FILE__, __FUNCTION__, __LINE__, ex.what());
+			}
+			cleanupSessions(true);
+		}
+
+	}
+}//end namespace
@@ -1978,6 +1978,23 @@ namespace Shared {
 			return 0;
 			}
 
+		time_t getFileModTime(string filename) {
+#ifdef WIN32
+#if defined(__MINGW32__)
+			struct _stat stbuf;
+#else
+			struct _stat64i32 stbuf;
+#endif
+			if (_wstat(utf8_decode(filename).c_str(), &stbuf) != -1) {
+#else
+			struct stat stbuf;
+			if (stat(filename.c_str(), &stbuf) != -1) {
+#endif
+				return stbuf.st_mtime;
+			}
+			return 0;
+		}
+
 		string executable_path(const string &exeName, bool includeExeNameInPath) {
 			string value = "";
 #ifdef _WIN32
@@ -14,6 +14,7 @@
 #include "util.h"
 #include "platform_common.h"
 #include <algorithm>
+#include <cstring>
 #include "conversion.h"
 #include "platform_util.h"
 #include "cache_manager.h"
@@ -66,7 +67,7 @@ namespace Shared {
 		}
 
 		void FileCRCPreCacheThread::setPauseForGame(bool pauseForGame) {
-			static string mutexOwnerId = CODE_AT_LINE;
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexPauseForGame, mutexOwnerId);
 			this->pauseForGame = pauseForGame;
 
@@ -79,7 +80,7 @@ namespace Shared {
 		}
 
 		bool FileCRCPreCacheThread::getPauseForGame() {
-			static string mutexOwnerId = CODE_AT_LINE;
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexPauseForGame, mutexOwnerId);
 			return this->pauseForGame;
 		}
@@ -179,10 +180,10 @@ namespace Shared {
 										new FileCRCPreCacheThread(techDataPaths,
 											workerTechList,
 											this->processTechCB);
-									static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+									static const char *mutexOwnerId = CODE_AT_LINE;
 									workerThread->setUniqueID(mutexOwnerId);
 									workerThread->setPauseForGame(this->getPauseForGame());
-									static string mutexOwnerId2 = CODE_AT_LINE;
+									static const char *mutexOwnerId2 = CODE_AT_LINE;
 									MutexSafeWrapper safeMutexPause(mutexPauseForGame, mutexOwnerId2);
 									preCacheWorkerThreadList.push_back(workerThread);
 									safeMutexPause.ReleaseLock();
@@ -226,7 +227,7 @@ namespace Shared {
 											} else if (workerThread->getRunningStatus() == false) {
 												sleep(25);
 
-												static string mutexOwnerId2 = CODE_AT_LINE;
+												static const char *mutexOwnerId2 = CODE_AT_LINE;
 												MutexSafeWrapper safeMutexPause(mutexPauseForGame, mutexOwnerId2);
 
 												delete workerThread;
@@ -400,13 +401,13 @@ namespace Shared {
 
 			setTaskSignalled(false);
 
-			string mutexOwnerId = CODE_AT_LINE;
+			const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexLastExecuteTimestamp, mutexOwnerId);
 			mutexLastExecuteTimestamp->setOwnerId(mutexOwnerId);
 			lastExecuteTimestamp = time(NULL);
 
 			if (this->wantSetupAndShutdown == true) {
-				string mutexOwnerId1 = CODE_AT_LINE;
+				const char *mutexOwnerId1 = CODE_AT_LINE;
 				MutexSafeWrapper safeMutex1(mutexSimpleTaskInterfaceValid, mutexOwnerId1);
 				if (this->simpleTaskInterfaceValid == true) {
 					safeMutex1.ReleaseLock();
@@ -448,7 +449,7 @@ namespace Shared {
 					this->overrideShutdownTask = NULL;
 				} else if (this->simpleTaskInterface != NULL) {
 					//printf("~SimpleTaskThread LINE: %d this = %p\n",__LINE__,this);
-					string mutexOwnerId1 = CODE_AT_LINE;
+					const char *mutexOwnerId1 = CODE_AT_LINE;
 					MutexSafeWrapper safeMutex1(mutexSimpleTaskInterfaceValid, mutexOwnerId1);
 					//printf("~SimpleTaskThread LINE: %d this = %p\n",__LINE__,this);
 					if (this->simpleTaskInterfaceValid == true) {
@@ -469,7 +470,7 @@ namespace Shared {
 		}
 
 		bool SimpleTaskThread::isThreadExecutionLagging() {
-			string mutexOwnerId = CODE_AT_LINE;
+			const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexLastExecuteTimestamp, mutexOwnerId);
 			mutexLastExecuteTimestamp->setOwnerId(mutexOwnerId);
 			bool result = (difftime(time(NULL), lastExecuteTimestamp) >= 5.0);
@@ -490,13 +491,13 @@ namespace Shared {
 		}
 
 		bool SimpleTaskThread::getSimpleTaskInterfaceValid() {
-			string mutexOwnerId1 = CODE_AT_LINE;
+			const char *mutexOwnerId1 = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex1(mutexSimpleTaskInterfaceValid, mutexOwnerId1);
 
 			return this->simpleTaskInterfaceValid;
 		}
 		void SimpleTaskThread::setSimpleTaskInterfaceValid(bool value) {
-			string mutexOwnerId1 = CODE_AT_LINE;
+			const char *mutexOwnerId1 = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex1(mutexSimpleTaskInterfaceValid, mutexOwnerId1);
 
 			this->simpleTaskInterfaceValid = value;
@@ -520,7 +521,7 @@ namespace Shared {
 
 						unsigned int idx = 0;
 						for (; this->simpleTaskInterface != NULL;) {
-							string mutexOwnerId1 = CODE_AT_LINE;
+							const char *mutexOwnerId1 = CODE_AT_LINE;
 							MutexSafeWrapper safeMutex1(mutexSimpleTaskInterfaceValid, mutexOwnerId1);
 							if (this->simpleTaskInterfaceValid == false) {
 								break;
@@ -548,7 +549,7 @@ namespace Shared {
 									if (getQuitStatus() == true) {
 										break;
 									}
-									string mutexOwnerId = CODE_AT_LINE;
+									const char *mutexOwnerId = CODE_AT_LINE;
 									MutexSafeWrapper safeMutex(mutexLastExecuteTimestamp, mutexOwnerId);
 									mutexLastExecuteTimestamp->setOwnerId(mutexOwnerId);
 									lastExecuteTimestamp = time(NULL);
@@ -598,7 +599,7 @@ namespace Shared {
 		}
 
 		void SimpleTaskThread::setTaskSignalled(bool value) {
-			string mutexOwnerId = CODE_AT_LINE;
+			const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexTaskSignaller, mutexOwnerId);
 			mutexTaskSignaller->setOwnerId(mutexOwnerId);
 			taskSignalled = value;
@@ -606,7 +607,7 @@ namespace Shared {
 		}
 
 		bool SimpleTaskThread::getTaskSignalled() {
-			string mutexOwnerId = CODE_AT_LINE;
+			const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexTaskSignaller, mutexOwnerId);
 			mutexTaskSignaller->setOwnerId(mutexOwnerId);
 			bool retval = taskSignalled;
@@ -617,15 +618,232 @@ namespace Shared {
 
 		// -------------------------------------------------
 
-		LogFileThread::LogFileThread() : BaseThread(), mutexLogList(new Mutex(CODE_AT_LINE)) {
+		// =====================================================
+		//	class ParallelRowsThread
+		// =====================================================
+
+		ParallelRowsThread::ParallelRowsThread(ParallelRowsCallbackInterface *callback,
+			int firstRow, int endRow) : BaseThread() {
+			this->callback = callback;
+			this->firstRow = firstRow;
+			this->endRow = endRow;
+		}
+
+		void ParallelRowsThread::execute() {
+			{
+				RunningStatusSafeWrapper runningStatus(this);
+				try {
+					callback->processRows(firstRow, endRow);
+				} catch (const exception &ex) {
+					SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] Error [%s]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, ex.what());
+					errorText = ex.what();
+				} catch (...) {
+					SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] UNKNOWN Error\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__);
+					errorText = "Unknown error processing rows";
+				}
+			}
+		}
+
+		int ParallelRowsThread::getWorkerCount(int rowCount, int minRowsPerWorker, int maxWorkers) {
+			int workerCount = (maxWorkers > 0 ? maxWorkers : SDL_GetCPUCount());
+			if (minRowsPerWorker > 0) {
+				workerCount = min(workerCount, rowCount / minRowsPerWorker);
+			}
+			return max(workerCount, 1);
+		}
+
+		void ParallelRowsThread::run(ParallelRowsCallbackInterface *callback, int rowCount, int workerCount) {
+			workerCount = min(workerCount, rowCount);
+			if (workerCount <= 1) {
+				if (rowCount > 0) {
+					callback->processRows(0, rowCount);
+				}
+				return;
+			}
+
+			vector<ParallelRowsThread *> workers;
+			string errorText = "";
+			for (int index = 1; index < workerCount; ++index) {
+				int firstRow = rowCount * index / workerCount;
+				int endRow = rowCount * (index + 1) / workerCount;
+
+				ParallelRowsThread *worker = new ParallelRowsThread(callback, firstRow, endRow);
+				static const char *mutexOwnerId = CODE_AT_LINE;
+				worker->setUniqueID(mutexOwnerId);
+				try {
+					worker->start();
+					workers.push_back(worker);
+				} catch (const exception &ex) {
+					// no thread to spare, this band is done here instead
+					SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] Error [%s]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, ex.what());
+					delete worker;
+					try {
+						callback->processRows(firstRow, endRow);
+					} catch (const exception &ex) {
+						if (errorText.empty() == true) {
+							errorText = ex.what();
+						}
+					}
+				}
+			}
+
+			try {
+				callback->processRows(0, rowCount / workerCount);
+			} catch (const exception &ex) {
+				if (errorText.empty() == true) {
+					errorText = ex.what();
+				}
+			}
+
+			for (unsigned int index = 0; index < workers.size(); ++index) {
+				workers[index]->join();
+				if (errorText.empty() == true) {
+					errorText = workers[index]->getErrorText();
+				}
+				delete workers[index];
+			}
+			workers.clear();
+
+			if (errorText.empty() == false) {
+				throw megaglest_runtime_error(errorText);
+			}
+		}
+
+		// -------------------------------------------------
+
+		// =====================================================
+		//	class LogEntryRing
+		// =====================================================
+
+		LogEntryRing::LogEntryRing(const void *owner, std::size_t capacity) :
+			owner(owner), head(0), tail(0), pendingSequence(noPendingSequence),
+			orphaned(false), closed(false), refCount(2) {
+			// a power of two keeps the offsets valid when the counters wrap
+			this->capacity = 64;
+			while (this->capacity < capacity) {
+				this->capacity *= 2;
+			}
+			buffer = new char[this->capacity];
+		}
+
+		LogEntryRing::~LogEntryRing() {
+			delete[] buffer;
+			buffer = NULL;
+		}
+
+		std::size_t LogEntryRing::getRecordSize(std::size_t length) {
+			return (sizeof(Header) + length + 7) & ~((std::size_t) 7);
+		}
+
+		void LogEntryRing::release() {
+			if (--refCount == 0) {
+				delete this;
+			}
+		}
+
+		bool LogEntryRing::push(uint64 sequence, SystemFlags::DebugType type, time_t entryDateTime,
+			const char *text, std::size_t length) {
+			const std::size_t recordSize = getRecordSize(length);
+			if (recordSize > capacity / 2) {
+				return false;
+			}
+
+			std::size_t writePos = head.load(std::memory_order_relaxed);
+			std::size_t readPos = tail.load(std::memory_order_acquire);
+			std::size_t offset = writePos & (capacity - 1);
+			// records never wrap, the rest of the buffer is skipped instead
+			std::size_t padding = (capacity - offset < recordSize ? capacity - offset : 0);
+			if (capacity - (writePos - readPos) < padding + recordSize) {
+				return false;
+			}
+
+			Header header;
+			if (padding >= sizeof(Header)) {
+				header.length = wrapMarker;
+				memcpy(&buffer[offset], &header, sizeof(Header));
+			}
+			offset = (writePos + padding) & (capacity - 1);
+
+			header.sequence = sequence;
+			header.entryDateTime = entryDateTime;
+			header.type = type;
+			header.length = (uint32) length;
+			memcpy(&buffer[offset], &header, sizeof(Header));
+			memcpy(&buffer[offset + sizeof(Header)], text, length);
+
+			head.store(writePos + padding + recordSize, std::memory_order_release);
+			return true;
+		}
+
+		bool LogEntryRing::pop(LogFileEntry &entry) {
+			std::size_t readPos = tail.load(std::memory_order_relaxed);
+			for (;;) {
+				std::size_t writePos = head.load(std::memory_order_acquire);
+				if (readPos == writePos) {
+					return false;
+				}
+
+				std::size_t offset = readPos & (capacity - 1);
+				if (capacity - offset < sizeof(Header)) {
+					readPos += capacity - offset;
+					continue;
+				}
+				Header header;
+				memcpy(&header, &buffer[offset], sizeof(Header));
+				if (header.length == wrapMarker) {
+					readPos += capacity - offset;
+					continue;
+				}
+
+				entry.sequence = header.sequence;
+				entry.type = (SystemFlags::DebugType) header.type;
+				entry.entryDateTime = (time_t) header.entryDateTime;
+				entry.entry.assign(&buffer[offset + sizeof(Header)], header.length);
+
+				tail.store(readPos + getRecordSize(header.length), std::memory_order_release);
+				return true;
+			}
+		}
+
+		// -------------------------------------------------
+
+		// The ring of the calling thread, handed back to its log thread when
+		// the calling thread exits
+		class LogEntryRingHolder {
+		public:
+			LogEntryRing *ring;
+			bool isLogThread;
+
+			LogEntryRingHolder() : ring(NULL), isLogThread(false) {
+			}
+			~LogEntryRingHolder() {
+				if (ring != NULL) {
+					ring->setOrphaned();
+					ring->release();
+					ring = NULL;
+				}
+			}
+		};
+
+		static thread_local LogEntryRingHolder threadLogEntryRing;
+
+		LogFileThread::LogFileThread() : BaseThread(), mutexLogList(new Mutex(CODE_AT_LINE_X(mutexLogList))),
+			nextSequence(0), queuedEntryCount(0) {
 			uniqueID = "LogFileThread";
 			logList.clear();
-			lastSaveToDisk = time(NULL);
-			static string mutexOwnerId = CODE_AT_LINE;
+			for (unsigned int i = 0; i <= SystemFlags::debugError; ++i) {
+				droppedEntryCount[i] = 0;
+			}
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			mutexLogList->setOwnerId(mutexOwnerId);
 		}
 
 		LogFileThread::~LogFileThread() {
+			for (unsigned int i = 0; i < logRings.size(); ++i) {
+				logRings[i]->setClosed();
+				logRings[i]->release();
+			}
+			logRings.clear();
 
 			delete mutexLogList;
 			mutexLogList = NULL;
@@ -633,30 +851,56 @@ namespace Shared {
 			if (SystemFlags::VERBOSE_MODE_ENABLED) printf("#1 In [%s::%s Line: %d] LogFile thread is deleting\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__);
 		}
 
-		void LogFileThread::addLogEntry(SystemFlags::DebugType type, string logEntry) {
-			static string mutexOwnerId = CODE_AT_LINE;
-			MutexSafeWrapper safeMutex(mutexLogList, mutexOwnerId);
-			mutexLogList->setOwnerId(mutexOwnerId);
-			LogFileEntry entry;
-			entry.type = type;
-			entry.entry = logEntry;
-			entry.entryDateTime = time(NULL);
-			logList.push_back(entry);
-
-			//if(logList.size() >= 750000) {
-			//    saveToDisk(false,true);
-			//}
+		LogEntryRing *LogFileThread::getThreadLogEntryRing() {
+			LogEntryRing *ring = threadLogEntryRing.ring;
+			if (ring != NULL && (ring->isClosed() == true || ring->getOwner() != this)) {
+				ring->release();
+				ring = NULL;
+				threadLogEntryRing.ring = NULL;
+			}
+			if (ring == NULL) {
+				ring = new LogEntryRing(this, threadLogBufferSize);
+
+				static const char *mutexOwnerId = CODE_AT_LINE;
+				MutexSafeWrapper safeMutex(mutexLogList, mutexOwnerId);
+				mutexLogList->setOwnerId(mutexOwnerId);
+				logRings.push_back(ring);
+				safeMutex.ReleaseLock();
+
+				threadLogEntryRing.ring = ring;
+			}
+			return ring;
 		}
 
-		bool LogFileThread::checkSaveCurrentLogBufferToDisk() {
-			bool ret = false;
-			if (difftime(time(NULL), lastSaveToDisk) >= 5.0 ||
-				(difftime(time(NULL), lastSaveToDisk) >= 2.0 &&
-					LogFileThread::getLogEntryBufferCount() >= 1000000)) {
-				lastSaveToDisk = time(NULL);
-				ret = true;
+		void LogFileThread::addLogEntry(SystemFlags::DebugType type, const string &logEntry) {
+			addLogEntry(type, logEntry.c_str(), logEntry.size());
+		}
+
+		void LogFileThread::addLogEntry(SystemFlags::DebugType type, const char *logEntry, std::size_t length) {
+			LogEntryRing *ring = getThreadLogEntryRing();
+
+			// Entries are ordered by sequence across threads. The pending mark
+			// is published before the sequence is taken so the log thread never
+			// writes past an entry that is still being copied into a ring.
+			ring->setPendingSequence(nextSequence.load());
+			uint64 sequence = nextSequence.fetch_add(1);
+			time_t entryDateTime = time(NULL);
+
+			bool added = ring->push(sequence, type, entryDateTime, logEntry, length);
+			// a full ring waits a little for the log thread before giving up
+			for (int attempt = 0; added == false && attempt < 50 &&
+				threadLogEntryRing.isLogThread == false &&
+				getRunningStatus() == true; ++attempt) {
+				sleep(1);
+				added = ring->push(sequence, type, entryDateTime, logEntry, length);
+			}
+			ring->setPendingSequence(LogEntryRing::noPendingSequence);
+
+			if (added == true) {
+				queuedEntryCount++;
+			} else {
+				droppedEntryCount[type]++;
 			}
-			return ret;
 		}
 
 		void LogFileThread::execute() {
@@ -677,11 +921,9 @@ namespace Shared {
 
 				try {
 					ExecutingTaskSafeWrapper safeExecutingTaskMutex(this);
+					threadLogEntryRing.isLogThread = true;
 					for (; this->getQuitStatus() == false;) {
-						while (this->getQuitStatus() == false &&
-							checkSaveCurrentLogBufferToDisk() == true) {
-							saveToDisk(false, false);
-						}
+						saveToDisk(false);
 						if (this->getQuitStatus() == false) {
 							sleep(25);
 						}
@@ -689,7 +931,7 @@ namespace Shared {
 
 					// Ensure remaining entryies are logged to disk on shutdown
 					if (SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__);
-					saveToDisk(true, false);
+					saveToDisk(true);
 					if (SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__);
 				} catch (const exception &ex) {
 					if (SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] Error [%s]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, ex.what());
@@ -712,12 +954,7 @@ namespace Shared {
 		}
 
 		std::size_t LogFileThread::getLogEntryBufferCount() {
-			static string mutexOwnerId = CODE_AT_LINE;
-			MutexSafeWrapper safeMutex(mutexLogList, mutexOwnerId);
-			mutexLogList->setOwnerId(mutexOwnerId);
-			std::size_t logCount = logList.size();
-			safeMutex.ReleaseLock();
-			return logCount;
+			return queuedEntryCount.load();
 		}
 
 		bool LogFileThread::canShutdown(bool deleteSelfIfShutdownDelayed) {
@@ -731,43 +968,62 @@ namespace Shared {
 			return ret;
 		}
 
-		void LogFileThread::saveToDisk(bool forceSaveAll, bool logListAlreadyLocked) {
-			static string mutexOwnerId = CODE_AT_LINE;
-			MutexSafeWrapper safeMutex(NULL, mutexOwnerId);
-			if (logListAlreadyLocked == false) {
-				safeMutex.setMutex(mutexLogList);
-				mutexLogList->setOwnerId(mutexOwnerId);
+		static bool compareLogFileEntrySequence(const LogFileEntry &a, const LogFileEntry &b) {
+			return a.sequence < b.sequence;
+		}
+
+		void LogFileThread::saveToDisk(bool forceSaveAll) {
+			// Every entry sequenced below the watermark is either in a ring
+			// already or still being added by a thread that marked it pending
+			uint64 watermark = nextSequence.load();
+
+			static const char *mutexOwnerId = CODE_AT_LINE;
+			MutexSafeWrapper safeMutex(mutexLogList, mutexOwnerId);
+			mutexLogList->setOwnerId(mutexOwnerId);
+			for (unsigned int i = 0; i < logRings.size(); ++i) {
+				watermark = min(watermark, logRings[i]->getPendingSequence());
+			}
+			std::size_t previousCount = logList.size();
+			for (unsigned int i = 0; i < logRings.size();) {
+				LogEntryRing *ring = logRings[i];
+				bool orphaned = ring->isOrphaned();
+				LogFileEntry entry;
+				while (ring->pop(entry) == true) {
+					logList.push_back(entry);
+				}
+				if (orphaned == true && ring->isEmpty() == true) {
+					logRings.erase(logRings.begin() + i);
+					ring->release();
+				} else {
+					++i;
+				}
+			}
+			safeMutex.ReleaseLock();
+
+			if (logList.size() != previousCount) {
+				std::sort(logList.begin(), logList.end(), compareLogFileEntrySequence);
 			}
 
-			std::size_t logCount = logList.size();
+			std::size_t logCount = 0;
+			for (; logCount < logList.size(); ++logCount) {
+				LogFileEntry &entry = logList[logCount];
+				if (forceSaveAll == false && entry.sequence >= watermark) {
+					break;
+				}
+				SystemFlags::logDebugEntry(entry.type, entry.entry, entry.entryDateTime);
+			}
 			if (logCount > 0) {
-				vector<LogFileEntry> tempLogList = logList;
-				safeMutex.ReleaseLock(true);
-
-				logCount = tempLogList.size();
-				//if(forceSaveAll == false) {
-				//    logCount = min(logCount,(std::size_t)2000000);
-				//}
-
-				if (logCount > 0) {
-					for (unsigned int i = 0; i < logCount; ++i) {
-						LogFileEntry &entry = tempLogList[i];
-						SystemFlags::logDebugEntry(entry.type, entry.entry, entry.entryDateTime);
-					}
+				logList.erase(logList.begin(), logList.begin() + logCount);
+				queuedEntryCount -= logCount;
+			}
 
-					safeMutex.Lock();
-					if (logList.size() > 0) {
-						if (logList.size() < logCount) {
-							char szBuf[8096] = "";
-							snprintf(szBuf, 8096, "logList.size() <= logCount [%lld][%lld]", (long long int)logList.size(), (long long int)logCount);
-							throw megaglest_runtime_error(szBuf);
-						}
-						logList.erase(logList.begin(), logList.begin() + logCount);
-					}
-					safeMutex.ReleaseLock();
+			for (unsigned int i = 0; i <= SystemFlags::debugError; ++i) {
+				unsigned int dropped = droppedEntryCount[i].exchange(0);
+				if (dropped > 0) {
+					char szBuf[8096] = "";
+					snprintf(szBuf, 8096, "*** %u log entries were dropped, the log buffer was full ***\n", dropped);
+					SystemFlags::logDebugEntry((SystemFlags::DebugType) i, szBuf, time(NULL));
 				}
-			} else {
-				safeMutex.ReleaseLock();
 			}
 		}
 
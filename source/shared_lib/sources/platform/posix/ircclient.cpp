@@ -207,7 +207,7 @@ namespace Shared {
 
 					if (SystemFlags::VERBOSE_MODE_ENABLED || IRCThread::debugEnabled) printf("===> IRC: Line: %d\n", __LINE__);
 
-					MutexSafeWrapper safeMutex(ctx->getMutexNickList(), string(__FILE__) + "_" + intToStr(__LINE__));
+					MutexSafeWrapper safeMutex(ctx->getMutexNickList(), CODE_AT_LINE);
 					std::vector<string> nickList = ctx->getCachedNickList();
 					for (unsigned int i = 0;
 						i < nickList.size(); ++i) {
@@ -331,7 +331,7 @@ namespace Shared {
 
 			IRCThread *ctx = (IRCThread *) irc_get_ctx(session);
 			if (ctx != NULL) {
-				MutexSafeWrapper safeMutex(ctx->getMutexIRCCB(), string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex(ctx->getMutexIRCCB(), CODE_AT_LINE);
 				IRCCallbackInterface *cb = ctx->getCallbackObj(false);
 				if (cb != NULL) {
 					cb->IRC_CallbackEvent(IRC_evt_chatText, realNick, params, count);
@@ -411,7 +411,7 @@ namespace Shared {
 
 				IRCThread *ctx = (IRCThread *) irc_get_ctx(session);
 				if (ctx != NULL) {
-					MutexSafeWrapper safeMutex(ctx->getMutexNickList(), string(__FILE__) + "_" + intToStr(__LINE__));
+					MutexSafeWrapper safeMutex(ctx->getMutexNickList(), CODE_AT_LINE);
 					std::vector<string> &nickList = ctx->getCachedNickList();
 					for (unsigned int i = 0;
 						i < nickList.size(); ++i) {
@@ -503,7 +503,7 @@ namespace Shared {
 
 						IRCThread *ctx = (IRCThread *) irc_get_ctx(session);
 						if (ctx != NULL) {
-							MutexSafeWrapper safeMutex(ctx->getMutexNickList(), string(__FILE__) + "_" + intToStr(__LINE__));
+							MutexSafeWrapper safeMutex(ctx->getMutexNickList(), CODE_AT_LINE);
 							ctx->setCachedNickList(nickList);
 						}
 					}
@@ -530,14 +530,14 @@ namespace Shared {
 #endif
 
 		bool IRCThread::getEventDataDone() {
-			MutexSafeWrapper safeMutex(&mutexEventDataDone, string(__FILE__) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutex(&mutexEventDataDone, CODE_AT_LINE);
 			bool result = eventDataDone;
 			safeMutex.ReleaseLock();
 
 			return result;
 		}
 		void IRCThread::setEventDataDone(bool value) {
-			MutexSafeWrapper safeMutex(&mutexEventDataDone, string(__FILE__) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutex(&mutexEventDataDone, CODE_AT_LINE);
 			eventDataDone = value;
 		}
 
@@ -558,7 +558,7 @@ namespace Shared {
 		void IRCThread::disconnect() {
 #if !defined(DISABLE_IRCCLIENT)
 
-			MutexSafeWrapper safeMutex(&mutexIRCSession, string(__FILE__) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutex(&mutexIRCSession, CODE_AT_LINE);
 			bool validSession = (ircSession != NULL);
 			safeMutex.ReleaseLock();
 
@@ -566,7 +566,7 @@ namespace Shared {
 				setCallbackObj(NULL);
 				if (SystemFlags::VERBOSE_MODE_ENABLED || IRCThread::debugEnabled) printf("===> IRC: Quitting Channel\n");
 
-				MutexSafeWrapper safeMutex1(&mutexIRCSession, string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex1(&mutexIRCSession, CODE_AT_LINE);
 				if (ircSession != NULL) {
 					irc_disconnect(ircSession);
 				}
@@ -585,7 +585,7 @@ namespace Shared {
 
 #if !defined(DISABLE_IRCCLIENT)
 
-			MutexSafeWrapper safeMutex(&mutexIRCSession, string(__FILE__) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutex(&mutexIRCSession, CODE_AT_LINE);
 			bool validSession = (ircSession != NULL);
 			safeMutex.ReleaseLock();
 
@@ -593,7 +593,7 @@ namespace Shared {
 				setCallbackObj(NULL);
 				if (SystemFlags::VERBOSE_MODE_ENABLED || IRCThread::debugEnabled) printf("===> IRC: Quitting Channel\n");
 
-				MutexSafeWrapper safeMutex1(&mutexIRCSession, string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex1(&mutexIRCSession, CODE_AT_LINE);
 				if (ircSession != NULL) {
 					irc_cmd_quit(ircSession, "ZG Bot is closing!");
 				}
@@ -615,7 +615,7 @@ namespace Shared {
 		}
 
 		void IRCThread::SendIRCCmdMessage(string target, string msg) {
-			MutexSafeWrapper safeMutex(&mutexIRCSession, string(__FILE__) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutex(&mutexIRCSession, CODE_AT_LINE);
 			bool validSession = (ircSession != NULL);
 			safeMutex.ReleaseLock();
 
@@ -623,7 +623,7 @@ namespace Shared {
 				if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s Line: %d] sending IRC command to [%s] cmd [%s]\n", __FILE__, __FUNCTION__, __LINE__, target.c_str(), msg.c_str());
 
 #if !defined(DISABLE_IRCCLIENT)
-				MutexSafeWrapper safeMutex1(&mutexIRCSession, string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex1(&mutexIRCSession, CODE_AT_LINE);
 				int ret = 0;
 				if (ircSession != NULL) {
 					ret = irc_cmd_msg(ircSession, target.c_str(), msg.c_str());
@@ -639,7 +639,7 @@ namespace Shared {
 			setEventDataDone(false);
 
 			if (SystemFlags::VERBOSE_MODE_ENABLED || IRCThread::debugEnabled) printf("===> IRC: Line: %d\n", __LINE__);
-			MutexSafeWrapper safeMutexSession(&mutexIRCSession, string(__FILE__) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutexSession(&mutexIRCSession, CODE_AT_LINE);
 			bool validSession = (ircSession != NULL);
 			safeMutexSession.ReleaseLock();
 
@@ -652,7 +652,7 @@ namespace Shared {
 
 				if (SystemFlags::VERBOSE_MODE_ENABLED || IRCThread::debugEnabled) printf("===> IRC: Line: %d\n", __LINE__);
 
-				MutexSafeWrapper safeMutex1(&mutexIRCSession, string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex1(&mutexIRCSession, CODE_AT_LINE);
 
 				if (SystemFlags::VERBOSE_MODE_ENABLED || IRCThread::debugEnabled) printf("===> IRC: Line: %d\n", __LINE__);
 				int ret = irc_cmd_names(ircSession, target.c_str());
@@ -683,7 +683,7 @@ namespace Shared {
 
 			if (SystemFlags::VERBOSE_MODE_ENABLED || IRCThread::debugEnabled) printf("===> IRC: Line: %d\n", __LINE__);
 
-			MutexSafeWrapper safeMutex(&mutexNickList, string(__FILE__) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutex(&mutexNickList, CODE_AT_LINE);
 			std::vector<string> nickList = eventData;
 			safeMutex.ReleaseLock();
 
@@ -695,7 +695,7 @@ namespace Shared {
 		bool IRCThread::isConnected(bool mutexLockRequired) {
 			bool ret = false;
 			if (this->getQuitStatus() == false) {
-				MutexSafeWrapper safeMutex(NULL, string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex(NULL, CODE_AT_LINE);
 				int lockStatus = 0;
 				if (mutexLockRequired == true) {
 					lockStatus = safeMutex.setMutexAndTryLock(&mutexIRCSession);
@@ -707,7 +707,7 @@ namespace Shared {
 
 				if (validSession == true) {
 #if !defined(DISABLE_IRCCLIENT)
-					MutexSafeWrapper safeMutex1(NULL, string(__FILE__) + "_" + intToStr(__LINE__));
+					MutexSafeWrapper safeMutex1(NULL, CODE_AT_LINE);
 					if (ircSession != NULL) {
 						lockStatus = 0;
 						if (mutexLockRequired == true) {
@@ -726,7 +726,7 @@ namespace Shared {
 		}
 
 		std::vector<string> IRCThread::getNickList() {
-			MutexSafeWrapper safeMutex(&mutexNickList, string(__FILE__) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutex(&mutexNickList, CODE_AT_LINE);
 			std::vector<string> nickList = eventData;
 			safeMutex.ReleaseLock();
 
@@ -734,14 +734,14 @@ namespace Shared {
 		}
 
 		IRCCallbackInterface * IRCThread::getCallbackObj(bool lockObj) {
-			MutexSafeWrapper safeMutex(NULL, string(__FILE__) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutex(NULL, CODE_AT_LINE);
 			if (lockObj == true) {
 				safeMutex.setMutex(&mutexIRCCB);
 			}
 			return callbackObj;
 		}
 		void IRCThread::setCallbackObj(IRCCallbackInterface *cb) {
-			MutexSafeWrapper safeMutex(&mutexIRCCB, string(__FILE__) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutex(&mutexIRCCB, CODE_AT_LINE);
 			callbackObj = cb;
 		}
 
@@ -763,7 +763,7 @@ namespace Shared {
 #if !defined(DISABLE_IRCCLIENT)
 					irc_callbacks_t	callbacks;
 
-					MutexSafeWrapper safeMutex(&mutexIRCSession, string(__FILE__) + "_" + intToStr(__LINE__));
+					MutexSafeWrapper safeMutex(&mutexIRCSession, CODE_AT_LINE);
 					ircSession = NULL;
 					safeMutex.ReleaseLock(true);
 
@@ -896,7 +896,7 @@ namespace Shared {
 				//printf("In ~IRCThread Line: %d [%p]\n",__LINE__,this);
 				// Delete ourself when the thread is done (no other actions can happen after this
 				// such as the mutex which modifies the running status of this method
-				MutexSafeWrapper safeMutex(&mutexIRCCB, string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex(&mutexIRCCB, CODE_AT_LINE);
 				IRCCallbackInterface *cb = getCallbackObj(false);
 				if (cb != NULL) {
 					//printf("In ~IRCThread Line: %d [%p]\n",__LINE__,this);
@@ -921,7 +921,7 @@ namespace Shared {
 			//		return 1;
 			//	}
 
-			MutexSafeWrapper safeMutex(&mutexIRCSession, string(__FILE__) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutex(&mutexIRCSession, CODE_AT_LINE);
 
 			if (isConnected(false) == false) {
 				//session->lasterror = LIBIRC_ERR_STATE;
@@ -1033,7 +1033,7 @@ namespace Shared {
 		void IRCThread::connectToHost() {
 			bool connectRequired = false;
 
-			MutexSafeWrapper safeMutex(&mutexIRCSession, string(__FILE__) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutex(&mutexIRCSession, CODE_AT_LINE);
 			bool validSession = (ircSession != NULL);
 			safeMutex.ReleaseLock();
 
@@ -1042,7 +1042,7 @@ namespace Shared {
 			} else {
 #if !defined(DISABLE_IRCCLIENT)
 
-				MutexSafeWrapper safeMutex1(&mutexIRCSession, string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex1(&mutexIRCSession, CODE_AT_LINE);
 				int result = irc_is_connected(ircSession);
 				if (result != 1) {
 					connectRequired = true;
@@ -1053,7 +1053,7 @@ namespace Shared {
 
 			if (connectRequired == false) {
 #if !defined(DISABLE_IRCCLIENT)
-				MutexSafeWrapper safeMutex1(&mutexIRCSession, string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex1(&mutexIRCSession, CODE_AT_LINE);
 				if (irc_connect(ircSession, argv[0].c_str(), IRC_SERVER_PORT, 0, this->nick.c_str(), this->username.c_str(), "zetaglest")) {
 					safeMutex1.ReleaseLock();
 
@@ -1069,14 +1069,14 @@ namespace Shared {
 			wantToLeaveChannel = false;
 			connectToHost();
 
-			MutexSafeWrapper safeMutex(&mutexIRCSession, string(__FILE__) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutex(&mutexIRCSession, CODE_AT_LINE);
 			bool validSession = (ircSession != NULL);
 			safeMutex.ReleaseLock();
 
 			if (validSession == true) {
 #if !defined(DISABLE_IRCCLIENT)
 
-				MutexSafeWrapper safeMutex1(&mutexIRCSession, string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex1(&mutexIRCSession, CODE_AT_LINE);
 				IRCThread *ctx = (IRCThread *) irc_get_ctx(ircSession);
 				if (ctx != NULL) {
 					eventData.clear();
@@ -1095,14 +1095,14 @@ namespace Shared {
 		void IRCThread::leaveChannel() {
 			wantToLeaveChannel = true;
 
-			MutexSafeWrapper safeMutex(&mutexIRCSession, string(__FILE__) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutex(&mutexIRCSession, CODE_AT_LINE);
 			bool validSession = (ircSession != NULL);
 			safeMutex.ReleaseLock();
 
 			if (validSession == true) {
 #if !defined(DISABLE_IRCCLIENT)
 
-				MutexSafeWrapper safeMutex1(&mutexIRCSession, string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex1(&mutexIRCSession, CODE_AT_LINE);
 				IRCThread *ctx = (IRCThread *) irc_get_ctx(ircSession);
 				if (ctx != NULL) {
 					irc_cmd_part(ircSession, ctx->getChannel().c_str());
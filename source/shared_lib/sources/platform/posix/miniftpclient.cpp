@@ -218,7 +218,7 @@ namespace Shared {
 				stats.currentFilename = out->currentFilename;
 				stats.downloadType = out->downloadType;
 
-				static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				MutexSafeWrapper safeMutex(out->ftpServer->getProgressMutex(), mutexOwnerId);
 				out->ftpServer->getProgressMutex()->setOwnerId(mutexOwnerId);
 				out->ftpServer->getCallBackObject()->FTPClient_CallbackEvent(
@@ -246,6 +246,8 @@ namespace Shared {
 			uniqueID = "FTPClientThread";
 			this->portNumber = portNumber;
 			this->serverUrl = serverUrl;
+			this->contentSyncPort = -1;
+			this->contentSyncDownloadType = ftp_cct_File;
 			this->mapsPath = mapsPath;
 			this->tilesetsPath = tilesetsPath;
 			this->techtreesPath = techtreesPath;
@@ -372,33 +374,36 @@ namespace Shared {
 			if (mapFileName.second != "") {
 				result = getMapFromServer(mapFileName, "", "");
 			} else {
-				pair<string, string> findMapFileName = mapFileName;
-				findMapFileName.first += +".zgm";
+				result = getItemFromContentSync(csit_Map, mapFileName.first, ftp_cct_Map, mapsPath);
+				if (result.first != ftp_crt_SUCCESS && this->getQuitStatus() == false) {
+					pair<string, string> findMapFileName = mapFileName;
+					findMapFileName.first += +".zgm";
 
-				result = getMapFromServer(findMapFileName, FTP_MAPS_CUSTOM_USERNAME, FTP_COMMON_PASSWORD);
-				if (result.first == ftp_crt_FAIL && this->getQuitStatus() == false) {
-					findMapFileName = mapFileName;
-					findMapFileName.first += +".gbm";
 					result = getMapFromServer(findMapFileName, FTP_MAPS_CUSTOM_USERNAME, FTP_COMMON_PASSWORD);
 					if (result.first == ftp_crt_FAIL && this->getQuitStatus() == false) {
-							findMapFileName = mapFileName;
-							findMapFileName.first += +".zgm";
-							result = getMapFromServer(findMapFileName, FTP_MAPS_USERNAME, FTP_COMMON_PASSWORD);
+						findMapFileName = mapFileName;
+						findMapFileName.first += +".gbm";
+						result = getMapFromServer(findMapFileName, FTP_MAPS_CUSTOM_USERNAME, FTP_COMMON_PASSWORD);
 						if (result.first == ftp_crt_FAIL && this->getQuitStatus() == false) {
-							findMapFileName = mapFileName;
-							findMapFileName.first += +".mgm";
-							result = getMapFromServer(findMapFileName, FTP_MAPS_USERNAME, FTP_COMMON_PASSWORD);
+								findMapFileName = mapFileName;
+								findMapFileName.first += +".zgm";
+								result = getMapFromServer(findMapFileName, FTP_MAPS_USERNAME, FTP_COMMON_PASSWORD);
 							if (result.first == ftp_crt_FAIL && this->getQuitStatus() == false) {
 								findMapFileName = mapFileName;
-								findMapFileName.first += +".gbm";
+								findMapFileName.first += +".mgm";
 								result = getMapFromServer(findMapFileName, FTP_MAPS_USERNAME, FTP_COMMON_PASSWORD);
+								if (result.first == ftp_crt_FAIL && this->getQuitStatus() == false) {
+									findMapFileName = mapFileName;
+									findMapFileName.first += +".gbm";
+									result = getMapFromServer(findMapFileName, FTP_MAPS_USERNAME, FTP_COMMON_PASSWORD);
+								}
 							}
 						}
 					}
 				}
 			}
 
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(this->getProgressMutex(), mutexOwnerId);
 			this->getProgressMutex()->setOwnerId(mutexOwnerId);
 			if (this->pCBObject != NULL) {
@@ -412,7 +417,7 @@ namespace Shared {
 
 		void FTPClientThread::addMapToRequests(string mapFilename, string URL) {
 			std::pair<string, string> item = make_pair(mapFilename, URL);
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(&mutexMapFileList, mutexOwnerId);
 			mutexMapFileList.setOwnerId(mutexOwnerId);
 			if (std::find(mapFileList.begin(), mapFileList.end(), item) == mapFileList.end()) {
@@ -422,7 +427,7 @@ namespace Shared {
 
 		void FTPClientThread::addTilesetToRequests(string tileSetName, string URL) {
 			std::pair<string, string> item = make_pair(tileSetName, URL);
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(&mutexTilesetList, mutexOwnerId);
 			mutexTilesetList.setOwnerId(mutexOwnerId);
 			if (std::find(tilesetList.begin(), tilesetList.end(), item) == tilesetList.end()) {
@@ -432,7 +437,7 @@ namespace Shared {
 
 		void FTPClientThread::addTechtreeToRequests(string techtreeName, string URL) {
 			std::pair<string, string> item = make_pair(techtreeName, URL);
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(&mutexTechtreeList, mutexOwnerId);
 			mutexTechtreeList.setOwnerId(mutexOwnerId);
 			if (std::find(techtreeList.begin(), techtreeList.end(), item) == techtreeList.end()) {
@@ -442,7 +447,7 @@ namespace Shared {
 
 		void FTPClientThread::addScenarioToRequests(string fileName, string URL) {
 			std::pair<string, string> item = make_pair(fileName, URL);
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(&mutexScenarioList, mutexOwnerId);
 			mutexScenarioList.setOwnerId(mutexOwnerId);
 			if (std::find(scenarioList.begin(), scenarioList.end(), item) == scenarioList.end()) {
@@ -452,7 +457,7 @@ namespace Shared {
 
 		void FTPClientThread::addFileToRequests(string fileName, string URL) {
 			std::pair<string, string> item = make_pair(fileName, URL);
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(&mutexFileList, mutexOwnerId);
 			mutexFileList.setOwnerId(mutexOwnerId);
 			if (std::find(fileList.begin(), fileList.end(), item) == fileList.end()) {
@@ -462,7 +467,7 @@ namespace Shared {
 
 		void FTPClientThread::addTempFileToRequests(string fileName, string URL) {
 			std::pair<string, string> item = make_pair(fileName, URL);
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(&mutexTempFileList, mutexOwnerId);
 			mutexTempFileList.setOwnerId(mutexOwnerId);
 			if (std::find(tempFileList.begin(), tempFileList.end(), item) == tempFileList.end()) {
@@ -471,11 +476,13 @@ namespace Shared {
 		}
 
 		void FTPClientThread::getTilesetFromServer(pair<string, string> tileSetName) {
-			bool findArchive = executeShellCommand(
-				this->fileArchiveExtractCommand,
-				this->fileArchiveExtractCommandSuccessResult);
-
 			pair<FTP_Client_ResultType, string> result = make_pair(ftp_crt_FAIL, "");
+			if (tileSetName.second == "") {
+				result = getItemFromContentSync(csit_Tileset, tileSetName.first, ftp_cct_Tileset, tilesetsPath);
+			}
+
+			bool findArchive = (result.first != ftp_crt_SUCCESS && this->getQuitStatus() == false &&
+				executeShellCommand(this->fileArchiveExtractCommand, this->fileArchiveExtractCommandSuccessResult));
 			if (findArchive == true) {
 				if (tileSetName.second != "") {
 					//result = getTilesetFromServer(tileSetName, "", "", "", findArchive);
@@ -500,7 +507,7 @@ namespace Shared {
 				}
 			}
 
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(this->getProgressMutex(), mutexOwnerId);
 			this->getProgressMutex()->setOwnerId(mutexOwnerId);
 			if (this->pCBObject != NULL) {
@@ -590,7 +597,7 @@ namespace Shared {
 						destRootArchiveFolder,
 						destRootArchiveFolder + tileSetName.first + this->fileArchiveExtension);
 
-					static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+					static const char *mutexOwnerId = CODE_AT_LINE;
 					MutexSafeWrapper safeMutex(this->getProgressMutex(), mutexOwnerId);
 					this->getProgressMutex()->setOwnerId(mutexOwnerId);
 
@@ -655,9 +662,12 @@ namespace Shared {
 
 		void FTPClientThread::getTechtreeFromServer(pair<string, string> techtreeName) {
 			pair<FTP_Client_ResultType, string> result = make_pair(ftp_crt_FAIL, "");
-			bool findArchive = executeShellCommand(
-				this->fileArchiveExtractCommand,
-				this->fileArchiveExtractCommandSuccessResult);
+			if (techtreeName.second == "") {
+				result = getItemFromContentSync(csit_Techtree, techtreeName.first, ftp_cct_Techtree, techtreesPath);
+			}
+
+			bool findArchive = (result.first != ftp_crt_SUCCESS && this->getQuitStatus() == false &&
+				executeShellCommand(this->fileArchiveExtractCommand, this->fileArchiveExtractCommandSuccessResult));
 			if (findArchive == true) {
 				if (techtreeName.second != "") {
 					result = getTechtreeFromServer(techtreeName, "", "");
@@ -669,7 +679,7 @@ namespace Shared {
 				}
 			}
 
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(this->getProgressMutex(), mutexOwnerId);
 			this->getProgressMutex()->setOwnerId(mutexOwnerId);
 			if (this->pCBObject != NULL) {
@@ -713,7 +723,7 @@ namespace Shared {
 					destRootArchiveFolder,
 					destRootArchiveFolder + techtreeName.first + this->fileArchiveExtension);
 
-				static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				MutexSafeWrapper safeMutex(this->getProgressMutex(), mutexOwnerId);
 				this->getProgressMutex()->setOwnerId(mutexOwnerId);
 				if (this->pCBObject != NULL) {
@@ -735,6 +745,67 @@ namespace Shared {
 
 		}
 
+		pair<FTP_Client_ResultType, string> FTPClientThread::getItemFromContentSync(ContentSyncItemType type, string itemName,
+			FTP_Client_CallbackType downloadType, std::pair<string, string> itemPaths) {
+			pair<FTP_Client_ResultType, string> result = make_pair(ftp_crt_FAIL, "");
+			if (this->contentSyncPort <= 0 || this->serverUrl == "" || itemPaths.first == "") {
+				return result;
+			}
+
+			// like the FTP download the item goes to the user data folder,
+			// the copy in the game data folder only provides blocks
+			string destFolder = (itemPaths.second != "" ? itemPaths.second : itemPaths.first);
+			string baseFolder = (itemPaths.second != "" ? itemPaths.first : "");
+			endPathWithSlash(destFolder);
+			if (baseFolder != "") {
+				endPathWithSlash(baseFolder);
+			}
+			if (type != csit_Map) {
+				destFolder += itemName + "/";
+				if (baseFolder != "") {
+					baseFolder += itemName + "/";
+				}
+			}
+
+			this->contentSyncDownloadType = downloadType;
+			ContentSyncClient client(this->serverUrl, this->contentSyncPort, this);
+			string errorText;
+			if (client.syncItem(type, itemName, destFolder, baseFolder, errorText) == true) {
+				result.first = ftp_crt_SUCCESS;
+				if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "===> Content sync of [%s] got %d blocks, " MG_I64_SPECIFIER " bytes\n", itemName.c_str(), client.getBlocksReceived(), client.getBytesReceived());
+			} else {
+				result.second = errorText;
+				if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "===> Content sync of [%s] failed [%s], using FTP\n", itemName.c_str(), errorText.c_str());
+			}
+			return result;
+		}
+
+		bool FTPClientThread::ContentSync_Progress(const string &itemName, int64 bytesNow, int64 bytesTotal) {
+			if (this->getQuitStatus() == true) {
+				return false;
+			}
+
+			FTPClientCallbackInterface::FtpProgressStats stats;
+			stats.download_total = (double) bytesTotal;
+			stats.download_now = (double) bytesNow;
+			stats.upload_total = 0;
+			stats.upload_now = 0;
+			stats.currentFilename = itemName;
+			stats.downloadType = this->contentSyncDownloadType;
+
+			static const char *mutexOwnerId = CODE_AT_LINE;
+			MutexSafeWrapper safeMutex(this->getProgressMutex(), mutexOwnerId);
+			this->getProgressMutex()->setOwnerId(mutexOwnerId);
+			if (this->pCBObject != NULL) {
+				this->pCBObject->FTPClient_CallbackEvent(
+					itemName,
+					ftp_cct_DownloadProgress,
+					make_pair(ftp_crt_SUCCESS, ""),
+					&stats);
+			}
+			return true;
+		}
+
 		void FTPClientThread::getScenarioFromServer(pair<string, string> fileName) {
 			pair<FTP_Client_ResultType, string> result = make_pair(ftp_crt_FAIL, "");
 			bool findArchive = executeShellCommand(
@@ -744,7 +815,7 @@ namespace Shared {
 				result = getScenarioInternalFromServer(fileName);
 			}
 
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(this->getProgressMutex(), mutexOwnerId);
 			this->getProgressMutex()->setOwnerId(mutexOwnerId);
 			if (this->pCBObject != NULL) {
@@ -786,7 +857,7 @@ namespace Shared {
 					destRootArchiveFolder,
 					destRootArchiveFolder + fileName.first + this->fileArchiveExtension);
 
-				static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				MutexSafeWrapper safeMutex(this->getProgressMutex(), mutexOwnerId);
 				this->getProgressMutex()->setOwnerId(mutexOwnerId);
 				if (this->pCBObject != NULL) {
@@ -822,7 +893,7 @@ namespace Shared {
 				result = getFileInternalFromServer(fileName);
 			}
 
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(this->getProgressMutex(), mutexOwnerId);
 			this->getProgressMutex()->setOwnerId(mutexOwnerId);
 			if (this->pCBObject != NULL) {
@@ -876,7 +947,7 @@ namespace Shared {
 				result = getTempFileInternalFromServer(fileName);
 			}
 
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(this->getProgressMutex(), mutexOwnerId);
 			this->getProgressMutex()->setOwnerId(mutexOwnerId);
 			if (this->pCBObject != NULL) {
@@ -1074,14 +1145,14 @@ namespace Shared {
 		}
 
 		FTPClientCallbackInterface * FTPClientThread::getCallBackObject() {
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(this->getProgressMutex(), mutexOwnerId);
 			this->getProgressMutex()->setOwnerId(mutexOwnerId);
 			return pCBObject;
 		}
 
 		void FTPClientThread::setCallBackObject(FTPClientCallbackInterface *value) {
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(this->getProgressMutex(), mutexOwnerId);
 			this->getProgressMutex()->setOwnerId(mutexOwnerId);
 			pCBObject = value;
@@ -1117,7 +1188,7 @@ namespace Shared {
 
 				try {
 					while (this->getQuitStatus() == false) {
-						static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+						static const char *mutexOwnerId = CODE_AT_LINE;
 						MutexSafeWrapper safeMutex(&mutexMapFileList, mutexOwnerId);
 						mutexMapFileList.setOwnerId(mutexOwnerId);
 						if (mapFileList.size() > 0) {
@@ -1134,7 +1205,7 @@ namespace Shared {
 							break;
 						}
 
-						static string mutexOwnerId2 = string(__FILE__) + string("_") + intToStr(__LINE__);
+						static const char *mutexOwnerId2 = CODE_AT_LINE;
 						MutexSafeWrapper safeMutex2(&mutexTilesetList, mutexOwnerId2);
 						mutexTilesetList.setOwnerId(mutexOwnerId2);
 						if (tilesetList.size() > 0) {
@@ -1147,7 +1218,7 @@ namespace Shared {
 							safeMutex2.ReleaseLock();
 						}
 
-						static string mutexOwnerId3 = string(__FILE__) + string("_") + intToStr(__LINE__);
+						static const char *mutexOwnerId3 = CODE_AT_LINE;
 						MutexSafeWrapper safeMutex3(&mutexTechtreeList, mutexOwnerId3);
 						mutexTechtreeList.setOwnerId(mutexOwnerId3);
 						if (techtreeList.size() > 0) {
@@ -1160,7 +1231,7 @@ namespace Shared {
 							safeMutex3.ReleaseLock();
 						}
 
-						static string mutexOwnerId4 = string(__FILE__) + string("_") + intToStr(__LINE__);
+						static const char *mutexOwnerId4 = CODE_AT_LINE;
 						MutexSafeWrapper safeMutex4(&mutexScenarioList, mutexOwnerId4);
 						mutexScenarioList.setOwnerId(mutexOwnerId4);
 						if (scenarioList.size() > 0) {
@@ -1173,7 +1244,7 @@ namespace Shared {
 							safeMutex4.ReleaseLock();
 						}
 
-						static string mutexOwnerId5 = string(__FILE__) + string("_") + intToStr(__LINE__);
+						static const char *mutexOwnerId5 = CODE_AT_LINE;
 						MutexSafeWrapper safeMutex5(&mutexFileList, mutexOwnerId5);
 						mutexFileList.setOwnerId(mutexOwnerId5);
 						if (fileList.size() > 0) {
@@ -1186,7 +1257,7 @@ namespace Shared {
 							safeMutex5.ReleaseLock();
 						}
 
-						static string mutexOwnerId6 = string(__FILE__) + string("_") + intToStr(__LINE__);
+						static const char *mutexOwnerId6 = CODE_AT_LINE;
 						MutexSafeWrapper safeMutex6(&mutexTempFileList, mutexOwnerId6);
 						mutexTempFileList.setOwnerId(mutexOwnerId6);
 						if (tempFileList.size() > 0) {
@@ -845,6 +845,7 @@ namespace Shared {
 		Socket::Socket(PLATFORM_SOCKET sock) {
 			dataSynchAccessorRead = new Mutex(CODE_AT_LINE);
 			dataSynchAccessorWrite = new Mutex(CODE_AT_LINE);
+			dataSynchAccessorWait = new Mutex(CODE_AT_LINE);
 			inSocketDestructorSynchAccessor = new Mutex(CODE_AT_LINE);
 			lastSocketError = 0;
 
@@ -868,6 +869,7 @@ namespace Shared {
 		Socket::Socket() {
 			dataSynchAccessorRead = new Mutex(CODE_AT_LINE);
 			dataSynchAccessorWrite = new Mutex(CODE_AT_LINE);
+			dataSynchAccessorWait = new Mutex(CODE_AT_LINE);
 			inSocketDestructorSynchAccessor = new Mutex(CODE_AT_LINE);
 			lastSocketError = 0;
 			lastDebugEvent = 0;
@@ -996,7 +998,8 @@ namespace Shared {
 			// Allow other callers with a lock on the mutexes to let them go
 			for (time_t elapsed = time(NULL);
 				(dataSynchAccessorRead->getRefCount() > 0 ||
-					dataSynchAccessorWrite->getRefCount() > 0) &&
+					dataSynchAccessorWrite->getRefCount() > 0 ||
+					dataSynchAccessorWait->getRefCount() > 0) &&
 				difftime((long int) time(NULL), elapsed) <= 2;) {
 				printf("Waiting in socket destructor\n");
 				//sleep(0);
@@ -1012,6 +1015,8 @@ namespace Shared {
 			dataSynchAccessorRead = NULL;
 			delete dataSynchAccessorWrite;
 			dataSynchAccessorWrite = NULL;
+			delete dataSynchAccessorWait;
+			dataSynchAccessorWait = NULL;
 			delete inSocketDestructorSynchAccessor;
 			inSocketDestructorSynchAccessor = NULL;
 		}
@@ -1024,11 +1029,21 @@ namespace Shared {
 			if (isSocketValid() == true) {
 				if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s] calling shutdown and close for socket = %d...\n", __FILE__, __FUNCTION__, sock);
 
+				// shutdown wakes a thread blocked in hasDataToReadWithWait, which
+				// then lets go of the wait lock the close below has to take
 				MutexSafeWrapper safeMutex(dataSynchAccessorRead, CODE_AT_LINE);
 				MutexSafeWrapper safeMutex1(dataSynchAccessorWrite, CODE_AT_LINE);
-
 				if (isSocketValid() == true) {
 					::shutdown(sock, 2);
+				}
+				safeMutex.ReleaseLock(true);
+				safeMutex1.ReleaseLock(true);
+
+				MutexSafeWrapper safeMutexWait(dataSynchAccessorWait, CODE_AT_LINE);
+				safeMutex.Lock();
+				safeMutex1.Lock();
+
+				if (isSocketValid() == true) {
 #ifndef WIN32
 					::close(sock);
 					sock = -1;
@@ -1039,6 +1054,7 @@ namespace Shared {
 				}
 				safeMutex.ReleaseLock();
 				safeMutex1.ReleaseLock();
+				safeMutexWait.ReleaseLock();
 			}
 
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s] END closing socket = %d...\n", __FILE__, __FUNCTION__, sock);
@@ -1142,7 +1158,10 @@ namespace Shared {
 		}
 
 		bool Socket::hasDataToReadWithWait(int waitMicroseconds) {
-			MutexSafeWrapper safeMutex(dataSynchAccessorRead, CODE_AT_LINE);
+			// only the wait lock is held across the select: disconnectSocket
+			// needs it to close the descriptor, so the OS cannot reuse it while
+			// we wait, and readers such as isConnected() are never held up
+			MutexSafeWrapper safeMutex(dataSynchAccessorWait, CODE_AT_LINE);
 			return Socket::hasDataToReadWithWait(sock, waitMicroseconds);
 		}
 
@@ -1950,7 +1969,7 @@ namespace Shared {
 
 			ClientSocket::stopBroadCastClientThread();
 
-			static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			broadCastClientThread = new BroadCastClientSocketThread(cb);
 			broadCastClientThread->setUniqueID(mutexOwnerId);
 			broadCastClientThread->start();
@@ -2296,7 +2315,7 @@ namespace Shared {
 
 			//printf("Start broadcast thread [%p]\n",broadCastThread);
 
-			static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			broadCastThread->setUniqueID(mutexOwnerId);
 			broadCastThread->start();
 
@@ -18,6 +18,9 @@
 #include "platform_common.h"
 #include "base_thread.h"
 #include "time.h"
+#ifdef MUTEX_PROFILING
+#include <chrono>
+#endif
 
 using namespace std;
 
@@ -413,6 +416,22 @@ namespace Shared {
 			}
 		}
 
+		void Thread::join() {
+			MutexSafeWrapper safeMutex(mutexthreadAccessor);
+			SDL_Thread *joinThread = thread;
+			safeMutex.ReleaseLock(true);
+
+			// thread stays set until the wait is over, a thread that has
+			// not begun yet skips execute() when it finds it cleared
+			if (joinThread != NULL) {
+				SDL_WaitThread(joinThread, NULL);
+
+				safeMutex.Lock();
+				thread = NULL;
+				safeMutex.ReleaseLock();
+			}
+		}
+
 		void Thread::kill() {
 			MutexSafeWrapper safeMutex(mutexthreadAccessor);
 			//SDL_KillThread(thread);
@@ -470,31 +489,21 @@ namespace Shared {
 			}
 		};
 
-		const bool debugMutexLock = false;
-		//const int debugMutexLockMillisecondThreshold 	= 2000;
-
-		Mutex::Mutex(string ownerId) {
+		Mutex::Mutex(const char *creatorId) {
 			this->isStaticMutexListMutex = false;
 			this->mutexAccessor = SDL_CreateMutex();
 
 			SDLMutexSafeWrapper safeMutex(&mutexAccessor);
 
-			this->maxRefCount = 0;
 			this->refCount = 0;
-			this->ownerId = ownerId;
-			this->lastownerId = "";
+			this->ownerId = creatorId;
+			this->creatorId = creatorId;
 			this->mutex = SDL_CreateMutex();
 			if (this->mutex == NULL) {
 				char szBuf[8096] = "";
 				snprintf(szBuf, 8095, "In [%s::%s Line: %d] mutex == NULL", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__);
 				throw megaglest_runtime_error(szBuf);
 			}
-			this->deleteownerId = "";
-
-			this->chronoPerf = NULL;
-			if (debugMutexLock == true) {
-				this->chronoPerf = new Chrono();
-			}
 
 			if (Mutex::mutexMutexList.get()) {
 				MutexSafeWrapper safeMutexX(Mutex::mutexMutexList.get());
@@ -519,77 +528,130 @@ namespace Shared {
 
 			SDLMutexSafeWrapper safeMutex(&mutexAccessor, true);
 			if (mutex == NULL) {
-				printf("In [%s::%s Line: %d] mutex == NULL refCount = %d owner [%s] deleteownerId [%s]", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, refCount, ownerId.c_str(), deleteownerId.c_str());
+				printf("In [%s::%s Line: %d] mutex == NULL refCount = %d owner [%s] creator [%s]", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, refCount, ownerId, creatorId);
 				//throw megaglest_runtime_error(szBuf);
 				//printf("%s\n",szBuf);
 			} else if (refCount >= 1) {
-				printf("In [%s::%s Line: %d] about to destroy mutex refCount = %d owner [%s] deleteownerId [%s]", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, refCount, ownerId.c_str(), deleteownerId.c_str());
+				printf("In [%s::%s Line: %d] about to destroy mutex refCount = %d owner [%s] creator [%s]", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, refCount, ownerId, creatorId);
 				//throw megaglest_runtime_error(szBuf);
 			}
 
-			if (debugMutexLock == true) {
-				delete chronoPerf;
-				chronoPerf = NULL;
-			}
-
 			if (mutex != NULL) {
-				deleteownerId = ownerId;
 				SDL_DestroyMutex(mutex);
 				mutex = NULL;
 			}
+		}
+
+#ifdef MUTEX_PROFILING
+		// =====================================================
+		//	class MutexLockSite
+		// =====================================================
+
+		MutexLockSite MutexLockSite::lockSites[MutexLockSite::maxLockSites];
+
+		MutexLockSite *MutexLockSite::get(const char *ownerId, const Mutex *mutex) {
+			// locks without an owner id are grouped by the mutex they take
+			const char *key = (ownerId != NULL && ownerId[0] != '\0' ? ownerId : mutex->getCreatorId());
+			if (key == NULL) {
+				return NULL;
+			}
+
+			std::size_t index = (reinterpret_cast<std::size_t>(key) >> 3) % maxLockSites;
+			for (int probe = 0; probe < maxLockSites; ++probe) {
+				MutexLockSite &site = lockSites[index];
+				const char *location = site.location.load();
+				if (location == key) {
+					return &site;
+				}
+				if (location == NULL) {
+					const char *expected = NULL;
+					if (site.location.compare_exchange_strong(expected, key) == true) {
+						site.mutexCreatorId.store(mutex->getCreatorId());
+						return &site;
+					}
+					if (expected == key) {
+						return &site;
+					}
+				}
+				index = (index + 1) % maxLockSites;
+			}
+			return NULL;
+		}
 
-			//	if(maxRefCount <= 1) {
-			//		printf("***> MUTEX candidate for removal ownerId [%s] deleteownerId [%s] lastownerId [%s]\n",ownerId.c_str(),deleteownerId.c_str(),lastownerId.c_str());
-			//	}
-		}
-
-		/*
-		inline void Mutex::p() {
-		//	if(mutex == NULL) {
-		//		string stack = PlatformExceptionHandler::getStackTrace();
-		//		char szBuf[8096]="";
-		//		snprintf(szBuf,8095,"In [%s::%s Line: %d] mutex == NULL refCount = %d owner [%s] deleteownerId [%s] stack: %s",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,refCount,ownerId.c_str(),deleteownerId.c_str(),stack.c_str());
-		//		throw megaglest_runtime_error(szBuf);
-		//	}
-		//	std::auto_ptr<Chrono> chronoLockPerf;
-		//	if(debugMutexLock == true) {
-		//		chronoLockPerf.reset(new Chrono());
-		//		chronoLockPerf->start();
-		//	}
-
-		//	maxRefCount = max(maxRefCount,refCount+1);
-			SDL_mutexP(mutex);
-			refCount++;
-
-		//	if(debugMutexLock == true) {
-		//		if(chronoLockPerf->getMillis() >= debugMutexLockMillisecondThreshold) {
-		//			printf("\n**WARNING possible mutex lock detected ms [%lld] Last ownerid: [%s]\n",(long long int)chronoLockPerf->getMillis(),lastownerId.c_str());
-		//		}
-		//		chronoPerf->start();
-		//	}
-		}
-
-		inline void Mutex::v() {
-		//	if(mutex == NULL) {
-		//		char szBuf[8096]="";
-		//		snprintf(szBuf,8095,"In [%s::%s Line: %d] mutex == NULL refCount = %d owner [%s] deleteownerId [%s]",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,refCount,ownerId.c_str(),deleteownerId.c_str());
-		//		throw megaglest_runtime_error(szBuf);
-		//	}
-			refCount--;
-
-		//	if(debugMutexLock == true) {
-		//		lastownerId = ownerId;
-		//		if(chronoPerf->getMillis() >= debugMutexLockMillisecondThreshold) {
-		//			printf("About to get stacktrace for stuck mutex ...\n");
-		//			string oldLastownerId = lastownerId;
-		//			lastownerId = PlatformExceptionHandler::getStackTrace();
-		//
-		//			printf("\n**WARNING possible mutex lock (on unlock) detected ms [%lld] Last ownerid: [%s]\noldLastownerId: [%s]\n",(long long int)chronoPerf->getMillis(),lastownerId.c_str(),oldLastownerId.c_str());
-		//		}
-		//	}
-			SDL_mutexV(mutex);
-		}
-		*/
+		int64 MutexLockSite::getCurrentMicroseconds() {
+			return std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		void MutexLockSite::updateMax(std::atomic<uint64> &value, uint64 sample) {
+			uint64 current = value.load();
+			while (sample > current && value.compare_exchange_weak(current, sample) == false) {
+			}
+		}
+
+		void MutexLockSite::addLock(bool contended, int64 waitMicros) {
+			lockCount++;
+			if (contended == true) {
+				contendedCount++;
+				waitMicroseconds += waitMicros;
+				updateMax(maxWaitMicroseconds, waitMicros);
+			}
+		}
+
+		void MutexLockSite::addHold(int64 holdMicros) {
+			holdMicroseconds += holdMicros;
+			updateMax(maxHoldMicroseconds, holdMicros);
+		}
+
+		static bool compareLockSiteWait(const std::pair<uint64, string> &a, const std::pair<uint64, string> &b) {
+			return a.first > b.first;
+		}
+
+		string MutexLockSite::getReport(unsigned int maxSites) {
+			vector<std::pair<uint64, string> > lines;
+			for (int i = 0; i < maxLockSites; ++i) {
+				MutexLockSite &site = lockSites[i];
+				const char *location = site.location.load();
+				uint64 locks = site.lockCount.load();
+				if (location == NULL || locks == 0) {
+					continue;
+				}
+				const char *creator = site.mutexCreatorId.load();
+				uint64 contended = site.contendedCount.load();
+				uint64 wait = site.waitMicroseconds.load();
+
+				char szBuf[8096] = "";
+				snprintf(szBuf, 8095, "%s [mutex %s] locks: %llu contended: %llu (%.1f%%) wait: %.2f ms (max %.2f) hold: %.2f ms (max %.2f)\n",
+					extractFileFromDirectoryPath(location).c_str(),
+					(creator != NULL && creator[0] != '\0' ? extractFileFromDirectoryPath(creator).c_str() : "unnamed"),
+					(unsigned long long) locks, (unsigned long long) contended,
+					contended * 100.0 / locks, wait / 1000.0,
+					site.maxWaitMicroseconds.load() / 1000.0,
+					site.holdMicroseconds.load() / 1000.0,
+					site.maxHoldMicroseconds.load() / 1000.0);
+				lines.push_back(std::make_pair(wait, string(szBuf)));
+			}
+			std::sort(lines.begin(), lines.end(), compareLockSiteWait);
+
+			string result = "";
+			for (unsigned int i = 0; i < lines.size() && i < maxSites; ++i) {
+				result += lines[i].second;
+			}
+			return result;
+		}
+
+		void MutexLockSite::reset() {
+			for (int i = 0; i < maxLockSites; ++i) {
+				MutexLockSite &site = lockSites[i];
+				site.lockCount = 0;
+				site.contendedCount = 0;
+				site.waitMicroseconds = 0;
+				site.maxWaitMicroseconds = 0;
+				site.holdMicroseconds = 0;
+				site.maxHoldMicroseconds = 0;
+			}
+		}
+#endif
 
 		// =====================================================
 		//	class Semaphore
@@ -11,12 +11,18 @@
 
 #include "sound.h"
 
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <stdexcept>
 #include "util.h"
+#include "platform_common.h"
+#include "platform_util.h"
+#include "checksum.h"
 #include "leak_dumper.h"
 
 using namespace Shared::Util;
+using namespace Shared::PlatformCommon;
 namespace Shared {
 	namespace Sound {
 
@@ -44,12 +50,254 @@ namespace Shared {
 			soundFileLoader = 0;
 		}
 
+		// =====================================================
+		//	class StaticSoundData
+		// =====================================================
+
+		StaticSoundData::StaticSoundData() {
+			path = "";
+			fileCRC = 0;
+			samples = NULL;
+			refCount = 0;
+			lastUsed = 0;
+		}
+
+		StaticSoundData::~StaticSoundData() {
+			unload();
+		}
+
+		void StaticSoundData::decode() {
+			if (samples != NULL) {
+				return;
+			}
+			string ext = (path.empty() == false ? path.substr(path.find_last_of('.') + 1) : "");
+			SoundFileLoader *soundFileLoader = SoundFileLoaderFactory::getInstance()->newInstance(ext);
+
+			if (soundFileLoader == NULL) {
+				throw megaglest_runtime_error("soundFileLoader == NULL");
+			}
+			soundFileLoader->open(path, &info);
+			samples = new int8[info.getSize()];
+			soundFileLoader->read(samples, info.getSize());
+			soundFileLoader->close();
+
+			delete soundFileLoader;
+		}
+
+		void StaticSoundData::unload() {
+			if (samples != NULL) {
+				delete[] samples;
+				samples = NULL;
+			}
+		}
+
+		// =====================================================
+		//	class StaticSoundCache
+		// =====================================================
+
+		StaticSoundCache::StaticSoundCache() : mutex(CODE_AT_LINE) {
+			useCounter = 0;
+			decodedBytes = 0;
+			maxDecodedBytes = 0;
+		}
+
+		StaticSoundCache::~StaticSoundCache() {
+			for (SoundCRCLookup::iterator iterMap = soundCRCLookup.begin();
+				iterMap != soundCRCLookup.end(); ++iterMap) {
+				delete iterMap->second;
+			}
+			soundCRCLookup.clear();
+			soundPathLookup.clear();
+		}
+
+		StaticSoundCache &StaticSoundCache::getInstance() {
+			// Never destroyed, static sounds owned by other singletons may
+			// still be released during process shutdown
+			static StaticSoundCache *cache = new StaticSoundCache();
+			return *cache;
+		}
+
+		string StaticSoundCache::getCanonicalPath(string path) {
+			replaceAll(path, "\\", "/");
+			path = formatPath(path);
+			updatePathClimbingParts(path);
+			return path;
+		}
+
+		StaticSoundData *StaticSoundCache::acquire(const string &path) {
+			string canonicalPath = getCanonicalPath(path);
+
+			MutexSafeWrapper safeMutex(&mutex, CODE_AT_LINE);
+			SoundPathLookup::iterator iterFindPath = soundPathLookup.find(canonicalPath);
+			if (iterFindPath != soundPathLookup.end()) {
+				iterFindPath->second->refCount++;
+				return iterFindPath->second;
+			}
+
+			// Identical files referenced from several places share one decode.
+			// The file CRC is usually already cached by the techtree CRC scan,
+			// otherwise the whole file is read here to compute it
+			Checksum checksum;
+			checksum.addFile(canonicalPath);
+			uint32 fileCRC = checksum.getSum();
+
+			std::pair<SoundCRCLookup::iterator, SoundCRCLookup::iterator> crcRange = soundCRCLookup.equal_range(fileCRC);
+			for (SoundCRCLookup::iterator iterFindCRC = crcRange.first; iterFindCRC != crcRange.second; ++iterFindCRC) {
+				StaticSoundData *data = iterFindCRC->second;
+				if (isSameFileContent(data->path, canonicalPath) == true) {
+					data->refCount++;
+					soundPathLookup[canonicalPath] = data;
+					return data;
+				}
+			}
+
+			// The loader only parses the header, samples are decoded on first use
+			string ext = (canonicalPath.empty() == false ? canonicalPath.substr(canonicalPath.find_last_of('.') + 1) : "");
+			SoundFileLoader *soundFileLoader = SoundFileLoaderFactory::getInstance()->newInstance(ext);
+			if (soundFileLoader == NULL) {
+				throw megaglest_runtime_error("soundFileLoader == NULL");
+			}
+
+			StaticSoundData *data = new StaticSoundData();
+			data->path = canonicalPath;
+			data->fileCRC = fileCRC;
+			try {
+				soundFileLoader->open(canonicalPath, &data->info);
+			} catch (...) {
+				delete soundFileLoader;
+				delete data;
+				throw;
+			}
+			soundFileLoader->close();
+			delete soundFileLoader;
+
+			data->refCount = 1;
+			soundPathLookup[canonicalPath] = data;
+			soundCRCLookup.insert(make_pair(fileCRC, data));
+			return data;
+		}
+
+		bool StaticSoundCache::isSameFileContent(const string &path1, const string &path2) {
+#ifdef WIN32
+			FILE *file1 = _wfopen(utf8_decode(path1).c_str(), L"rb");
+			FILE *file2 = _wfopen(utf8_decode(path2).c_str(), L"rb");
+#else
+			FILE *file1 = fopen(path1.c_str(), "rb");
+			FILE *file2 = fopen(path2.c_str(), "rb");
+#endif
+			bool same = (file1 != NULL && file2 != NULL);
+			if (same == true) {
+				char buffer1[8192];
+				char buffer2[8192];
+				for (;;) {
+					size_t read1 = fread(buffer1, 1, sizeof(buffer1), file1);
+					size_t read2 = fread(buffer2, 1, sizeof(buffer2), file2);
+					if (read1 != read2 || memcmp(buffer1, buffer2, read1) != 0) {
+						same = false;
+						break;
+					}
+					if (read1 < sizeof(buffer1)) {
+						break;
+					}
+				}
+			}
+			if (file1 != NULL) {
+				fclose(file1);
+			}
+			if (file2 != NULL) {
+				fclose(file2);
+			}
+			return same;
+		}
+
+		void StaticSoundCache::release(StaticSoundData *data) {
+			if (data == NULL) {
+				return;
+			}
+			MutexSafeWrapper safeMutex(&mutex, CODE_AT_LINE);
+			data->refCount--;
+			if (data->refCount > 0) {
+				return;
+			}
+
+			for (SoundPathLookup::iterator iterMap = soundPathLookup.begin();
+				iterMap != soundPathLookup.end();) {
+				if (iterMap->second == data) {
+					soundPathLookup.erase(iterMap++);
+				} else {
+					++iterMap;
+				}
+			}
+			std::pair<SoundCRCLookup::iterator, SoundCRCLookup::iterator> crcRange = soundCRCLookup.equal_range(data->fileCRC);
+			for (SoundCRCLookup::iterator iterFindCRC = crcRange.first; iterFindCRC != crcRange.second; ++iterFindCRC) {
+				if (iterFindCRC->second == data) {
+					soundCRCLookup.erase(iterFindCRC);
+					break;
+				}
+			}
+			if (data->samples != NULL) {
+				decodedBytes -= data->info.getSize();
+			}
+			delete data;
+		}
+
+		void StaticSoundCache::evictDecodedSamples(StaticSoundData *keepData) {
+			while (maxDecodedBytes > 0 && decodedBytes > maxDecodedBytes) {
+				StaticSoundData *oldestData = NULL;
+				for (SoundCRCLookup::iterator iterMap = soundCRCLookup.begin();
+					iterMap != soundCRCLookup.end(); ++iterMap) {
+					StaticSoundData *data = iterMap->second;
+					if (data != keepData && data->samples != NULL &&
+						(oldestData == NULL || data->lastUsed < oldestData->lastUsed)) {
+						oldestData = data;
+					}
+				}
+				if (oldestData == NULL) {
+					break;
+				}
+				decodedBytes -= oldestData->info.getSize();
+				oldestData->unload();
+			}
+		}
+
+		int8 *StaticSoundCache::getSamples(StaticSoundData *data) {
+			if (data == NULL) {
+				return NULL;
+			}
+			MutexSafeWrapper safeMutex(&mutex, CODE_AT_LINE);
+			data->lastUsed = ++useCounter;
+			if (data->samples == NULL) {
+				data->decode();
+				decodedBytes += data->info.getSize();
+				evictDecodedSamples(data);
+			}
+			return data->samples;
+		}
+
+		void StaticSoundCache::prefetch(StaticSoundData *data) {
+			if (data == NULL) {
+				return;
+			}
+			MutexSafeWrapper safeMutex(&mutex, CODE_AT_LINE);
+			if (data->samples == NULL) {
+				data->decode();
+				decodedBytes += data->info.getSize();
+				evictDecodedSamples(data);
+			}
+		}
+
+		void StaticSoundCache::setMaxDecodedBytes(std::size_t maxBytes) {
+			MutexSafeWrapper safeMutex(&mutex, CODE_AT_LINE);
+			maxDecodedBytes = maxBytes;
+			evictDecodedSamples(NULL);
+		}
+
 		// =====================================================
 		//	class StaticSound
 		// =====================================================
 
 		StaticSound::StaticSound() {
-			samples = NULL;
+			data = NULL;
 			soundFileLoader = NULL;
 			fileName = "";
 		}
@@ -59,9 +307,9 @@ namespace Shared {
 		}
 
 		void StaticSound::close() {
-			if (samples != NULL) {
-				delete[] samples;
-				samples = NULL;
+			if (data != NULL) {
+				StaticSoundCache::getInstance().release(data);
+				data = NULL;
 			}
 
 			if (soundFileLoader != NULL) {
@@ -71,6 +319,10 @@ namespace Shared {
 			}
 		}
 
+		int8 *StaticSound::getSamples() const {
+			return StaticSoundCache::getInstance().getSamples(data);
+		}
+
 		void StaticSound::load(const string &path) {
 			close();
 
@@ -79,19 +331,12 @@ namespace Shared {
 			if (GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
 				return;
 			}
-			string ext = (path.empty() == false ? path.substr(path.find_last_of('.') + 1) : "");
-			soundFileLoader = SoundFileLoaderFactory::getInstance()->newInstance(ext);
-
-			if (soundFileLoader == NULL) {
-				throw megaglest_runtime_error("soundFileLoader == NULL");
-			}
-			soundFileLoader->open(path, &info);
-			samples = new int8[info.getSize()];
-			soundFileLoader->read(samples, info.getSize());
-			soundFileLoader->close();
+			data = StaticSoundCache::getInstance().acquire(path);
+			info = data->info;
+		}
 
-			delete soundFileLoader;
-			soundFileLoader = NULL;
+		void StaticSound::prefetch() {
+			StaticSoundCache::getInstance().prefetch(data);
 		}
 
 		// =====================================================
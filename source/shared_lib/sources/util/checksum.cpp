@@ -372,7 +372,7 @@ namespace Shared {
 					for (std::map<string, uint32>::iterator iterMap = fileList.begin();
 						iterMap != fileList.end(); ++iterMap) {
 
-						MutexSafeWrapper safeMutexSocketDestructorFlag(&Checksum::fileListCacheSynchAccessor, string(__FILE__) + "_" + intToStr(__LINE__));
+						MutexSafeWrapper safeMutexSocketDestructorFlag(&Checksum::fileListCacheSynchAccessor, CODE_AT_LINE);
 						if (Checksum::fileListCache.find(iterMap->first) == Checksum::fileListCache.end()) {
 							Checksum fileResult;
 							//bool fileAddedOk = fileResult.addFileToSum(iterMap->first);
@@ -415,14 +415,14 @@ namespace Shared {
 		}
 
 		void Checksum::removeFileFromCache(const string file) {
-			MutexSafeWrapper safeMutexSocketDestructorFlag(&Checksum::fileListCacheSynchAccessor, string(__FILE__) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutexSocketDestructorFlag(&Checksum::fileListCacheSynchAccessor, CODE_AT_LINE);
 			if (Checksum::fileListCache.find(file) != Checksum::fileListCache.end()) {
 				Checksum::fileListCache.erase(file);
 			}
 		}
 
 		void Checksum::clearFileCache() {
-			MutexSafeWrapper safeMutexSocketDestructorFlag(&Checksum::fileListCacheSynchAccessor, string(__FILE__) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutexSocketDestructorFlag(&Checksum::fileListCacheSynchAccessor, CODE_AT_LINE);
 			Checksum::fileListCache.clear();
 		}
 
@@ -0,0 +1,93 @@
+// ==============================================================
+//	This file is part of ZetaGlest Shared Library (www.zetaglest.org)
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 3 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "latency_estimator.h"
+
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include "leak_dumper.h"
+
+using namespace std;
+
+namespace Shared {
+	namespace Util {
+
+		// =====================================================
+		//	class LatencyEstimator
+		// =====================================================
+
+		LatencyEstimator::LatencyEstimator(int windowSize) {
+			samples.resize(max(2, windowSize));
+			clear();
+		}
+
+		void LatencyEstimator::addSample(int64 micros) {
+			samples[nextSample] = max<int64>(0, micros);
+			nextSample = (nextSample + 1) % (int) samples.size();
+			sampleCount++;
+		}
+
+		void LatencyEstimator::clear() {
+			std::fill(samples.begin(), samples.end(), 0);
+			nextSample = 0;
+			sampleCount = 0;
+		}
+
+		int64 LatencyEstimator::getMeanMicros() const {
+			int count = min(sampleCount, (int) samples.size());
+			if (count == 0) {
+				return 0;
+			}
+			int64 total = 0;
+			for (int index = 0; index < count; ++index) {
+				total += samples[index];
+			}
+			return total / count;
+		}
+
+		int64 LatencyEstimator::getJitterMicros() const {
+			int count = min(sampleCount, (int) samples.size());
+			if (count < 2) {
+				return 0;
+			}
+			double mean = (double) getMeanMicros();
+			double sumOfSquares = 0;
+			for (int index = 0; index < count; ++index) {
+				double diff = samples[index] - mean;
+				sumOfSquares += diff * diff;
+			}
+			return (int64) sqrt(sumOfSquares / (count - 1));
+		}
+
+		int64 LatencyEstimator::getQuantileMicros(double exceedProbability) const {
+			double result = getMeanMicros() + getNormalQuantile(exceedProbability) * getJitterMicros();
+			return (int64) max(0.0, result);
+		}
+
+		double LatencyEstimator::getNormalQuantile(double exceedProbability) {
+			double probability = min(max(exceedProbability, 1e-9), 1.0 - 1e-9);
+			if (probability > 0.5) {
+				return -getNormalQuantile(1.0 - probability);
+			}
+			// Abramowitz and Stegun 26.2.23, error below 4.5e-4
+			double t = sqrt(-2.0 * log(probability));
+			return t - (2.515517 + 0.802853 * t + 0.010328 * t * t) /
+				(1.0 + 1.432788 * t + 0.189269 * t * t + 0.001308 * t * t * t);
+		}
+
+		int64 LatencyEstimator::getCurrentMicros() {
+			return std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+	}
+}//end namespace
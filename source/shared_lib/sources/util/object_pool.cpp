@@ -0,0 +1,111 @@
+// ==============================================================
+//	This file is part of ZetaGlest Shared Library (www.zetaglest.org)
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 3 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "object_pool.h"
+
+#include <new>
+#include "platform_common.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Platform;
+
+namespace Shared {
+	namespace Util {
+
+		// blocks keep the alignment the global operator new gives
+		static const size_t blockAlignment = 16;
+
+		// =====================================================
+		//	class ObjectPool
+		// =====================================================
+
+		ObjectPool::ObjectPool(size_t objectSize, int blocksPerChunk) : mutex(CODE_AT_LINE) {
+			if (objectSize < sizeof(void *)) {
+				objectSize = sizeof(void *);
+			}
+			this->blockSize = (objectSize + blockAlignment - 1) / blockAlignment * blockAlignment;
+			this->blocksPerChunk = (blocksPerChunk > 0 ? blocksPerChunk : 1);
+			this->freeList = NULL;
+			this->usedCount = 0;
+			this->freeCount = 0;
+		}
+
+		ObjectPool::~ObjectPool() {
+			// objects still alive at exit keep their chunk
+			if (usedCount == 0) {
+				for (unsigned int i = 0; i < chunks.size(); ++i) {
+					::operator delete(chunks[i]);
+				}
+				chunks.clear();
+			}
+		}
+
+		void ObjectPool::addChunk() {
+			char *chunk = static_cast<char *>(::operator new(blockSize * blocksPerChunk));
+			chunks.push_back(chunk);
+			// thread the new blocks onto the free list, lowest address first
+			for (int i = blocksPerChunk - 1; i >= 0; --i) {
+				void *block = chunk + i * blockSize;
+				*static_cast<void **>(block) = freeList;
+				freeList = block;
+			}
+			freeCount += blocksPerChunk;
+		}
+
+		void *ObjectPool::allocate(size_t size) {
+			if (size > blockSize) {
+				return ::operator new(size);
+			}
+
+			MutexSafeWrapper safeMutex(&mutex, CODE_AT_LINE);
+			if (freeList == NULL) {
+				addChunk();
+			}
+			void *block = freeList;
+			freeList = *static_cast<void **>(block);
+			freeCount--;
+			usedCount++;
+			return block;
+		}
+
+		void ObjectPool::release(void *block, size_t size) {
+			if (block == NULL) {
+				return;
+			}
+			if (size > blockSize) {
+				::operator delete(block);
+				return;
+			}
+
+			MutexSafeWrapper safeMutex(&mutex, CODE_AT_LINE);
+			*static_cast<void **>(block) = freeList;
+			freeList = block;
+			freeCount++;
+			usedCount--;
+		}
+
+		int ObjectPool::getUsedCount() {
+			MutexSafeWrapper safeMutex(&mutex, CODE_AT_LINE);
+			return usedCount;
+		}
+
+		int ObjectPool::getFreeCount() {
+			MutexSafeWrapper safeMutex(&mutex, CODE_AT_LINE);
+			return freeCount;
+		}
+
+		int ObjectPool::getChunkCount() {
+			MutexSafeWrapper safeMutex(&mutex, CODE_AT_LINE);
+			return (int) chunks.size();
+		}
+
+	}
+}//end namespace
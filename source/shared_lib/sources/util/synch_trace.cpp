@@ -0,0 +1,198 @@
+// ==============================================================
+//	This file is part of ZetaGlest Shared Library (www.zetaglest.org)
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 3 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "synch_trace.h"
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include "byte_order.h"
+#include "conversion.h"
+#include "platform_util.h"
+#include "util.h"
+#include "leak_dumper.h"
+
+using namespace std;
+using namespace Shared::PlatformByteOrder;
+
+namespace Shared {
+	namespace Util {
+
+		// =====================================================
+		//	class SynchTrace
+		// =====================================================
+
+		const char SynchTrace::fileId[4] = { 'Z', 'G', 'S', 'T' };
+		const int32 SynchTrace::fileVersion = 1;
+
+		SynchTrace::SynchTrace() {
+			nextRecord = 0;
+			wrapped = false;
+		}
+
+		void SynchTrace::init(unsigned int capacity) {
+			records.assign(capacity, SynchTraceRecord());
+			nextRecord = 0;
+			wrapped = false;
+		}
+
+		void SynchTrace::clear() {
+			nextRecord = 0;
+			wrapped = false;
+		}
+
+		void SynchTrace::getRecords(std::vector<SynchTraceRecord> &result) const {
+			result.clear();
+			if (wrapped == false) {
+				result.insert(result.end(), records.begin(), records.begin() + nextRecord);
+				return;
+			}
+
+			result.reserve(records.size());
+			result.insert(result.end(), records.begin() + nextRecord, records.end());
+			result.insert(result.end(), records.begin(), records.begin() + nextRecord);
+
+			// the start of the oldest frame was overwritten
+			unsigned int firstComplete = 0;
+			while (firstComplete < result.size() &&
+				result[firstComplete].frame == result.front().frame) {
+				firstComplete++;
+			}
+			result.erase(result.begin(), result.begin() + firstComplete);
+		}
+
+		void SynchTrace::save(const string &path) const {
+			std::vector<SynchTraceRecord> orderedRecords;
+			getRecords(orderedRecords);
+
+#ifdef WIN32
+			FILE *f = _wfopen(utf8_decode(path).c_str(), L"wb");
+#else
+			FILE *f = fopen(path.c_str(), "wb");
+#endif
+			if (f == NULL) {
+				throw megaglest_runtime_error("Cant open file for writing: [" + path + "]");
+			}
+
+			int32 header[2] = {
+				toCommonEndian(fileVersion),
+				toCommonEndian((int32) orderedRecords.size())
+			};
+			bool ok = (fwrite(fileId, sizeof(fileId), 1, f) == 1 &&
+				fwrite(header, sizeof(header), 1, f) == 1);
+			for (unsigned int i = 0; ok == true && i < orderedRecords.size(); ++i) {
+				const SynchTraceRecord &record = orderedRecords[i];
+				int32 values[4] = {
+					toCommonEndian(record.frame),
+					toCommonEndian(record.id),
+					toCommonEndian(record.tag),
+					toCommonEndian(record.value)
+				};
+				ok = (fwrite(values, sizeof(values), 1, f) == 1);
+			}
+			fclose(f);
+
+			if (ok == false) {
+				throw megaglest_runtime_error("Error writing synch trace file: [" + path + "]");
+			}
+		}
+
+		void SynchTrace::load(const string &path, std::vector<SynchTraceRecord> &result) {
+			result.clear();
+
+#ifdef WIN32
+			FILE *f = _wfopen(utf8_decode(path).c_str(), L"rb");
+#else
+			FILE *f = fopen(path.c_str(), "rb");
+#endif
+			if (f == NULL) {
+				throw megaglest_runtime_error("Error opening synch trace file: [" + path + "]");
+			}
+
+			char id[4] = { 0, 0, 0, 0 };
+			int32 header[2] = { 0, 0 };
+			if (fread(id, sizeof(id), 1, f) != 1 || memcmp(id, fileId, sizeof(fileId)) != 0 ||
+				fread(header, sizeof(header), 1, f) != 1) {
+				fclose(f);
+				throw megaglest_runtime_error("Not a synch trace file: [" + path + "]");
+			}
+			int32 version = fromCommonEndian(header[0]);
+			int32 recordCount = fromCommonEndian(header[1]);
+			if (version != fileVersion || recordCount < 0) {
+				fclose(f);
+				throw megaglest_runtime_error("Unsupported synch trace file version " +
+					intToStr(version) + ": [" + path + "]");
+			}
+
+			result.reserve(recordCount);
+			for (int32 i = 0; i < recordCount; ++i) {
+				int32 values[4];
+				if (fread(values, sizeof(values), 1, f) != 1) {
+					fclose(f);
+					throw megaglest_runtime_error("Truncated synch trace file: [" + path + "]");
+				}
+				result.push_back(SynchTraceRecord(fromCommonEndian(values[0]),
+					fromCommonEndian(values[1]), fromCommonEndian(values[2]),
+					fromCommonEndian(values[3])));
+			}
+			fclose(f);
+		}
+
+		bool SynchTrace::findFirstDivergence(const std::vector<SynchTraceRecord> &first,
+			const std::vector<SynchTraceRecord> &second,
+			SynchTraceDivergence &result) {
+			result = SynchTraceDivergence();
+			if (first.empty() == true || second.empty() == true) {
+				return false;
+			}
+
+			int32 startFrame = max(first.front().frame, second.front().frame);
+			int32 endFrame = min(first.back().frame, second.back().frame);
+
+			unsigned int i = 0;
+			while (i < first.size() && first[i].frame < startFrame) {
+				i++;
+			}
+			unsigned int j = 0;
+			while (j < second.size() && second[j].frame < startFrame) {
+				j++;
+			}
+
+			for (int recordIndex = 0;; ++recordIndex, ++i, ++j) {
+				bool hasFirst = (i < first.size() && first[i].frame <= endFrame);
+				bool hasSecond = (j < second.size() && second[j].frame <= endFrame);
+				if (hasFirst == false && hasSecond == false) {
+					return false;
+				}
+				if (hasFirst == true && hasSecond == true && first[i] == second[j]) {
+					continue;
+				}
+				// one trace may have been saved part way through its last frame
+				if (hasFirst != hasSecond &&
+					(hasFirst ? first[i].frame : second[j].frame) == endFrame) {
+					return false;
+				}
+
+				result.recordIndex = recordIndex;
+				result.firstMissing = (hasFirst == false);
+				result.secondMissing = (hasSecond == false);
+				if (hasFirst == true) {
+					result.first = first[i];
+				}
+				if (hasSecond == true) {
+					result.second = second[j];
+				}
+				return true;
+			}
+		}
+
+	}
+}//end namespace
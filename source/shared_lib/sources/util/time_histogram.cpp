@@ -0,0 +1,76 @@
+// ==============================================================
+//	This file is part of ZetaGlest Shared Library (www.zetaglest.org)
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 3 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "time_histogram.h"
+
+#include <cstdio>
+#include <algorithm>
+#include "leak_dumper.h"
+
+using namespace std;
+
+namespace Shared {
+	namespace Util {
+
+		// =====================================================
+		//	class TimeHistogram
+		// =====================================================
+
+		TimeHistogram::TimeHistogram(int bucketMicros, int bucketCount) {
+			this->bucketMicros = max(1, bucketMicros);
+			buckets.assign(max(1, bucketCount) + 1, 0);
+			count = 0;
+			totalMicros = 0;
+			maxMicros = 0;
+		}
+
+		void TimeHistogram::add(int64 micros) {
+			micros = max<int64>(0, micros);
+			int lastBucket = (int) buckets.size() - 1;
+			int bucket = (int) min<int64>(micros / bucketMicros, lastBucket);
+			buckets[bucket]++;
+			count++;
+			totalMicros += micros;
+			maxMicros = max(maxMicros, micros);
+		}
+
+		void TimeHistogram::clear() {
+			std::fill(buckets.begin(), buckets.end(), 0);
+			count = 0;
+			totalMicros = 0;
+			maxMicros = 0;
+		}
+
+		double TimeHistogram::getPercentileMillis(double percentile) const {
+			int wanted = (int) (count * percentile);
+			int seen = 0;
+			int lastBucket = (int) buckets.size() - 1;
+			for (int bucket = 0; bucket < lastBucket; ++bucket) {
+				seen += buckets[bucket];
+				if (seen > wanted) {
+					return (bucket + 1) * (double) bucketMicros / 1000.0;
+				}
+			}
+			// the last bucket has no upper end
+			return maxMicros / 1000.0;
+		}
+
+		string TimeHistogram::getReport(const string &sampleName) const {
+			char szBuf[8096] = "";
+			snprintf(szBuf, 8096, "%d %s, mean %.3f ms, p50 %.1f ms, p95 %.1f ms, p99 %.1f ms, max %.2f ms",
+				count, sampleName.c_str(), (count > 0 ? totalMicros / 1000.0 / count : 0.0),
+				getPercentileMillis(0.50), getPercentileMillis(0.95),
+				getPercentileMillis(0.99), maxMicros / 1000.0);
+			return szBuf;
+		}
+
+	}
+}//end namespace
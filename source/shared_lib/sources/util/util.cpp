@@ -327,6 +327,10 @@ namespace Shared {
 		void SystemFlags::Close() {
 			if (SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__);
 
+#ifdef MUTEX_PROFILING
+			printf("Mutex lock sites by total wait time:\n%s", Shared::Platform::MutexLockSite::getReport(25).c_str());
+#endif
+
 			if (threadLogger != NULL) {
 				SystemFlags::ENABLE_THREADED_LOGGING = false;
 				//SystemFlags::SHUTDOWN_PROGRAM_MODE=true;
@@ -428,7 +432,7 @@ namespace Shared {
 				SystemFlags::ENABLE_THREADED_LOGGING &&
 				threadLogger != NULL &&
 				threadLogger->getRunningStatus() == true) {
-				threadLogger->addLogEntry(type, szBuf);
+				threadLogger->addLogEntry(type, szBuf, strlen(szBuf));
 			} else {
 				// Get the current time.
 				time_t curtime = time(NULL);
@@ -562,7 +566,7 @@ namespace Shared {
 					}
 
 					if (currentDebugLog.fileStream->is_open() == true) {
-						MutexSafeWrapper safeMutex(currentDebugLog.mutex, string(extractFileFromDirectoryPath(__FILE__).c_str()) + "_" + intToStr(__LINE__));
+						MutexSafeWrapper safeMutex(currentDebugLog.mutex, CODE_AT_LINE);
 
 						(*currentDebugLog.fileStream) << "Starting ZetaGlest logging for type: " << type << "\n";
 						(*currentDebugLog.fileStream).flush();
@@ -574,7 +578,7 @@ namespace Shared {
 				assert(currentDebugLog.fileStream != NULL);
 
 				if (currentDebugLog.fileStream->is_open() == true) {
-					static string mutexCodeLocation = string(extractFileFromDirectoryPath(__FILE__).c_str()) + "_" + intToStr(__LINE__);
+					static const char *mutexCodeLocation = CODE_AT_LINE;
 					MutexSafeWrapper safeMutex(currentDebugLog.mutex, mutexCodeLocation);
 
 					// All items in the if clause we don't want timestamps
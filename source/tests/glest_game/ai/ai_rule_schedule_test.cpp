@@ -0,0 +1,99 @@
+// ==============================================================
+//	This file is part of ZetaGlest Unit Tests (www.zetaglest.org)
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 3 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <algorithm>
+#include "ai_rule_schedule.h"
+
+using namespace Glest::Game;
+
+//
+// Tests for the AI rule schedule
+//
+class AiRuleScheduleTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( AiRuleScheduleTest );
+
+	CPPUNIT_TEST( test_short_intervals_run_every_frame );
+	CPPUNIT_TEST( test_unstaggered_rules_pile_up );
+	CPPUNIT_TEST( test_staggered_rules_spread );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+	static const int updateFps = 40;
+	static const int factionCount = 4;
+	// one schedule period: every interval below divides it
+	static const int frameCount = 2400;
+
+	// test intervals of the rules in the order Ai::init adds them, the
+	// resource producer rule at its short interval
+	static int getRuleInterval(int ruleIndex) {
+		static const int intervals[] = {
+			1000, 20000, 10000, 3000, 5000, 1000, 5000, 5000,
+			10000, 2000, 1000, 2000, 30000, 10000, 10000
+		};
+		return intervals[ruleIndex];
+	}
+	static int getRuleCount() {
+		return 15;
+	}
+
+	// rules tested on the busiest frame and in total over one period
+	static void countDueRules(bool stagger, int &maxPerFrame, int &total) {
+		maxPerFrame = 0;
+		total = 0;
+		for (int timer = 0; timer < frameCount; ++timer) {
+			int dueCount = 0;
+			for (int factionIndex = 1; factionIndex <= factionCount; ++factionIndex) {
+				for (int ruleIndex = 0; ruleIndex < getRuleCount(); ++ruleIndex) {
+					int intervalFrames = AiRuleSchedule::getIntervalFrames(getRuleInterval(ruleIndex), updateFps);
+					int phase = AiRuleSchedule::getPhase(ruleIndex, factionIndex, intervalFrames, stagger);
+					if (AiRuleSchedule::isDue(timer, phase, intervalFrames) == true) {
+						dueCount++;
+					}
+				}
+			}
+			maxPerFrame = std::max(maxPerFrame, dueCount);
+			total += dueCount;
+		}
+	}
+
+public:
+
+	void test_short_intervals_run_every_frame() {
+		CPPUNIT_ASSERT_EQUAL( 0, AiRuleSchedule::getPhase(3, 2, 1, true) );
+		CPPUNIT_ASSERT( AiRuleSchedule::isDue(5, 0, 1) );
+		CPPUNIT_ASSERT( AiRuleSchedule::isDue(5, 0, 0) );
+	}
+
+	void test_unstaggered_rules_pile_up() {
+		int maxPerFrame = 0;
+		int total = 0;
+		countDueRules(false, maxPerFrame, total);
+		// every rule of every faction on frame 0
+		CPPUNIT_ASSERT_EQUAL( getRuleCount() * factionCount, maxPerFrame );
+		CPPUNIT_ASSERT_EQUAL( 1300, total );
+	}
+
+	void test_staggered_rules_spread() {
+		int maxPerFrame = 0;
+		int total = 0;
+		countDueRules(true, maxPerFrame, total);
+		// the same number of tests, at most two on any frame
+		CPPUNIT_ASSERT_EQUAL( 1300, total );
+		CPPUNIT_ASSERT( maxPerFrame <= 2 );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( AiRuleScheduleTest );
+//
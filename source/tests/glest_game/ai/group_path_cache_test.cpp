@@ -0,0 +1,89 @@
+// ==============================================================
+//	This file is part of ZetaGlest Unit Tests (www.zetaglest.org)
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 3 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "group_path_cache.h"
+
+using namespace Glest::Game;
+
+//
+// Tests for the command group paths shared by the path finder
+//
+class GroupPathCacheTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( GroupPathCacheTest );
+
+	CPPUNIT_TEST( test_join_radius );
+	CPPUNIT_TEST( test_join_prefers_later_cell );
+	CPPUNIT_TEST( test_evicts_in_insertion_order );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+	static GroupPath makeLine(int length) {
+		GroupPath path;
+		for (int x = 0; x < length; ++x) {
+			path.cells.push_back(Vec2i(x, 0));
+		}
+		return path;
+	}
+
+public:
+
+	void test_join_radius() {
+		GroupPath path = makeLine(5);
+		// every cell is 3 away, which is still close enough
+		CPPUNIT_ASSERT_EQUAL( 4, path.findJoinIndex(Vec2i(2, 3), 3) );
+		CPPUNIT_ASSERT_EQUAL( -1, path.findJoinIndex(Vec2i(2, 4), 3) );
+		CPPUNIT_ASSERT_EQUAL( 4, path.findJoinIndex(Vec2i(7, 0), 3) );
+		CPPUNIT_ASSERT_EQUAL( -1, path.findJoinIndex(Vec2i(8, 0), 3) );
+		CPPUNIT_ASSERT_EQUAL( -1, GroupPath().findJoinIndex(Vec2i(0, 0), 3) );
+	}
+
+	void test_join_prefers_later_cell() {
+		GroupPath path = makeLine(5);
+		// cells 1, 2 and 3 are all 1 cell away
+		CPPUNIT_ASSERT_EQUAL( 3, path.findJoinIndex(Vec2i(2, 1), 3) );
+		// the closer cell wins over a later one
+		CPPUNIT_ASSERT_EQUAL( 0, path.findJoinIndex(Vec2i(-1, 0), 3) );
+	}
+
+	void test_evicts_in_insertion_order() {
+		GroupPathCache cache;
+		// ids counted per peer, so a newer group can have a lower id
+		cache.add(50, 3).targetPos = Vec2i(50, 0);
+		cache.add(7, 3).targetPos = Vec2i(7, 0);
+		cache.add(20, 3).targetPos = Vec2i(20, 0);
+		CPPUNIT_ASSERT_EQUAL( 3, cache.size() );
+
+		// storing an existing group again keeps its place
+		cache.add(50, 3).targetPos = Vec2i(51, 0);
+		CPPUNIT_ASSERT_EQUAL( 3, cache.size() );
+		CPPUNIT_ASSERT_EQUAL( 50, cache.getGroupId(0) );
+
+		cache.add(3, 3);
+		CPPUNIT_ASSERT_EQUAL( 3, cache.size() );
+		CPPUNIT_ASSERT( cache.find(50) == NULL );
+		CPPUNIT_ASSERT( cache.find(7) != NULL );
+		CPPUNIT_ASSERT( cache.find(20) != NULL );
+		CPPUNIT_ASSERT( cache.find(3) != NULL );
+		CPPUNIT_ASSERT_EQUAL( 7, cache.getGroupId(0) );
+		CPPUNIT_ASSERT_EQUAL( 3, cache.getGroupId(2) );
+
+		cache.clear();
+		CPPUNIT_ASSERT_EQUAL( 0, cache.size() );
+		CPPUNIT_ASSERT( cache.find(7) == NULL );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( GroupPathCacheTest );
+//
@@ -14,6 +14,7 @@
 #include "font.h"
 #include <vector>
 #include <algorithm>
+#include <cstdio>
 
 #ifdef WIN32
 #include <io.h>
@@ -32,12 +33,70 @@ class FontTest : public CppUnit::TestFixture {
 
 	CPPUNIT_TEST( test_LTR_RTL_Mixed );
 	CPPUNIT_TEST( test_bidi_newline_handling );
+	CPPUNIT_TEST( test_text_layout_parts );
+	CPPUNIT_TEST( test_text_layout_cache );
 
 	CPPUNIT_TEST_SUITE_END();
 	// End of Fixture registration
 
 public:
 
+	void test_text_layout_parts() {
+		std::vector<string> parts;
+		TextLayout::splitParts("no specials", parts);
+		CPPUNIT_ASSERT_EQUAL( 0,(int)parts.size() );
+
+		TextLayout::splitParts("HP:\t90\nArmor", parts);
+		CPPUNIT_ASSERT_EQUAL( 5,(int)parts.size() );
+		CPPUNIT_ASSERT_EQUAL( string("HP:"),parts[0] );
+		CPPUNIT_ASSERT_EQUAL( string("\t"),parts[1] );
+		CPPUNIT_ASSERT_EQUAL( string("90"),parts[2] );
+		CPPUNIT_ASSERT_EQUAL( string("\n"),parts[3] );
+		CPPUNIT_ASSERT_EQUAL( string("Armor"),parts[4] );
+
+		TextLayout::splitParts("\n\nend", parts);
+		CPPUNIT_ASSERT_EQUAL( 3,(int)parts.size() );
+		CPPUNIT_ASSERT_EQUAL( string("end"),parts[2] );
+	}
+
+	void test_text_layout_cache() {
+		Font::fontIsMultibyte = false;
+		Font::fontIsRightToLeft = false;
+		Font::fontSupportMixedRightToLeft = false;
+
+		// a master server style list laid out on two consecutive frames
+		std::vector<string> serverList;
+		for(int i = 0; i < 200; ++i) {
+			char szBuf[256] = "";
+			snprintf(szBuf, 256, "Server %d\t192.168.0.%d\t4/8\tmegapack\tv3.13", i, i % 255);
+			serverList.push_back(szBuf);
+		}
+
+		FontMetrics metrics;
+		for(int i = 0; i < Font::charCount; ++i) {
+			metrics.setWidth(i, 2.f);
+		}
+		TextLayoutCache *layoutCache = metrics.getLayoutCache();
+
+		for(int frame = 0; frame < 2; ++frame) {
+			for(unsigned int i = 0; i < serverList.size(); ++i) {
+				TextLayout &layout = layoutCache->getLayout(serverList[i], true);
+				CPPUNIT_ASSERT_EQUAL( serverList[i],layout.renderText );
+				CPPUNIT_ASSERT_EQUAL( 9,(int)layout.parts.size() );
+			}
+		}
+		CPPUNIT_ASSERT_EQUAL( 200u,layoutCache->getMissCount() );
+		CPPUNIT_ASSERT_EQUAL( 200u,layoutCache->getHitCount() );
+
+		CPPUNIT_ASSERT_EQUAL( 10.f,metrics.getTextWidth("Lobby") );
+		CPPUNIT_ASSERT_EQUAL( 10.f,metrics.getTextWidth("Lobby") );
+		CPPUNIT_ASSERT_EQUAL( 201u,layoutCache->getHitCount() );
+
+		// changing a glyph width invalidates measured strings
+		metrics.setWidth('L', 4.f);
+		CPPUNIT_ASSERT_EQUAL( 12.f,metrics.getTextWidth("Lobby") );
+	}
+
 	void test_bidi_newline_handling() {
 
 		string text = "\n\nHP: 9000/9000\nArmor: 0 (Stone)\nSight: 15\nProduce Slave";
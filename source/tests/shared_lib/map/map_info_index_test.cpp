@@ -0,0 +1,133 @@
+// ==============================================================
+//	This file is part of ZetaGlest Unit Tests (www.zetaglest.org)
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 3 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <fstream>
+#include <iterator>
+#include "map_preview.h"
+#include "map_info_index.h"
+#include "platform_common.h"
+#include "platform_util.h"
+
+using namespace Shared::Map;
+using namespace Shared::PlatformCommon;
+using namespace Shared::Platform;
+
+static const string testFolder = "map_info_index_test/";
+
+//
+// Tests for the bulk map reader and the map info index
+//
+class MapInfoIndexTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( MapInfoIndexTest );
+
+	CPPUNIT_TEST( test_load_matches_saved_map );
+	CPPUNIT_TEST( test_preview_is_downsampled );
+	CPPUNIT_TEST( test_cut_off_map_is_refused );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+	string mapFile;
+	MapPreview savedMap;
+
+public:
+
+	void setUp() {
+		removeFolder(testFolder);
+		createDirectoryPaths(testFolder);
+		mapFile = testFolder + "test.gbm";
+
+		savedMap.reset(256, 128, 5.0f, st_Road);
+		savedMap.resetFactions(4);
+		savedMap.setTitle("Test map");
+		for (int i = 0; i < savedMap.getW(); ++i) {
+			for (int j = 0; j < savedMap.getH(); ++j) {
+				savedMap.setHeight(i, j, (float) ((i + j) % 20));
+				if ((i * 7 + j) % 11 == 0) {
+					savedMap.setObject(i, j, 3);
+				}
+			}
+		}
+		savedMap.changeStartLocation(100, 50, 2);
+		savedMap.saveToFile(mapFile);
+		MapInfoIndex::clear();
+	}
+
+	void tearDown() {
+		MapInfoIndex::clear();
+		removeFolder(testFolder);
+	}
+
+	void test_load_matches_saved_map() {
+		MapPreview loadedMap;
+		loadedMap.loadFromFile(mapFile);
+
+		CPPUNIT_ASSERT_EQUAL( 256, loadedMap.getW() );
+		CPPUNIT_ASSERT_EQUAL( 128, loadedMap.getH() );
+		CPPUNIT_ASSERT_EQUAL( 4, loadedMap.getMaxFactions() );
+		CPPUNIT_ASSERT_EQUAL( string("Test map"), loadedMap.getTitle() );
+		CPPUNIT_ASSERT_EQUAL( 100, loadedMap.getStartLocationX(2) );
+		for (int i = 0; i < loadedMap.getW(); ++i) {
+			for (int j = 0; j < loadedMap.getH(); ++j) {
+				CPPUNIT_ASSERT_EQUAL( savedMap.getHeight(i, j), loadedMap.getHeight(i, j) );
+				CPPUNIT_ASSERT_EQUAL( savedMap.getObject(i, j), loadedMap.getObject(i, j) );
+			}
+		}
+
+		MapInfo mapInfo;
+		CPPUNIT_ASSERT( MapPreview::loadMapInfo(mapFile, &mapInfo, "", "") );
+		CPPUNIT_ASSERT_EQUAL( 256, mapInfo.size.x );
+		CPPUNIT_ASSERT_EQUAL( 4, mapInfo.players );
+	}
+
+	void test_preview_is_downsampled() {
+		MapPreview preview;
+		preview.loadPreviewFromFile(mapFile);
+
+		// every fourth cell, so the longest side fits the preview
+		CPPUNIT_ASSERT_EQUAL( 64, preview.getW() );
+		CPPUNIT_ASSERT_EQUAL( 32, preview.getH() );
+		CPPUNIT_ASSERT_EQUAL( 25, preview.getStartLocationX(2) );
+		CPPUNIT_ASSERT_EQUAL( 12, preview.getStartLocationY(2) );
+		for (int i = 0; i < preview.getW(); ++i) {
+			for (int j = 0; j < preview.getH(); ++j) {
+				CPPUNIT_ASSERT_EQUAL( savedMap.getHeight(i * 4, j * 4), preview.getHeight(i, j) );
+				CPPUNIT_ASSERT_EQUAL( savedMap.getObject(i * 4, j * 4), preview.getObject(i, j) );
+			}
+		}
+
+		MapIndexEntry entry;
+		CPPUNIT_ASSERT( MapInfoIndex::getEntry(mapFile, entry) );
+		CPPUNIT_ASSERT( entry.valid );
+		CPPUNIT_ASSERT_EQUAL( string("Test map"), entry.title );
+		CPPUNIT_ASSERT( entry.crc != 0 );
+	}
+
+	void test_cut_off_map_is_refused() {
+		std::ifstream in(mapFile.c_str(), std::ios::binary);
+		string mapData((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+		in.close();
+		saveDataToFile(mapFile, mapData.substr(0, mapData.size() - 10));
+
+		MapPreview loadedMap;
+		CPPUNIT_ASSERT_THROW( loadedMap.loadFromFile(mapFile), megaglest_runtime_error );
+
+		MapIndexEntry entry;
+		CPPUNIT_ASSERT( MapInfoIndex::getEntry(mapFile, entry) );
+		CPPUNIT_ASSERT( entry.valid == false );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( MapInfoIndexTest );
+//
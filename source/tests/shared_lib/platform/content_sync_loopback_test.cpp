@@ -0,0 +1,215 @@
+// ==============================================================
+//	This file is part of ZetaGlest Unit Tests (www.zetaglest.org)
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 3 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <fstream>
+#include <iterator>
+#include "content_sync.h"
+#include "socket.h"
+#include "platform_common.h"
+#include "platform_util.h"
+
+using namespace Shared::PlatformCommon;
+using namespace Shared::Platform;
+
+static const string loopbackTestFolder = "content_sync_loopback_test/";
+static const string loopbackIp = "127.0.0.1";
+// in host byte order, as the server hands it to the validator
+static const uint32 loopbackIpAddress = 0x7F000001;
+// away from the default game, FTP and content sync ports
+static const int loopbackTestPort = 61470;
+
+static string readLoopbackTestFile(const string &path) {
+	std::ifstream in(path.c_str(), std::ios::binary);
+	return string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+static void writeLoopbackTestFile(const string &path, const string &data) {
+	createDirectoryPaths(extractDirectoryPathFromFile(path));
+	saveDataToFile(path, data);
+}
+
+static string getLoopbackTestData(int size, unsigned int seed) {
+	string data(size, '\0');
+	for (int i = 0; i < size; ++i) {
+		seed = seed * 1103515245 + 12345;
+		data[i] = (char) (seed >> 16);
+	}
+	return data;
+}
+
+// lets the tests choose whether the connecting client is a player
+class LoopbackClientValidator : public FTPClientValidationInterface {
+public:
+	int validClient;
+	int validationCount;
+	uint32 lastClientIp;
+
+	LoopbackClientValidator() : validClient(1), validationCount(0), lastClientIp(0) {
+	}
+
+	virtual int isValidClientType(uint32 clientIp) {
+		validationCount++;
+		lastClientIp = clientIp;
+		return validClient;
+	}
+	virtual int isClientAllowedToGetFile(uint32 clientIp, const char *username, const char *filename) {
+		return validClient;
+	}
+};
+
+// cancels the sync once cancelAfterBytes have arrived
+class LoopbackProgress : public ContentSyncProgressInterface {
+public:
+	int64 cancelAfterBytes;
+
+	LoopbackProgress() : cancelAfterBytes(-1) {
+	}
+
+	virtual bool ContentSync_Progress(const string &itemName, int64 bytesNow, int64 bytesTotal) {
+		return (cancelAfterBytes < 0 || bytesNow < cancelAfterBytes);
+	}
+};
+
+//
+// Tests for the content sync server and client talking over
+// a loopback connection
+//
+class ContentSyncLoopbackTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( ContentSyncLoopbackTest );
+
+	CPPUNIT_TEST( test_sync_over_loopback );
+	CPPUNIT_TEST( test_interrupted_sync_resumes );
+	CPPUNIT_TEST( test_unknown_client_is_refused );
+	CPPUNIT_TEST( test_item_not_shared );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+	string serverFolder;
+	string clientFolder;
+	LoopbackClientValidator validator;
+	ContentSyncServerThread *server;
+
+	// the model fits one block request, the map needs more
+	// blocks than the client asks for at once
+	static const int modelBlocks = 5;
+	static const int mapBlocks = 70;
+	static const int unitBlocks = 4;
+	static const int totalBlocks = 1 + modelBlocks + mapBlocks + unitBlocks;
+
+	bool syncTechtree(ContentSyncClient &client, string &errorText) {
+		return client.syncItem(csit_Techtree, "mod", clientFolder + "mod/", "", errorText);
+	}
+
+	void assertClientMatchesServer() {
+		const char *files[] = { "mod.xml", "units/model.g3d", "units/map.bin", "units/unit.xml" };
+		for (unsigned int i = 0; i < sizeof(files) / sizeof(files[0]); ++i) {
+			CPPUNIT_ASSERT_MESSAGE( files[i], readLoopbackTestFile(clientFolder + "mod/" + files[i]) ==
+				readLoopbackTestFile(serverFolder + "mod/" + files[i]) );
+		}
+	}
+
+public:
+
+	void setUp() {
+		removeFolder(loopbackTestFolder);
+		serverFolder = loopbackTestFolder + "server/techs/";
+		clientFolder = loopbackTestFolder + "client/techs/";
+
+		writeLoopbackTestFile(serverFolder + "mod/mod.xml", "<tech-tree/>");
+		writeLoopbackTestFile(serverFolder + "mod/units/model.g3d",
+			getLoopbackTestData(modelBlocks * ContentSyncManifest::blockSize - 1000, 1));
+		writeLoopbackTestFile(serverFolder + "mod/units/map.bin",
+			getLoopbackTestData(mapBlocks * ContentSyncManifest::blockSize, 2));
+		writeLoopbackTestFile(serverFolder + "mod/units/unit.xml", string(200000, 'a'));
+
+		validator = LoopbackClientValidator();
+		server = new ContentSyncServerThread(loopbackTestPort, &validator);
+		server->addFolder(csit_Techtree, serverFolder);
+		server->start();
+		// the socket listens once the thread runs
+		for (int waited = 0; server->getRunningStatus() == false && waited < 2000; waited += 10) {
+			sleep(10);
+		}
+		sleep(100);
+	}
+
+	void tearDown() {
+		server->shutdownAndWait();
+		delete server;
+		server = NULL;
+		removeFolder(loopbackTestFolder);
+	}
+
+	void test_sync_over_loopback() {
+		ContentSyncClient client(loopbackIp, loopbackTestPort);
+		string errorText;
+		CPPUNIT_ASSERT_MESSAGE( errorText, syncTechtree(client, errorText) );
+		CPPUNIT_ASSERT_EQUAL( totalBlocks, client.getBlocksReceived() );
+		assertClientMatchesServer();
+		// unit.xml is deflated on the wire
+		CPPUNIT_ASSERT( client.getBytesReceived() < (int64) (readLoopbackTestFile(serverFolder + "mod/units/map.bin").size() +
+			readLoopbackTestFile(serverFolder + "mod/units/model.g3d").size() + 200000) );
+
+		CPPUNIT_ASSERT_EQUAL( 1, validator.validationCount );
+		CPPUNIT_ASSERT_EQUAL( loopbackIpAddress, validator.lastClientIp );
+
+		// an up to date copy only costs the manifest
+		CPPUNIT_ASSERT_MESSAGE( errorText, syncTechtree(client, errorText) );
+		CPPUNIT_ASSERT_EQUAL( 0, client.getBlocksReceived() );
+	}
+
+	void test_interrupted_sync_resumes() {
+		LoopbackProgress progress;
+		progress.cancelAfterBytes = 10 * ContentSyncManifest::blockSize;
+		ContentSyncClient client(loopbackIp, loopbackTestPort, &progress);
+		string errorText;
+		CPPUNIT_ASSERT( syncTechtree(client, errorText) == false );
+		CPPUNIT_ASSERT_EQUAL( string("cancelled"), errorText );
+		int blocksBeforeBreak = client.getBlocksReceived();
+		CPPUNIT_ASSERT( blocksBeforeBreak > 0 && blocksBeforeBreak < totalBlocks );
+		CPPUNIT_ASSERT( fileExists(clientFolder + "mod/units/map.bin") == false );
+
+		// only the blocks that never arrived are fetched again
+		progress.cancelAfterBytes = -1;
+		CPPUNIT_ASSERT_MESSAGE( errorText, syncTechtree(client, errorText) );
+		CPPUNIT_ASSERT_EQUAL( totalBlocks - blocksBeforeBreak, client.getBlocksReceived() );
+		assertClientMatchesServer();
+		CPPUNIT_ASSERT( fileExists(clientFolder + "mod/units/map.bin" + ContentSyncTarget::partialFileExtension) == false );
+		CPPUNIT_ASSERT( fileExists(clientFolder + "mod/units/model.g3d" + ContentSyncTarget::partialFileExtension) == false );
+	}
+
+	void test_unknown_client_is_refused() {
+		validator.validClient = 0;
+		ContentSyncClient client(loopbackIp, loopbackTestPort);
+		string errorText;
+		CPPUNIT_ASSERT( syncTechtree(client, errorText) == false );
+		CPPUNIT_ASSERT_EQUAL( 0, client.getBlocksReceived() );
+		CPPUNIT_ASSERT( folderExists(clientFolder + "mod/") == false );
+		CPPUNIT_ASSERT_EQUAL( 1, validator.validationCount );
+		CPPUNIT_ASSERT_EQUAL( loopbackIpAddress, validator.lastClientIp );
+	}
+
+	void test_item_not_shared() {
+		ContentSyncClient client(loopbackIp, loopbackTestPort);
+		string errorText;
+		CPPUNIT_ASSERT( client.syncItem(csit_Techtree, "missing", clientFolder + "missing/", "", errorText) == false );
+		CPPUNIT_ASSERT( errorText.find("is not shared") != string::npos );
+		CPPUNIT_ASSERT( client.syncItem(csit_Tileset, "mod", clientFolder + "mod/", "", errorText) == false );
+		CPPUNIT_ASSERT_EQUAL( 0, client.getBlocksReceived() );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( ContentSyncLoopbackTest );
+//
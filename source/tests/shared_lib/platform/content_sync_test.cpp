@@ -0,0 +1,186 @@
+// ==============================================================
+//	This file is part of ZetaGlest Unit Tests (www.zetaglest.org)
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 3 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <fstream>
+#include <iterator>
+#include "content_sync.h"
+#include "platform_common.h"
+#include "checksum.h"
+
+using namespace Shared::PlatformCommon;
+using namespace Shared::Util;
+
+static const string testFolder = "content_sync_test/";
+
+static string readTestFile(const string &path) {
+	std::ifstream in(path.c_str(), std::ios::binary);
+	return string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+static void writeTestFile(const string &path, const string &data) {
+	createDirectoryPaths(extractDirectoryPathFromFile(path));
+	saveDataToFile(path, data);
+}
+
+static string getTestData(int size, unsigned int seed) {
+	string data(size, '\0');
+	for (int i = 0; i < size; ++i) {
+		seed = seed * 1103515245 + 12345;
+		data[i] = (char) (seed >> 16);
+	}
+	return data;
+}
+
+//
+// Tests for the block based content sync, with the server side
+// source feeding the client side target directly
+//
+class ContentSyncTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( ContentSyncTest );
+
+	CPPUNIT_TEST( test_manifest_round_trip );
+	CPPUNIT_TEST( test_only_changed_blocks_are_sent );
+	CPPUNIT_TEST( test_interrupted_sync_resumes );
+	CPPUNIT_TEST( test_unsafe_paths_are_refused );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+	string serverFolder;
+	string clientFolder;
+
+	// blocks sent, or -1 when the sync did not finish; stops
+	// after blockLimit blocks to simulate a broken connection
+	int syncTechtree(const string &destFolder, const string &baseFolder, int blockLimit = -1) {
+		ContentSyncSource source;
+		source.addFolder(csit_Techtree, serverFolder);
+		ContentSyncManifest manifest;
+		CPPUNIT_ASSERT( source.getManifest(csit_Techtree, "mod", manifest) );
+
+		ContentSyncTarget target(csit_Techtree, destFolder, baseFolder);
+		target.setRemoteManifest(manifest);
+		std::map<int, vector<int> > neededBlocks = target.getNeededBlocks();
+
+		int blocksSent = 0;
+		for (std::map<int, vector<int> >::iterator iterMap = neededBlocks.begin();
+			iterMap != neededBlocks.end(); ++iterMap) {
+			for (unsigned int i = 0; i < iterMap->second.size(); ++i) {
+				if (blockLimit >= 0 && blocksSent >= blockLimit) {
+					return -1;
+				}
+				string blockData;
+				bool compressed = false;
+				CPPUNIT_ASSERT( source.getBlock(csit_Techtree, "mod", manifest.files[iterMap->first].path,
+					iterMap->second[i], blockData, compressed) );
+				CPPUNIT_ASSERT( target.applyBlock(iterMap->first, iterMap->second[i], blockData, compressed) );
+				blocksSent++;
+			}
+		}
+		string errorText;
+		CPPUNIT_ASSERT_MESSAGE( errorText, target.finish(errorText) );
+		return blocksSent;
+	}
+
+	// the server builds its manifest from the cached folder checksums
+	void changeServerFile(const string &path, const string &data) {
+		writeTestFile(serverFolder + "mod/" + path, data);
+		clearFolderTreeContentsCheckSumList(serverFolder + "mod/*", "");
+		Checksum::clearFileCache();
+	}
+
+public:
+
+	void setUp() {
+		removeFolder(testFolder);
+		serverFolder = testFolder + "server/techs/";
+		clientFolder = testFolder + "client/techs/";
+
+		changeServerFile("mod.xml", "<tech-tree/>");
+		changeServerFile("units/model.g3d", getTestData(300000, 1));
+		changeServerFile("units/unit.xml", string(200000, 'a'));
+	}
+
+	void tearDown() {
+		removeFolder(testFolder);
+	}
+
+	void test_manifest_round_trip() {
+		ContentSyncManifest manifest;
+		manifest.buildFromFolder(serverFolder + "mod/");
+		CPPUNIT_ASSERT_EQUAL( (size_t) 3, manifest.files.size() );
+		CPPUNIT_ASSERT_EQUAL( (int64) 500012, manifest.getTotalSize() );
+
+		const ContentSyncFile *model = manifest.findFile("units/model.g3d");
+		CPPUNIT_ASSERT( model != NULL );
+		CPPUNIT_ASSERT_EQUAL( 5, model->getBlockCount() );
+		CPPUNIT_ASSERT_EQUAL( 300000 - 4 * ContentSyncManifest::blockSize, model->getBlockSize(4) );
+
+		ContentSyncManifest copy;
+		CPPUNIT_ASSERT( copy.fromBytes(manifest.toBytes()) );
+		CPPUNIT_ASSERT( copy.toBytes() == manifest.toBytes() );
+	}
+
+	void test_only_changed_blocks_are_sent() {
+		CPPUNIT_ASSERT_EQUAL( 5 + 4 + 1, syncTechtree(clientFolder + "mod/", "") );
+		CPPUNIT_ASSERT( readTestFile(clientFolder + "mod/units/model.g3d") ==
+			readTestFile(serverFolder + "mod/units/model.g3d") );
+		CPPUNIT_ASSERT_EQUAL( 0, syncTechtree(clientFolder + "mod/", "") );
+
+		string model = readTestFile(serverFolder + "mod/units/model.g3d");
+		model[70000] ^= 1;
+		changeServerFile("units/model.g3d", model);
+		writeTestFile(clientFolder + "mod/units/stale.xml", "<unit/>");
+
+		CPPUNIT_ASSERT_EQUAL( 1, syncTechtree(clientFolder + "mod/", "") );
+		CPPUNIT_ASSERT( readTestFile(clientFolder + "mod/units/model.g3d") == model );
+		CPPUNIT_ASSERT( fileExists(clientFolder + "mod/units/stale.xml") == false );
+
+		// a fresh user folder takes everything from the installed copy
+		CPPUNIT_ASSERT_EQUAL( 0, syncTechtree(testFolder + "user/techs/mod/", clientFolder + "mod/") );
+		CPPUNIT_ASSERT( readTestFile(testFolder + "user/techs/mod/units/model.g3d") == model );
+	}
+
+	void test_interrupted_sync_resumes() {
+		CPPUNIT_ASSERT_EQUAL( 10, syncTechtree(clientFolder + "mod/", "") );
+
+		changeServerFile("units/model.g3d", getTestData(400000, 2));
+		CPPUNIT_ASSERT_EQUAL( -1, syncTechtree(clientFolder + "mod/", "", 3) );
+		CPPUNIT_ASSERT( fileExists(clientFolder + "mod/units/model.g3d" + ContentSyncTarget::partialFileExtension) );
+
+		CPPUNIT_ASSERT_EQUAL( 7 - 3, syncTechtree(clientFolder + "mod/", "") );
+		CPPUNIT_ASSERT( readTestFile(clientFolder + "mod/units/model.g3d") ==
+			readTestFile(serverFolder + "mod/units/model.g3d") );
+		CPPUNIT_ASSERT( fileExists(clientFolder + "mod/units/model.g3d" + ContentSyncTarget::partialFileExtension) == false );
+	}
+
+	void test_unsafe_paths_are_refused() {
+		ContentSyncSource source;
+		source.addFolder(csit_Techtree, serverFolder);
+		ContentSyncManifest manifest;
+		CPPUNIT_ASSERT( source.getManifest(csit_Techtree, "..", manifest) == false );
+		CPPUNIT_ASSERT( source.getManifest(csit_Techtree, "mod", manifest) );
+
+		string blockData;
+		bool compressed = false;
+		CPPUNIT_ASSERT( source.getBlock(csit_Techtree, "mod", "../../mod.xml", 0, blockData, compressed) == false );
+
+		ContentSyncManifest evil;
+		evil.files.resize(1);
+		evil.files[0].path = "../evil.xml";
+		CPPUNIT_ASSERT( manifest.fromBytes(evil.toBytes()) == false );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( ContentSyncTest );
+//
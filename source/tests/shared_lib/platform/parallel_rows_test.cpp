@@ -0,0 +1,89 @@
+// ==============================================================
+//	This file is part of ZetaGlest Unit Tests (www.zetaglest.org)
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 3 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <vector>
+#include "simple_threads.h"
+#include "platform_util.h"
+
+using namespace Shared::PlatformCommon;
+using namespace Shared::Platform;
+
+class CountRowsCallback : public ParallelRowsCallbackInterface {
+public:
+	std::vector<int> rowVisits;
+	int failRow;
+
+	CountRowsCallback(int rowCount, int failRow = -1)
+		: rowVisits(rowCount, 0), failRow(failRow) {
+	}
+
+	virtual void processRows(int firstRow, int endRow) {
+		for (int row = firstRow; row < endRow; ++row) {
+			// every band writes only its own rows
+			rowVisits[row]++;
+			if (row == failRow) {
+				throw megaglest_runtime_error("row failed");
+			}
+		}
+	}
+};
+
+//
+// Tests for ParallelRowsThread
+//
+class ParallelRowsTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( ParallelRowsTest );
+
+	CPPUNIT_TEST( test_every_row_once );
+	CPPUNIT_TEST( test_worker_count_limits );
+	CPPUNIT_TEST( test_worker_error_is_thrown );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_every_row_once() {
+		for (int workerCount = 1; workerCount <= 8; ++workerCount) {
+			CountRowsCallback callback(103);
+			ParallelRowsThread::run(&callback, 103, workerCount);
+			for (int row = 0; row < 103; ++row) {
+				CPPUNIT_ASSERT_EQUAL( 1, callback.rowVisits[row] );
+			}
+		}
+
+		// more workers than rows
+		CountRowsCallback callback(3);
+		ParallelRowsThread::run(&callback, 3, 8);
+		for (int row = 0; row < 3; ++row) {
+			CPPUNIT_ASSERT_EQUAL( 1, callback.rowVisits[row] );
+		}
+	}
+
+	void test_worker_count_limits() {
+		CPPUNIT_ASSERT_EQUAL( 4, ParallelRowsThread::getWorkerCount(512, 16, 4) );
+		CPPUNIT_ASSERT_EQUAL( 2, ParallelRowsThread::getWorkerCount(32, 16, 4) );
+		CPPUNIT_ASSERT_EQUAL( 1, ParallelRowsThread::getWorkerCount(8, 16, 4) );
+		CPPUNIT_ASSERT( ParallelRowsThread::getWorkerCount(512, 16) >= 1 );
+	}
+
+	void test_worker_error_is_thrown() {
+		// the last band always runs on a worker thread
+		CountRowsCallback callback(64, 63);
+		CPPUNIT_ASSERT_THROW( ParallelRowsThread::run(&callback, 64, 4), megaglest_runtime_error );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( ParallelRowsTest );
+//
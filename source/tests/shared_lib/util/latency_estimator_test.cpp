@@ -0,0 +1,96 @@
+// ==============================================================
+//	This file is part of ZetaGlest Unit Tests (www.zetaglest.org)
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 3 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "latency_estimator.h"
+#include "randomgen.h"
+
+using namespace Shared::Util;
+
+//
+// Tests for the round trip time estimator, fed with simulated
+// latency and jitter
+//
+class LatencyEstimatorTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( LatencyEstimatorTest );
+
+	CPPUNIT_TEST( test_normal_quantile );
+	CPPUNIT_TEST( test_steady_latency );
+	CPPUNIT_TEST( test_jitter_is_covered );
+	CPPUNIT_TEST( test_old_samples_leave_the_window );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_normal_quantile() {
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.0, LatencyEstimator::getNormalQuantile(0.5), 0.001 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 1.96, LatencyEstimator::getNormalQuantile(0.025), 0.001 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 2.326, LatencyEstimator::getNormalQuantile(0.01), 0.001 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( -1.96, LatencyEstimator::getNormalQuantile(0.975), 0.001 );
+	}
+
+	void test_steady_latency() {
+		LatencyEstimator estimator;
+		for (int i = 0; i < 100; ++i) {
+			estimator.addSample(40000);
+		}
+		CPPUNIT_ASSERT_EQUAL( 100, estimator.getSampleCount() );
+		CPPUNIT_ASSERT_EQUAL( (int64) 40000, estimator.getMeanMicros() );
+		CPPUNIT_ASSERT_EQUAL( (int64) 0, estimator.getJitterMicros() );
+		CPPUNIT_ASSERT_EQUAL( (int64) 40000, estimator.getQuantileMicros(0.01) );
+
+		estimator.clear();
+		CPPUNIT_ASSERT_EQUAL( 0, estimator.getSampleCount() );
+	}
+
+	void test_jitter_is_covered() {
+		// 40 ms with up to 15 ms of jitter either way
+		RandomGen random;
+		random.init(1234);
+		random.setDisableLastCallerTracking(true);
+
+		LatencyEstimator estimator;
+		for (int i = 0; i < 200; ++i) {
+			estimator.addSample(random.randRange(25000, 55000));
+		}
+		CPPUNIT_ASSERT( estimator.getMeanMicros() > 30000 );
+		CPPUNIT_ASSERT( estimator.getMeanMicros() < 50000 );
+		CPPUNIT_ASSERT( estimator.getJitterMicros() > 5000 );
+
+		// the 1% quantile has to cover nearly every later sample
+		int64 limit = estimator.getQuantileMicros(0.01);
+		int exceeded = 0;
+		for (int i = 0; i < 1000; ++i) {
+			if (random.randRange(25000, 55000) > limit) {
+				exceeded++;
+			}
+		}
+		CPPUNIT_ASSERT( exceeded <= 20 );
+	}
+
+	void test_old_samples_leave_the_window() {
+		LatencyEstimator estimator(4);
+		estimator.addSample(500000);
+		for (int i = 0; i < 4; ++i) {
+			estimator.addSample(20000);
+		}
+		CPPUNIT_ASSERT_EQUAL( 5, estimator.getSampleCount() );
+		CPPUNIT_ASSERT_EQUAL( (int64) 20000, estimator.getMeanMicros() );
+		CPPUNIT_ASSERT_EQUAL( (int64) 0, estimator.getJitterMicros() );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( LatencyEstimatorTest );
+//
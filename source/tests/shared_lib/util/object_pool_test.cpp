@@ -0,0 +1,106 @@
+// ==============================================================
+//	This file is part of ZetaGlest Unit Tests (www.zetaglest.org)
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 3 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cstring>
+#include <set>
+#include <vector>
+#include "object_pool.h"
+
+using namespace Shared::Util;
+
+//
+// Tests for the fixed size block pool and the generational slot table
+//
+class ObjectPoolTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( ObjectPoolTest );
+
+	CPPUNIT_TEST( test_blocks_are_reused );
+	CPPUNIT_TEST( test_blocks_do_not_overlap );
+	CPPUNIT_TEST( test_large_requests_use_heap );
+	CPPUNIT_TEST( test_stale_handles_are_refused );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_blocks_are_reused() {
+		ObjectPool pool(40, 8);
+		CPPUNIT_ASSERT_EQUAL( (size_t) 48, pool.getBlockSize() );
+
+		void *first = pool.allocate(40);
+		pool.release(first, 40);
+		void *second = pool.allocate(40);
+		CPPUNIT_ASSERT( first == second );
+		CPPUNIT_ASSERT_EQUAL( 1, pool.getUsedCount() );
+		CPPUNIT_ASSERT_EQUAL( 7, pool.getFreeCount() );
+		pool.release(second, 40);
+		CPPUNIT_ASSERT_EQUAL( 0, pool.getUsedCount() );
+	}
+
+	void test_blocks_do_not_overlap() {
+		ObjectPool pool(24, 4);
+		std::vector<char *> blocks;
+		std::set<char *> seen;
+		for (int i = 0; i < 10; ++i) {
+			char *block = static_cast<char *>(pool.allocate(24));
+			CPPUNIT_ASSERT( seen.insert(block).second );
+			CPPUNIT_ASSERT_EQUAL( (size_t) 0, (size_t) block % 16 );
+			memset(block, i, 24);
+			blocks.push_back(block);
+		}
+		CPPUNIT_ASSERT_EQUAL( 3, pool.getChunkCount() );
+		for (int i = 0; i < 10; ++i) {
+			for (int j = 0; j < 24; ++j) {
+				CPPUNIT_ASSERT_EQUAL( (char) i, blocks[i][j] );
+			}
+			pool.release(blocks[i], 24);
+		}
+		CPPUNIT_ASSERT_EQUAL( 0, pool.getUsedCount() );
+		CPPUNIT_ASSERT_EQUAL( 12, pool.getFreeCount() );
+	}
+
+	void test_large_requests_use_heap() {
+		ObjectPool pool(16, 4);
+		void *block = pool.allocate(100);
+		CPPUNIT_ASSERT( block != NULL );
+		CPPUNIT_ASSERT_EQUAL( 0, pool.getUsedCount() );
+		CPPUNIT_ASSERT_EQUAL( 0, pool.getChunkCount() );
+		pool.release(block, 100);
+	}
+
+	void test_stale_handles_are_refused() {
+		int a = 1;
+		int b = 2;
+		SlotTable<int> table;
+		SlotHandle handleA = table.add(&a);
+		CPPUNIT_ASSERT( table.get(handleA) == &a );
+		CPPUNIT_ASSERT( table.remove(handleA) );
+		CPPUNIT_ASSERT( table.get(handleA) == NULL );
+		CPPUNIT_ASSERT( table.remove(handleA) == false );
+
+		// b takes over a's slot but not a's handle
+		SlotHandle handleB = table.add(&b);
+		CPPUNIT_ASSERT_EQUAL( handleA.slot, handleB.slot );
+		CPPUNIT_ASSERT( table.get(handleA) == NULL );
+		CPPUNIT_ASSERT( table.get(handleB) == &b );
+		CPPUNIT_ASSERT_EQUAL( 1, table.size() );
+
+		CPPUNIT_ASSERT( table.get(SlotHandle()) == NULL );
+		CPPUNIT_ASSERT( table.get(SlotHandle(5, 0)) == NULL );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( ObjectPoolTest );
+//
@@ -0,0 +1,119 @@
+// ==============================================================
+//	This file is part of ZetaGlest Unit Tests (www.zetaglest.org)
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 3 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "synch_trace.h"
+#include <cstdio>
+#include <vector>
+
+using namespace Shared::Util;
+
+//
+// Tests for the binary synch trace recorder
+//
+class SynchTraceTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( SynchTraceTest );
+
+	CPPUNIT_TEST( test_ring_buffer_drops_partial_frame );
+	CPPUNIT_TEST( test_save_and_load );
+	CPPUNIT_TEST( test_find_first_divergence );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+	static void addFrame(SynchTrace &trace, int frame, int units, int valueOffset) {
+		for (int unit = 0; unit < units; ++unit) {
+			trace.add(frame, unit, 1, frame * 10 + unit);
+			trace.add(frame, unit, 2, frame + valueOffset);
+		}
+	}
+
+public:
+
+	void test_ring_buffer_drops_partial_frame() {
+		SynchTrace trace;
+		trace.init(10);
+		addFrame(trace, 1, 2, 0);
+		addFrame(trace, 2, 2, 0);
+
+		std::vector<SynchTraceRecord> records;
+		trace.getRecords(records);
+		CPPUNIT_ASSERT_EQUAL( (size_t)8, records.size() );
+		CPPUNIT_ASSERT_EQUAL( 1, (int)records.front().frame );
+
+		// frame 1 is partly overwritten and must not be reported
+		addFrame(trace, 3, 2, 0);
+		trace.getRecords(records);
+		CPPUNIT_ASSERT_EQUAL( (size_t)8, records.size() );
+		CPPUNIT_ASSERT_EQUAL( 2, (int)records.front().frame );
+		CPPUNIT_ASSERT_EQUAL( 3, (int)records.back().frame );
+	}
+
+	void test_save_and_load() {
+		SynchTrace trace;
+		trace.init(64);
+		addFrame(trace, 1, 3, 0);
+		addFrame(trace, 2, 3, -7);
+
+		const std::string path = "synch_trace_test.bin";
+		trace.save(path);
+
+		std::vector<SynchTraceRecord> expected;
+		trace.getRecords(expected);
+		std::vector<SynchTraceRecord> loaded;
+		SynchTrace::load(path, loaded);
+		remove(path.c_str());
+
+		CPPUNIT_ASSERT_EQUAL( expected.size(), loaded.size() );
+		for (unsigned int i = 0; i < expected.size(); ++i) {
+			CPPUNIT_ASSERT( expected[i] == loaded[i] );
+		}
+	}
+
+	void test_find_first_divergence() {
+		SynchTrace server;
+		server.init(100);
+		SynchTrace client;
+		client.init(16);
+		for (int frame = 1; frame <= 6; ++frame) {
+			addFrame(server, frame, 2, 0);
+			// the client goes wrong on frame 5
+			addFrame(client, frame, 2, (frame >= 5 ? 1 : 0));
+		}
+
+		std::vector<SynchTraceRecord> serverRecords;
+		server.getRecords(serverRecords);
+		std::vector<SynchTraceRecord> clientRecords;
+		client.getRecords(clientRecords);
+
+		SynchTraceDivergence divergence;
+		CPPUNIT_ASSERT_EQUAL( true, SynchTrace::findFirstDivergence(serverRecords, clientRecords, divergence) );
+		CPPUNIT_ASSERT_EQUAL( 5, (int)divergence.first.frame );
+		CPPUNIT_ASSERT_EQUAL( 0, (int)divergence.first.id );
+		CPPUNIT_ASSERT_EQUAL( 2, (int)divergence.first.tag );
+		CPPUNIT_ASSERT_EQUAL( 5, (int)divergence.first.value );
+		CPPUNIT_ASSERT_EQUAL( 6, (int)divergence.second.value );
+
+		// a trace saved part way through its last frame is not a desync
+		server.clear();
+		for (int frame = 1; frame <= 4; ++frame) {
+			addFrame(server, frame, 2, 0);
+		}
+		server.add(5, 0, 1, 50);
+		server.getRecords(serverRecords);
+		CPPUNIT_ASSERT_EQUAL( false, SynchTrace::findFirstDivergence(serverRecords, clientRecords, divergence) );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( SynchTraceTest );
+//
@@ -0,0 +1,63 @@
+// ==============================================================
+//	This file is part of ZetaGlest Unit Tests (www.zetaglest.org)
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 3 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "time_histogram.h"
+
+using namespace Shared::Util;
+
+//
+// Tests for the duration histogram
+//
+class TimeHistogramTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( TimeHistogramTest );
+
+	CPPUNIT_TEST( test_percentiles );
+	CPPUNIT_TEST( test_samples_past_last_bucket );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_percentiles() {
+		TimeHistogram histogram(1000, 10);
+		for (int i = 0; i < 90; ++i) {
+			histogram.add(500);
+		}
+		for (int i = 0; i < 10; ++i) {
+			histogram.add(4500);
+		}
+
+		CPPUNIT_ASSERT_EQUAL( 100, histogram.getCount() );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 1.0, histogram.getPercentileMillis(0.50), 0.0001 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 5.0, histogram.getPercentileMillis(0.95), 0.0001 );
+
+		histogram.clear();
+		CPPUNIT_ASSERT_EQUAL( 0, histogram.getCount() );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.0, histogram.getPercentileMillis(0.50), 0.0001 );
+	}
+
+	void test_samples_past_last_bucket() {
+		TimeHistogram histogram(1000, 10);
+		histogram.add(2000);
+		histogram.add(250000);
+
+		// the slow sample is only known by its maximum
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 3.0, histogram.getPercentileMillis(0.25), 0.0001 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 250.0, histogram.getPercentileMillis(0.99), 0.0001 );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( TimeHistogramTest );
+//